@@ -0,0 +1,23 @@
+/*
+ * Switches.cpp
+ *
+ *  Created on: Dec 18, 2020
+ *  Edited on:  Jan 16, 2021
+ *      Author: Cooper Brotherton
+ */
+/* DriverLib Includes */
+#include <Switch.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "periph.hpp"
+
+/* S1, the C modules still use SWITCH_PORT and SWITCH_PIN */
+using S1 = periph::Pin<1, 1>;
+
+static_assert(S1::port == SWITCH_PORT && S1::mask == SWITCH_PIN,
+              "S1 must match SWITCH_PORT and SWITCH_PIN");
+
+void Switch_init(void)
+{
+    S1::asInputPullUp();
+}
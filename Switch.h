@@ -23,7 +23,7 @@ extern "C" {
  * \brief This function configures the switches as inputs
  *
  * This function configures P1.1 as an input pin with a pull-up resistor.
- * Port 1 interrupts are enabled.
+ * Edge interrupts are left disabled; the switch is sampled by debounce.c.
  *
  * \return None
  */
@@ -0,0 +1,538 @@
+/*!
+ * acquisition.c
+ *      Description: Helper file for the ADC14 acquisition path. The ADC is
+ *                   clocked from MCLK and paced by TimerA1 from SMCLK, so
+ *                   both are retimed on every clock profile change.
+ *
+ *                   TimerA1 runs at twice the rate of the fastest channel
+ *                   and each rising edge of its CCR1 output converts the
+ *                   next memory of the repeated MEM14, MEM15 sequence. Only
+ *                   MEM15 interrupts, once per pair, and the handler stores
+ *                   the results of the channels that are due, so the CPU
+ *                   takes one interrupt per trigger period and no software
+ *                   trigger. When both channels are quiet the trigger slows
+ *                   down with them, down to one interrupt every 8 ms.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "acquisition.h"
+#include "defer.h"
+#include "priorities.h"
+#include "power.h"
+#include "clock.h"
+#include "instrument.h"
+#include "trace.h"
+#include "capture.h"
+#include "detector.h"
+#include "ramfunc.h"
+
+/* ADC14 input clock limit */
+#define ADC_CLOCK_MAX       24000000
+/* Sample and hold time used at 3 MHz (4 ADC clocks), in ns */
+#define ADC_SAMPLE_TIME_NS  1334
+
+static EventQueue *sampleQueue;
+static int sampleWork = DEFER_INVALID_WORK;
+/* MCLK/SMCLK ratio, for the interrupt latency */
+static uint32_t smclkRatio = 1;
+
+/* Per channel state. Blocks are written by the ADC interrupt until posted,
+ * then held by the deferred work until released. stride and phase belong to
+ * the interrupt and are only changed with it masked; level and the rate
+ * controller belong to the deferred work. */
+typedef struct
+{
+    uint16_t blocks[ACQ_NUM_BLOCKS][ACQ_BLOCK_SIZE];
+    uint16_t blockRate[ACQ_NUM_BLOCKS];
+    /* Rate of the samples after the first rate change of a block, or of
+     * all of them, and the samples, rate and time of the last sample before
+     * that change, splitCount 0 if there was none */
+    uint16_t endRate[ACQ_NUM_BLOCKS];
+    uint8_t splitCount[ACQ_NUM_BLOCKS];
+    uint16_t splitRate[ACQ_NUM_BLOCKS];
+    uint32_t splitTime[ACQ_NUM_BLOCKS];
+    volatile bool held[ACQ_NUM_BLOCKS];
+    uint8_t filling;
+    uint16_t fillCount;
+    uint8_t sampleLevel;
+    uint32_t sampleTime;
+    uint8_t stride;
+    uint8_t phase;
+    volatile uint8_t level;
+    uint8_t fastestLevel;
+    uint8_t slowestLevel;
+    uint8_t quietBlocks;
+    bool haveMean;
+    uint16_t lastMean;
+    uint32_t residencyMs[ACQ_RATE_LEVELS];
+    uint32_t changes;
+} Channel;
+
+static Channel channels[NUM_CHANNELS];
+/* Level of the fastest channel, TimerA1 triggers at its rate */
+static uint8_t triggerLevel;
+static volatile uint32_t overruns;
+
+static const uint32_t pulseWidths[] = { ADC_PULSE_WIDTH_4, ADC_PULSE_WIDTH_8,
+                                        ADC_PULSE_WIDTH_16, ADC_PULSE_WIDTH_32,
+                                        ADC_PULSE_WIDTH_64, ADC_PULSE_WIDTH_96,
+                                        ADC_PULSE_WIDTH_128,
+                                        ADC_PULSE_WIDTH_192 };
+static const uint16_t pulseCycles[] = { 4, 8, 16, 32, 64, 96, 128, 192 };
+#define NUM_PULSE_WIDTHS    (sizeof(pulseCycles) / sizeof(pulseCycles[0]))
+
+/*!
+ * Selects the ADC clock divider and sample and hold time for an MCLK
+ * frequency and applies them. Conversions must be disabled.
+ *
+ * \param mclk MCLK frequency in Hz
+ *
+ * \return None
+ */
+static void configureClock(uint32_t mclk)
+{
+    uint32_t divider = ADC_DIVIDER_1;
+    uint32_t adcClock = mclk;
+    if (mclk > ADC_CLOCK_MAX)
+    {
+        divider = ADC_DIVIDER_2;
+        adcClock = mclk / 2;
+    }
+    ADC14_initModule(ADC_CLOCKSOURCE_MCLK, ADC_PREDIVIDER_1, divider, 0);
+    smclkRatio = mclk / Clock_getSMCLK();
+
+    // Shortest pulse that still gives the inputs the original settling time
+    uint32_t needed = (uint32_t) (((uint64_t) adcClock * ADC_SAMPLE_TIME_NS)
+            / 1000000000);
+    uint32_t i = 0;
+    while (i < NUM_PULSE_WIDTHS - 1 && pulseCycles[i] < needed)
+    {
+        i++;
+    }
+    ADC14_setSampleHoldTime(pulseWidths[i], pulseWidths[i]);
+}
+
+/*!
+ * Returns the sample rate of a level.
+ *
+ * \param level Rate level
+ *
+ * \return Rate in Hz
+ */
+static uint16_t levelRate(uint8_t level)
+{
+    return ACQ_SAMPLE_HZ >> level;
+}
+
+/*!
+ * Returns the TimerA1 period for two conversions per trigger period.
+ *
+ * \return CCR0 value, below 2^16 for SMCLK up to CLOCK_SMCLK_MAX
+ */
+static uint16_t triggerPeriod(void)
+{
+    return Clock_getSMCLK() / (2 * levelRate(triggerLevel)) - 1;
+}
+
+/*!
+ * Retimes TimerA1 for the trigger level. The count restarts so a shorter
+ * period never waits for the counter to wrap.
+ *
+ * \return None
+ */
+static void setTriggerPeriod(void)
+{
+    uint16_t period = triggerPeriod();
+
+    Timer_A_setCompareValue(TIMER_A1_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0,
+                            period);
+    Timer_A_setCompareValue(TIMER_A1_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_1,
+                            period / 2);
+    Timer_A_clearTimer(TIMER_A1_BASE);
+}
+
+/*!
+ * Moves the trigger to the fastest channel and gives every channel the
+ * stride that keeps its own rate. The ADC interrupt is masked meanwhile so
+ * it never sees a stride of the old trigger rate with the new one.
+ *
+ * \return None
+ */
+static void applyRates(void)
+{
+    uint8_t fastest = ACQ_RATE_LEVELS - 1;
+    uint8_t i;
+
+    for (i = 0; i < NUM_CHANNELS; i++)
+    {
+        if (channels[i].level < fastest)
+        {
+            fastest = channels[i].level;
+        }
+    }
+
+    Interrupt_disableInterrupt(INT_ADC14);
+    for (i = 0; i < NUM_CHANNELS; i++)
+    {
+        channels[i].stride = 1 << (channels[i].level - fastest);
+        channels[i].phase = 0;
+    }
+    if (fastest != triggerLevel)
+    {
+        triggerLevel = fastest;
+        setTriggerPeriod();
+    }
+    Interrupt_enableInterrupt(INT_ADC14);
+}
+
+/*!
+ * Changes the rate level of a channel.
+ *
+ * \param channel Channel number
+ * \param level New level
+ *
+ * \return None
+ */
+static void setLevel(uint8_t channel, uint8_t level)
+{
+    Channel *ch = &channels[channel];
+
+    if (level == ch->level)
+    {
+        return;
+    }
+    ch->level = level;
+    ch->quietBlocks = 0;
+    ch->changes++;
+    TRACE(TRACE_ACQ_RATE, ((uint16_t) channel << 12) | levelRate(level));
+    applyRates();
+}
+
+/*!
+ * Measures the slope and variance of a block and picks the next rate of its
+ * channel: the fastest allowed when active, one step slower after
+ * ACQ_QUIET_BLOCKS quiet blocks.
+ *
+ * \param channel Channel number
+ * \param samples Block samples
+ * \param rate Rate the block was sampled at, 0 if mixed
+ *
+ * \return None
+ */
+static void adaptRate(uint8_t channel, const uint16_t *samples, uint16_t rate)
+{
+    Channel *ch = &channels[channel];
+    uint32_t sum = 0;
+    uint64_t squares = 0;
+    uint16_t i;
+
+    if (rate == 0)
+    {
+        rate = levelRate(ch->level);
+    }
+    ch->residencyMs[ch->level] += ACQ_BLOCK_SIZE * 1000UL / rate;
+
+    for (i = 0; i < ACQ_BLOCK_SIZE; i++)
+    {
+        sum += samples[i];
+        squares += (uint32_t) samples[i] * samples[i];
+    }
+    uint16_t mean = sum / ACQ_BLOCK_SIZE;
+    uint32_t variance = (uint32_t) ((squares - (uint64_t) sum * sum
+            / ACQ_BLOCK_SIZE) / ACQ_BLOCK_SIZE);
+    // Change of the mean over one block period, in counts per second
+    uint32_t slope = 0;
+    if (ch->haveMean)
+    {
+        uint16_t change = mean > ch->lastMean ?
+                mean - ch->lastMean : ch->lastMean - mean;
+        slope = (uint32_t) change * rate / ACQ_BLOCK_SIZE;
+    }
+    ch->lastMean = mean;
+    ch->haveMean = true;
+
+    if (slope > ACQ_SLOPE_UP
+            || variance > (uint32_t) ACQ_STDDEV_UP * ACQ_STDDEV_UP)
+    {
+        ch->quietBlocks = 0;
+        setLevel(channel, ch->fastestLevel);
+    }
+    else if (slope < ACQ_SLOPE_DOWN
+            && variance < (uint32_t) ACQ_STDDEV_DOWN * ACQ_STDDEV_DOWN)
+    {
+        if (++ch->quietBlocks >= ACQ_QUIET_BLOCKS
+                && ch->level < ch->slowestLevel)
+        {
+            setLevel(channel, ch->level + 1);
+        }
+    }
+    else
+    {
+        ch->quietBlocks = 0;
+    }
+}
+
+void Acq_init(EventQueue *queue, int notifyWork)
+{
+    uint8_t i;
+
+    sampleQueue = queue;
+    sampleWork = notifyWork;
+    memset(channels, 0, sizeof(channels));
+    for (i = 0; i < NUM_CHANNELS; i++)
+    {
+        channels[i].stride = 1;
+        channels[i].slowestLevel = ACQ_RATE_LEVELS - 1;
+    }
+    triggerLevel = 0;
+    overruns = 0;
+
+    ADC14_enableModule();
+    configureClock(Clock_getMCLK());
+
+    // Configuring GPIOs (6.0, 6.1; A15, A14)
+    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P6,
+                                               GPIO_PIN0 | GPIO_PIN1,
+                                               GPIO_TERTIARY_MODULE_FUNCTION);
+
+    // Configuring ADC, one conversion per TA1.1 edge
+    ADC14_configureMultiSequenceMode(ADC_MEM14, ADC_MEM15, true);
+    ADC14_configureConversionMemory(ADC_MEM14,
+                                    ADC_VREFPOS_AVCC_VREFNEG_VSS,
+                                    ADC_INPUT_A14, false);
+    ADC14_configureConversionMemory(ADC_MEM15,
+                                    ADC_VREFPOS_AVCC_VREFNEG_VSS,
+                                    ADC_INPUT_A15, false);
+    ADC14_setSampleHoldTrigger(ADC_TRIGGER_SOURCE3, false);
+    ADC14_enableSampleTimer(ADC_MANUAL_ITERATION);
+    ADC14_enableInterrupt(ADC_INT15);
+    Interrupt_setPriority(INT_ADC14, PRIORITY_ADC14);
+    Interrupt_enableInterrupt(INT_ADC14);
+    ADC14_enableConversion();
+
+    // TimerA1 sets OUT1 at CCR1 and resets it at CCR0, one edge per period
+    uint16_t period = triggerPeriod();
+    const Timer_A_UpModeConfig upConfig = { TIMER_A_CLOCKSOURCE_SMCLK,
+                                            TIMER_A_CLOCKSOURCE_DIVIDER_1,
+                                            period,
+                                            TIMER_A_TAIE_INTERRUPT_DISABLE,
+                                            TIMER_A_CCIE_CCR0_INTERRUPT_DISABLE,
+                                            TIMER_A_DO_CLEAR };
+    const Timer_A_CompareModeConfig compareConfig = {
+            TIMER_A_CAPTURECOMPARE_REGISTER_1,
+            TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE,
+            TIMER_A_OUTPUTMODE_SET_RESET, period / 2 };
+    Timer_A_configureUpMode(TIMER_A1_BASE, &upConfig);
+    Timer_A_initCompare(TIMER_A1_BASE, &compareConfig);
+    Timer_A_startCounter(TIMER_A1_BASE, TIMER_A_UP_MODE);
+}
+
+const uint16_t *Acq_getBlock(uint8_t index, uint8_t channel)
+{
+    return channels[channel % NUM_CHANNELS].blocks[index % ACQ_NUM_BLOCKS];
+}
+
+uint16_t Acq_getBlockRate(uint8_t index, uint8_t channel)
+{
+    return channels[channel % NUM_CHANNELS].blockRate[index % ACQ_NUM_BLOCKS];
+}
+
+void Acq_captureBlock(uint8_t index, uint8_t channel, uint32_t timestamp)
+{
+    Channel *ch = &channels[channel % NUM_CHANNELS];
+    uint8_t split;
+
+    index %= ACQ_NUM_BLOCKS;
+    split = ch->splitCount[index];
+    // One record per rate, so replay spaces each part at its own rate
+    if (split != 0)
+    {
+        Capture_adc(channel, ch->blocks[index], split, ch->splitRate[index],
+                    ch->splitTime[index]);
+    }
+    Capture_adc(channel, &ch->blocks[index][split], ACQ_BLOCK_SIZE - split,
+                ch->endRate[index], timestamp);
+}
+
+void Acq_releaseBlock(uint8_t index, uint8_t channel)
+{
+    Channel *ch = &channels[channel % NUM_CHANNELS];
+
+    index %= ACQ_NUM_BLOCKS;
+    adaptRate(channel % NUM_CHANNELS, ch->blocks[index],
+              ch->blockRate[index]);
+    ch->held[index] = false;
+}
+
+void Acq_setRateLimits(uint8_t channel, uint16_t minHz, uint16_t maxHz)
+{
+    Channel *ch = &channels[channel % NUM_CHANNELS];
+    uint8_t fastest = 0;
+    uint8_t slowest = ACQ_RATE_LEVELS - 1;
+
+    while (fastest < ACQ_RATE_LEVELS - 1 && levelRate(fastest) > maxHz)
+    {
+        fastest++;
+    }
+    while (slowest > fastest && levelRate(slowest) < minHz)
+    {
+        slowest--;
+    }
+    ch->fastestLevel = fastest;
+    ch->slowestLevel = slowest;
+    if (ch->level < fastest)
+    {
+        setLevel(channel % NUM_CHANNELS, fastest);
+    }
+    else if (ch->level > slowest)
+    {
+        setLevel(channel % NUM_CHANNELS, slowest);
+    }
+}
+
+uint16_t Acq_getRate(uint8_t channel)
+{
+    return levelRate(channels[channel % NUM_CHANNELS].level);
+}
+
+uint32_t Acq_getOverruns(void)
+{
+    return overruns;
+}
+
+void Acq_report(void (*write)(const char *line))
+{
+    char line[40];
+    uint8_t level;
+
+    write("sample rate residency:   A14 ms     A15 ms");
+    for (level = 0; level < ACQ_RATE_LEVELS; level++)
+    {
+        sprintf(line, "  %4u Hz %15lu %10lu", levelRate(level),
+                (unsigned long) channels[CHANNEL_PHOTO].residencyMs[level],
+                (unsigned long) channels[CHANNEL_POT].residencyMs[level]);
+        write(line);
+    }
+    sprintf(line, "  changes %14lu %10lu",
+            (unsigned long) channels[CHANNEL_PHOTO].changes,
+            (unsigned long) channels[CHANNEL_POT].changes);
+    write(line);
+}
+
+void Acq_retime(uint32_t mclk)
+{
+    ADC14_disableConversion();
+    configureClock(mclk);
+    setTriggerPeriod();
+    // Restarts the sequence at MEM14, a half converted pair is redone
+    ADC14_enableConversion();
+}
+
+/*!
+ * Runs the detector of a channel on one sample, stores it and posts its
+ * block once it is full. If the deferred work still holds the other block
+ * of the channel, the full block is refilled instead and counted as an
+ * overrun. The deferred work is requested for a detection too.
+ *
+ * \param channel Channel number
+ * \param value ADC result
+ * \param timestamp Time of the conversion pair
+ *
+ * \return None
+ */
+RAMFUNC static void storeSample(uint8_t channel, uint16_t value,
+                                uint32_t timestamp)
+{
+    Channel *ch = &channels[channel];
+
+    if (Detector_sample(channel, value, timestamp))
+    {
+        Defer_request(sampleWork);
+    }
+    if (ch->fillCount == 0)
+    {
+        ch->splitCount[ch->filling] = 0;
+    }
+    else if (ch->level != ch->sampleLevel && ch->splitCount[ch->filling] == 0)
+    {
+        // The samples so far were taken at the old rate
+        ch->splitCount[ch->filling] = (uint8_t) ch->fillCount;
+        ch->splitRate[ch->filling] = levelRate(ch->sampleLevel);
+        ch->splitTime[ch->filling] = ch->sampleTime;
+    }
+    ch->sampleLevel = ch->level;
+    ch->sampleTime = timestamp;
+    ch->blocks[ch->filling][ch->fillCount] = value;
+    if (++ch->fillCount < ACQ_BLOCK_SIZE)
+    {
+        return;
+    }
+    ch->fillCount = 0;
+
+    uint8_t next = (ch->filling + 1) % ACQ_NUM_BLOCKS;
+    Event event;
+    event.timestamp = timestamp;
+    event.value = ch->filling;
+    event.type = EVENT_ADC_BLOCK;
+    event.channel = channel;
+    if (ch->held[next] || !Queue_push(sampleQueue, &event))
+    {
+        overruns++;
+        return;
+    }
+    ch->endRate[ch->filling] = levelRate(ch->level);
+    ch->blockRate[ch->filling] = ch->splitCount[ch->filling] == 0 ?
+            ch->endRate[ch->filling] : 0;
+    ch->held[ch->filling] = true;
+    ch->filling = next;
+    Defer_request(sampleWork);
+}
+
+/* !
+ * \brief This function handles ADC conversions
+ *
+ * This function stores each pair of results in the current blocks of the
+ * channels due at this trigger, both stamped with the time of the
+ * interrupt. ADC_MEM14 is connected to a photoresistor
+ * and ADC_MEM15 is connected to a potentiometer. Runs from SRAM.
+ *
+ * \return None
+ */
+RAMFUNC void ADC14_IRQHandler(void)
+{
+    INSTR_ISR_ENTER(INSTR_ISR_ADC14);
+    TRACE(TRACE_ISR_ADC14_BEGIN, 0);
+    uint32_t now = Power_timestamp();
+    // TA1R counts SMCLK periods since the CCR1 edge that started the
+    // conversion, so the latency includes the fixed conversion time
+    uint16_t count = TIMER_A1->R;
+    uint16_t edge = TIMER_A1->CCR[1];
+    INSTR_ISR_LATENCY(INSTR_ISR_ADC14, smclkRatio * (count >= edge ?
+            count - edge : count + TIMER_A1->CCR[0] + 1 - edge));
+    uint64_t status = MAP_ADC14_getEnabledInterruptStatus();
+    MAP_ADC14_clearInterruptFlag(status);
+    // MEM15 completes the pair, MEM14 is already valid
+    if (ADC_INT15 & status)
+    {
+        // Slower channels keep one pair in stride
+        if (++channels[CHANNEL_PHOTO].phase >= channels[CHANNEL_PHOTO].stride)
+        {
+            channels[CHANNEL_PHOTO].phase = 0;
+            storeSample(CHANNEL_PHOTO, MAP_ADC14_getResult(ADC_MEM14), now);
+        }
+        if (++channels[CHANNEL_POT].phase >= channels[CHANNEL_POT].stride)
+        {
+            channels[CHANNEL_POT].phase = 0;
+            storeSample(CHANNEL_POT, MAP_ADC14_getResult(ADC_MEM15), now);
+        }
+    }
+    TRACE(TRACE_ISR_ADC14_END, status >> 14);
+    INSTR_ISR_EXIT(INSTR_ISR_ADC14);
+}
@@ -0,0 +1,201 @@
+/*!
+ * acquisition.h
+ *      Description: Header file for the ADC14 acquisition path. The
+ *                   photoresistor (A14) and potentiometer (A15) are sampled,
+ *                   paced by TimerA1 in hardware, into double-buffered blocks
+ *                   of ACQ_BLOCK_SIZE samples per channel. Each full block
+ *                   is posted to an event queue for deferred work in
+ *                   PendSV, which hands it back with Acq_releaseBlock.
+ *
+ *                   Each channel has its own sample rate, from
+ *                   ACQ_SAMPLE_HZ down to ACQ_MIN_SAMPLE_HZ in steps of two.
+ *                   The slope and variance of every released block decide
+ *                   it: a quiet channel steps down one rate after
+ *                   ACQ_QUIET_BLOCKS quiet blocks, an active one returns to
+ *                   its fastest rate at once. Between the two thresholds the
+ *                   rate is kept.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef ACQUISITION_H_
+#define ACQUISITION_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#include "queue.h"
+
+/* Channel numbers used in Event.channel */
+#define CHANNEL_PHOTO       0
+#define CHANNEL_POT         1
+#define NUM_CHANNELS        2
+
+/* Full scale of a 14-bit result */
+#define ADC_FULL_SCALE      16384
+
+/* Fastest sample rate of each channel and samples per channel in a block */
+#define ACQ_SAMPLE_HZ       1000
+#define ACQ_BLOCK_SIZE      32
+#define ACQ_NUM_BLOCKS      2
+
+/* Sample rates ACQ_SAMPLE_HZ >> level, level 0 to ACQ_RATE_LEVELS - 1 */
+#define ACQ_RATE_LEVELS     4
+#define ACQ_MIN_SAMPLE_HZ   (ACQ_SAMPLE_HZ >> (ACQ_RATE_LEVELS - 1))
+
+/* Activity thresholds in ADC counts, up to go fast, down to count as quiet */
+#define ACQ_SLOPE_UP        400     // change of the block mean, per second
+#define ACQ_SLOPE_DOWN      150
+#define ACQ_STDDEV_UP       24      // standard deviation within a block
+#define ACQ_STDDEV_DOWN     12
+
+/* Quiet blocks in a row before a channel steps down one rate */
+#define ACQ_QUIET_BLOCKS    4
+
+/*!
+ * \brief This function initializes the ADC and its input pins
+ *
+ * This function configures A14 and A15 as a repeated sequence triggered by
+ * TimerA1 and starts sampling both channels at ACQ_SAMPLE_HZ. Each full
+ * block is posted to queue as an EVENT_ADC_BLOCK with the block index as
+ * value and its channel, and notifyWork is requested with Defer_request.
+ * The ADC interrupt gets PRIORITY_ADC14.
+ *
+ * \param queue is the queue results are posted to
+ * \param notifyWork is the deferred work id to request on each result
+ *
+ * \return None
+ */
+extern void Acq_init(EventQueue *queue, int notifyWork);
+
+/*!
+ * \brief This function returns the samples of a posted block
+ *
+ * \param index is the block index from the EVENT_ADC_BLOCK event
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ *
+ * \return ACQ_BLOCK_SIZE results, oldest first, valid until the block is
+ *         released
+ */
+extern const uint16_t *Acq_getBlock(uint8_t index, uint8_t channel);
+
+/*!
+ * \brief This function returns the sample rate of a posted block
+ *
+ * \param index is the block index from the EVENT_ADC_BLOCK event
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ *
+ * \return Sample rate in Hz, 0 if the rate changed while the block filled
+ */
+extern uint16_t Acq_getBlockRate(uint8_t index, uint8_t channel);
+
+/*!
+ * \brief This function records a posted block in the input capture
+ *
+ * A block that spans a rate change is recorded as two parts, each with the
+ * rate and the time of its last sample. Call from the deferred work before
+ * the block is released.
+ *
+ * \param index is the block index from the EVENT_ADC_BLOCK event
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ * \param timestamp is the timestamp of the EVENT_ADC_BLOCK event
+ *
+ * \return None
+ */
+extern void Acq_captureBlock(uint8_t index, uint8_t channel,
+                             uint32_t timestamp);
+
+/*!
+ * \brief This function hands a posted block back to the ADC interrupt
+ *
+ * This function also measures the activity of the block and adjusts the
+ * sample rate of its channel, so every posted block must be released once.
+ *
+ * \param index is the block index from the EVENT_ADC_BLOCK event
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ *
+ * \return None
+ */
+extern void Acq_releaseBlock(uint8_t index, uint8_t channel);
+
+/*!
+ * \brief This function limits the sample rate of a channel
+ *
+ * Rates are rounded to the ACQ_SAMPLE_HZ >> level steps inside the limits.
+ * Equal limits fix the rate. The current rate is moved inside the limits
+ * immediately.
+ *
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ * \param minHz is the slowest rate, at least ACQ_MIN_SAMPLE_HZ
+ * \param maxHz is the fastest rate, at most ACQ_SAMPLE_HZ
+ *
+ * \return None
+ */
+extern void Acq_setRateLimits(uint8_t channel, uint16_t minHz,
+                              uint16_t maxHz);
+
+/*!
+ * \brief This function returns the current sample rate of a channel
+ *
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ *
+ * \return Sample rate in Hz
+ */
+extern uint16_t Acq_getRate(uint8_t channel);
+
+/*!
+ * \brief This function returns the number of dropped blocks
+ *
+ * A block is dropped when it fills while the other one of its channel has
+ * not been released yet.
+ *
+ * \return Dropped blocks since Acq_init
+ */
+extern uint32_t Acq_getOverruns(void);
+
+/*!
+ * \brief This function writes the sample rate history
+ *
+ * This function writes, for each rate, the time each channel spent at it,
+ * and the number of rate changes. Each change is also traced as
+ * TRACE_ACQ_RATE.
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void Acq_report(void (*write)(const char *line));
+
+/*!
+ * \brief This function retimes the ADC for a new MCLK frequency
+ *
+ * This function keeps the ADC clock within its limit, keeps the sample and
+ * hold time at least as long as at 3 MHz and keeps the sample rates.
+ * Registered as a clock listener.
+ *
+ * \param mclk is the new MCLK frequency in Hz
+ *
+ * \return None
+ */
+extern void Acq_retime(uint32_t mclk);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ACQUISITION_H_ */
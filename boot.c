@@ -0,0 +1,106 @@
+/*!
+ * boot.c
+ *      Description: Helper file for boot latency measurement. Power_timestamp
+ *                   counts MCLK cycles, so the elapsed time is folded into
+ *                   microseconds at every clock change and the cycles since
+ *                   the last change are converted at the current rate.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <stdio.h>
+
+#include "boot.h"
+#include "power.h"
+
+static const char * const milestoneNames[BOOT_NUM_MILESTONES] = {
+    "setup done", "first block", "lcd ready", "first display" };
+
+/* Microseconds up to segmentStart, and the MCLK rate since then */
+static uint32_t baseMicros;
+static uint32_t segmentStart;
+static uint32_t segmentMclk;
+
+static uint32_t milestoneMicros[BOOT_NUM_MILESTONES];
+static bool reached[BOOT_NUM_MILESTONES];
+
+/*!
+ * Converts cycles since segmentStart to microseconds at the segment rate.
+ *
+ * \param now Power_timestamp reading
+ *
+ * \return Microseconds
+ */
+static uint32_t segmentMicros(uint32_t now)
+{
+    return (uint32_t) (((uint64_t) (now - segmentStart) * 1000000)
+            / segmentMclk);
+}
+
+void Boot_init(uint32_t mclk)
+{
+    int i;
+
+    baseMicros = 0;
+    segmentStart = Power_timestamp();
+    segmentMclk = mclk;
+    for (i = 0; i < BOOT_NUM_MILESTONES; i++)
+    {
+        milestoneMicros[i] = 0;
+        reached[i] = false;
+    }
+}
+
+void Boot_clock(uint32_t mclk)
+{
+    // Only matters until the last milestone
+    if (reached[BOOT_NUM_MILESTONES - 1])
+    {
+        return;
+    }
+    uint32_t now = Power_timestamp();
+    baseMicros += segmentMicros(now);
+    segmentStart = now;
+    segmentMclk = mclk;
+}
+
+bool Boot_mark(Boot_Milestone milestone)
+{
+    if (milestone >= BOOT_NUM_MILESTONES || reached[milestone])
+    {
+        return false;
+    }
+    milestoneMicros[milestone] = baseMicros + segmentMicros(Power_timestamp());
+    reached[milestone] = true;
+    return true;
+}
+
+uint32_t Boot_getMicros(Boot_Milestone milestone)
+{
+    if (milestone >= BOOT_NUM_MILESTONES)
+    {
+        return 0;
+    }
+    return milestoneMicros[milestone];
+}
+
+void Boot_report(void (*write)(const char *line))
+{
+    char line[40];
+    int i;
+
+    write("boot:");
+    for (i = 0; i < BOOT_NUM_MILESTONES; i++)
+    {
+        if (reached[i])
+        {
+            sprintf(line, "  %-14s %8lu us", milestoneNames[i],
+                    (unsigned long) milestoneMicros[i]);
+        }
+        else
+        {
+            sprintf(line, "  %-14s %8s", milestoneNames[i], "-");
+        }
+        write(line);
+    }
+}
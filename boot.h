@@ -0,0 +1,104 @@
+/*!
+ * boot.h
+ *      Description: Header file for boot latency measurement. Records the
+ *                   time from the start of setup to each boot milestone in
+ *                   microseconds, following MCLK changes made by the governor
+ *                   while the boot sequence is still running.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Boot milestones in the order they normally happen */
+typedef enum
+{
+    BOOT_SETUP_DONE,
+    BOOT_FIRST_BLOCK,
+    BOOT_LCD_READY,
+    BOOT_FIRST_DISPLAY,
+    BOOT_NUM_MILESTONES
+} Boot_Milestone;
+
+/*!
+ * \brief This function starts the boot clock
+ *
+ * This function sets time zero for the milestones. Power_init must have been
+ * called and MCLK must be set to mclk.
+ *
+ * \param mclk is the current MCLK frequency in Hz
+ *
+ * \return None
+ */
+extern void Boot_init(uint32_t mclk);
+
+/*!
+ * \brief This function keeps the boot clock in step with MCLK
+ *
+ * Registered as a clock listener. Clock_setProfile calls it with
+ * interrupts masked, so a Boot_mark never sees a half folded segment.
+ *
+ * \param mclk is the new MCLK frequency in Hz
+ *
+ * \return None
+ */
+extern void Boot_clock(uint32_t mclk);
+
+/*!
+ * \brief This function records a milestone
+ *
+ * This function records the time since Boot_init the first time a milestone
+ * is reached; later calls are ignored. Main context or deferred work: a
+ * mark in PendSV cannot split a profile change and its Boot_clock, so it is
+ * timed either at the old MCLK or at the new one. Each milestone must be
+ * marked from one context only.
+ *
+ * \param milestone is the milestone reached
+ *
+ * \return true if this call recorded the milestone
+ */
+extern bool Boot_mark(Boot_Milestone milestone);
+
+/*!
+ * \brief This function returns the time of a milestone
+ *
+ * \param milestone is the milestone to look up
+ *
+ * \return Microseconds from Boot_init, 0 if not reached yet
+ */
+extern uint32_t Boot_getMicros(Boot_Milestone milestone);
+
+/*!
+ * \brief This function writes the milestone times
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void Boot_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOOT_H_ */
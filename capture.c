@@ -0,0 +1,229 @@
+/*!
+ * capture.c
+ *      Description: Helper file for the input capture recorder. The dump
+ *                   format is line based so it survives a terminal capture:
+ *
+ *                       CAPTURE BEGIN <bytes> <dropped records>
+ *                       <CAPTURE_LINE_BYTES bytes as hex>
+ *                       CAPTURE END
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+
+#include "capture.h"
+#include "acquisition.h"
+#include "clock.h"
+#include "codec.h"
+#include "power.h"
+
+/* Tag byte and a 32-bit varint */
+#define MAX_HEAD_BYTES      6
+/* A 32-bit varint */
+#define MAX_VARINT_BYTES    5
+#define NUM_ADC_CHANNELS    16
+
+#if CAPTURE_ENABLE
+static uint8_t captureBuffer[CAPTURE_BUFFER_SIZE];
+static uint32_t captureLength = 0;
+static uint32_t droppedRecords = 0;
+static bool captureRunning = false;
+static uint32_t lastTimestamp;
+static uint32_t lastInput;
+/* Written by the deferred work only, outside the critical section */
+static uint8_t encoded[CODEC_MAX_BYTES(ACQ_BLOCK_SIZE)];
+
+static void (*dumpWrite)(const char *line) = 0;
+static uint32_t dumpNext;
+static uint32_t dumpEnd;
+static bool dumpHeader;
+
+/*!
+ * Appends a varint, 7 bits per byte with the high bit set on all but the
+ * last byte.
+ *
+ * \param value Value to append
+ *
+ * \return None
+ */
+static void putVarint(uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        captureBuffer[captureLength++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    captureBuffer[captureLength++] = (uint8_t) value;
+}
+
+/*!
+ * Checks that a record fits and appends its tag and timestamp. Interrupts
+ * must be masked.
+ *
+ * \param type Record type
+ * \param channel Channel, 0 - 15
+ * \param now Power_timestamp of the record
+ * \param payloadBytes Most bytes the payload can take
+ *
+ * \return true if the payload may be appended
+ */
+static bool beginRecord(uint8_t type, uint8_t channel, uint32_t now,
+                        uint32_t payloadBytes)
+{
+    int32_t delta;
+
+    if (!captureRunning)
+    {
+        return false;
+    }
+    if (captureLength + MAX_HEAD_BYTES + payloadBytes > CAPTURE_BUFFER_SIZE)
+    {
+        droppedRecords++;
+        return false;
+    }
+    // ADC blocks are recorded after inputs that came later, zigzag keeps
+    // the small negative steps short
+    delta = (int32_t) (now - lastTimestamp);
+    captureBuffer[captureLength++] = (type << 4) | (channel & 0x0F);
+    putVarint(((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31));
+    lastTimestamp = now;
+    return true;
+}
+#endif
+
+void Capture_init(void)
+{
+#if CAPTURE_ENABLE
+    captureLength = 0;
+    droppedRecords = 0;
+    lastTimestamp = Power_timestamp();
+    lastInput = 0;
+    captureRunning = true;
+    Capture_clock(Clock_getMCLK());
+#endif
+}
+
+void Capture_adc(uint8_t channel, const uint16_t *samples, uint32_t count,
+                 uint16_t rate, uint32_t timestamp)
+{
+#if CAPTURE_ENABLE
+    uint32_t length;
+    uint32_t primask;
+    uint32_t i;
+
+    if (!captureRunning || count == 0 || count > ACQ_BLOCK_SIZE)
+    {
+        return;
+    }
+    channel &= NUM_ADC_CHANNELS - 1;
+    length = Codec_encode(channel, samples, count, encoded);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (beginRecord(CAPTURE_ADC, channel, timestamp,
+                    2 * MAX_VARINT_BYTES + length))
+    {
+        putVarint(rate);
+        putVarint(length);
+        for (i = 0; i < length; i++)
+        {
+            captureBuffer[captureLength++] = encoded[i];
+        }
+    }
+    __set_PRIMASK(primask);
+#endif
+}
+
+void Capture_input(uint32_t raw)
+{
+#if CAPTURE_ENABLE
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (raw != lastInput && beginRecord(CAPTURE_INPUT, 0, Power_timestamp(),
+                                        MAX_VARINT_BYTES))
+    {
+        putVarint(raw);
+        lastInput = raw;
+    }
+    __set_PRIMASK(primask);
+#endif
+}
+
+void Capture_clock(uint32_t mclk)
+{
+#if CAPTURE_ENABLE
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (beginRecord(CAPTURE_CLOCK, 0, Power_timestamp(), MAX_VARINT_BYTES))
+    {
+        putVarint(mclk / 1000);
+    }
+    __set_PRIMASK(primask);
+#endif
+}
+
+void Capture_dumpBegin(void (*write)(const char *line))
+{
+#if CAPTURE_ENABLE
+    if (dumpWrite != 0)
+    {
+        return;
+    }
+    captureRunning = false;
+
+    dumpNext = 0;
+    dumpEnd = captureLength;
+    dumpWrite = write;
+    dumpHeader = true;
+#else
+    write("CAPTURE BEGIN 0 0");
+    write("CAPTURE END");
+#endif
+}
+
+bool Capture_dumpStep(uint32_t maxLines)
+{
+#if CAPTURE_ENABLE
+    static const char hex[] = "0123456789abcdef";
+    char line[2 * CAPTURE_LINE_BYTES + 1];
+    uint32_t i;
+
+    if (dumpWrite == 0)
+    {
+        return true;
+    }
+    // The header waits for the first step so it stays next to the data
+    if (dumpHeader && maxLines > 0)
+    {
+        sprintf(line, "CAPTURE BEGIN %lu %lu", (unsigned long) dumpEnd,
+                (unsigned long) droppedRecords);
+        dumpWrite(line);
+        dumpHeader = false;
+        maxLines--;
+    }
+    while (dumpNext != dumpEnd && maxLines-- > 0)
+    {
+        for (i = 0; i < CAPTURE_LINE_BYTES && dumpNext != dumpEnd; i++)
+        {
+            line[2 * i] = hex[captureBuffer[dumpNext] >> 4];
+            line[2 * i + 1] = hex[captureBuffer[dumpNext] & 0x0F];
+            dumpNext++;
+        }
+        line[2 * i] = 0;
+        dumpWrite(line);
+    }
+    if (dumpHeader || dumpNext != dumpEnd)
+    {
+        return false;
+    }
+
+    dumpWrite("CAPTURE END");
+    dumpWrite = 0;
+    Capture_init();
+#endif
+    return true;
+}
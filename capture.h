@@ -0,0 +1,154 @@
+/*!
+ * capture.h
+ *      Description: Header file for the input capture recorder. ADC results
+ *                   and raw button samples are recorded as the firmware sees
+ *                   them, so a field session can be replayed through the same
+ *                   processing and display path on the host simulator
+ *                   (host/sim, "replay" scenario command).
+ *
+ *                   Records are a tag byte followed by varints, so a slowly
+ *                   changing sensor costs a few bits per sample:
+ *
+ *                       tag         type << 4 | channel
+ *                       delta       Power_timestamp counts since the last
+ *                                   record, zigzag varint
+ *                       payload     CAPTURE_ADC: sample rate in Hz, varint,
+ *                                   the byte count of the block, varint,
+ *                                   and every sample of the block as
+ *                                   Codec_encode writes it (codec.h)
+ *                                   CAPTURE_INPUT: raw button mask, varint
+ *                                   CAPTURE_CLOCK: MCLK in kHz, varint
+ *
+ *                   An ADC record is stamped with the last sample of its
+ *                   block, the others precede that at the sample rate. A
+ *                   block that spans a rate change takes a record per rate.
+ *                   Blocks are recorded by the deferred work, so a delta is
+ *                   negative when an input was recorded in between, and the
+ *                   blocks an overrun drops are missing.
+ *
+ *                   Recording stops when the buffer is full. Build with
+ *                   CAPTURE_ENABLE defined to 0 to compile the recorder out.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef CAPTURE_ENABLE
+#define CAPTURE_ENABLE          1
+#endif
+
+/* Capture size in bytes, about 6.5 s of both channels at the full sample
+ * rate with 300 counts of noise on one, longer for quiet or slowed
+ * channels */
+#define CAPTURE_BUFFER_SIZE     16384
+/* Bytes per dump line, written as hex */
+#define CAPTURE_LINE_BYTES      32
+
+/* Record types */
+#define CAPTURE_ADC             0
+#define CAPTURE_INPUT           1
+#define CAPTURE_CLOCK           2
+
+/*!
+ * \brief This function clears the capture and starts recording
+ *
+ * The first record is the current MCLK, so timestamps can be converted to
+ * time from the start of the capture.
+ *
+ * \return None
+ */
+extern void Capture_init(void);
+
+/*!
+ * \brief This function records a block of ADC results
+ *
+ * Called with each posted block of each channel, so replay feeds the
+ * firmware every sample it converted. The block is compressed before
+ * interrupts are masked; only call from one context, the deferred work.
+ *
+ * \param channel is the acquisition channel (CHANNEL_PHOTO, CHANNEL_POT)
+ * \param samples is the block, oldest first
+ * \param count is the number of samples, 1 to ACQ_BLOCK_SIZE
+ * \param rate is the sample rate of the block in Hz
+ * \param timestamp is the Power_timestamp of the last sample
+ *
+ * \return None
+ */
+extern void Capture_adc(uint8_t channel, const uint16_t *samples,
+                        uint32_t count, uint16_t rate, uint32_t timestamp);
+
+/*!
+ * \brief This function records a raw button sample
+ *
+ * This function only adds a record when the sample differs from the last
+ * one, so it can be called on every debounce tick.
+ *
+ * \param raw is the undebounced button mask, bit n set while button n reads
+ *            held
+ *
+ * \return None
+ */
+extern void Capture_input(uint32_t raw);
+
+/*!
+ * \brief This function records the MCLK frequency
+ *
+ * Registered as a clock listener so replay can follow profile changes.
+ *
+ * \param mclk is the MCLK frequency in Hz
+ *
+ * \return None
+ */
+extern void Capture_clock(uint32_t mclk);
+
+/*!
+ * \brief This function starts a dump of the capture
+ *
+ * This function stops recording so the capture is frozen while it is
+ * written. Nothing is written until Capture_dumpStep, which must be called
+ * until it returns true. A dump already in progress is not restarted.
+ *
+ * \param write is called once per line of the dump
+ *
+ * \return None
+ */
+extern void Capture_dumpBegin(void (*write)(const char *line));
+
+/*!
+ * \brief This function writes part of the capture dump
+ *
+ * This function writes up to maxLines lines of CAPTURE_LINE_BYTES bytes.
+ * Recording restarts with an empty capture once the dump is complete.
+ *
+ * \param maxLines is the maximum number of lines to write
+ *
+ * \return true when the dump is complete or none is in progress
+ */
+extern bool Capture_dumpStep(uint32_t maxLines);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAPTURE_H_ */
@@ -0,0 +1,173 @@
+/*!
+ * clock.c
+ *      Description: Helper file for selectable clock profiles. Settings follow
+ *                   SystemInit in system_msp432p401r.c: VCORE1 is required
+ *                   above 24 MHz and one flash wait state above 12 MHz. SMCLK
+ *                   is divided so it never exceeds CLOCK_SMCLK_MAX, which
+ *                   keeps 16-bit Timer_A periods in range.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "clock.h"
+
+typedef struct
+{
+    uint32_t dcoFrequency;
+    uint32_t mclk;
+    uint_fast8_t vcore;
+    uint32_t waitStates;
+    uint32_t smclkDivider;
+    uint32_t smclkDivide;
+} Clock_Profile;
+
+static const Clock_Profile profiles[CLOCK_NUM_PROFILES] = {
+    { CS_DCO_FREQUENCY_1_5, 1500000, PCM_VCORE0, 0, CS_CLOCK_DIVIDER_1, 1 },
+    { CS_DCO_FREQUENCY_3, 3000000, PCM_VCORE0, 0, CS_CLOCK_DIVIDER_1, 1 },
+    { CS_DCO_FREQUENCY_6, 6000000, PCM_VCORE0, 0, CS_CLOCK_DIVIDER_2, 2 },
+    { CS_DCO_FREQUENCY_12, 12000000, PCM_VCORE0, 0, CS_CLOCK_DIVIDER_4, 4 },
+    { CS_DCO_FREQUENCY_24, 24000000, PCM_VCORE0, 1, CS_CLOCK_DIVIDER_8, 8 },
+    { CS_DCO_FREQUENCY_48, 48000000, PCM_VCORE1, 1, CS_CLOCK_DIVIDER_16, 16 }
+};
+
+static Clock_Listener listeners[CLOCK_MAX_LISTENERS];
+static int listenerCount = 0;
+static Clock_ProfileId activeProfile = CLOCK_3MHZ;
+
+/*!
+ * Sets the flash wait states and read buffering for both banks.
+ *
+ * \param waitStates Number of wait states
+ *
+ * \return None
+ */
+static void setFlashTiming(uint32_t waitStates)
+{
+    FlashCtl_setWaitState(FLASH_BANK0, waitStates);
+    FlashCtl_setWaitState(FLASH_BANK1, waitStates);
+    if (waitStates > 0)
+    {
+        FlashCtl_enableReadBuffering(FLASH_BANK0,
+                                     FLASH_DATA_READ | FLASH_INSTRUCTION_FETCH);
+        FlashCtl_enableReadBuffering(FLASH_BANK1,
+                                     FLASH_DATA_READ | FLASH_INSTRUCTION_FETCH);
+    }
+    else
+    {
+        FlashCtl_disableReadBuffering(FLASH_BANK0,
+                                      FLASH_DATA_READ | FLASH_INSTRUCTION_FETCH);
+        FlashCtl_disableReadBuffering(FLASH_BANK1,
+                                      FLASH_DATA_READ | FLASH_INSTRUCTION_FETCH);
+    }
+}
+
+/*!
+ * Moves the DCO and clock dividers to a profile. VCORE and flash timing must
+ * already allow the faster of the old and new frequencies.
+ *
+ * \param profile Profile to apply
+ *
+ * \return None
+ */
+static void setClocks(const Clock_Profile *profile)
+{
+    CS_setDCOCenteredFrequency(profile->dcoFrequency);
+    CS_initClockSignal(CS_MCLK, CS_DCOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    CS_initClockSignal(CS_HSMCLK, CS_DCOCLK_SELECT, CS_CLOCK_DIVIDER_1);
+    CS_initClockSignal(CS_SMCLK, CS_DCOCLK_SELECT, profile->smclkDivider);
+}
+
+/*!
+ * Applies a profile, ordering the VCORE and flash changes around the DCO
+ * change so the core is never clocked faster than its settings allow.
+ *
+ * \param profile Profile to switch to
+ *
+ * \return None
+ */
+static void applyProfile(Clock_ProfileId profile)
+{
+    const Clock_Profile *next = &profiles[profile];
+
+    if (profile > activeProfile)
+    {
+        PCM_setCoreVoltageLevel(next->vcore);
+        setFlashTiming(next->waitStates);
+        setClocks(next);
+    }
+    else
+    {
+        setClocks(next);
+        setFlashTiming(next->waitStates);
+        PCM_setCoreVoltageLevel(next->vcore);
+    }
+    activeProfile = profile;
+}
+
+void Clock_init(Clock_ProfileId profile)
+{
+    if (profile >= CLOCK_NUM_PROFILES)
+    {
+        return;
+    }
+    // SystemInit leaves the device at __SYSTEM_CLOCK (3 MHz), VCORE0, no wait
+    activeProfile = CLOCK_3MHZ;
+    applyProfile(profile);
+}
+
+bool Clock_addListener(Clock_Listener listener)
+{
+    if (listenerCount >= CLOCK_MAX_LISTENERS || listener == 0)
+    {
+        return false;
+    }
+    listeners[listenerCount++] = listener;
+    return true;
+}
+
+void Clock_setProfile(Clock_ProfileId profile)
+{
+    if (profile >= CLOCK_NUM_PROFILES || profile == activeProfile)
+    {
+        return;
+    }
+
+    bool wasMasked = Interrupt_disableMaster();
+    applyProfile(profile);
+    int i;
+    for (i = 0; i < listenerCount; i++)
+    {
+        listeners[i](profiles[profile].mclk);
+    }
+    if (!wasMasked)
+    {
+        Interrupt_enableMaster();
+    }
+}
+
+Clock_ProfileId Clock_getProfile(void)
+{
+    return activeProfile;
+}
+
+uint32_t Clock_getMCLK(void)
+{
+    return profiles[activeProfile].mclk;
+}
+
+uint32_t Clock_getSMCLK(void)
+{
+    return profiles[activeProfile].mclk / profiles[activeProfile].smclkDivide;
+}
+
+uint32_t Clock_getProfileMCLK(Clock_ProfileId profile)
+{
+    if (profile >= CLOCK_NUM_PROFILES)
+    {
+        return 0;
+    }
+    return profiles[profile].mclk;
+}
@@ -0,0 +1,124 @@
+/*!
+ * clock.h
+ *      Description: Header file for selectable clock profiles. Each profile
+ *                   sets the DCO, the VCORE level and the flash wait states
+ *                   it needs, then notifies registered listeners so every
+ *                   peripheral timed from MCLK or SMCLK can be retimed.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CLOCK_MAX_LISTENERS     12
+
+/* SMCLK is divided down to at most this frequency in every profile */
+#define CLOCK_SMCLK_MAX         3000000
+
+/* Profiles, in order of increasing MCLK */
+typedef enum
+{
+    CLOCK_1_5MHZ,
+    CLOCK_3MHZ,
+    CLOCK_6MHZ,
+    CLOCK_12MHZ,
+    CLOCK_24MHZ,
+    CLOCK_48MHZ,
+    CLOCK_NUM_PROFILES
+} Clock_ProfileId;
+
+/*!
+ * Called after every profile change with the new MCLK frequency in Hz, while
+ * interrupts are still masked. Use Clock_getSMCLK for the SMCLK frequency.
+ */
+typedef void (*Clock_Listener)(uint32_t mclk);
+
+/*!
+ * \brief This function initializes the clock module
+ *
+ * This function applies a profile without notifying listeners. Call before
+ * the peripherals are configured.
+ *
+ * \param profile is the profile to start in
+ *
+ * \return None
+ */
+extern void Clock_init(Clock_ProfileId profile);
+
+/*!
+ * \brief This function registers a clock change listener
+ *
+ * \param listener is called after every profile change
+ *
+ * \return true on success, false if the listener table is full
+ */
+extern bool Clock_addListener(Clock_Listener listener);
+
+/*!
+ * \brief This function switches to another clock profile
+ *
+ * This function raises VCORE and flash wait states before raising the DCO,
+ * and lowers them only after lowering the DCO. All listeners are called
+ * before interrupts are unmasked again.
+ *
+ * \param profile is the profile to switch to
+ *
+ * \return None
+ */
+extern void Clock_setProfile(Clock_ProfileId profile);
+
+/*!
+ * \brief This function returns the active profile
+ *
+ * \return Active profile
+ */
+extern Clock_ProfileId Clock_getProfile(void);
+
+/*!
+ * \brief This function returns the MCLK frequency of the active profile
+ *
+ * \return MCLK in Hz
+ */
+extern uint32_t Clock_getMCLK(void);
+
+/*!
+ * \brief This function returns the SMCLK frequency of the active profile
+ *
+ * \return SMCLK in Hz
+ */
+extern uint32_t Clock_getSMCLK(void);
+
+/*!
+ * \brief This function returns the MCLK frequency of a profile
+ *
+ * \param profile is the profile to look up
+ *
+ * \return MCLK in Hz
+ */
+extern uint32_t Clock_getProfileMCLK(Clock_ProfileId profile);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOCK_H_ */
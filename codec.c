@@ -0,0 +1,220 @@
+/*!
+ * codec.c
+ *      Description: Helper file for the sample block codec. The bit writer
+ *                   keeps up to 7 pending bits in a 32-bit accumulator and
+ *                   flushes whole bytes after each write, so a write of up
+ *                   to 17 bits never overflows it. The decoder is the same
+ *                   code run backwards and is used on the host to check
+ *                   the encoder.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <stdbool.h>
+
+#include "codec.h"
+
+/* Bits of a raw zig-zag difference, +-65535 */
+#define RAW_BITS            17
+
+/* Largest Rice parameter, 4 bits in the header */
+#define MAX_K               15
+
+typedef struct
+{
+    uint8_t *out;
+    uint32_t length;
+    uint32_t bits;
+    uint8_t used;
+} BitWriter;
+
+typedef struct
+{
+    const uint8_t *in;
+    uint32_t length;
+    uint32_t next;
+    uint32_t bits;
+    uint8_t used;
+} BitReader;
+
+/*!
+ * Maps a signed difference to an unsigned one, 0, -1, 1, -2, ... to
+ * 0, 1, 2, 3, ...
+ *
+ * \param delta Difference
+ *
+ * \return Zig-zag value
+ */
+static uint32_t zigzag(int32_t delta)
+{
+    return ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31);
+}
+
+/*!
+ * Appends bits, most significant first.
+ *
+ * \param writer Bit writer
+ * \param value Bits in the low count bits
+ * \param count Number of bits, up to 24
+ *
+ * \return None
+ */
+static void putBits(BitWriter *writer, uint32_t value, uint8_t count)
+{
+    writer->bits = (writer->bits << count) | (value & ((1UL << count) - 1));
+    writer->used += count;
+    while (writer->used >= 8)
+    {
+        writer->used -= 8;
+        writer->out[writer->length++] = (uint8_t) (writer->bits
+                >> writer->used);
+    }
+}
+
+/*!
+ * Takes the next bits, most significant first.
+ *
+ * \param reader Bit reader
+ * \param count Number of bits, up to 24
+ * \param value Receives the bits
+ *
+ * \return false if the block ends first
+ */
+static bool getBits(BitReader *reader, uint8_t count, uint32_t *value)
+{
+    while (reader->used < count)
+    {
+        if (reader->next == reader->length)
+        {
+            return false;
+        }
+        reader->bits = (reader->bits << 8) | reader->in[reader->next++];
+        reader->used += 8;
+    }
+    reader->used -= count;
+    *value = (reader->bits >> reader->used) & ((1UL << count) - 1);
+    return true;
+}
+
+uint32_t Codec_encode(uint8_t channel, const uint16_t *samples,
+                      uint32_t count, uint8_t *out)
+{
+    BitWriter writer;
+    uint32_t sum = 0;
+    uint8_t k = 0;
+    uint32_t i;
+
+    if (channel > CODEC_MAX_CHANNEL || count == 0
+            || count > CODEC_MAX_SAMPLES)
+    {
+        return 0;
+    }
+
+    // k = log2 of the mean difference, the best Rice parameter for a
+    // geometric distribution to within a bit
+    for (i = 1; i < count; i++)
+    {
+        sum += zigzag((int32_t) samples[i] - samples[i - 1]);
+    }
+    while (count > 1 && k < MAX_K && (sum >> (k + 1)) >= count - 1)
+    {
+        k++;
+    }
+
+    out[0] = (uint8_t) count;
+    out[1] = (uint8_t) ((channel << 4) | k);
+    out[2] = (uint8_t) (samples[0] >> 8);
+    out[3] = (uint8_t) samples[0];
+    writer.out = out;
+    writer.length = CODEC_HEADER_BYTES;
+    writer.bits = 0;
+    writer.used = 0;
+    for (i = 1; i < count; i++)
+    {
+        uint32_t z = zigzag((int32_t) samples[i] - samples[i - 1]);
+        uint32_t quotient = z >> k;
+
+        if (quotient < CODEC_ESCAPE)
+        {
+            // quotient ones and a zero, then the remainder
+            putBits(&writer, (((1UL << quotient) - 1) << 1), quotient + 1);
+            putBits(&writer, z, k);
+        }
+        else
+        {
+            putBits(&writer, (1UL << CODEC_ESCAPE) - 1, CODEC_ESCAPE);
+            putBits(&writer, z, RAW_BITS);
+        }
+    }
+    if (writer.used != 0)
+    {
+        putBits(&writer, 0, 8 - writer.used);
+    }
+    return writer.length;
+}
+
+int32_t Codec_decode(const uint8_t *in, uint32_t length, uint8_t *channel,
+                     uint16_t *samples, uint32_t max)
+{
+    BitReader reader;
+    uint32_t count;
+    uint8_t k;
+    uint32_t i;
+
+    if (length < CODEC_HEADER_BYTES)
+    {
+        return -1;
+    }
+    count = in[0];
+    k = in[1] & 0x0F;
+    if (count == 0 || count > max)
+    {
+        return -1;
+    }
+    *channel = in[1] >> 4;
+    samples[0] = ((uint16_t) in[2] << 8) | in[3];
+    reader.in = in;
+    reader.length = length;
+    reader.next = CODEC_HEADER_BYTES;
+    reader.bits = 0;
+    reader.used = 0;
+    for (i = 1; i < count; i++)
+    {
+        uint32_t quotient = 0;
+        uint32_t bit;
+        uint32_t z;
+
+        while (quotient < CODEC_ESCAPE)
+        {
+            if (!getBits(&reader, 1, &bit))
+            {
+                return -1;
+            }
+            if (bit == 0)
+            {
+                break;
+            }
+            quotient++;
+        }
+        if (quotient == CODEC_ESCAPE)
+        {
+            if (!getBits(&reader, RAW_BITS, &z))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            uint32_t remainder = 0;
+
+            if (k != 0 && !getBits(&reader, k, &remainder))
+            {
+                return -1;
+            }
+            z = (quotient << k) | remainder;
+        }
+        samples[i] = (uint16_t) (samples[i - 1]
+                + ((int32_t) (z >> 1) ^ -(int32_t) (z & 1)));
+    }
+    return (int32_t) count;
+}
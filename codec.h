@@ -0,0 +1,90 @@
+/*!
+ * codec.h
+ *      Description: Header file for the sample block codec. A block of
+ *                   unsigned 16-bit samples of one channel is stored as
+ *
+ *                       count, channel << 4 | k, first sample (big endian)
+ *                       count - 1 Rice codes, MSB first, zero padded
+ *
+ *                   Each code is the zig-zag mapped difference to the
+ *                   previous sample, the quotient z >> k in unary (ones
+ *                   ended by a zero) and the k low bits. A quotient of
+ *                   CODEC_ESCAPE or more is sent as CODEC_ESCAPE ones and
+ *                   the 17 bits of z instead, so a sample never costs more
+ *                   than 33 bits and two bit writes however noisy the
+ *                   block. k is picked per block from the mean difference.
+ *
+ *                   A slowly varying 14-bit signal takes 3 to 6 bits per
+ *                   sample instead of 16.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef CODEC_H_
+#define CODEC_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define CODEC_HEADER_BYTES  4
+#define CODEC_MAX_SAMPLES   255
+#define CODEC_MAX_CHANNEL   15
+
+/* Unary quotient that announces a raw difference */
+#define CODEC_ESCAPE        16
+
+/* Largest encoded block of count samples */
+#define CODEC_MAX_BYTES(count) \
+        (CODEC_HEADER_BYTES + ((count) * (CODEC_ESCAPE + 17) + 7) / 8)
+
+/*!
+ * \brief This function encodes a block of samples
+ *
+ * This function makes two passes over the samples, the first to pick k.
+ * Each pass does a fixed amount of work per sample.
+ *
+ * \param channel is the channel number stored in the header, 0 to 15
+ * \param samples is the block
+ * \param count is the number of samples, 1 to CODEC_MAX_SAMPLES
+ * \param out receives the block, at least CODEC_MAX_BYTES(count) bytes
+ *
+ * \return Number of bytes written, 0 if channel or count is out of range
+ */
+extern uint32_t Codec_encode(uint8_t channel, const uint16_t *samples,
+                             uint32_t count, uint8_t *out);
+
+/*!
+ * \brief This function decodes a block of samples
+ *
+ * \param in is an encoded block
+ * \param length is the number of bytes available at in
+ * \param channel receives the channel number from the header
+ * \param samples receives the samples
+ * \param max is the number of samples that fit in samples
+ *
+ * \return Number of samples, or -1 if the block is truncated, malformed or
+ *         longer than max
+ */
+extern int32_t Codec_decode(const uint8_t *in, uint32_t length,
+                            uint8_t *channel, uint16_t *samples, uint32_t max);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CODEC_H_ */
@@ -0,0 +1,221 @@
+/*!
+ * debounce.c
+ *      Description: Helper file for the timer sampled button debounce engine.
+ *                   Bit n of every mask below belongs to button n. The two
+ *                   bit vertical counter advances for every button whose raw
+ *                   sample differs from its debounced state and resets when
+ *                   they agree, so a button only changes state after four
+ *                   equal samples in a row.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "debounce.h"
+#include "power.h"
+#include "trace.h"
+#include "capture.h"
+
+#define LONG_PRESS_TICKS    (DEBOUNCE_LONG_PRESS_MS / DEBOUNCE_TICK_MS)
+#define DOUBLE_CLICK_TICKS  (DEBOUNCE_DOUBLE_CLICK_MS / DEBOUNCE_TICK_MS)
+
+typedef struct
+{
+    volatile uint8_t *input;
+    uint8_t pin;
+} Button;
+
+static Button buttons[DEBOUNCE_MAX_BUTTONS];
+static int buttonCount = 0;
+static EventQueue *eventQueue;
+
+/* Debounced state, 1 = held */
+static uint32_t state = 0;
+/* Vertical counter bits */
+static uint32_t count0 = 0;
+static uint32_t count1 = 0;
+/* Buttons that already reported a long press this hold */
+static uint32_t longReported = 0;
+/* Buttons released recently enough that a press is a double click */
+static uint32_t clickPending = 0;
+
+static uint32_t tickCount = 0;
+static uint32_t pressTick[DEBOUNCE_MAX_BUTTONS];
+static uint32_t releaseTick[DEBOUNCE_MAX_BUTTONS];
+
+/*!
+ * Looks up the input register of a port.
+ *
+ * \param port DriverLib port number
+ *
+ * \return Address of PxIN, or 0 for an invalid port
+ */
+static volatile uint8_t *portInput(uint_fast8_t port)
+{
+    switch (port)
+    {
+    case GPIO_PORT_P1:
+        return &P1->IN;
+    case GPIO_PORT_P2:
+        return &P2->IN;
+    case GPIO_PORT_P3:
+        return &P3->IN;
+    case GPIO_PORT_P4:
+        return &P4->IN;
+    case GPIO_PORT_P5:
+        return &P5->IN;
+    case GPIO_PORT_P6:
+        return &P6->IN;
+    case GPIO_PORT_P7:
+        return &P7->IN;
+    case GPIO_PORT_P8:
+        return &P8->IN;
+    case GPIO_PORT_P9:
+        return &P9->IN;
+    case GPIO_PORT_P10:
+        return &P10->IN;
+    default:
+        return 0;
+    }
+}
+
+/*!
+ * Posts a button event.
+ *
+ * \param button Button id
+ * \param kind BUTTON_PRESS, BUTTON_RELEASE, BUTTON_LONG_PRESS or
+ *             BUTTON_DOUBLE_CLICK
+ *
+ * \return None
+ */
+static void postButtonEvent(int button, uint16_t kind)
+{
+    Event event;
+    event.timestamp = Power_timestamp();
+    event.value = kind;
+    event.type = EVENT_BUTTON;
+    event.channel = button;
+    TRACE(TRACE_BUTTON, (button << 8) | kind);
+    Queue_push(eventQueue, &event);
+}
+
+/*!
+ * Returns the index of the lowest set bit.
+ *
+ * \param mask Non-zero bit mask
+ *
+ * \return Bit index
+ */
+static inline int lowestBit(uint32_t mask)
+{
+    return 31 - __CLZ(mask & -mask);
+}
+
+void Debounce_init(EventQueue *queue)
+{
+    eventQueue = queue;
+    buttonCount = 0;
+    state = 0;
+    count0 = 0;
+    count1 = 0;
+    longReported = 0;
+    clickPending = 0;
+    tickCount = 0;
+}
+
+int Debounce_addButton(uint_fast8_t port, uint_fast16_t pin)
+{
+    volatile uint8_t *input = portInput(port);
+    if (buttonCount >= DEBOUNCE_MAX_BUTTONS || input == 0)
+    {
+        return DEBOUNCE_INVALID_BUTTON;
+    }
+    buttons[buttonCount].input = input;
+    buttons[buttonCount].pin = pin;
+    return buttonCount++;
+}
+
+bool Debounce_tick(void)
+{
+    uint32_t raw = 0;
+    int i;
+
+    tickCount++;
+
+    // Active low: a cleared input bit is a held button
+    for (i = 0; i < buttonCount; i++)
+    {
+        if ((*buttons[i].input & buttons[i].pin) == 0)
+        {
+            raw |= 1u << i;
+        }
+    }
+    Capture_input(raw);
+
+    // Vertical counter, counts samples that disagree with the state
+    uint32_t delta = raw ^ state;
+    count1 = (count1 ^ count0) & delta;
+    count0 = ~count0 & delta;
+    uint32_t toggle = delta & ~(count0 | count1);
+    state ^= toggle;
+
+    uint32_t pressed = toggle & state;
+    uint32_t released = toggle & ~state;
+    bool posted = (toggle != 0);
+
+    while (pressed != 0)
+    {
+        i = lowestBit(pressed);
+        pressed &= pressed - 1;
+        postButtonEvent(i, BUTTON_PRESS);
+        if ((clickPending & (1u << i))
+                && (tickCount - releaseTick[i]) <= DOUBLE_CLICK_TICKS)
+        {
+            postButtonEvent(i, BUTTON_DOUBLE_CLICK);
+            clickPending &= ~(1u << i);
+        }
+        pressTick[i] = tickCount;
+    }
+
+    while (released != 0)
+    {
+        i = lowestBit(released);
+        released &= released - 1;
+        postButtonEvent(i, BUTTON_RELEASE);
+        // A long press does not start a double click
+        if (longReported & (1u << i))
+        {
+            clickPending &= ~(1u << i);
+        }
+        else
+        {
+            clickPending |= 1u << i;
+        }
+        longReported &= ~(1u << i);
+        releaseTick[i] = tickCount;
+    }
+
+    // Only buttons still held and not yet reported cost time here
+    uint32_t held = state & ~longReported;
+    while (held != 0)
+    {
+        i = lowestBit(held);
+        held &= held - 1;
+        if (tickCount - pressTick[i] >= LONG_PRESS_TICKS)
+        {
+            postButtonEvent(i, BUTTON_LONG_PRESS);
+            longReported |= 1u << i;
+            clickPending &= ~(1u << i);
+            posted = true;
+        }
+    }
+
+    return posted;
+}
+
+uint32_t Debounce_getState(void)
+{
+    return state;
+}
@@ -0,0 +1,93 @@
+/*!
+ * debounce.h
+ *      Description: Header file for the timer sampled button debounce engine.
+ *                   All registered buttons are sampled from one periodic tick
+ *                   and debounced together with a vertical counter, so the
+ *                   cost per tick does not depend on how much a switch
+ *                   bounces. Buttons are active low with pull-ups.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "queue.h"
+
+#define DEBOUNCE_MAX_BUTTONS        32
+#define DEBOUNCE_INVALID_BUTTON     (-1)
+
+/* Sample period, a state change needs 4 equal samples (20 ms) */
+#define DEBOUNCE_TICK_MS            5
+#define DEBOUNCE_LONG_PRESS_MS      1000
+#define DEBOUNCE_DOUBLE_CLICK_MS    300
+
+/* Button events, posted as EVENT_BUTTON with the event in Event.value */
+#define BUTTON_PRESS                0
+#define BUTTON_RELEASE              1
+#define BUTTON_LONG_PRESS           2
+#define BUTTON_DOUBLE_CLICK         3
+
+/*!
+ * \brief This function initializes the debounce engine
+ *
+ * \param queue is the queue button events are posted to. It must only be
+ *              produced into from the context that calls Debounce_tick.
+ *
+ * \return None
+ */
+extern void Debounce_init(EventQueue *queue);
+
+/*!
+ * \brief This function registers a button
+ *
+ * This function adds an active low button to the set sampled each tick. The
+ * pin must already be configured as an input with a pull-up.
+ *
+ * \param port is the GPIO port of the button (GPIO_PORT_P1 - GPIO_PORT_P10)
+ * \param pin is the GPIO pin of the button
+ *
+ * \return Button id used in Event.channel, or DEBOUNCE_INVALID_BUTTON
+ */
+extern int Debounce_addButton(uint_fast8_t port, uint_fast16_t pin);
+
+/*!
+ * \brief This function samples and debounces all buttons
+ *
+ * This function must be called every DEBOUNCE_TICK_MS from a timer interrupt.
+ *
+ * \return true if any event was posted
+ */
+extern bool Debounce_tick(void);
+
+/*!
+ * \brief This function returns the debounced button states
+ *
+ * \return Bit mask with bit n set while button n is held
+ */
+extern uint32_t Debounce_getState(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEBOUNCE_H_ */
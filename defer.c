@@ -0,0 +1,156 @@
+/*!
+ * defer.c
+ *      Description: Helper file for deferred interrupt work. Each work item
+ *                   has a pending flag that any handler may set; PendSV
+ *                   clears a flag before running its item, so a request
+ *                   made during the run is not lost. PendSV keeps going
+ *                   until no flag is set, then returns to the main context.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+
+#include "defer.h"
+#include "priorities.h"
+#include "power.h"
+#include "instrument.h"
+#include "trace.h"
+
+typedef struct
+{
+    const char *name;
+    Defer_WorkFn fn;
+    volatile bool pending;
+    Defer_Stats stats;
+} Defer_Work;
+
+static Defer_Work work[DEFER_MAX_WORK];
+static int workCount = 0;
+/* PendSV entries, fewer than the item runs when work is batched */
+static uint32_t entries;
+
+void Defer_init(void)
+{
+    workCount = 0;
+    entries = 0;
+    Interrupt_setPriority(FAULT_PENDSV, PRIORITY_PENDSV);
+}
+
+int Defer_add(const char *name, Defer_WorkFn fn)
+{
+    if (workCount >= DEFER_MAX_WORK || fn == 0)
+    {
+        return DEFER_INVALID_WORK;
+    }
+
+    Defer_Work *item = &work[workCount];
+    item->name = name;
+    item->fn = fn;
+    item->pending = false;
+    item->stats.runs = 0;
+    item->stats.worstCycles = 0;
+    item->stats.totalCycles = 0;
+    return workCount++;
+}
+
+void Defer_request(int id)
+{
+    if (id < 0 || id >= workCount)
+    {
+        return;
+    }
+    work[id].pending = true;
+    Interrupt_pendInterrupt(FAULT_PENDSV);
+}
+
+uint32_t Defer_lock(void)
+{
+    uint32_t mask = __get_BASEPRI();
+
+    if (mask == 0 || mask > PRIORITY_PENDSV)
+    {
+        __set_BASEPRI(PRIORITY_PENDSV);
+    }
+    return mask;
+}
+
+void Defer_unlock(uint32_t mask)
+{
+    __set_BASEPRI(mask);
+}
+
+void Defer_report(void (*write)(const char *line))
+{
+    char line[64];
+    Defer_Stats stats;
+    uint32_t mask;
+    int i;
+
+    mask = Defer_lock();
+    sprintf(line, "deferred     runs   worst     avg  (%lu PendSV)",
+            (unsigned long) entries);
+    Defer_unlock(mask);
+    write(line);
+    for (i = 0; i < workCount; i++)
+    {
+        mask = Defer_lock();
+        stats = work[i].stats;
+        Defer_unlock(mask);
+        sprintf(line, "%-8s %8lu %7lu %7lu", work[i].name,
+                (unsigned long) stats.runs,
+                (unsigned long) stats.worstCycles,
+                (unsigned long) (stats.runs ?
+                        stats.totalCycles / stats.runs : 0));
+        write(line);
+    }
+}
+
+/* !
+ * \brief This function runs the requested work items
+ *
+ * This function runs every pending item in registration order and starts
+ * over until none is pending. Higher priority handlers preempt it, and
+ * their time is included in the item run times.
+ *
+ * \return None
+ */
+void PendSV_Handler(void)
+{
+    INSTR_ISR_ENTER(INSTR_ISR_PENDSV);
+    TRACE(TRACE_ISR_PENDSV_BEGIN, 0);
+    bool ran;
+    int i;
+
+    entries++;
+    do
+    {
+        ran = false;
+        for (i = 0; i < workCount; i++)
+        {
+            Defer_Work *item = &work[i];
+            if (!item->pending)
+            {
+                continue;
+            }
+            item->pending = false;
+            uint32_t start = Power_timestamp();
+            item->fn();
+            uint32_t cycles = Power_timestamp() - start;
+
+            item->stats.runs++;
+            item->stats.totalCycles += cycles;
+            if (cycles > item->stats.worstCycles)
+            {
+                item->stats.worstCycles = cycles;
+            }
+            ran = true;
+        }
+    }
+    while (ran);
+    TRACE(TRACE_ISR_PENDSV_END, 0);
+    INSTR_ISR_EXIT(INSTR_ISR_PENDSV);
+}
@@ -0,0 +1,122 @@
+/*!
+ * defer.h
+ *      Description: Header file for deferred interrupt work. Interrupt
+ *                   handlers capture their data and call Defer_request; the
+ *                   requested work items then run in PendSV at the lowest
+ *                   interrupt priority (see priorities.h), after every
+ *                   handler has returned but ahead of the main context.
+ *                   Requests made while an item is pending are merged, so
+ *                   the items process whatever has queued up in batches.
+ *
+ *                   Work items run to completion and never preempt each
+ *                   other. The main context keeps them out of a critical
+ *                   section with Defer_lock, which leaves every other
+ *                   interrupt enabled.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef DEFER_H_
+#define DEFER_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DEFER_MAX_WORK      4
+#define DEFER_INVALID_WORK  (-1)
+
+typedef void (*Defer_WorkFn)(void);
+
+/* Timing statistics for one work item, execution times in MCLK cycles */
+typedef struct
+{
+    uint32_t runs;
+    uint32_t worstCycles;
+    uint64_t totalCycles;
+} Defer_Stats;
+
+/*!
+ * \brief This function initializes deferred work
+ *
+ * This function clears the work table and gives PendSV the lowest priority.
+ * Power_init must have been called so run times can be measured.
+ *
+ * \return None
+ */
+extern void Defer_init(void);
+
+/*!
+ * \brief This function registers a work item
+ *
+ * Items requested together run in registration order.
+ *
+ * \param name is a short name for reports
+ * \param fn is the function run in PendSV
+ *
+ * \return The work id, or DEFER_INVALID_WORK if the table is full
+ */
+extern int Defer_add(const char *name, Defer_WorkFn fn);
+
+/*!
+ * \brief This function requests a run of a work item
+ *
+ * Safe to call from any interrupt and from the main context. The item runs
+ * once after the request, however many requests were made meanwhile.
+ *
+ * \param id is the work id
+ *
+ * \return None
+ */
+extern void Defer_request(int id);
+
+/*!
+ * \brief This function holds back deferred work
+ *
+ * Raises BASEPRI to the PendSV level so no work item starts until
+ * Defer_unlock. Interrupt handlers keep running. Calls may be nested.
+ *
+ * \return The previous mask, to pass to Defer_unlock
+ */
+extern uint32_t Defer_lock(void);
+
+/*!
+ * \brief This function lets deferred work run again
+ *
+ * Work requested while locked runs right away.
+ *
+ * \param mask is the value returned by the matching Defer_lock
+ *
+ * \return None
+ */
+extern void Defer_unlock(uint32_t mask);
+
+/*!
+ * \brief This function sends the work item statistics over the UART
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void Defer_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEFER_H_ */
@@ -10,6 +10,8 @@
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 
 #include "delays.h"
+#include "trace.h"
+#include "ramfunc.h"
 
 #define USEC_DIVISOR    1000000
 #define MSEC_DIVISOR    1000
@@ -22,7 +24,8 @@ void initDelayTimer(uint32_t clkFreq) {
     sysClkFreq = clkFreq;
 }
 
-int delayMicroSec(uint32_t micros) {
+/* Runs from SRAM so the polling loop has no flash wait states */
+RAMFUNC int delayMicroSec(uint32_t micros) {
     uint64_t ticks = sysClkFreq * micros / USEC_DIVISOR;
     if (ticks < 2) {
         return UNDERFLOW;
@@ -31,6 +34,7 @@ int delayMicroSec(uint32_t micros) {
         return OVERFLOW;
     }
 
+    TRACE(TRACE_DELAY_BEGIN, micros);
     // Set the period of the SysTick counter
     SysTick->LOAD = ticks - 1;
     // Write any value to reset timer counter
@@ -38,6 +42,7 @@ int delayMicroSec(uint32_t micros) {
     SysTick_enableModule();
     while(!(SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk));
     SysTick_disableModule();
+    TRACE(TRACE_DELAY_END, micros);
     return SUCCESS;
 }
 
@@ -0,0 +1,238 @@
+/*!
+ * detector.c
+ *      Description: Helper file for the sample event detectors. The state of
+ *                   each detector only changes in the ADC interrupt, and
+ *                   Detector_configure swaps it with interrupts masked. The
+ *                   band limits are worked out there so a sample costs a
+ *                   few compares.
+ *
+ *                   The extreme detector starts out tracking both the
+ *                   lowest and highest sample; whichever the signal first
+ *                   moves away from by prominence is taken as the start and
+ *                   not reported, after that it alternates between looking
+ *                   for a peak and for a dip.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+
+#include "detector.h"
+#include "ramfunc.h"
+
+/* Detection types, EVENT_RISING to EVENT_DIP */
+#define NUM_DETECTIONS      4
+
+/* Where the signal is relative to the band */
+typedef enum
+{
+    LEVEL_UNKNOWN, LEVEL_BELOW, LEVEL_ABOVE
+} Detector_Level;
+
+/* What the extreme detector looks for */
+typedef enum
+{
+    SEEK_EITHER, SEEK_PEAK, SEEK_DIP
+} Detector_Seek;
+
+typedef struct
+{
+    uint16_t low;               /* falls at or below */
+    uint16_t high;              /* rises at or above */
+    uint8_t edges;
+    uint16_t prominence;
+    Detector_Level level;
+    Detector_Seek seek;
+    uint16_t extreme;           /* top or bottom so far, the peak or dip */
+    uint32_t extremeTime;
+    uint16_t lowest;            /* other end while SEEK_EITHER */
+    uint32_t counts[NUM_DETECTIONS];
+} Detector_State;
+
+static Detector_State detectors[NUM_CHANNELS];
+static EventQueue *detectQueue;
+
+static const char *const detectionNames[NUM_DETECTIONS] = { "rising",
+                                                            "falling", "peak",
+                                                            "dip" };
+
+/*!
+ * Counts a detection and posts it.
+ *
+ * \param channel Channel number
+ * \param type EVENT_RISING to EVENT_DIP
+ * \param value Sample that caused it
+ * \param timestamp Time of that sample
+ *
+ * \return true if it was queued
+ */
+RAMFUNC static bool post(uint8_t channel, uint8_t type, uint16_t value,
+                         uint32_t timestamp)
+{
+    Event event;
+
+    detectors[channel].counts[type - EVENT_RISING]++;
+    event.timestamp = timestamp;
+    event.value = value;
+    event.type = type;
+    event.channel = channel;
+    return Queue_push(detectQueue, &event);
+}
+
+/*!
+ * Restarts the extreme detector from a sample.
+ *
+ * \param detector Detector
+ * \param seek What to look for next
+ * \param value Sample
+ * \param timestamp Time of the sample
+ *
+ * \return None
+ */
+RAMFUNC static void restartExtreme(Detector_State *detector,
+                                   Detector_Seek seek, uint16_t value,
+                                   uint32_t timestamp)
+{
+    detector->seek = seek;
+    detector->extreme = value;
+    detector->extremeTime = timestamp;
+    detector->lowest = value;
+}
+
+void Detector_init(EventQueue *queue)
+{
+    const Detector_Config off = { 0, 0, 0, 0 };
+    uint8_t i;
+
+    detectQueue = queue;
+    for (i = 0; i < NUM_CHANNELS; i++)
+    {
+        Detector_configure(i, &off);
+    }
+}
+
+void Detector_configure(uint8_t channel, const Detector_Config *config)
+{
+    Detector_State *detector = &detectors[channel % NUM_CHANNELS];
+    uint32_t high = (uint32_t) config->threshold + config->hysteresis;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    detector->low = config->threshold > config->hysteresis ?
+            config->threshold - config->hysteresis : 0;
+    detector->high = high > UINT16_MAX ? UINT16_MAX : high;
+    detector->edges = config->edges;
+    detector->prominence = config->prominence;
+    detector->level = LEVEL_UNKNOWN;
+    detector->seek = SEEK_EITHER;
+    // The first sample sets both ends
+    detector->extreme = 0;
+    detector->lowest = UINT16_MAX;
+    __set_PRIMASK(primask);
+}
+
+RAMFUNC bool Detector_sample(uint8_t channel, uint16_t value,
+                             uint32_t timestamp)
+{
+    Detector_State *detector = &detectors[channel];
+    bool posted = false;
+
+    if (detector->edges != 0)
+    {
+        if (value >= detector->high && detector->level != LEVEL_ABOVE)
+        {
+            if (detector->level == LEVEL_BELOW
+                    && (detector->edges & DETECT_RISING))
+            {
+                posted |= post(channel, EVENT_RISING, value, timestamp);
+            }
+            detector->level = LEVEL_ABOVE;
+        }
+        else if (value <= detector->low && detector->level != LEVEL_BELOW)
+        {
+            if (detector->level == LEVEL_ABOVE
+                    && (detector->edges & DETECT_FALLING))
+            {
+                posted |= post(channel, EVENT_FALLING, value, timestamp);
+            }
+            detector->level = LEVEL_BELOW;
+        }
+    }
+
+    if (detector->prominence == 0)
+    {
+        return posted;
+    }
+    switch (detector->seek)
+    {
+    case SEEK_PEAK:
+        if (value > detector->extreme)
+        {
+            detector->extreme = value;
+            detector->extremeTime = timestamp;
+        }
+        else if (detector->extreme - value >= detector->prominence)
+        {
+            posted |= post(channel, EVENT_PEAK, detector->extreme,
+                           detector->extremeTime);
+            restartExtreme(detector, SEEK_DIP, value, timestamp);
+        }
+        break;
+    case SEEK_DIP:
+        if (value < detector->extreme)
+        {
+            detector->extreme = value;
+            detector->extremeTime = timestamp;
+        }
+        else if (value - detector->extreme >= detector->prominence)
+        {
+            posted |= post(channel, EVENT_DIP, detector->extreme,
+                           detector->extremeTime);
+            restartExtreme(detector, SEEK_PEAK, value, timestamp);
+        }
+        break;
+    default:
+        if (value > detector->extreme)
+        {
+            detector->extreme = value;
+            detector->extremeTime = timestamp;
+        }
+        if (value < detector->lowest)
+        {
+            detector->lowest = value;
+        }
+        // Moving away from one end makes the other the start, unreported
+        if (value - detector->lowest >= detector->prominence)
+        {
+            restartExtreme(detector, SEEK_PEAK, value, timestamp);
+        }
+        else if (detector->extreme - value >= detector->prominence)
+        {
+            restartExtreme(detector, SEEK_DIP, value, timestamp);
+        }
+        break;
+    }
+    return posted;
+}
+
+void Detector_report(void (*write)(const char *line))
+{
+    char line[48];
+    uint8_t type;
+
+    write("detections      A14     A15");
+    for (type = 0; type < NUM_DETECTIONS; type++)
+    {
+        sprintf(line, "  %-8s %8lu %7lu", detectionNames[type],
+                (unsigned long) detectors[CHANNEL_PHOTO].counts[type],
+                (unsigned long) detectors[CHANNEL_POT].counts[type]);
+        write(line);
+    }
+    sprintf(line, "  dropped %9lu",
+            (unsigned long) Queue_getOverflows(detectQueue));
+    write(line);
+}
@@ -0,0 +1,117 @@
+/*!
+ * detector.h
+ *      Description: Header file for the sample event detectors. Every sample
+ *                   an acquisition channel stores passes through the
+ *                   detector of its channel in the ADC interrupt, in
+ *                   constant time, so short events between two sample
+ *                   blocks are still seen. Each detector can watch:
+ *
+ *                   - a level with hysteresis: EVENT_RISING once the signal
+ *                     reaches threshold + hysteresis from below, and
+ *                     EVENT_FALLING once it drops to threshold - hysteresis
+ *                     from above, each direction selected separately;
+ *                   - local extremes: EVENT_PEAK for a maximum the signal
+ *                     then falls away from by prominence, EVENT_DIP for a
+ *                     minimum it then rises from by prominence.
+ *
+ *                   Detections are posted to an event queue with the value
+ *                   and timestamp of the sample that caused them, the top
+ *                   or bottom sample for an extreme, which is therefore
+ *                   posted a little later. Timestamps are as fine as the
+ *                   current sample rate of the channel.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef DETECTOR_H_
+#define DETECTOR_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "queue.h"
+#include "acquisition.h"
+
+/* Level crossings reported, Detector_Config.edges */
+#define DETECT_RISING       0x01
+#define DETECT_FALLING      0x02
+
+/* Detector settings in ADC counts */
+typedef struct
+{
+    uint16_t threshold;
+    uint16_t hysteresis;    /* half width of the band around threshold */
+    uint8_t edges;          /* DETECT_RISING, DETECT_FALLING, 0 for none */
+    uint16_t prominence;    /* 0 for no extremes */
+} Detector_Config;
+
+/*!
+ * \brief This function initializes the detectors
+ *
+ * This function turns every detector off. Detections of all channels are
+ * posted to queue, whose producer is the ADC interrupt.
+ *
+ * \param queue is the queue detections are posted to
+ *
+ * \return None
+ */
+extern void Detector_init(EventQueue *queue);
+
+/*!
+ * \brief This function sets up the detector of a channel
+ *
+ * This function restarts the detector with new settings. The next sample
+ * only sets where the signal is, so a level already past the threshold is
+ * not reported.
+ *
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ * \param config is the settings, copied
+ *
+ * \return None
+ */
+extern void Detector_configure(uint8_t channel, const Detector_Config *config);
+
+/*!
+ * \brief This function runs the detector of a channel on one sample
+ *
+ * Only called from the ADC interrupt, by the acquisition path.
+ *
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ * \param value is the sample
+ * \param timestamp is the Power_timestamp of the sample
+ *
+ * \return true if a detection was posted
+ */
+extern bool Detector_sample(uint8_t channel, uint16_t value,
+                            uint32_t timestamp);
+
+/*!
+ * \brief This function sends the detection counts over the UART
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void Detector_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DETECTOR_H_ */
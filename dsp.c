@@ -0,0 +1,647 @@
+/*!
+ * dsp.c
+ *      Description: Helper file for the fixed-point DSP kernels. Pairs of
+ *                   Q15 samples are loaded as one 32-bit word and multiplied
+ *                   with a pair of coefficients by one SMLALD. Builds
+ *                   without the DSP extension use C versions of the same
+ *                   instructions, so the host runs the exact arithmetic of
+ *                   the target. The cycles on the target are measured with
+ *                   DSP_BENCH_ENABLE, see dspbench.h.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <string.h>
+
+#include "dsp.h"
+#include "ramfunc.h"
+
+#if defined(__TI_COMPILER_VERSION__) && defined(__TI_ARM_V7M4__)
+#define DSP_SIMD            1
+#define SMLALD(x, y, acc)   _smlald((acc), (x), (y))
+#define SMUSD(x, y)         _smusd((x), (y))
+#define SMUADX(x, y)        _smuadx((x), (y))
+#define QADD16(x, y)        ((uint32_t) _qadd16((x), (y)))
+#define SHADD16(x, y)       ((uint32_t) _shadd16((x), (y)))
+#define SHSUB16(x, y)       ((uint32_t) _shsub16((x), (y)))
+#define QADD(x, y)          _sadd((x), (y))
+#elif defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#include <arm_acle.h>
+#define DSP_SIMD            1
+#define SMLALD(x, y, acc)   __smlald((x), (y), (acc))
+#define SMUSD(x, y)         __smusd((x), (y))
+#define SMUADX(x, y)        __smuadx((x), (y))
+#define QADD16(x, y)        ((uint32_t) __qadd16((x), (y)))
+#define SHADD16(x, y)       ((uint32_t) __shadd16((x), (y)))
+#define SHSUB16(x, y)       ((uint32_t) __shsub16((x), (y)))
+#define QADD(x, y)          __qadd((x), (y))
+#else
+#define DSP_SIMD            0
+#define SMLALD(x, y, acc)   smlald((x), (y), (acc))
+#define SMUSD(x, y)         smusd((x), (y))
+#define SMUADX(x, y)        smuadx((x), (y))
+#define QADD16(x, y)        qadd16((x), (y))
+#define SHADD16(x, y)       shadd16((x), (y))
+#define SHSUB16(x, y)       shsub16((x), (y))
+#define QADD(x, y)          qadd((x), (y))
+#endif
+
+/* Angles are in 1/65536 turn, the table has 256 steps per quarter turn */
+#define QUARTER_TURN        0x4000
+#define TABLE_SHIFT         6
+
+/* sin(2 pi i / 1024) in Q15 for the first quarter turn */
+static const q15_t sineTable[257] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210, 2410,
+    2611, 2811, 3012, 3212, 3412, 3612, 3811, 4011, 4210, 4410, 4609, 4808,
+    5007, 5205, 5404, 5602, 5800, 5998, 6195, 6393, 6590, 6786, 6983, 7179,
+    7375, 7571, 7767, 7962, 8157, 8351, 8545, 8739, 8933, 9126, 9319, 9512,
+    9704, 9896, 10087, 10278, 10469, 10659, 10849, 11039, 11228, 11417,
+    11605, 11793, 11980, 12167, 12353, 12539, 12725, 12910, 13094, 13279,
+    13462, 13645, 13828, 14010, 14191, 14372, 14553, 14732, 14912, 15090,
+    15269, 15446, 15623, 15800, 15976, 16151, 16325, 16499, 16673, 16846,
+    17018, 17189, 17360, 17530, 17700, 17869, 18037, 18204, 18371, 18537,
+    18703, 18868, 19032, 19195, 19357, 19519, 19680, 19841, 20000, 20159,
+    20317, 20475, 20631, 20787, 20942, 21096, 21250, 21403, 21554, 21705,
+    21856, 22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027, 23170,
+    23311, 23452, 23592, 23731, 23870, 24007, 24143, 24279, 24413, 24547,
+    24680, 24811, 24942, 25072, 25201, 25329, 25456, 25582, 25708, 25832,
+    25955, 26077, 26198, 26319, 26438, 26556, 26674, 26790, 26905, 27019,
+    27133, 27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001, 28105,
+    28208, 28310, 28411, 28510, 28609, 28706, 28803, 28898, 28992, 29085,
+    29177, 29268, 29358, 29447, 29534, 29621, 29706, 29791, 29874, 29956,
+    30037, 30117, 30195, 30273, 30349, 30424, 30498, 30571, 30643, 30714,
+    30783, 30852, 30919, 30985, 31050, 31113, 31176, 31237, 31297, 31356,
+    31414, 31470, 31526, 31580, 31633, 31685, 31736, 31785, 31833, 31880,
+    31926, 31971, 32014, 32057, 32098, 32137, 32176, 32213, 32250, 32285,
+    32318, 32351, 32382, 32412, 32441, 32469, 32495, 32521, 32545, 32567,
+    32589, 32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717, 32728,
+    32737, 32745, 32752, 32757, 32761, 32765, 32766, 32767 };
+
+/*!
+ * Saturates to Q15.
+ *
+ * \param value Value to saturate
+ *
+ * \return value limited to [-32768, 32767]
+ */
+static inline q15_t sat16(int64_t value)
+{
+    if (value > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return (q15_t) value;
+}
+
+/*!
+ * Saturates to Q31.
+ *
+ * \param value Value to saturate
+ *
+ * \return value limited to the int32_t range
+ */
+static inline q31_t sat32(int64_t value)
+{
+    if (value > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (value < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    return (q31_t) value;
+}
+
+#if !DSP_SIMD
+/*!
+ * C version of SMLALD: acc + x.lo * y.lo + x.hi * y.hi.
+ *
+ * \param x Two Q15 values
+ * \param y Two Q15 values
+ * \param acc Accumulator
+ *
+ * \return New accumulator
+ */
+static inline int64_t smlald(uint32_t x, uint32_t y, int64_t acc)
+{
+    return acc + (int32_t) (int16_t) x * (int16_t) y
+            + (int32_t) (int16_t) (x >> 16) * (int16_t) (y >> 16);
+}
+
+/*!
+ * C version of SMUSD: x.lo * y.lo - x.hi * y.hi.
+ *
+ * \param x Two Q15 values
+ * \param y Two Q15 values
+ *
+ * \return Difference of the products
+ */
+static inline int32_t smusd(uint32_t x, uint32_t y)
+{
+    return (int32_t) (int16_t) x * (int16_t) y
+            - (int32_t) (int16_t) (x >> 16) * (int16_t) (y >> 16);
+}
+
+/*!
+ * C version of SMUADX: x.lo * y.hi + x.hi * y.lo.
+ *
+ * \param x Two Q15 values
+ * \param y Two Q15 values
+ *
+ * \return Sum of the crossed products
+ */
+static inline int32_t smuadx(uint32_t x, uint32_t y)
+{
+    return (int32_t) (int16_t) x * (int16_t) (y >> 16)
+            + (int32_t) (int16_t) (x >> 16) * (int16_t) y;
+}
+
+/*!
+ * C version of SHADD16, halved sum of each halfword.
+ *
+ * \param x Two Q15 values
+ * \param y Two Q15 values
+ *
+ * \return Two halved sums
+ */
+static inline uint32_t shadd16(uint32_t x, uint32_t y)
+{
+    int32_t lo = ((int32_t) (int16_t) x + (int16_t) y) >> 1;
+    int32_t hi = ((int32_t) (int16_t) (x >> 16) + (int16_t) (y >> 16)) >> 1;
+    return ((uint32_t) (uint16_t) hi << 16) | (uint16_t) lo;
+}
+
+/*!
+ * C version of SHSUB16, halved difference of each halfword.
+ *
+ * \param x Two Q15 values
+ * \param y Two Q15 values
+ *
+ * \return Two halved differences
+ */
+static inline uint32_t shsub16(uint32_t x, uint32_t y)
+{
+    int32_t lo = ((int32_t) (int16_t) x - (int16_t) y) >> 1;
+    int32_t hi = ((int32_t) (int16_t) (x >> 16) - (int16_t) (y >> 16)) >> 1;
+    return ((uint32_t) (uint16_t) hi << 16) | (uint16_t) lo;
+}
+
+/*!
+ * C version of QADD16, saturating add of each halfword.
+ *
+ * \param x Two Q15 values
+ * \param y Two Q15 values
+ *
+ * \return Two saturated sums
+ */
+static inline uint32_t qadd16(uint32_t x, uint32_t y)
+{
+    q15_t lo = sat16((int32_t) (int16_t) x + (int16_t) y);
+    q15_t hi = sat16((int32_t) (int16_t) (x >> 16) + (int16_t) (y >> 16));
+    return ((uint32_t) (uint16_t) hi << 16) | (uint16_t) lo;
+}
+
+/*!
+ * C version of QADD, saturating 32-bit add.
+ *
+ * \param x Q31 value
+ * \param y Q31 value
+ *
+ * \return Saturated sum
+ */
+static inline q31_t qadd(q31_t x, q31_t y)
+{
+    return sat32((int64_t) x + y);
+}
+#endif
+
+/*!
+ * Loads two Q15 values as one word, the first in the low half. The M4
+ * allows unaligned word loads, memcpy keeps the compiler aware of them.
+ *
+ * \param p First value
+ *
+ * \return Packed pair
+ */
+static inline uint32_t read2(const q15_t *p)
+{
+    uint32_t pair;
+    memcpy(&pair, p, sizeof(pair));
+    return pair;
+}
+
+/*!
+ * Stores a packed pair of Q15 values.
+ *
+ * \param p Destination of the low half
+ * \param pair Packed pair
+ *
+ * \return None
+ */
+static inline void write2(q15_t *p, uint32_t pair)
+{
+    memcpy(p, &pair, sizeof(pair));
+}
+
+/*!
+ * Packs two Q15 values, lo in the low half.
+ *
+ * \param lo Low half
+ * \param hi High half
+ *
+ * \return Packed pair
+ */
+static inline uint32_t pack(q15_t lo, q15_t hi)
+{
+    return ((uint32_t) (uint16_t) hi << 16) | (uint16_t) lo;
+}
+
+void Dsp_firInitQ15(Dsp_FirQ15 *fir, uint16_t numTaps, const q15_t *coeffs,
+                    q15_t *state, uint16_t blockSize)
+{
+    fir->numTaps = numTaps;
+    fir->coeffs = coeffs;
+    fir->state = state;
+    memset(state, 0, (numTaps + blockSize - 1) * sizeof(q15_t));
+}
+
+RAMFUNC void Dsp_firQ15(Dsp_FirQ15 *fir, const q15_t *in, q15_t *out,
+                        uint16_t blockSize)
+{
+    q15_t *state = fir->state;
+    uint16_t numTaps = fir->numTaps;
+    uint16_t n;
+    uint16_t k;
+
+    // The block follows the numTaps - 1 samples kept from the last one
+    memcpy(&state[numTaps - 1], in, blockSize * sizeof(q15_t));
+
+    for (n = 0; n < blockSize; n++)
+    {
+        const q15_t *x = &state[n];
+        const q15_t *b = fir->coeffs;
+        int64_t acc = 1 << 14;
+
+        // Two taps per SMLALD, coefficients are stored time-reversed
+        for (k = numTaps >> 1; k > 0; k--)
+        {
+            acc = SMLALD(read2(x), read2(b), acc);
+            x += 2;
+            b += 2;
+        }
+        if (numTaps & 1)
+        {
+            acc += (int32_t) *x * *b;
+        }
+        out[n] = sat16(acc >> 15);
+    }
+
+    memmove(state, &state[blockSize], (numTaps - 1) * sizeof(q15_t));
+}
+
+void Dsp_biquadInitQ15(Dsp_BiquadQ15 *iir, uint8_t numStages,
+                       const q15_t *coeffs, q15_t *state, uint8_t postShift)
+{
+    iir->numStages = numStages;
+    iir->postShift = postShift;
+    iir->coeffs = coeffs;
+    iir->state = state;
+    memset(state, 0, numStages * DSP_BIQUAD_STATE * sizeof(q15_t));
+}
+
+RAMFUNC void Dsp_biquadQ15(Dsp_BiquadQ15 *iir, const q15_t *in, q15_t *out,
+                           uint16_t blockSize)
+{
+    const q15_t *coeffs = iir->coeffs;
+    q15_t *state = iir->state;
+    int shift = 15 - iir->postShift;
+    int64_t round = 1 << (shift - 1);
+    uint8_t stage;
+    uint16_t n;
+
+    for (stage = 0; stage < iir->numStages; stage++)
+    {
+        int32_t b0 = coeffs[0];
+        uint32_t b1b2 = read2(&coeffs[2]);
+        uint32_t a1a2 = read2(&coeffs[4]);
+        // x[n-1] and y[n-1] in the low halves, x[n-2] and y[n-2] above
+        uint32_t x1x2 = read2(&state[0]);
+        uint32_t y1y2 = read2(&state[2]);
+
+        for (n = 0; n < blockSize; n++)
+        {
+            q15_t x0 = in[n];
+            int64_t acc = round + b0 * x0;
+
+            acc = SMLALD(b1b2, x1x2, acc);
+            acc = SMLALD(a1a2, y1y2, acc);
+            q15_t y0 = sat16(acc >> shift);
+
+            x1x2 = pack(x0, (q15_t) x1x2);
+            y1y2 = pack(y0, (q15_t) y1y2);
+            out[n] = y0;
+        }
+
+        write2(&state[0], x1x2);
+        write2(&state[2], y1y2);
+        coeffs += DSP_BIQUAD_COEFFS;
+        state += DSP_BIQUAD_STATE;
+        // Later stages filter the output of the previous one in place
+        in = out;
+    }
+}
+
+/*!
+ * Returns the sine of an angle, interpolated between table entries.
+ *
+ * \param phase Angle in 1/65536 turn
+ *
+ * \return sin(2 pi phase / 65536) in Q15
+ */
+static q15_t sinTurn(uint16_t phase)
+{
+    uint16_t offset = phase & (QUARTER_TURN - 1);
+    uint16_t index;
+    uint16_t frac;
+    int32_t value;
+
+    // Second and fourth quarters run the table backwards
+    if (phase & QUARTER_TURN)
+    {
+        offset = QUARTER_TURN - offset;
+    }
+    index = offset >> TABLE_SHIFT;
+    frac = offset & ((1 << TABLE_SHIFT) - 1);
+    value = sineTable[index];
+    if (frac != 0)
+    {
+        value += ((sineTable[index + 1] - value) * frac) >> TABLE_SHIFT;
+    }
+    return (phase & (2 * QUARTER_TURN)) ? (q15_t) -value : (q15_t) value;
+}
+
+/*!
+ * Returns the cosine of an angle.
+ *
+ * \param phase Angle in 1/65536 turn
+ *
+ * \return cos(2 pi phase / 65536) in Q15
+ */
+static q15_t cosTurn(uint16_t phase)
+{
+    return sinTurn((uint16_t) (phase + QUARTER_TURN));
+}
+
+/*!
+ * Integer square root.
+ *
+ * \param value Radicand
+ *
+ * \return floor(sqrt(value))
+ */
+static uint32_t isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/*!
+ * Reorders complex values into bit-reversed index order.
+ *
+ * \param data Interleaved complex values
+ * \param points Number of complex values, a power of two
+ *
+ * \return None
+ */
+static void bitReverse(q15_t *data, uint16_t points)
+{
+    uint16_t i;
+    uint16_t j = 0;
+
+    for (i = 1; i < points; i++)
+    {
+        uint16_t bit = points >> 1;
+        while (j & bit)
+        {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            uint32_t swap = read2(&data[2 * i]);
+            write2(&data[2 * i], read2(&data[2 * j]));
+            write2(&data[2 * j], swap);
+        }
+    }
+}
+
+RAMFUNC void Dsp_rfftQ15(q15_t *data, uint16_t size)
+{
+    uint16_t points = size >> 1;
+    uint16_t span;
+    uint16_t i;
+    uint16_t j;
+    uint16_t k;
+
+    // Even samples as the real part and odd ones as the imaginary part
+    bitReverse(data, points);
+    for (span = 1; span < points; span <<= 1)
+    {
+        uint16_t step = (uint16_t) (QUARTER_TURN * 2 / span);
+
+        for (j = 0; j < span; j++)
+        {
+            uint16_t phase = j * step;
+            // W = cos - j sin, one SMUSD and one SMUADX per product
+            uint32_t w = pack(cosTurn(phase), (q15_t) -sinTurn(phase));
+
+            for (i = j; i < points; i += 2 * span)
+            {
+                q15_t *a = &data[2 * i];
+                q15_t *b = &data[2 * (i + span)];
+                uint32_t x = read2(a);
+                uint32_t y = read2(b);
+                uint32_t t = pack(sat16(SMUSD(y, w) >> 15),
+                                  sat16(SMUADX(y, w) >> 15));
+
+                // Halving butterflies, so no stage can overflow
+                write2(a, SHADD16(x, t));
+                write2(b, SHSUB16(x, t));
+            }
+        }
+    }
+
+    // Split the half size transform into the bins of the real one
+    int32_t zr = data[0];
+    int32_t zi = data[1];
+    data[0] = (q15_t) ((zr + zi) >> 1);
+    data[1] = (q15_t) ((zr - zi) >> 1);
+    for (k = 1; k <= points / 2; k++)
+    {
+        q15_t *a = &data[2 * k];
+        q15_t *b = &data[2 * (points - k)];
+        uint16_t phase = (uint16_t) (((uint32_t) k << 16) / size);
+        int32_t wr = cosTurn(phase);
+        int32_t wi = -sinTurn(phase);
+        // E and D are the halved sum and difference of Z[k] and Z*[N/2 - k]
+        int32_t er = (a[0] + b[0]) >> 1;
+        int32_t ei = (a[1] - b[1]) >> 1;
+        int32_t dr = (a[0] - b[0]) >> 1;
+        int32_t di = (a[1] + b[1]) >> 1;
+        int32_t tr = (dr * wr - di * wi) >> 15;
+        int32_t ti = (dr * wi + di * wr) >> 15;
+
+        a[0] = sat16((er + ti) >> 1);
+        a[1] = sat16((ei - tr) >> 1);
+        b[0] = sat16((er - ti) >> 1);
+        b[1] = sat16((-ei - tr) >> 1);
+    }
+}
+
+void Dsp_cmplxMagQ15(const q15_t *spectrum, uint16_t size, q15_t *mag)
+{
+    uint16_t k;
+
+    // X[0] is real, X[size / 2] is dropped
+    mag[0] = sat16(spectrum[0] < 0 ? -(int32_t) spectrum[0] : spectrum[0]);
+    for (k = 1; k < size / 2; k++)
+    {
+        int32_t re = spectrum[2 * k];
+        int32_t im = spectrum[2 * k + 1];
+        mag[k] = sat16(isqrt((uint32_t) (re * re) + (uint32_t) (im * im)));
+    }
+}
+
+void Dsp_hannQ15(q15_t *data, uint16_t size)
+{
+    uint16_t step = (uint16_t) (((uint32_t) 1 << 16) / size);
+    uint16_t n;
+
+    for (n = 0; n < size; n++)
+    {
+        // (1 - cos) / 2, from 0 to 32767
+        int32_t w = (32768 - cosTurn(n * step)) >> 1;
+        data[n] = (q15_t) ((data[n] * w) >> 15);
+    }
+}
+
+void Dsp_goertzelInitQ15(Dsp_GoertzelQ15 *g, uint32_t freqHz,
+                         uint32_t sampleHz)
+{
+    uint16_t phase = (uint16_t) ((((uint64_t) freqHz << 16) + sampleHz / 2)
+            / sampleHz);
+
+    g->cosine = cosTurn(phase);
+    g->sine = sinTurn(phase);
+}
+
+RAMFUNC q15_t Dsp_goertzelQ15(const Dsp_GoertzelQ15 *g, const q15_t *in,
+                              uint16_t size)
+{
+    int32_t s1 = 0;
+    int32_t s2 = 0;
+    uint16_t n;
+
+    // s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2], the Q15 cosine is 2 cos in Q14
+    for (n = 0; n < size; n++)
+    {
+        int32_t s0 = in[n] + (int32_t) (((int64_t) g->cosine * s1) >> 14) - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    // X = s[N-1] - e^-jw s[N-2], scaled by 2^15; the amplitude is 2 |X| / N
+    int64_t re = ((int64_t) s1 << 15) - (int64_t) g->cosine * s2;
+    int64_t im = (int64_t) g->sine * s2;
+    int64_t divisor = (int64_t) size << 14;
+    int32_t ar = (int32_t) (re / divisor);
+    int32_t ai = (int32_t) (im / divisor);
+
+    // Anything past full scale saturates anyway, this keeps the squares small
+    ar = ar > 32768 ? 32768 : ar < -32768 ? -32768 : ar;
+    ai = ai > 32768 ? 32768 : ai < -32768 ? -32768 : ai;
+    return sat16(isqrt((uint32_t) (ar * ar) + (uint32_t) (ai * ai)));
+}
+
+void Dsp_scaleQ15(const q15_t *in, q15_t scaleFract, uint8_t shift,
+                  q15_t *out, uint16_t blockSize)
+{
+    int rightShift = 15 - shift;
+    uint16_t n;
+
+    for (n = 0; n < blockSize; n++)
+    {
+        out[n] = sat16(((int32_t) in[n] * scaleFract) >> rightShift);
+    }
+}
+
+void Dsp_offsetQ15(const q15_t *in, q15_t offset, q15_t *out,
+                   uint16_t blockSize)
+{
+    uint32_t offsets = pack(offset, offset);
+    uint16_t n;
+
+    // Two samples per QADD16
+    for (n = 0; n + 1 < blockSize; n += 2)
+    {
+        write2(&out[n], QADD16(read2(&in[n]), offsets));
+    }
+    if (n < blockSize)
+    {
+        out[n] = sat16((int32_t) in[n] + offset);
+    }
+}
+
+void Dsp_scaleQ31(const q31_t *in, q31_t scaleFract, uint8_t shift,
+                  q31_t *out, uint16_t blockSize)
+{
+    int rightShift = 31 - shift;
+    uint16_t n;
+
+    for (n = 0; n < blockSize; n++)
+    {
+        out[n] = sat32(((int64_t) in[n] * scaleFract) >> rightShift);
+    }
+}
+
+void Dsp_offsetQ31(const q31_t *in, q31_t offset, q31_t *out,
+                   uint16_t blockSize)
+{
+    uint16_t n;
+
+    for (n = 0; n < blockSize; n++)
+    {
+        out[n] = QADD(in[n], offset);
+    }
+}
+
+bool Dsp_isSimd(void)
+{
+    return DSP_SIMD;
+}
@@ -0,0 +1,294 @@
+/*!
+ * dsp.h
+ *      Description: Header file for the fixed-point DSP kernels. Block
+ *                   based FIR and biquad filters, scaling and offset on Q15
+ *                   samples, and scaling and offset on Q31 samples. On the
+ *                   Cortex-M4 the inner loops use the dual 16-bit multiply
+ *                   accumulate instructions (SMLAD, SMLALD) and saturating
+ *                   adds; elsewhere a portable C version gives bit-identical
+ *                   results.
+ *
+ *                   A real FFT, magnitudes, a Hann window and Goertzel
+ *                   single-bin detectors cover spectral analysis.
+ *
+ *                   Q15 values are int16_t in [-1, 1), Q31 values int32_t.
+ *                   Results saturate instead of wrapping. In-place operation
+ *                   (out == in) is allowed for every kernel.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef DSP_H_
+#define DSP_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+/* Words in a biquad stage: coefficients and state */
+#define DSP_BIQUAD_COEFFS   6
+#define DSP_BIQUAD_STATE    4
+
+/* Largest and smallest Dsp_rfftQ15 size */
+#define DSP_FFT_MAX_SIZE    1024
+#define DSP_FFT_MIN_SIZE    16
+
+/* FIR filter, see Dsp_firInitQ15 */
+typedef struct
+{
+    uint16_t numTaps;
+    const q15_t *coeffs;
+    q15_t *state;
+} Dsp_FirQ15;
+
+/* Cascade of direct form I biquads, see Dsp_biquadInitQ15 */
+typedef struct
+{
+    uint8_t numStages;
+    uint8_t postShift;
+    const q15_t *coeffs;
+    q15_t *state;
+} Dsp_BiquadQ15;
+
+/*!
+ * \brief This function initializes a Q15 FIR filter
+ *
+ * The coefficients are stored in time-reversed order, b[numTaps - 1] first.
+ * The state buffer holds numTaps + blockSize - 1 samples and is cleared.
+ *
+ * \param fir is the filter to initialize
+ * \param numTaps is the number of coefficients
+ * \param coeffs is the coefficient array, kept by the filter
+ * \param state is the state buffer, kept by the filter
+ * \param blockSize is the largest block passed to Dsp_firQ15
+ *
+ * \return None
+ */
+extern void Dsp_firInitQ15(Dsp_FirQ15 *fir, uint16_t numTaps,
+                           const q15_t *coeffs, q15_t *state,
+                           uint16_t blockSize);
+
+/*!
+ * \brief This function filters a block with a Q15 FIR filter
+ *
+ * Products are accumulated in 64 bits, so the sum of the coefficients may
+ * exceed 1 as long as the output fits. Runs from SRAM.
+ *
+ * \param fir is the filter
+ * \param in is the input block
+ * \param out receives the output block
+ * \param blockSize is the number of samples, at most the size given to
+ *                  Dsp_firInitQ15
+ *
+ * \return None
+ */
+extern void Dsp_firQ15(Dsp_FirQ15 *fir, const q15_t *in, q15_t *out,
+                       uint16_t blockSize);
+
+/*!
+ * \brief This function initializes a Q15 biquad cascade
+ *
+ * Each stage has DSP_BIQUAD_COEFFS coefficients {b0, 0, b1, b2, a1, a2}
+ * scaled down by 2^postShift, so coefficients up to 2^postShift in magnitude
+ * can be represented. The feedback coefficients have the opposite sign of
+ * the usual transfer function:
+ *     y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+ * The state buffer holds DSP_BIQUAD_STATE samples per stage and is cleared.
+ *
+ * \param iir is the filter to initialize
+ * \param numStages is the number of second order stages
+ * \param coeffs is the coefficient array, kept by the filter
+ * \param state is the state buffer, kept by the filter
+ * \param postShift is the coefficient scaling shift, 0 to 14
+ *
+ * \return None
+ */
+extern void Dsp_biquadInitQ15(Dsp_BiquadQ15 *iir, uint8_t numStages,
+                              const q15_t *coeffs, q15_t *state,
+                              uint8_t postShift);
+
+/*!
+ * \brief This function filters a block with a Q15 biquad cascade
+ *
+ * Each stage accumulates in 64 bits and saturates its output to Q15. Runs
+ * from SRAM.
+ *
+ * \param iir is the filter
+ * \param in is the input block
+ * \param out receives the output block
+ * \param blockSize is the number of samples
+ *
+ * \return None
+ */
+extern void Dsp_biquadQ15(Dsp_BiquadQ15 *iir, const q15_t *in, q15_t *out,
+                          uint16_t blockSize);
+
+/* Goertzel detector for one frequency, see Dsp_goertzelInitQ15 */
+typedef struct
+{
+    q15_t cosine;
+    q15_t sine;
+} Dsp_GoertzelQ15;
+
+/*!
+ * \brief This function computes the FFT of a real Q15 block in place
+ *
+ * The block is transformed as a complex FFT of half the size followed by a
+ * split step. Every stage halves its output, so the result is the DFT
+ * divided by size and cannot overflow; a sine of amplitude A gives bins of
+ * magnitude A / 2. The output is packed as {X[0], X[size / 2]} followed by
+ * {re, im} of X[1] to X[size / 2 - 1]. Runs from SRAM.
+ *
+ * \param data is the block, replaced by its spectrum
+ * \param size is the number of samples, a power of two from DSP_FFT_MIN_SIZE
+ *             to DSP_FFT_MAX_SIZE
+ *
+ * \return None
+ */
+extern void Dsp_rfftQ15(q15_t *data, uint16_t size);
+
+/*!
+ * \brief This function computes the bin magnitudes of a Dsp_rfftQ15 output
+ *
+ * \param spectrum is the packed spectrum
+ * \param size is the size given to Dsp_rfftQ15
+ * \param mag receives size / 2 magnitudes, X[0] to X[size / 2 - 1], may be
+ *            the same memory as spectrum
+ *
+ * \return None
+ */
+extern void Dsp_cmplxMagQ15(const q15_t *spectrum, uint16_t size,
+                            q15_t *mag);
+
+/*!
+ * \brief This function applies a Hann window to a Q15 block in place
+ *
+ * The window halves the amplitude of a tone (coherent gain 0.5) and keeps
+ * leakage from strong bins out of bins further than two away.
+ *
+ * \param data is the block
+ * \param size is the number of samples, a power of two up to
+ *             DSP_FFT_MAX_SIZE
+ *
+ * \return None
+ */
+extern void Dsp_hannQ15(q15_t *data, uint16_t size);
+
+/*!
+ * \brief This function initializes a Goertzel detector
+ *
+ * \param g is the detector to initialize
+ * \param freqHz is the frequency to detect
+ * \param sampleHz is the sample rate, above 2 * freqHz
+ *
+ * \return None
+ */
+extern void Dsp_goertzelInitQ15(Dsp_GoertzelQ15 *g, uint32_t freqHz,
+                                uint32_t sampleHz);
+
+/*!
+ * \brief This function measures the amplitude of one frequency in a block
+ *
+ * Cheaper than a FFT when only a few frequencies matter, and not limited to
+ * bin centres. The recursion is kept in 32 bits, which holds full-scale
+ * input of any size. Below sampleHz / 64 the Q15 coefficient no longer
+ * places the frequency accurately.
+ *
+ * \param g is the detector
+ * \param in is the input block
+ * \param size is the number of samples, 1 to DSP_FFT_MAX_SIZE
+ *
+ * \return Amplitude of a sine at the detector frequency, Q15
+ */
+extern q15_t Dsp_goertzelQ15(const Dsp_GoertzelQ15 *g, const q15_t *in,
+                             uint16_t size);
+
+/*!
+ * \brief This function multiplies a Q15 block by a constant
+ *
+ * out = in * scaleFract * 2^shift, so gains above 1 use a fraction and a
+ * left shift.
+ *
+ * \param in is the input block
+ * \param scaleFract is the Q15 fractional part of the gain
+ * \param shift is the left shift applied after the multiply, 0 to 15
+ * \param out receives the output block
+ * \param blockSize is the number of samples
+ *
+ * \return None
+ */
+extern void Dsp_scaleQ15(const q15_t *in, q15_t scaleFract, uint8_t shift,
+                         q15_t *out, uint16_t blockSize);
+
+/*!
+ * \brief This function adds a constant to a Q15 block
+ *
+ * \param in is the input block
+ * \param offset is the value added to each sample
+ * \param out receives the output block
+ * \param blockSize is the number of samples
+ *
+ * \return None
+ */
+extern void Dsp_offsetQ15(const q15_t *in, q15_t offset, q15_t *out,
+                          uint16_t blockSize);
+
+/*!
+ * \brief This function multiplies a Q31 block by a constant
+ *
+ * out = in * scaleFract * 2^shift.
+ *
+ * \param in is the input block
+ * \param scaleFract is the Q31 fractional part of the gain
+ * \param shift is the left shift applied after the multiply, 0 to 31
+ * \param out receives the output block
+ * \param blockSize is the number of samples
+ *
+ * \return None
+ */
+extern void Dsp_scaleQ31(const q31_t *in, q31_t scaleFract, uint8_t shift,
+                         q31_t *out, uint16_t blockSize);
+
+/*!
+ * \brief This function adds a constant to a Q31 block
+ *
+ * \param in is the input block
+ * \param offset is the value added to each sample
+ * \param out receives the output block
+ * \param blockSize is the number of samples
+ *
+ * \return None
+ */
+extern void Dsp_offsetQ31(const q31_t *in, q31_t offset, q31_t *out,
+                          uint16_t blockSize);
+
+/*!
+ * \brief This function reports whether the SIMD instructions are used
+ *
+ * \return true on a Cortex-M4 build, false for the portable version
+ */
+extern bool Dsp_isSimd(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_H_ */
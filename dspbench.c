@@ -0,0 +1,432 @@
+/*!
+ * dspbench.c
+ *      Description: Helper file for the DSP kernel benchmark. The scalar
+ *                   versions do one multiply per loop iteration with the
+ *                   same rounding and saturation as the kernels, so their
+ *                   outputs must match bit for bit. All buffers are static
+ *                   and the linker drops them unless DspBench_run is called.
+ *
+ *                   The spectrum kernels have no scalar twin; each block
+ *                   size is checked with a tone of known bin and amplitude.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dspbench.h"
+#include "dsp.h"
+#include "acquisition.h"
+
+#define BENCH_BLOCK         ACQ_BLOCK_SIZE
+#define BENCH_REPEATS       8
+#define MAX_TAPS            32
+#define BIQUAD_STAGES       2
+#define BIQUAD_POST_SHIFT   1
+
+/* Spectrum test tone: half scale, centred on bin size / 8 */
+#define TONE_AMPLITUDE      16384
+#define TONE_BIN_DIVISOR    8
+#define TONE_TOLERANCE      (TONE_AMPLITUDE / 50)
+
+typedef struct
+{
+    const char *name;
+    void (*reset)(void);
+    void (*kernel)(void);
+    void (*scalar)(void);
+    bool q31;
+} BenchCase;
+
+/* 30 Hz low-pass for 1 kHz, the filter used by filters.c */
+static const q15_t fir32[MAX_TAPS] = {
+    14, 32, 63, 118, 207, 334, 503, 712, 955, 1221, 1496, 1763, 2004, 2202,
+    2344, 2416, 2416, 2344, 2202, 2004, 1763, 1496, 1221, 955, 712, 503, 334,
+    207, 118, 63, 32, 14 };
+/* 60 Hz low-pass for 1 kHz */
+static const q15_t fir16[16] = {
+    43, 154, 485, 1151, 2136, 3270, 4276, 4869, 4869, 4276, 3270, 2136, 1151,
+    485, 154, 43 };
+/* Two 25 Hz Butterworth sections, {b0, 0, b1, b2, a1, a2} in Q14 */
+static const q15_t biquad[BIQUAD_STAGES * DSP_BIQUAD_COEFFS] = {
+    91, 0, 181, 91, 29141, -13120,
+    91, 0, 181, 91, 29141, -13120 };
+
+static q15_t input[BENCH_BLOCK];
+static q31_t input31[BENCH_BLOCK];
+static q15_t kernelOut[BENCH_BLOCK];
+static q15_t scalarOut[BENCH_BLOCK];
+static q31_t kernelOut31[BENCH_BLOCK];
+static q31_t scalarOut31[BENCH_BLOCK];
+
+static q15_t firState[MAX_TAPS + BENCH_BLOCK - 1];
+static q15_t scalarFirState[MAX_TAPS + BENCH_BLOCK - 1];
+static q15_t spectrum[DSP_FFT_MAX_SIZE];
+static const uint16_t spectrumSizes[] = { 64, 128, 256, 512, 1024 };
+
+static q15_t iirState[BIQUAD_STAGES * DSP_BIQUAD_STATE];
+static q15_t scalarIirState[BIQUAD_STAGES * DSP_BIQUAD_STATE];
+static Dsp_FirQ15 fir;
+static Dsp_BiquadQ15 iir;
+
+/*!
+ * Saturates to Q15.
+ *
+ * \param value Value to saturate
+ *
+ * \return value limited to [-32768, 32767]
+ */
+static q15_t sat16(int64_t value)
+{
+    return value > INT16_MAX ? INT16_MAX :
+            value < INT16_MIN ? INT16_MIN : (q15_t) value;
+}
+
+/*!
+ * Saturates to Q31.
+ *
+ * \param value Value to saturate
+ *
+ * \return value limited to the int32_t range
+ */
+static q31_t sat32(int64_t value)
+{
+    return value > INT32_MAX ? INT32_MAX :
+            value < INT32_MIN ? INT32_MIN : (q31_t) value;
+}
+
+/*!
+ * Scalar FIR with the state layout of Dsp_firQ15.
+ *
+ * \param numTaps Number of taps
+ * \param coeffs Time-reversed coefficients
+ *
+ * \return None
+ */
+static void scalarFir(uint16_t numTaps, const q15_t *coeffs)
+{
+    uint16_t n;
+    uint16_t k;
+
+    memcpy(&scalarFirState[numTaps - 1], input, sizeof(input));
+    for (n = 0; n < BENCH_BLOCK; n++)
+    {
+        int64_t acc = 1 << 14;
+        for (k = 0; k < numTaps; k++)
+        {
+            acc += (int32_t) scalarFirState[n + k] * coeffs[k];
+        }
+        scalarOut[n] = sat16(acc >> 15);
+    }
+    memmove(scalarFirState, &scalarFirState[BENCH_BLOCK],
+            (numTaps - 1) * sizeof(q15_t));
+}
+
+static void resetFir16(void)
+{
+    Dsp_firInitQ15(&fir, 16, fir16, firState, BENCH_BLOCK);
+    memset(scalarFirState, 0, sizeof(scalarFirState));
+}
+
+static void kernelFir16(void)
+{
+    Dsp_firQ15(&fir, input, kernelOut, BENCH_BLOCK);
+}
+
+static void scalarFir16(void)
+{
+    scalarFir(16, fir16);
+}
+
+static void resetFir32(void)
+{
+    Dsp_firInitQ15(&fir, MAX_TAPS, fir32, firState, BENCH_BLOCK);
+    memset(scalarFirState, 0, sizeof(scalarFirState));
+}
+
+static void kernelFir32(void)
+{
+    Dsp_firQ15(&fir, input, kernelOut, BENCH_BLOCK);
+}
+
+static void scalarFir32(void)
+{
+    scalarFir(MAX_TAPS, fir32);
+}
+
+static void resetBiquad(void)
+{
+    Dsp_biquadInitQ15(&iir, BIQUAD_STAGES, biquad, iirState,
+                      BIQUAD_POST_SHIFT);
+    memset(scalarIirState, 0, sizeof(scalarIirState));
+}
+
+static void kernelBiquad(void)
+{
+    Dsp_biquadQ15(&iir, input, kernelOut, BENCH_BLOCK);
+}
+
+static void scalarBiquad(void)
+{
+    const q15_t *in = input;
+    int shift = 15 - BIQUAD_POST_SHIFT;
+    int stage;
+    int n;
+
+    for (stage = 0; stage < BIQUAD_STAGES; stage++)
+    {
+        const q15_t *b = &biquad[stage * DSP_BIQUAD_COEFFS];
+        q15_t *state = &scalarIirState[stage * DSP_BIQUAD_STATE];
+        for (n = 0; n < BENCH_BLOCK; n++)
+        {
+            int64_t acc = 1 << (shift - 1);
+            acc += (int32_t) b[0] * in[n];
+            acc += (int32_t) b[2] * state[0];
+            acc += (int32_t) b[3] * state[1];
+            acc += (int32_t) b[4] * state[2];
+            acc += (int32_t) b[5] * state[3];
+            q15_t y = sat16(acc >> shift);
+            state[1] = state[0];
+            state[0] = in[n];
+            state[3] = state[2];
+            state[2] = y;
+            scalarOut[n] = y;
+        }
+        in = scalarOut;
+    }
+}
+
+static void resetNone(void)
+{
+}
+
+static void kernelOffset(void)
+{
+    Dsp_offsetQ15(input, -8192, kernelOut, BENCH_BLOCK);
+}
+
+static void scalarOffset(void)
+{
+    int n;
+    for (n = 0; n < BENCH_BLOCK; n++)
+    {
+        scalarOut[n] = sat16((int32_t) input[n] - 8192);
+    }
+}
+
+static void kernelScale(void)
+{
+    Dsp_scaleQ15(input, 0x6000, 1, kernelOut, BENCH_BLOCK);
+}
+
+static void scalarScale(void)
+{
+    int n;
+    for (n = 0; n < BENCH_BLOCK; n++)
+    {
+        scalarOut[n] = sat16(((int32_t) input[n] * 0x6000) >> 14);
+    }
+}
+
+static void kernelOffset31(void)
+{
+    Dsp_offsetQ31(input31, 0x40000000, kernelOut31, BENCH_BLOCK);
+}
+
+static void scalarOffset31(void)
+{
+    int n;
+    for (n = 0; n < BENCH_BLOCK; n++)
+    {
+        scalarOut31[n] = sat32((int64_t) input31[n] + 0x40000000);
+    }
+}
+
+static void kernelScale31(void)
+{
+    Dsp_scaleQ31(input31, 0x60000000, 1, kernelOut31, BENCH_BLOCK);
+}
+
+static void scalarScale31(void)
+{
+    int n;
+    for (n = 0; n < BENCH_BLOCK; n++)
+    {
+        scalarOut31[n] = sat32(((int64_t) input31[n] * 0x60000000) >> 30);
+    }
+}
+
+static const BenchCase cases[] = {
+    { "fir 16 taps", resetFir16, kernelFir16, scalarFir16, false },
+    { "fir 32 taps", resetFir32, kernelFir32, scalarFir32, false },
+    { "biquad x2", resetBiquad, kernelBiquad, scalarBiquad, false },
+    { "offset q15", resetNone, kernelOffset, scalarOffset, false },
+    { "scale q15", resetNone, kernelScale, scalarScale, false },
+    { "offset q31", resetNone, kernelOffset31, scalarOffset31, true },
+    { "scale q31", resetNone, kernelScale31, scalarScale31, true },
+};
+
+/*!
+ * Runs one variant BENCH_REPEATS times from a reset state.
+ *
+ * \param bench Case to run
+ * \param fn Variant to time
+ * \param cycles Cycle counter
+ *
+ * \return Fastest run in cycles
+ */
+static uint32_t timeRuns(const BenchCase *bench, void (*fn)(void),
+                         uint32_t (*cycles)(void))
+{
+    uint32_t best = UINT32_MAX;
+    int i;
+
+    bench->reset();
+    for (i = 0; i < BENCH_REPEATS; i++)
+    {
+        uint32_t start = cycles();
+        fn();
+        uint32_t elapsed = cycles() - start;
+        if (elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/*!
+ * Fills the spectrum buffer with the test tone.
+ *
+ * \param size Number of samples
+ *
+ * \return None
+ */
+static void makeTone(uint16_t size)
+{
+    Dsp_GoertzelQ15 phasor;
+    int32_t s1 = 0;
+    int32_t s2 = 0;
+    uint16_t n;
+
+    // sin(n w) from the recursion the Goertzel detector uses, no libm
+    Dsp_goertzelInitQ15(&phasor, size / TONE_BIN_DIVISOR, size);
+    s1 = (int32_t) TONE_AMPLITUDE * phasor.sine >> 15;
+    spectrum[0] = 0;
+    for (n = 1; n < size; n++)
+    {
+        spectrum[n] = (q15_t) s1;
+        int32_t next = (int32_t) (((int64_t) phasor.cosine * s1) >> 14) - s2;
+        s2 = s1;
+        s1 = next;
+    }
+}
+
+/*!
+ * Checks and times the spectrum kernels for one block size.
+ *
+ * \param size Block size
+ * \param cycles Cycle counter
+ * \param line Receives the report line
+ *
+ * \return true if the tone was found at its bin and amplitude
+ */
+static bool benchSpectrum(uint16_t size, uint32_t (*cycles)(void),
+                          char *line)
+{
+    Dsp_GoertzelQ15 detector;
+    uint32_t fft = UINT32_MAX;
+    uint32_t goertzel = UINT32_MAX;
+    uint16_t peak = 1;
+    q15_t amplitude = 0;
+    uint16_t k;
+    int i;
+
+    Dsp_goertzelInitQ15(&detector, size / TONE_BIN_DIVISOR, size);
+    for (i = 0; i < BENCH_REPEATS; i++)
+    {
+        makeTone(size);
+        uint32_t start = cycles();
+        amplitude = Dsp_goertzelQ15(&detector, spectrum, size);
+        uint32_t elapsed = cycles() - start;
+        goertzel = elapsed < goertzel ? elapsed : goertzel;
+
+        start = cycles();
+        Dsp_rfftQ15(spectrum, size);
+        Dsp_cmplxMagQ15(spectrum, size, spectrum);
+        elapsed = cycles() - start;
+        fft = elapsed < fft ? elapsed : fft;
+    }
+
+    for (k = 2; k < size / 2; k++)
+    {
+        if (spectrum[k] > spectrum[peak])
+        {
+            peak = k;
+        }
+    }
+    // The FFT bins hold half the amplitude
+    bool match = peak == size / TONE_BIN_DIVISOR
+            && 2 * spectrum[peak] > TONE_AMPLITUDE - TONE_TOLERANCE
+            && 2 * spectrum[peak] < TONE_AMPLITUDE + TONE_TOLERANCE
+            && amplitude > TONE_AMPLITUDE - TONE_TOLERANCE
+            && amplitude < TONE_AMPLITUDE + TONE_TOLERANCE;
+
+    sprintf(line, "%4u %8lu %9lu  %5u/%5u%s", size, (unsigned long) fft,
+            (unsigned long) goertzel, 2 * spectrum[peak], amplitude,
+            match ? "" : "  MISMATCH");
+    return match;
+}
+
+bool DspBench_run(uint32_t (*cycles)(void), void (*write)(const char *line))
+{
+    char line[64];
+    uint32_t seed = 12345;
+    bool allMatch = true;
+    size_t i;
+
+    // Full-scale noise so saturation paths are exercised too
+    for (i = 0; i < BENCH_BLOCK; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        input[i] = (q15_t) (seed >> 16);
+        input31[i] = (q31_t) seed;
+    }
+
+    sprintf(line, "dsp cycles/sample, block %d, %s", BENCH_BLOCK,
+            Dsp_isSimd() ? "simd" : "portable");
+    write(line);
+    write("kernel          dsp  scalar  gain");
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        const BenchCase *bench = &cases[i];
+        uint32_t kernel = timeRuns(bench, bench->kernel, cycles);
+        uint32_t scalar = timeRuns(bench, bench->scalar, cycles);
+        // Both variants ran the same blocks from the same state
+        bool match = bench->q31 ?
+                memcmp(kernelOut31, scalarOut31, sizeof(kernelOut31)) == 0 :
+                memcmp(kernelOut, scalarOut, sizeof(kernelOut)) == 0;
+
+        allMatch = allMatch && match;
+        sprintf(line, "%-12s %4lu.%lu %4lu.%lu %3lu.%lux%s", bench->name,
+                (unsigned long) (kernel / BENCH_BLOCK),
+                (unsigned long) (kernel * 10 / BENCH_BLOCK % 10),
+                (unsigned long) (scalar / BENCH_BLOCK),
+                (unsigned long) (scalar * 10 / BENCH_BLOCK % 10),
+                (unsigned long) (kernel ? scalar / kernel : 0),
+                (unsigned long) (kernel ? scalar * 10 / kernel % 10 : 0),
+                match ? "" : "  MISMATCH");
+        write(line);
+    }
+
+    write("spectrum cycles/block, tone at size/8");
+    write("size  fft+mag  goertzel    amp fft/gz");
+    for (i = 0; i < sizeof(spectrumSizes) / sizeof(spectrumSizes[0]); i++)
+    {
+        bool match = benchSpectrum(spectrumSizes[i], cycles, line);
+        allMatch = allMatch && match;
+        write(line);
+    }
+    return allMatch;
+}
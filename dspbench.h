@@ -0,0 +1,63 @@
+/*!
+ * dspbench.h
+ *      Description: Header file for the DSP kernel benchmark. Times each
+ *                   filter kernel in dsp.c against a plain
+ *                   one-multiply-per-loop C version of the same arithmetic,
+ *                   checks that both give the same output and writes the
+ *                   cycles per sample. The FFT and Goertzel kernels are
+ *                   timed per block for each block size from 64 to 1024.
+ *
+ *                   Build with DSP_BENCH_ENABLE defined to 1 to run it once
+ *                   at boot and send the table over the UART. host/ runs it
+ *                   with "make dsp" to check the portable kernels; there the
+ *                   C versions of the DSP instructions are timed, so the
+ *                   gain column says nothing about the target.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef DSPBENCH_H_
+#define DSPBENCH_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef DSP_BENCH_ENABLE
+#define DSP_BENCH_ENABLE    0
+#endif
+
+/*!
+ * \brief This function runs the DSP kernel benchmark
+ *
+ * Each case runs several times and the fastest run is kept, so interrupts
+ * taken during the benchmark do not inflate the result.
+ *
+ * \param cycles returns a cycle counter that increases, wrapping at 2^32
+ * \param write is called with each line of the report
+ *
+ * \return true if every kernel matched its scalar version
+ */
+extern bool DspBench_run(uint32_t (*cycles)(void),
+                         void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSPBENCH_H_ */
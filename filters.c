@@ -0,0 +1,76 @@
+/*!
+ * filters.c
+ *      Description: Helper file for the sample block filters. Both channels
+ *                   use a 32-tap linear phase FIR low-pass at 30 Hz for a
+ *                   1 kHz sample rate: -48 dB at 100 Hz, -78 dB at 120 Hz and
+ *                   unity gain at DC, with a delay of 15.5 samples.
+ *
+ *                   The response scales with the sample rate of a channel,
+ *                   so a quiet channel slowed to 125 Hz is smoothed at
+ *                   3.75 Hz. It only slows down when nothing above that
+ *                   is happening.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include "filters.h"
+#include "acquisition.h"
+
+#define NUM_TAPS            32
+
+/* ADC counts to Q15: subtract mid-scale, then multiply by 4 (0.5 * 2^3) */
+#define COUNTS_OFFSET       (-(ADC_FULL_SCALE / 2))
+#define COUNTS_SCALE        0x4000
+#define COUNTS_SHIFT        3
+
+/* Hamming windowed sinc, symmetric so time reversal changes nothing. The
+ * taps add up to exactly 32768. */
+static const q15_t lowPass[NUM_TAPS] = {
+    14, 32, 63, 118, 207, 334, 503, 712, 955, 1221, 1496, 1763, 2004, 2202,
+    2344, 2416, 2416, 2344, 2202, 2004, 1763, 1496, 1221, 955, 712, 503, 334,
+    207, 118, 63, 32, 14 };
+
+static q15_t firState[NUM_CHANNELS][NUM_TAPS + ACQ_BLOCK_SIZE - 1];
+static Dsp_FirQ15 fir[NUM_CHANNELS];
+static q15_t work[ACQ_BLOCK_SIZE];
+
+void Filters_init(void)
+{
+    uint8_t channel;
+
+    for (channel = 0; channel < NUM_CHANNELS; channel++)
+    {
+        Dsp_firInitQ15(&fir[channel], NUM_TAPS, lowPass, firState[channel],
+                       ACQ_BLOCK_SIZE);
+    }
+}
+
+void Filters_countsToQ15(const uint16_t *samples, q15_t *out, uint16_t count)
+{
+    // 14-bit results are positive Q15 values as they are
+    Dsp_offsetQ15((const q15_t *) samples, COUNTS_OFFSET, out, count);
+    Dsp_scaleQ15(out, COUNTS_SCALE, COUNTS_SHIFT, out, count);
+}
+
+uint16_t Filters_processBlock(uint8_t channel, const uint16_t *samples,
+                              q15_t *out)
+{
+    if (out == 0)
+    {
+        out = work;
+    }
+    Filters_countsToQ15(samples, out, ACQ_BLOCK_SIZE);
+    Dsp_firQ15(&fir[channel % NUM_CHANNELS], out, out, ACQ_BLOCK_SIZE);
+
+    // Back to counts, the filter may overshoot full scale slightly
+    int32_t counts = (out[ACQ_BLOCK_SIZE - 1] >> 2) + ADC_FULL_SCALE / 2;
+    if (counts < 0)
+    {
+        counts = 0;
+    }
+    if (counts > ADC_FULL_SCALE - 1)
+    {
+        counts = ADC_FULL_SCALE - 1;
+    }
+    return (uint16_t) counts;
+}
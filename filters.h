@@ -0,0 +1,71 @@
+/*!
+ * filters.h
+ *      Description: Header file for the sample block filters. Each channel
+ *                   is converted from ADC counts to Q15 and low-pass filtered
+ *                   with the DSP kernels, removing noise and lamp flicker
+ *                   from the displayed readings.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef FILTERS_H_
+#define FILTERS_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#include "dsp.h"
+
+/*!
+ * \brief This function clears the filter state of every channel
+ *
+ * \return None
+ */
+extern void Filters_init(void);
+
+/*!
+ * \brief This function filters one block of a channel
+ *
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ * \param samples is ACQ_BLOCK_SIZE ADC results, oldest first
+ * \param out receives ACQ_BLOCK_SIZE filtered Q15 samples, may be 0
+ *
+ * \return The last filtered sample in ADC counts
+ */
+extern uint16_t Filters_processBlock(uint8_t channel, const uint16_t *samples,
+                                     q15_t *out);
+
+/*!
+ * \brief This function converts ADC counts to Q15
+ *
+ * Mid-scale maps to 0 and full scale to 1. Uses the offset and scale kernels.
+ *
+ * \param samples is the ADC results
+ * \param out receives the Q15 samples, may be the same memory as samples
+ * \param count is the number of samples
+ *
+ * \return None
+ */
+extern void Filters_countsToQ15(const uint16_t *samples, q15_t *out,
+                                uint16_t count);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILTERS_H_ */
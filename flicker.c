@@ -0,0 +1,255 @@
+/*!
+ * flicker.c
+ *      Description: Helper file for the light flicker analysis. The frame
+ *                   holds raw ADC counts until it is full; the analysis then
+ *                   removes the mean, doubles the samples to use the Q15
+ *                   range, applies a Hann window, runs the Goertzel
+ *                   detectors and finally the in-place real FFT. The only
+ *                   buffer is the FLICKER_SIZE sample frame; the bin
+ *                   magnitudes fill its first half and the noise floor is
+ *                   found in the second.
+ *
+ *                   Blocks are added in deferred work and the analysis runs
+ *                   as a task, so the frame changes hands through fill: the
+ *                   deferred work owns it while it is not full, the task
+ *                   once it is. The task publishes its result and hands the
+ *                   frame back with deferred work locked out.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <string.h>
+
+#include "flicker.h"
+#include "acquisition.h"
+#include "dsp.h"
+#include "defer.h"
+
+/* Frame samples are 2 * (counts - mean) after the conversion */
+#define FRAME_SCALE         0x4000
+#define FRAME_SHIFT         2
+
+/* Dominant peaks below 0.5 % are reported as no flicker */
+#define MIN_PEAK_PERMILLE   5
+#define MAX_PERMILLE        1000
+
+/*
+ * So are peaks below 6 times the median bin, the noise floor. The largest of
+ * the bins of white noise is rarely above 3 times their median.
+ */
+#define MIN_PEAK_TO_FLOOR   6
+
+/* The DC bin and its Hann window leakage are skipped in the peak search */
+#define FIRST_PEAK_BIN      2
+
+static q15_t frame[FLICKER_SIZE];
+static volatile uint16_t fill;
+static uint32_t countSum;
+/* Set by a restart while the task owns the frame, its result is dropped */
+static volatile bool discard;
+static Dsp_GoertzelQ15 lowDetector;
+static Dsp_GoertzelQ15 highDetector;
+static Flicker_Result result;
+
+/*!
+ * Converts an amplitude in ADC counts to a depth.
+ *
+ * \param counts Amplitude in counts
+ * \param mean Mean level in counts
+ *
+ * \return counts / mean in per mille, at most MAX_PERMILLE
+ */
+static uint16_t toPermille(uint32_t counts, uint32_t mean)
+{
+    uint32_t permille;
+
+    if (mean == 0)
+    {
+        return 0;
+    }
+    permille = (counts * 1000 + mean / 2) / mean;
+    return permille > MAX_PERMILLE ? MAX_PERMILLE : (uint16_t) permille;
+}
+
+/*!
+ * Returns the median of the values, reordering them.
+ *
+ * \param values Values to search, count of them
+ * \param count Number of values, at least 1
+ *
+ * \return The value of rank count / 2
+ */
+static q15_t selectMedian(q15_t *values, uint16_t count)
+{
+    int32_t middle = count / 2;
+    int32_t left = 0;
+    int32_t right = count - 1;
+
+    // Hoare's selection, partitions around a pivot until the middle is placed
+    while (left < right)
+    {
+        q15_t pivot = values[middle];
+        int32_t i = left;
+        int32_t j = right;
+
+        do
+        {
+            while (values[i] < pivot)
+            {
+                i++;
+            }
+            while (pivot < values[j])
+            {
+                j--;
+            }
+            if (i <= j)
+            {
+                q15_t swap = values[i];
+                values[i] = values[j];
+                values[j] = swap;
+                i++;
+                j--;
+            }
+        } while (i <= j);
+        if (j < middle)
+        {
+            left = i;
+        }
+        if (middle < i)
+        {
+            right = j;
+        }
+    }
+    return values[middle];
+}
+
+/*!
+ * Finds the strongest bin and its frequency.
+ *
+ * \param mag Bin magnitudes, FLICKER_SIZE / 2 of them, followed by
+ *            FLICKER_SIZE / 2 values of scratch space
+ * \param mean Mean level in counts
+ * \param out Receives the peak frequency and depth
+ *
+ * \return None
+ */
+static void findPeak(q15_t *mag, uint32_t mean, Flicker_Result *out)
+{
+    const uint16_t bins = FLICKER_SIZE / 2 - 1 - FIRST_PEAK_BIN;
+    q15_t *scratch = &mag[FLICKER_SIZE / 2];
+    q15_t noiseFloor;
+    uint16_t peak = FIRST_PEAK_BIN;
+    uint16_t k;
+
+    for (k = FIRST_PEAK_BIN + 1; k < FLICKER_SIZE / 2 - 1; k++)
+    {
+        if (mag[k] > mag[peak])
+        {
+            peak = k;
+        }
+    }
+
+    // The window quarters the bins, so the amplitude in counts is 2 |X|
+    out->peakPermille = toPermille(2 * (uint32_t) mag[peak], mean);
+    memcpy(scratch, &mag[FIRST_PEAK_BIN], bins * sizeof(q15_t));
+    noiseFloor = selectMedian(scratch, bins);
+    if (out->peakPermille < MIN_PEAK_PERMILLE
+            || mag[peak] < MIN_PEAK_TO_FLOOR * (int32_t) noiseFloor)
+    {
+        out->peakTenthsHz = 0;
+        return;
+    }
+
+    // A parabola through the peak and its neighbours places it between bins
+    int32_t tenths = (int32_t) peak * ACQ_SAMPLE_HZ * 10 / FLICKER_SIZE;
+    int32_t slope = mag[peak + 1] - mag[peak - 1];
+    int32_t curve = 2 * (2 * mag[peak] - mag[peak - 1] - mag[peak + 1]);
+    if (curve > 0)
+    {
+        tenths += slope * (ACQ_SAMPLE_HZ * 10) / (curve * FLICKER_SIZE);
+    }
+    out->peakTenthsHz = (uint16_t) tenths;
+}
+
+void Flicker_init(void)
+{
+    Dsp_goertzelInitQ15(&lowDetector, FLICKER_LOW_HZ, ACQ_SAMPLE_HZ);
+    Dsp_goertzelInitQ15(&highDetector, FLICKER_HIGH_HZ, ACQ_SAMPLE_HZ);
+    memset(&result, 0, sizeof(result));
+    fill = 0;
+    countSum = 0;
+    discard = false;
+}
+
+void Flicker_restart(void)
+{
+    result.valid = false;
+    if (fill == FLICKER_SIZE)
+    {
+        // The task is analyzing, let it hand back an empty frame
+        discard = true;
+        return;
+    }
+    fill = 0;
+    countSum = 0;
+}
+
+bool Flicker_addBlock(const uint16_t *samples)
+{
+    uint16_t i;
+
+    if (fill == FLICKER_SIZE)
+    {
+        return false;
+    }
+    // Counts are below 2^14, valid Q15 values until the mean is removed
+    memcpy(&frame[fill], samples, ACQ_BLOCK_SIZE * sizeof(uint16_t));
+    for (i = 0; i < ACQ_BLOCK_SIZE; i++)
+    {
+        countSum += samples[i];
+    }
+    fill += ACQ_BLOCK_SIZE;
+    return fill == FLICKER_SIZE;
+}
+
+void Flicker_analyze(void)
+{
+    Flicker_Result next;
+    uint32_t mean;
+
+    if (fill != FLICKER_SIZE)
+    {
+        return;
+    }
+    mean = countSum / FLICKER_SIZE;
+    Dsp_offsetQ15(frame, (q15_t) -(int32_t) mean, frame, FLICKER_SIZE);
+    Dsp_scaleQ15(frame, FRAME_SCALE, FRAME_SHIFT, frame, FLICKER_SIZE);
+    Dsp_hannQ15(frame, FLICKER_SIZE);
+
+    // Window gain 0.5 and frame scale 2 cancel, amplitudes are in counts
+    next.lowPermille = toPermille(
+            Dsp_goertzelQ15(&lowDetector, frame, FLICKER_SIZE), mean);
+    next.highPermille = toPermille(
+            Dsp_goertzelQ15(&highDetector, frame, FLICKER_SIZE), mean);
+
+    Dsp_rfftQ15(frame, FLICKER_SIZE);
+    Dsp_cmplxMagQ15(frame, FLICKER_SIZE, frame);
+    findPeak(frame, mean, &next);
+    next.valid = true;
+
+    // A restart must not land between the check and the hand back
+    uint32_t mask = Defer_lock();
+    if (!discard)
+    {
+        result = next;
+    }
+    discard = false;
+    countSum = 0;
+    fill = 0;
+    Defer_unlock(mask);
+}
+
+void Flicker_getResult(Flicker_Result *out)
+{
+    *out = result;
+}
@@ -0,0 +1,110 @@
+/*!
+ * flicker.h
+ *      Description: Header file for the light flicker analysis. Photoresistor
+ *                   sample blocks are collected into a frame of FLICKER_SIZE
+ *                   samples, which is windowed and analyzed with a real FFT
+ *                   for the dominant flicker frequency and with Goertzel
+ *                   detectors for the 100 Hz and 120 Hz mains flicker of
+ *                   lamps on 50 Hz and 60 Hz supplies.
+ *
+ *                   Depths are the percent flicker of the lighting metric,
+ *                   the amplitude of the modulation over the mean level.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef FLICKER_H_
+#define FLICKER_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Samples per analysis frame, a multiple of ACQ_BLOCK_SIZE and a power of
+ * two up to DSP_FFT_MAX_SIZE. 512 samples at 1 kHz resolve 1.95 Hz bins. */
+#ifndef FLICKER_SIZE
+#define FLICKER_SIZE        512
+#endif
+
+/* Mains flicker, twice the supply frequency */
+#define FLICKER_LOW_HZ      100
+#define FLICKER_HIGH_HZ     120
+
+/* Result of the last analyzed frame */
+typedef struct
+{
+    bool valid;                 // false until the first frame is analyzed
+    uint16_t peakTenthsHz;      // dominant frequency in 0.1 Hz, 0 if none
+    uint16_t peakPermille;      // depth of the dominant frequency
+    uint16_t lowPermille;       // depth at FLICKER_LOW_HZ
+    uint16_t highPermille;      // depth at FLICKER_HIGH_HZ
+} Flicker_Result;
+
+/*!
+ * \brief This function initializes the detectors and clears the results
+ *
+ * \return None
+ */
+extern void Flicker_init(void);
+
+/*!
+ * \brief This function starts collection over
+ *
+ * The partial frame is dropped and the result cleared. A frame that is
+ * being analyzed gives no result. Call from the context that adds blocks.
+ *
+ * \return None
+ */
+extern void Flicker_restart(void);
+
+/*!
+ * \brief This function adds a photoresistor block to the frame
+ *
+ * Blocks are ignored while a full frame waits for Flicker_analyze. Runs in
+ * deferred work.
+ *
+ * \param samples is ACQ_BLOCK_SIZE ADC results, oldest first
+ *
+ * \return true if the frame is full and ready for Flicker_analyze
+ */
+extern bool Flicker_addBlock(const uint16_t *samples);
+
+/*!
+ * \brief This function analyzes a full frame and starts the next one
+ *
+ * Runs as a scheduler task released when Flicker_addBlock fills the frame.
+ * Does nothing if the frame is not full.
+ *
+ * \return None
+ */
+extern void Flicker_analyze(void);
+
+/*!
+ * \brief This function returns the result of the last analyzed frame
+ *
+ * \param result receives the result
+ *
+ * \return None
+ */
+extern void Flicker_getResult(Flicker_Result *result);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLICKER_H_ */
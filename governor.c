@@ -0,0 +1,141 @@
+/*!
+ * governor.c
+ *      Description: Helper file for the dynamic frequency governor. Load is
+ *                   measured over each evaluation period from the idle total
+ *                   kept by power.c. Stepping up is immediate, a queue
+ *                   overflow jumps straight to the fastest profile, and
+ *                   stepping down needs GOVERNOR_DOWN_HOLD quiet periods in a
+ *                   row so the clock does not oscillate.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <stdio.h>
+
+#include "governor.h"
+#include "power.h"
+#include "scheduler.h"
+
+static const EventQueue *watchQueue;
+static Clock_ProfileId slowest;
+static Clock_ProfileId fastest;
+
+static uint32_t lastTimestamp;
+static uint32_t lastIdle;
+static uint32_t lastTicks;
+static uint32_t lastOverflows;
+static uint8_t quietCount;
+static uint8_t load;
+
+/* Scheduler ticks spent at each profile */
+static uint32_t residencyTicks[CLOCK_NUM_PROFILES];
+
+void Governor_init(const EventQueue *queue, Clock_ProfileId minProfile,
+                   Clock_ProfileId maxProfile)
+{
+    watchQueue = queue;
+    slowest = minProfile;
+    fastest = maxProfile;
+    lastTimestamp = Power_timestamp();
+    lastIdle = Power_getIdleTotal();
+    lastTicks = Sched_getTicks();
+    lastOverflows = Queue_getOverflows(queue);
+    quietCount = 0;
+    load = 0;
+
+    int i;
+    for (i = 0; i < CLOCK_NUM_PROFILES; i++)
+    {
+        residencyTicks[i] = 0;
+    }
+}
+
+void Governor_task(void)
+{
+    Clock_ProfileId profile = Clock_getProfile();
+
+    // Load over the last period, measured entirely at the current profile
+    uint32_t now = Power_timestamp();
+    uint32_t idleTotal = Power_getIdleTotal();
+    uint32_t elapsed = now - lastTimestamp;
+    uint32_t idle = idleTotal - lastIdle;
+    if (idle > elapsed)
+    {
+        idle = elapsed;
+    }
+    load = elapsed ? 100 - (uint8_t) (((uint64_t) idle * 100) / elapsed) : 0;
+
+    uint32_t ticks = Sched_getTicks();
+    residencyTicks[profile] += ticks - lastTicks;
+
+    uint32_t overflows = Queue_getOverflows(watchQueue);
+    uint32_t depth = Queue_count(watchQueue);
+
+    Clock_ProfileId next = profile;
+    if (overflows != lastOverflows)
+    {
+        next = fastest;
+        quietCount = 0;
+    }
+    else if (load >= GOVERNOR_UP_LOAD || depth >= GOVERNOR_UP_DEPTH)
+    {
+        if (profile < fastest)
+        {
+            next = (Clock_ProfileId) (profile + 1);
+        }
+        quietCount = 0;
+    }
+    else if (load < GOVERNOR_DOWN_LOAD && depth == 0)
+    {
+        if (++quietCount >= GOVERNOR_DOWN_HOLD && profile > slowest)
+        {
+            next = (Clock_ProfileId) (profile - 1);
+            quietCount = 0;
+        }
+    }
+    else
+    {
+        quietCount = 0;
+    }
+
+    if (next != profile)
+    {
+        Clock_setProfile(next);
+    }
+
+    // Timestamps are in MCLK cycles, so restart the window after a change
+    lastTimestamp = Power_timestamp();
+    lastIdle = Power_getIdleTotal();
+    lastTicks = ticks;
+    lastOverflows = overflows;
+}
+
+uint8_t Governor_getLoad(void)
+{
+    return load;
+}
+
+uint32_t Governor_getResidency(Clock_ProfileId profile)
+{
+    if (profile >= CLOCK_NUM_PROFILES)
+    {
+        return 0;
+    }
+    return residencyTicks[profile] * SCHED_TICK_MS;
+}
+
+void Governor_report(void (*write)(const char *line))
+{
+    char line[40];
+    int i;
+    write("clock residency:");
+    for (i = 0; i < CLOCK_NUM_PROFILES; i++)
+    {
+        uint32_t mclk = Clock_getProfileMCLK((Clock_ProfileId) i);
+        sprintf(line, "  %2lu.%lu MHz %10lu ms",
+                (unsigned long) (mclk / 1000000),
+                (unsigned long) ((mclk / 100000) % 10),
+                (unsigned long) Governor_getResidency((Clock_ProfileId) i));
+        write(line);
+    }
+}
@@ -0,0 +1,96 @@
+/*!
+ * governor.h
+ *      Description: Header file for the dynamic frequency governor. Steps the
+ *                   clock profile down while the CPU is mostly asleep and up
+ *                   when the CPU load is high or the sample queue backs up,
+ *                   and keeps the time spent at each profile.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef GOVERNOR_H_
+#define GOVERNOR_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#include "clock.h"
+#include "queue.h"
+
+/* Evaluation period in scheduler ticks (100 ms) */
+#define GOVERNOR_PERIOD         10
+/* Step up when CPU load reaches this percentage */
+#define GOVERNOR_UP_LOAD        70
+/* Step down only while CPU load stays below this percentage */
+#define GOVERNOR_DOWN_LOAD      25
+/* Step up when this many samples are waiting */
+#define GOVERNOR_UP_DEPTH       4
+/* Consecutive quiet evaluations before stepping down */
+#define GOVERNOR_DOWN_HOLD      10
+
+/*!
+ * \brief This function initializes the governor
+ *
+ * \param queue is the sample queue whose depth is watched
+ * \param minProfile is the slowest profile the governor may select
+ * \param maxProfile is the fastest profile the governor may select
+ *
+ * \return None
+ */
+extern void Governor_init(const EventQueue *queue, Clock_ProfileId minProfile,
+                          Clock_ProfileId maxProfile);
+
+/*!
+ * \brief This function evaluates the load and changes profile if needed
+ *
+ * This function must run as a scheduler task every GOVERNOR_PERIOD ticks.
+ *
+ * \return None
+ */
+extern void Governor_task(void);
+
+/*!
+ * \brief This function returns the CPU load of the last evaluation
+ *
+ * \return CPU load in percent (0 - 100)
+ */
+extern uint8_t Governor_getLoad(void);
+
+/*!
+ * \brief This function returns the time spent at a profile
+ *
+ * \param profile is the profile to look up
+ *
+ * \return Time in milliseconds since Governor_init
+ */
+extern uint32_t Governor_getResidency(Clock_ProfileId profile);
+
+/*!
+ * \brief This function writes the time spent at each profile
+ *
+ * \param write is called once per line of the report
+ *
+ * \return None
+ */
+extern void Governor_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GOVERNOR_H_ */
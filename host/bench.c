@@ -0,0 +1,181 @@
+/*!
+ * bench.c
+ *      Description: Host benchmark of the LCD, delay and display code built
+ *                   against the stub DriverLib. For each case it reports, per
+ *                   call, the peripheral register reads and writes, the
+ *                   modeled time on the target and the host cycles spent.
+ *                   Bus counts and modeled time are exact for a given build,
+ *                   so any change in them is a real change in the firmware.
+ *
+ *                   Usage: bench [iterations] [name filter]
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../lcd.h"
+#include "../acquisition.h"
+
+#define DEFAULT_ITERATIONS  1000
+/* Sample blocks for the filters to reach a new reading */
+#define SETTLE_BLOCKS       3
+
+/* Firmware entry points from main.c, built with main renamed */
+extern void setup(void);
+extern void handleEvents(void);
+extern void refreshDisplay(void);
+extern void formatReading(uint16_t digitalValue, char *digits, char *volts);
+extern void ADC14_IRQHandler(void);
+
+typedef struct
+{
+    const char *name;
+    void (*fn)(void);
+} Benchmark;
+
+static uint16_t reading;
+
+/*!
+ * Returns a host timestamp, TSC cycles where available.
+ *
+ * \return Host cycles or nanoseconds
+ */
+static uint64_t hostCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/*!
+ * Moves a new ADC reading through the real acquisition path until the
+ * filters have settled on it.
+ *
+ * \param value Reading for both channels
+ *
+ * \return None
+ */
+static void setReading(uint16_t value)
+{
+    int i;
+
+    stubAdcResult[ADC_MEM14] = value;
+    stubAdcResult[ADC_MEM15] = value;
+    // One conversion per step, no interrupts are taken without vectors
+    for (i = 0; i < 2 * ACQ_BLOCK_SIZE * SETTLE_BLOCKS; i++)
+    {
+        Stub_advance(CS_getMCLK() / (2 * ACQ_SAMPLE_HZ));
+        ADC14_IRQHandler();
+        handleEvents();
+    }
+}
+
+static void benchPrintString(void)
+{
+    printString("Analog: ", 8);
+}
+
+static void benchCommandInstruction(void)
+{
+    commandInstruction(SET_CURSOR_MASK | LINE2_OFFSET, false);
+}
+
+static void benchClearDisplay(void)
+{
+    commandInstruction(CLEAR_DISPLAY_MASK, false);
+}
+
+static void benchRefreshDisplay(void)
+{
+    refreshDisplay();
+}
+
+static void benchFormatReading(void)
+{
+    char digits[8];
+    char volts[8];
+
+    // Cover every digit count
+    reading = (reading * 7 + 1237) & (ADC_FULL_SCALE - 1);
+    formatReading(reading, digits, volts);
+}
+
+static const Benchmark benchmarks[] = {
+    { "printString", benchPrintString },
+    { "commandInstruction", benchCommandInstruction },
+    { "clearDisplay", benchClearDisplay },
+    { "refreshDisplay", benchRefreshDisplay },
+    { "formatReading", benchFormatReading },
+};
+
+int main(int argc, char *argv[])
+{
+    unsigned long iterations = DEFAULT_ITERATIONS;
+    const char *filter = argc > 2 ? argv[2] : 0;
+    size_t i;
+
+    if (argc > 1)
+    {
+        iterations = strtoul(argv[1], 0, 0);
+        if (iterations == 0)
+        {
+            iterations = 1;
+        }
+    }
+
+    Stub_reset();
+    setup();
+    // setup leaves the LCD sequence to the scheduler, which is not run here
+    initLCD();
+    setReading(9000);
+
+    printf("MCLK %lu Hz, %lu iterations, per call:\n",
+           (unsigned long) CS_getMCLK(), iterations);
+    printf("%-20s %10s %10s %12s %12s\n", "benchmark", "bus reads",
+           "bus writes", "modeled us", "host cycles");
+    for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+    {
+        const Benchmark *bench = &benchmarks[i];
+        Stub_Counters before;
+        uint64_t start;
+        uint64_t host;
+        unsigned long n;
+
+        if (filter != 0 && strstr(bench->name, filter) == 0)
+        {
+            continue;
+        }
+        before = stubCounters;
+        start = hostCycles();
+        for (n = 0; n < iterations; n++)
+        {
+            bench->fn();
+        }
+        host = hostCycles() - start;
+
+        printf("%-20s %10.1f %10.1f %12.2f %12.1f\n", bench->name,
+               (double) (stubCounters.busReads - before.busReads) / iterations,
+               (double) (stubCounters.busWrites - before.busWrites)
+                       / iterations,
+               (double) (stubCounters.picos - before.picos) / 1e6
+                       / iterations,
+               (double) host / iterations);
+    }
+    return 0;
+}
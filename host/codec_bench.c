@@ -0,0 +1,197 @@
+/*!
+ * codec_bench.c
+ *      Description: Host check of the sample block codec. Encodes blocks of
+ *                   typical and worst case 14-bit signals, decodes them and
+ *                   compares every sample, checks that truncated blocks are
+ *                   rejected, and reports the bits per sample and the host
+ *                   cycles to encode one. Exits non-zero on any mismatch.
+ *
+ *                   Usage: codec_bench
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../codec.h"
+#include "../acquisition.h"
+
+#define PI                  3.14159265358979323846
+#define NUM_BLOCKS          256
+#define ADC_MAX             (ADC_FULL_SCALE - 1)
+
+typedef enum
+{
+    SIGNAL_CONST, SIGNAL_RAMP, SIGNAL_NOISE, SIGNAL_SINE, SIGNAL_STEPS,
+    SIGNAL_RANDOM, SIGNAL_EXTREMES, NUM_SIGNALS
+} Signal;
+
+static const char *const signalNames[NUM_SIGNALS] = { "const", "slow ramp",
+                                                      "noise +-300",
+                                                      "sine 5 Hz",
+                                                      "steps", "random",
+                                                      "0/65535" };
+
+static uint32_t noiseState = 12345;
+
+/*!
+ * Returns a host timestamp, TSC cycles where available.
+ *
+ * \return Host cycles or nanoseconds
+ */
+static uint64_t hostCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/*!
+ * Returns the next pseudo random number, xorshift32.
+ *
+ * \return Random 32 bits
+ */
+static uint32_t nextRandom(void)
+{
+    noiseState ^= noiseState << 13;
+    noiseState ^= noiseState >> 17;
+    noiseState ^= noiseState << 5;
+    return noiseState;
+}
+
+/*!
+ * Returns a sample of a test signal at 1 kHz.
+ *
+ * \param signal Signal
+ * \param n Sample number
+ *
+ * \return Sample
+ */
+static uint16_t sample(Signal signal, uint32_t n)
+{
+    switch (signal)
+    {
+    case SIGNAL_CONST:
+        return 8000;
+    case SIGNAL_RAMP:
+        return (uint16_t) (2000 + n / 4);
+    case SIGNAL_NOISE:
+        return (uint16_t) (6000 + (int32_t) (nextRandom() % 601) - 300);
+    case SIGNAL_SINE:
+        return (uint16_t) (8192 + 6000 * sin(2 * PI * 5 * n / 1000.0));
+    case SIGNAL_STEPS:
+        return (n / 100) % 2 ? 12000 : 3000;
+    case SIGNAL_RANDOM:
+        return (uint16_t) (nextRandom() % (ADC_MAX + 1));
+    default:
+        return n % 2 ? 0 : 65535;
+    }
+}
+
+/*!
+ * Encodes and decodes every block of one signal.
+ *
+ * \param signal Signal
+ * \param count Samples per block
+ *
+ * \return true if every block came back unchanged
+ */
+static bool runSignal(Signal signal, uint32_t count)
+{
+    uint16_t samples[CODEC_MAX_SAMPLES];
+    uint16_t decoded[CODEC_MAX_SAMPLES];
+    uint8_t block[CODEC_MAX_BYTES(CODEC_MAX_SAMPLES)];
+    uint64_t cycles = 0;
+    uint64_t bytes = 0;
+    uint32_t n = 0;
+    uint32_t b;
+    uint32_t i;
+
+    for (b = 0; b < NUM_BLOCKS; b++)
+    {
+        uint8_t channel;
+        uint32_t length;
+        uint64_t start;
+
+        for (i = 0; i < count; i++)
+        {
+            samples[i] = sample(signal, n++);
+        }
+        start = hostCycles();
+        length = Codec_encode(b % 2, samples, count, block);
+        cycles += hostCycles() - start;
+        bytes += length;
+
+        if (length == 0 || length > CODEC_MAX_BYTES(count)
+                || Codec_decode(block, length, &channel, decoded, count)
+                        != (int32_t) count
+                || channel != b % 2
+                || memcmp(samples, decoded, count * sizeof(uint16_t)) != 0)
+        {
+            printf("%-12s %3u  block %u does not round-trip\n",
+                   signalNames[signal], count, b);
+            return false;
+        }
+        // Every byte is needed, except the padding of a whole byte block
+        if (length > CODEC_HEADER_BYTES
+                && Codec_decode(block, length - 1, &channel, decoded, count)
+                        >= 0
+                && count > 1 && block[length - 1] != 0)
+        {
+            printf("%-12s %3u  truncated block %u accepted\n",
+                   signalNames[signal], count, b);
+            return false;
+        }
+    }
+    printf("%-12s %3u %8.2f %8.1f%% %10.1f\n", signalNames[signal], count,
+           8.0 * bytes / (NUM_BLOCKS * count),
+           100.0 * bytes / (NUM_BLOCKS * count * sizeof(uint16_t)),
+           (double) cycles / (NUM_BLOCKS * count));
+    return true;
+}
+
+int main(void)
+{
+    static const uint32_t counts[] = { 1, ACQ_BLOCK_SIZE, CODEC_MAX_SAMPLES };
+    uint8_t block[CODEC_MAX_BYTES(2)];
+    uint16_t samples[2] = { 0, 0 };
+    uint8_t channel;
+    bool ok = true;
+    uint32_t c;
+    int signal;
+
+    printf("signal     block bits/smp     size  cycles/smp\n");
+    for (c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        for (signal = 0; signal < NUM_SIGNALS; signal++)
+        {
+            ok &= runSignal((Signal) signal, counts[c]);
+        }
+    }
+
+    // Out of range arguments and headers
+    ok &= Codec_encode(CODEC_MAX_CHANNEL + 1, samples, 2, block) == 0;
+    ok &= Codec_encode(0, samples, 0, block) == 0;
+    ok &= Codec_encode(0, samples, CODEC_MAX_SAMPLES + 1, block) == 0;
+    ok &= Codec_decode(block, CODEC_HEADER_BYTES - 1, &channel, samples, 2)
+            == -1;
+    Codec_encode(0, samples, 2, block);
+    ok &= Codec_decode(block, sizeof(block), &channel, samples, 1) == -1;
+
+    printf("%s\n", ok ? "all blocks round-trip" : "FAILED");
+    return ok ? 0 : 1;
+}
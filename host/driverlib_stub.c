@@ -0,0 +1,1857 @@
+/*!
+ * driverlib_stub.c
+ *      Description: Host implementation of the stub DriverLib. Each function
+ *                   charges the register accesses the real DriverLib makes
+ *                   (read-modify-write counts as one read and one write) and
+ *                   keeps enough peripheral state for the firmware to run:
+ *                   clock frequencies, Timer32 and Timer_A counters derived
+ *                   from virtual time, the DWT cycle counter, SysTick delays,
+ *                   ADC14 sequences with their conversion time, started by
+ *                   software or by a Timer_A CCR1 output, UART bytes with
+ *                   their time on the line, and an eUSCI_B0 I2C master
+ *                   whose bytes the DMA can move, with a simulated target
+ *                   behind the hooks.
+ *
+ *                   Interrupt lines are level sensitive like the hardware: a
+ *                   handler runs while its flag and enable are set, so a
+ *                   handler that forgets to clear its flag loops forever here
+ *                   too. A handler is preempted only by a line of strictly higher priority
+ *                   (lower value), set with Interrupt_setPriority, and
+ *                   BASEPRI holds back lines at or below its level. System
+ *                   exceptions such as PendSV are pended by software and are
+ *                   always enabled.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <string.h>
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#define PICOS_PER_SECOND    1000000000000ULL
+#define NANOS_PER_SECOND    1000000000ULL
+#define NO_EVENT            UINT64_MAX
+
+/* Timer_A CCTLn bits */
+#define CCIFG               0x0001
+#define CCIE                0x0010
+#define OUTMOD_MASK         0x00E0
+
+/* ADC14 clocks to convert one channel at 14 bits, after sampling */
+#define ADC_CONVERSION_CLOCKS   16
+
+Stub_Counters stubCounters;
+uint16_t stubAdcResult[32];
+Stub_Hooks stubHooks;
+void (*stubVectors[STUB_NUM_INTERRUPTS])(void);
+
+SysTick_Type stubSysTick;
+CoreDebug_Type stubCoreDebug;
+SCB_Type stubScb;
+uint32_t stubStack[STUB_STACK_WORDS];
+DIO_PORT_Type stubPorts[11];
+ADC14_Type stubAdc14;
+
+static DWT_Type dwt;
+static uint32_t dwtSynced;
+static uint64_t dwtBase;
+
+typedef struct
+{
+    uint64_t start;         /* MCLK cycle of the last load */
+    uint64_t fired;         /* periods elapsed since start */
+    bool periodic;
+    bool running;
+    bool interrupt;
+} Timer32_State;
+
+static Timer32_Type timer32[2];
+static Timer32_State timer32State[2];
+
+typedef struct
+{
+    uint64_t start;         /* SMCLK tick of the last (re)start */
+    uint64_t fired;         /* periods elapsed since start */
+    uint64_t edges;         /* CCR1 matches since start */
+    uint16_t period;        /* CCR0 the phase was started with */
+    bool running;
+} TimerA_State;
+
+static Timer_A_Type timerA[4];
+static TimerA_State timerAState[4];
+
+/* DCO frequency of each CS_DCO_FREQUENCY_x setting */
+static const uint32_t dcoFrequencies[] = { 1500000, 3000000, 6000000,
+                                           12000000, 24000000, 48000000 };
+static uint32_t dco;
+static uint32_t mclkDivider;
+static uint32_t smclkDivider;
+
+/* SMCLK periods elapsed, Timer_A and UART time base */
+static uint64_t smclkTicks;
+static uint64_t smclkRemainder;
+
+/* Execution priority of thread mode, below every handler */
+#define THREAD_PRIORITY     256
+/* Interrupt numbers below 16 are system exceptions */
+#define SYSTEM_EXCEPTIONS   0xFFFFULL
+
+static uint32_t primask;
+static uint32_t basepri;
+static uint32_t control;
+static uint64_t nvicEnabled;
+static uint64_t softPending;
+static uint8_t nvicPriority[STUB_NUM_INTERRUPTS];
+static int activePriority;
+static uint64_t dispatched;
+
+/* Absolute time the update hook wants to run again */
+static uint64_t hookDue;
+
+/* Cached cycle of the next event, invalidated by any state change */
+static uint64_t nextEventAt;
+static bool nextEventValid;
+
+/* Timer_A CTL bits */
+#define TACLR               0x0004
+#define MC_MASK             0x0030
+
+/* ADC14 sequence state, adcMemory < 0 when idle. MCTLn holds the input
+ * channel, MEMn the results and IFGR0 their flags. */
+static const uint16_t pulseCycles[] = { 4, 8, 16, 32, 64, 96, 128, 192 };
+static const uint16_t predividers[] = { 1, 4, 32, 64 };
+static uint32_t adcStart;
+static uint32_t adcEnd;
+static uint32_t adcClockDivide;
+static uint32_t adcPulse;
+static bool adcEnabledConversion;
+static int adcMemory;
+static uint64_t adcDoneAt;
+static uint64_t adcInterrupts;
+/* Timer_A instance whose CCR1 output triggers conversions, -1 for ADC14SC.
+ * Without automatic iteration each trigger converts one memory and a
+ * repeated sequence continues from adcNext. */
+static int adcTriggerTimer;
+static bool adcAutomatic;
+static bool adcRepeat;
+static uint32_t adcNext;
+
+/* UART transmitter */
+static uint32_t uartBitTicks;
+static bool uartInterrupt;
+static bool uartTxFlag;
+static bool uartBusy;
+static uint8_t uartByte;
+static uint64_t uartDoneAt;
+
+/* eUSCI_B0 I2C master. A start with the address holds the bus for ten bit
+ * times, a byte with its acknowledge nine and a stop one. SCL is held in the
+ * _WAIT phases until the firmware fills TXBUF, empties RXBUF, or asks for a
+ * start or stop, like the hardware. A received byte is NACKed when STOP is
+ * set by the time it ends. */
+typedef enum
+{
+    I2C_IDLE,
+    I2C_ADDRESS,
+    I2C_SEND,
+    I2C_SEND_WAIT,
+    I2C_RECEIVE,
+    I2C_RECEIVE_WAIT,
+    I2C_NACK_WAIT,
+    I2C_STOPPING
+} I2c_Phase;
+
+static I2c_Phase i2cPhase;
+static uint32_t i2cBitTicks;
+static uint64_t i2cDoneAt;
+static uint8_t i2cAddress;
+static bool i2cTransmit;
+static bool i2cStartPending;
+static bool i2cStopPending;
+static bool i2cTxFull;
+static uint8_t i2cTxBuffer;
+static uint8_t i2cShift;
+static bool i2cRxFull;
+static uint8_t i2cRxBuffer;
+/* RXIFG0, STPIFG and NACKIFG; TXIFG0 follows from the buffer state */
+static uint16_t i2cFlags;
+static uint16_t i2cInterrupts;
+
+/* eUSCI_B0 buffer registers, handed to the DMA as its peripheral side */
+#define I2C_RXBUF_ADDRESS   (EUSCI_B0_BASE + 0x4C)
+#define I2C_TXBUF_ADDRESS   (EUSCI_B0_BASE + 0x4E)
+
+/* DMA channels in basic mode. Only the eUSCI_B0 triggers move data, one
+ * byte per flag, and a transfer takes no time. */
+#define DMA_CHANNELS        8
+
+typedef struct
+{
+    uint32_t mapping;       /* DMA_CHn_x from DMA_assignChannel */
+    uint8_t *source;
+    uint8_t *destination;
+    uint32_t remaining;
+    bool sourceIncrement;
+    bool destinationIncrement;
+    bool enabled;
+} Dma_Channel;
+
+static Dma_Channel dma[DMA_CHANNELS];
+static uint32_t dmaDone;
+static uint32_t dmaInt1Channel;
+
+static void dispatch(void);
+
+/*!
+ * Marks the cached next event time stale after a peripheral state change.
+ *
+ * \return None
+ */
+static void rescheduled(void)
+{
+    nextEventValid = false;
+}
+
+void Stub_reset(void)
+{
+    memset(&stubCounters, 0, sizeof(stubCounters));
+    memset(stubPorts, 0, sizeof(stubPorts));
+    memset(&stubSysTick, 0, sizeof(stubSysTick));
+    memset(&dwt, 0, sizeof(dwt));
+    memset(&stubScb, 0, sizeof(stubScb));
+    memset(timer32, 0, sizeof(timer32));
+    memset(timer32State, 0, sizeof(timer32State));
+    memset(timerA, 0, sizeof(timerA));
+    memset(timerAState, 0, sizeof(timerAState));
+    dwtSynced = 0;
+    dwtBase = 0;
+
+    // SystemInit leaves MCLK and SMCLK on the 3 MHz DCO
+    dco = 3000000;
+    mclkDivider = 0;
+    smclkDivider = 0;
+    smclkTicks = 0;
+    smclkRemainder = 0;
+
+    primask = 0;
+    basepri = 0;
+    control = 0;
+    nvicEnabled = 0;
+    softPending = 0;
+    memset(nvicPriority, 0, sizeof(nvicPriority));
+    activePriority = THREAD_PRIORITY;
+    dispatched = 0;
+    hookDue = 0;
+    nextEventValid = false;
+
+    memset(&stubAdc14, 0, sizeof(stubAdc14));
+    adcStart = 0;
+    adcEnd = 0;
+    adcClockDivide = 1;
+    adcPulse = pulseCycles[0];
+    adcEnabledConversion = false;
+    adcMemory = -1;
+    adcInterrupts = 0;
+    adcTriggerTimer = -1;
+    adcAutomatic = true;
+    adcRepeat = false;
+    adcNext = 0;
+
+    uartBitTicks = 1;
+    uartInterrupt = false;
+    uartTxFlag = true;
+    uartBusy = false;
+
+    i2cPhase = I2C_IDLE;
+    i2cBitTicks = 1;
+    i2cTransmit = false;
+    i2cStartPending = false;
+    i2cStopPending = false;
+    i2cTxFull = false;
+    i2cRxFull = false;
+    i2cFlags = 0;
+    i2cInterrupts = 0;
+    memset(dma, 0, sizeof(dma));
+    dmaDone = 0;
+    dmaInt1Channel = 0;
+}
+
+/*!
+ * Returns the MCLK cycles per SMCLK period.
+ *
+ * \return Divider ratio
+ */
+static uint32_t smclkRatio(void)
+{
+    return 1U << (smclkDivider - mclkDivider);
+}
+
+/*!
+ * Returns the MCLK cycles of one ADC14 conversion, sampling included.
+ *
+ * \return Conversion time in MCLK cycles
+ */
+static uint64_t adcConversionCycles(void)
+{
+    return (uint64_t) (adcPulse + ADC_CONVERSION_CLOCKS) * adcClockDivide;
+}
+
+/*!
+ * Starts a conversion at the current sequence position. A trigger while a
+ * conversion is running is ignored.
+ *
+ * \return None
+ */
+static void startConversion(void)
+{
+    if (!adcEnabledConversion || adcMemory >= 0)
+    {
+        return;
+    }
+    adcMemory = adcNext;
+    adcDoneAt = stubCounters.cycles + adcConversionCycles();
+    rescheduled();
+}
+
+/*!
+ * Returns the CCR1 matches of a running Timer_A since its start, the rising
+ * OUT1 edges in set/reset mode.
+ *
+ * \param i Timer_A instance
+ *
+ * \return Matches since start
+ */
+static uint64_t timerAEdges(int i)
+{
+    uint64_t elapsed = smclkTicks - timerAState[i].start;
+
+    if (elapsed < timerA[i].CCR[1])
+    {
+        return 0;
+    }
+    return (elapsed - timerA[i].CCR[1]) / ((uint64_t) timerA[i].CCR[0] + 1)
+            + 1;
+}
+
+/*!
+ * Returns whether TXIFG0 of eUSCI_B0 is set: TXBUF is empty while the
+ * master transmits.
+ *
+ * \return Flag state
+ */
+static bool i2cTxFlag(void)
+{
+    return i2cTransmit && !i2cTxFull
+            && (i2cPhase == I2C_ADDRESS || i2cPhase == I2C_SEND
+                    || i2cPhase == I2C_SEND_WAIT);
+}
+
+/*!
+ * Enters a timed bus phase.
+ *
+ * \param phase I2C_ADDRESS, I2C_SEND, I2C_RECEIVE or I2C_STOPPING
+ * \param bits Its length in bit times
+ *
+ * \return None
+ */
+static void i2cBegin(I2c_Phase phase, uint32_t bits)
+{
+    i2cPhase = phase;
+    i2cDoneAt = stubCounters.cycles
+            + (uint64_t) bits * i2cBitTicks * smclkRatio();
+}
+
+/*!
+ * Leaves a _WAIT phase once the firmware has let the bus go on.
+ *
+ * \return true if the phase changed
+ */
+static bool i2cResume(void)
+{
+    switch (i2cPhase)
+    {
+    case I2C_IDLE:
+        if (!i2cStartPending)
+        {
+            return false;
+        }
+        i2cBegin(I2C_ADDRESS, 10);
+        return true;
+    case I2C_SEND_WAIT:
+        if (i2cTxFull)
+        {
+            i2cShift = i2cTxBuffer;
+            i2cTxFull = false;
+            i2cBegin(I2C_SEND, 9);
+            return true;
+        }
+        // A start or stop follows the last byte
+        // Fall through
+    case I2C_NACK_WAIT:
+        if (i2cStartPending)
+        {
+            i2cBegin(I2C_ADDRESS, 10);
+            return true;
+        }
+        if (i2cStopPending)
+        {
+            i2cBegin(I2C_STOPPING, 1);
+            return true;
+        }
+        return false;
+    case I2C_RECEIVE_WAIT:
+        if (i2cRxFull)
+        {
+            return false;
+        }
+        i2cBegin(I2C_RECEIVE, 9);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*!
+ * Moves one byte on each DMA channel whose trigger flag is set.
+ *
+ * \return true if a byte moved
+ */
+static bool dmaMove(void)
+{
+    bool moved = false;
+    int i;
+
+    for (i = 0; i < DMA_CHANNELS; i++)
+    {
+        Dma_Channel *channel = &dma[i];
+
+        if (!channel->enabled)
+        {
+            continue;
+        }
+        if (channel->mapping == DMA_CH0_EUSCIB0TX0 && i2cTxFlag())
+        {
+            i2cTxBuffer = *channel->source;
+            i2cTxFull = true;
+            channel->source += channel->sourceIncrement;
+        }
+        else if (channel->mapping == DMA_CH1_EUSCIB0RX0 && i2cRxFull)
+        {
+            *channel->destination = i2cRxBuffer;
+            i2cRxFull = false;
+            i2cFlags &= ~EUSCI_B_I2C_RECEIVE_INTERRUPT0;
+            channel->destination += channel->destinationIncrement;
+        }
+        else
+        {
+            continue;
+        }
+        moved = true;
+        if (--channel->remaining == 0)
+        {
+            channel->enabled = false;
+            dmaDone |= 1UL << i;
+        }
+    }
+    return moved;
+}
+
+/*!
+ * Settles the I2C master and the DMA after a state change.
+ *
+ * \return None
+ */
+static void i2cUpdate(void)
+{
+    while (i2cResume() | dmaMove())
+    {
+    }
+    rescheduled();
+}
+
+/*!
+ * Ends the timed bus phase, asking the target hooks for its response.
+ *
+ * \return None
+ */
+static void i2cPhaseDone(void)
+{
+    bool ack;
+
+    switch (i2cPhase)
+    {
+    case I2C_ADDRESS:
+        i2cStartPending = false;
+        ack = stubHooks.i2cStart != 0
+                && stubHooks.i2cStart(i2cAddress, !i2cTransmit);
+        i2cPhase = !ack ? I2C_NACK_WAIT :
+                   i2cTransmit ? I2C_SEND_WAIT : I2C_RECEIVE_WAIT;
+        break;
+    case I2C_SEND:
+        ack = stubHooks.i2cWrite != 0 && stubHooks.i2cWrite(i2cShift);
+        i2cPhase = ack ? I2C_SEND_WAIT : I2C_NACK_WAIT;
+        break;
+    case I2C_RECEIVE:
+        i2cRxBuffer = stubHooks.i2cRead != 0 ? stubHooks.i2cRead() : 0xFF;
+        i2cRxFull = true;
+        i2cFlags |= EUSCI_B_I2C_RECEIVE_INTERRUPT0;
+        if (i2cStopPending)
+        {
+            i2cBegin(I2C_STOPPING, 1);
+            return;
+        }
+        i2cPhase = I2C_RECEIVE_WAIT;
+        break;
+    case I2C_STOPPING:
+        i2cStopPending = false;
+        i2cFlags |= EUSCI_B_I2C_STOP_INTERRUPT;
+        i2cPhase = I2C_IDLE;
+        if (stubHooks.i2cStop)
+        {
+            stubHooks.i2cStop();
+        }
+        break;
+    default:
+        break;
+    }
+    if (i2cPhase == I2C_NACK_WAIT)
+    {
+        // A NACK discards TXBUF
+        i2cFlags |= EUSCI_B_I2C_NAK_INTERRUPT;
+        i2cTxFull = false;
+    }
+}
+
+/*!
+ * Returns whether the I2C master is in a timed phase.
+ *
+ * \return true while a start, byte or stop is on the bus
+ */
+static bool i2cTimed(void)
+{
+    return i2cPhase == I2C_ADDRESS || i2cPhase == I2C_SEND
+            || i2cPhase == I2C_RECEIVE || i2cPhase == I2C_STOPPING;
+}
+
+/*!
+ * Raises the flags of everything due at the current time and runs the
+ * update hook when it asked to be called.
+ *
+ * \return None
+ */
+static void updatePeripherals(void)
+{
+    uint64_t now = stubCounters.cycles;
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        Timer32_State *state = &timer32State[i];
+        if (state->running && state->periodic && timer32[i].LOAD != 0)
+        {
+            uint64_t fires = (now - state->start) / timer32[i].LOAD;
+            if (fires != state->fired)
+            {
+                state->fired = fires;
+                timer32[i].RIS = 1;
+            }
+        }
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        TimerA_State *state = &timerAState[i];
+        if (state->running)
+        {
+            uint64_t fires = (smclkTicks - state->start)
+                    / ((uint64_t) timerA[i].CCR[0] + 1);
+            if (fires != state->fired)
+            {
+                state->fired = fires;
+                timerA[i].CCTL[0] |= CCIFG;
+            }
+            // Set/reset gives one rising OUT1 edge per period, at CCR1
+            if (i == adcTriggerTimer && (timerA[i].CCTL[1] & OUTMOD_MASK)
+                    == TIMER_A_OUTPUTMODE_SET_RESET)
+            {
+                uint64_t edges = timerAEdges(i);
+                if (edges != state->edges)
+                {
+                    state->edges = edges;
+                    startConversion();
+                }
+            }
+        }
+    }
+
+    while (adcMemory >= 0 && now >= adcDoneAt)
+    {
+        uint16_t value = stubHooks.adcInput ?
+                stubHooks.adcInput(stubAdc14.MCTL[adcMemory] & 0x1F,
+                                   Stub_getNanos()) :
+                stubAdcResult[adcMemory];
+        stubAdc14.MEM[adcMemory] = value;
+        stubAdc14.IFGR0 |= 1UL << adcMemory;
+        if (stubHooks.adcDone)
+        {
+            stubHooks.adcDone(adcMemory, value, Stub_getNanos());
+        }
+        adcNext = (uint32_t) adcMemory < adcEnd ?
+                (uint32_t) adcMemory + 1 : adcStart;
+        if (adcAutomatic && (uint32_t) adcMemory < adcEnd)
+        {
+            adcMemory++;
+            adcDoneAt += adcConversionCycles();
+        }
+        else
+        {
+            adcMemory = -1;
+        }
+    }
+
+    if (uartBusy && now >= uartDoneAt)
+    {
+        uartBusy = false;
+        uartTxFlag = true;
+        if (stubHooks.uartByte)
+        {
+            stubHooks.uartByte(uartByte);
+        }
+    }
+
+    if (i2cTimed() && now >= i2cDoneAt)
+    {
+        i2cPhaseDone();
+        i2cUpdate();
+    }
+
+    if (stubHooks.update && hookDue != NO_EVENT && Stub_getNanos() >= hookDue)
+    {
+        uint64_t next = stubHooks.update(Stub_getNanos());
+        hookDue = next ? Stub_getNanos() + next : NO_EVENT;
+    }
+}
+
+/*!
+ * Returns the MCLK cycles until the next peripheral or hook event.
+ *
+ * \return Cycles, at least 1, or NO_EVENT
+ */
+static uint64_t cyclesToNextEvent(void)
+{
+    uint64_t now = stubCounters.cycles;
+    uint64_t next = NO_EVENT;
+    uint64_t cycles;
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        Timer32_State *state = &timer32State[i];
+        if (state->running && state->periodic && timer32[i].LOAD != 0)
+        {
+            cycles = state->start + (state->fired + 1) * timer32[i].LOAD - now;
+            next = cycles < next ? cycles : next;
+        }
+    }
+    for (i = 0; i < 4; i++)
+    {
+        TimerA_State *state = &timerAState[i];
+        if (state->running)
+        {
+            uint64_t ticks = state->start + (state->fired + 1)
+                    * ((uint64_t) timerA[i].CCR[0] + 1) - smclkTicks;
+            cycles = ticks * smclkRatio() - smclkRemainder;
+            next = cycles < next ? cycles : next;
+            if (i == adcTriggerTimer)
+            {
+                ticks = state->start + timerA[i].CCR[1] + state->edges
+                        * ((uint64_t) timerA[i].CCR[0] + 1) - smclkTicks;
+                cycles = ticks * smclkRatio() - smclkRemainder;
+                next = cycles < next ? cycles : next;
+            }
+        }
+    }
+    if (adcMemory >= 0)
+    {
+        cycles = adcDoneAt - now;
+        next = cycles < next ? cycles : next;
+    }
+    if (uartBusy)
+    {
+        cycles = uartDoneAt - now;
+        next = cycles < next ? cycles : next;
+    }
+    if (i2cTimed())
+    {
+        cycles = i2cDoneAt > now ? i2cDoneAt - now : 0;
+        next = cycles < next ? cycles : next;
+    }
+    if (stubHooks.update && hookDue != NO_EVENT)
+    {
+        uint64_t nanos = Stub_getNanos();
+        uint64_t delta = hookDue > nanos ? hookDue - nanos : 0;
+        // Far events are reached in several steps, avoiding overflow
+        if (delta > NANOS_PER_SECOND)
+        {
+            delta = NANOS_PER_SECOND;
+        }
+        cycles = (delta * CS_getMCLK() + NANOS_PER_SECOND - 1)
+                / NANOS_PER_SECOND;
+        next = cycles < next ? cycles : next;
+    }
+    return next == 0 ? 1 : next;
+}
+
+/*!
+ * Moves virtual time without looking at events.
+ *
+ * \param cycles MCLK cycles to pass
+ *
+ * \return None
+ */
+static void elapse(uint64_t cycles)
+{
+    uint32_t ratio = smclkRatio();
+
+    stubCounters.cycles += cycles;
+    stubCounters.picos += cycles * PICOS_PER_SECOND / CS_getMCLK();
+    smclkRemainder += cycles;
+    smclkTicks += smclkRemainder / ratio;
+    smclkRemainder %= ratio;
+}
+
+void Stub_advance(uint64_t cycles)
+{
+    while (cycles > 0)
+    {
+        uint64_t step;
+
+        if (!nextEventValid)
+        {
+            uint64_t next = cyclesToNextEvent();
+            nextEventAt = next == NO_EVENT ? NO_EVENT :
+                    stubCounters.cycles + next;
+            nextEventValid = true;
+        }
+        step = nextEventAt - stubCounters.cycles;
+        if (step > cycles)
+        {
+            step = cycles;
+        }
+        elapse(step);
+        cycles -= step;
+        if (stubCounters.cycles >= nextEventAt)
+        {
+            updatePeripherals();
+            rescheduled();
+            dispatch();
+        }
+    }
+}
+
+void Stub_bus(uint32_t reads, uint32_t writes)
+{
+    stubCounters.busReads += reads;
+    stubCounters.busWrites += writes;
+    Stub_advance((uint64_t) (reads + writes) * STUB_BUS_CYCLES);
+}
+
+uint64_t Stub_getNanos(void)
+{
+    return stubCounters.picos / 1000;
+}
+
+/*!
+ * Returns the interrupt lines that are asserted, enabled and have a handler.
+ *
+ * \return Bit mask by DriverLib interrupt number
+ */
+static uint64_t pendingInterrupts(void)
+{
+    uint64_t lines = 0;
+    uint64_t pending;
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (timer32[i].RIS && timer32State[i].interrupt)
+        {
+            lines |= 1ULL << (INT_T32_INT1 + i);
+        }
+    }
+    for (i = 0; i < 4; i++)
+    {
+        if ((timerA[i].CCTL[0] & (CCIFG | CCIE)) == (CCIFG | CCIE))
+        {
+            lines |= 1ULL << (INT_TA0_0 + 2 * i);
+        }
+    }
+    if (stubAdc14.IFGR0 & adcInterrupts)
+    {
+        lines |= 1ULL << INT_ADC14;
+    }
+    if (uartInterrupt && uartTxFlag)
+    {
+        lines |= 1ULL << INT_EUSCIA0;
+    }
+    if ((i2cFlags | (i2cTxFlag() ? EUSCI_B_I2C_TRANSMIT_INTERRUPT0 : 0))
+            & i2cInterrupts)
+    {
+        lines |= 1ULL << INT_EUSCIB0;
+    }
+    if (dmaDone & (1UL << dmaInt1Channel))
+    {
+        lines |= 1ULL << INT_DMA_INT1;
+    }
+
+    lines |= softPending;
+    lines &= nvicEnabled | SYSTEM_EXCEPTIONS;
+    // Only asserted lines are checked, this runs on every bus access
+    for (pending = lines; pending != 0; pending &= pending - 1)
+    {
+        i = __builtin_ctzll(pending);
+        if (stubVectors[i] == 0)
+        {
+            lines &= ~(1ULL << i);
+        }
+    }
+    return lines;
+}
+
+/*!
+ * Picks the pending line to take next, highest priority first and lowest
+ * number among equal priorities, like the NVIC.
+ *
+ * \param lines Pending lines, not 0
+ *
+ * \return Interrupt number
+ */
+static int nextInterrupt(uint64_t lines)
+{
+    int best = __builtin_ctzll(lines);
+    int i;
+
+    for (lines &= lines - 1; lines != 0; lines &= lines - 1)
+    {
+        i = __builtin_ctzll(lines);
+        if (nvicPriority[i] < nvicPriority[best])
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/*!
+ * Runs the handlers of pending interrupts that may preempt the current
+ * execution priority until none is left. A handler entered here can itself
+ * be preempted by a higher priority line asserted while it runs. Does
+ * nothing with PRIMASK set.
+ *
+ * \return None
+ */
+static void dispatch(void)
+{
+    uint64_t lines;
+
+    if (primask)
+    {
+        return;
+    }
+    while ((lines = pendingInterrupts()) != 0)
+    {
+        int irq = nextInterrupt(lines);
+        int priority = nvicPriority[irq];
+        int preempted = activePriority;
+
+        if (priority >= activePriority
+                || (basepri != 0 && priority >= (int) basepri))
+        {
+            break;
+        }
+        // Entry clears a software pend, a later pend runs the handler again
+        activePriority = priority;
+        softPending &= ~(1ULL << irq);
+        Stub_advance(STUB_ISR_ENTRY_CYCLES);
+        stubVectors[irq]();
+        Stub_advance(STUB_ISR_EXIT_CYCLES);
+        activePriority = preempted;
+        dispatched++;
+    }
+}
+
+/*!
+ * Maps a DriverLib Timer32 base address to a stub instance.
+ *
+ * \param timer TIMER32_0_BASE or TIMER32_1_BASE
+ *
+ * \return Instance index
+ */
+static int timer32Index(uint32_t timer)
+{
+    return timer == TIMER32_0_BASE ? 0 : 1;
+}
+
+/*!
+ * Maps a DriverLib Timer_A base address to a stub instance.
+ *
+ * \param timer TIMER_Ax_BASE
+ *
+ * \return Instance index
+ */
+static int timerAIndex(uint32_t timer)
+{
+    return (int) ((timer - TIMER_A0_BASE) / 0x400) & 3;
+}
+
+DWT_Type *Stub_dwt(void)
+{
+    // A store since the last access (CYCCNT = 0) rebases the counter
+    if (dwt.CYCCNT != dwtSynced)
+    {
+        dwtBase = stubCounters.cycles - dwt.CYCCNT;
+    }
+    if (dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk)
+    {
+        dwt.CYCCNT = (uint32_t) (stubCounters.cycles - dwtBase);
+    }
+    dwtSynced = dwt.CYCCNT;
+    Stub_bus(1, 0);
+    return &dwt;
+}
+
+Timer32_Type *Stub_timer32(int instance)
+{
+    Timer32_Type *timer = &timer32[instance];
+    Timer32_State *state = &timer32State[instance];
+
+    Stub_bus(1, 0);
+    if (state->running)
+    {
+        uint64_t elapsed = stubCounters.cycles - state->start;
+        if (state->periodic && timer->LOAD != 0)
+        {
+            timer->VALUE = timer->LOAD - (uint32_t) (elapsed % timer->LOAD);
+        }
+        else
+        {
+            timer->VALUE = 0xFFFFFFFF - (uint32_t) elapsed;
+        }
+    }
+    return timer;
+}
+
+Timer_A_Type *Stub_timerA(int instance)
+{
+    Stub_bus(1, 0);
+    return Stub_timerARegs(instance);
+}
+
+Timer_A_Type *Stub_timerARegs(int instance)
+{
+    Timer_A_Type *timer = &timerA[instance];
+    TimerA_State *state = &timerAState[instance];
+
+    if (state->running)
+    {
+        timer->R = (uint16_t) ((smclkTicks - state->start)
+                % ((uint64_t) timer->CCR[0] + 1));
+    }
+    return timer;
+}
+
+//*****************************************************************************
+//
+// CMSIS core
+//
+//*****************************************************************************
+
+uint32_t __get_PRIMASK(void)
+{
+    return primask;
+}
+
+void __set_PRIMASK(uint32_t value)
+{
+    primask = value & 1;
+    dispatch();
+}
+
+void __disable_irq(void)
+{
+    primask = 1;
+}
+
+void __enable_irq(void)
+{
+    primask = 0;
+    dispatch();
+}
+
+uint32_t __get_BASEPRI(void)
+{
+    return basepri;
+}
+
+void __set_BASEPRI(uint32_t basePri)
+{
+    basepri = basePri & 0xFF;
+    dispatch();
+}
+
+uint32_t __get_MSP(void)
+{
+    return 0;
+}
+
+void __set_PSP(uint32_t topOfProcStack)
+{
+}
+
+uint32_t __get_CONTROL(void)
+{
+    return control;
+}
+
+void __set_CONTROL(uint32_t value)
+{
+    control = value;
+}
+
+//*****************************************************************************
+//
+// GPIO
+//
+//*****************************************************************************
+
+void Stub_portWritten(uint_fast8_t port)
+{
+    if (stubHooks.portWrite)
+    {
+        stubHooks.portWrite(port, stubPorts[port].OUT, stubCounters.picos);
+    }
+}
+
+void GPIO_setAsOutputPin(uint_fast8_t port, uint_fast16_t pins)
+{
+    Stub_bus(3, 3);
+    stubPorts[port].SEL0 &= ~pins;
+    stubPorts[port].SEL1 &= ~pins;
+    stubPorts[port].DIR |= pins;
+}
+
+void GPIO_setAsInputPinWithPullUpResistor(uint_fast8_t port,
+                                          uint_fast16_t pins)
+{
+    Stub_bus(5, 5);
+    stubPorts[port].SEL0 &= ~pins;
+    stubPorts[port].SEL1 &= ~pins;
+    stubPorts[port].DIR &= ~pins;
+    stubPorts[port].REN |= pins;
+    stubPorts[port].OUT |= pins;
+    // Nothing drives the pin yet, the pull-up reads high
+    stubPorts[port].IN |= pins;
+}
+
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint_fast8_t port,
+                                                uint_fast16_t pins,
+                                                uint_fast8_t mode)
+{
+    Stub_bus(3, 3);
+    stubPorts[port].DIR &= ~pins;
+    if (mode & GPIO_PRIMARY_MODULE_FUNCTION)
+    {
+        stubPorts[port].SEL0 |= pins;
+    }
+    if (mode & GPIO_SECONDARY_MODULE_FUNCTION)
+    {
+        stubPorts[port].SEL1 |= pins;
+    }
+}
+
+void GPIO_setOutputHighOnPin(uint_fast8_t port, uint_fast16_t pins)
+{
+    Stub_bus(1, 1);
+    stubPorts[port].OUT |= pins;
+    Stub_portWritten(port);
+}
+
+void GPIO_setOutputLowOnPin(uint_fast8_t port, uint_fast16_t pins)
+{
+    Stub_bus(1, 1);
+    stubPorts[port].OUT &= ~pins;
+    Stub_portWritten(port);
+}
+
+uint8_t GPIO_getInputPinValue(uint_fast8_t port, uint_fast16_t pins)
+{
+    Stub_bus(1, 0);
+    return (stubPorts[port].IN & pins) ? GPIO_INPUT_PIN_HIGH :
+                                         GPIO_INPUT_PIN_LOW;
+}
+
+void GPIO_enableInterrupt(uint_fast8_t port, uint_fast16_t pins)
+{
+    Stub_bus(1, 1);
+}
+
+void GPIO_clearInterruptFlag(uint_fast8_t port, uint_fast16_t pins)
+{
+    Stub_bus(1, 1);
+}
+
+uint_fast16_t GPIO_getEnabledInterruptStatus(uint_fast8_t port)
+{
+    Stub_bus(2, 0);
+    return 0;
+}
+
+//*****************************************************************************
+//
+// Clock system, power control, flash controller, watchdog, FPU
+//
+//*****************************************************************************
+
+void CS_setDCOCenteredFrequency(uint32_t dcoFreq)
+{
+    // Unlock, modify CSCTL0, lock
+    Stub_bus(1, 3);
+    if (dcoFreq < sizeof(dcoFrequencies) / sizeof(dcoFrequencies[0]))
+    {
+        dco = dcoFrequencies[dcoFreq];
+    }
+    rescheduled();
+}
+
+void CS_initClockSignal(uint32_t selectedClockSignal, uint32_t clockSource,
+                        uint32_t clockSourceDivider)
+{
+    // Unlock, modify CSCTL1, lock, wait for the clock to be ready
+    Stub_bus(2, 3);
+    if (selectedClockSignal == CS_MCLK)
+    {
+        mclkDivider = clockSourceDivider;
+    }
+    else if (selectedClockSignal == CS_SMCLK)
+    {
+        smclkDivider = clockSourceDivider;
+    }
+    rescheduled();
+}
+
+uint32_t CS_getMCLK(void)
+{
+    return dco >> mclkDivider;
+}
+
+uint32_t CS_getSMCLK(void)
+{
+    return dco >> smclkDivider;
+}
+
+bool PCM_setCoreVoltageLevel(uint_fast8_t voltageLevel)
+{
+    // Key write, mode request, busy polling
+    Stub_bus(3, 1);
+    return true;
+}
+
+bool PCM_gotoLPM0(void)
+{
+    uint64_t handled = dispatched;
+
+    Stub_bus(1, 1);
+    // WFI wakes on any enabled interrupt, even with PRIMASK set
+    while (pendingInterrupts() == 0 && dispatched == handled)
+    {
+        uint64_t next = cyclesToNextEvent();
+        if (next == NO_EVENT)
+        {
+            // Nothing can wake the core
+            break;
+        }
+        Stub_advance(next);
+    }
+    return true;
+}
+
+bool FlashCtl_setWaitState(uint32_t bank, uint32_t waitState)
+{
+    Stub_bus(1, 1);
+    return true;
+}
+
+void FlashCtl_enableReadBuffering(uint_fast8_t memoryBank,
+                                  uint_fast8_t accessMethod)
+{
+    Stub_bus(1, 1);
+}
+
+void FlashCtl_disableReadBuffering(uint_fast8_t memoryBank,
+                                   uint_fast8_t accessMethod)
+{
+    Stub_bus(1, 1);
+}
+
+void WDT_A_holdTimer(void)
+{
+    Stub_bus(1, 1);
+}
+
+void FPU_enableModule(void)
+{
+    Stub_bus(1, 1);
+}
+
+void FPU_enableLazyStacking(void)
+{
+    Stub_bus(1, 1);
+}
+
+//*****************************************************************************
+//
+// Interrupt controller
+//
+//*****************************************************************************
+
+void Interrupt_enableInterrupt(uint32_t interruptNumber)
+{
+    Stub_bus(0, 1);
+    nvicEnabled |= 1ULL << interruptNumber;
+    dispatch();
+}
+
+void Interrupt_disableInterrupt(uint32_t interruptNumber)
+{
+    Stub_bus(0, 1);
+    nvicEnabled &= ~(1ULL << interruptNumber);
+}
+
+bool Interrupt_enableMaster(void)
+{
+    bool wasMasked = primask != 0;
+    primask = 0;
+    dispatch();
+    return wasMasked;
+}
+
+bool Interrupt_disableMaster(void)
+{
+    bool wasMasked = primask != 0;
+    primask = 1;
+    return wasMasked;
+}
+
+void Interrupt_setPriority(uint32_t interruptNumber, uint8_t priority)
+{
+    // Byte access to NVIC_IPRn or SCB_SHPRn
+    Stub_bus(0, 1);
+    nvicPriority[interruptNumber] = priority;
+}
+
+void Interrupt_pendInterrupt(uint32_t interruptNumber)
+{
+    // ICSR.PENDSVSET or NVIC_ISPRn
+    Stub_bus(0, 1);
+    softPending |= 1ULL << interruptNumber;
+    dispatch();
+}
+
+//*****************************************************************************
+//
+// MPU
+//
+//*****************************************************************************
+
+void MPU_enableModule(uint32_t mpuConfig)
+{
+    Stub_bus(0, 1);
+}
+
+void MPU_setRegion(uint32_t region, uint32_t addr, uint32_t flags)
+{
+    // RNR, RBAR, RASR
+    Stub_bus(0, 3);
+}
+
+void MPU_enableInterrupt(void)
+{
+    // SHCSR.MEMFAULTENA
+    Stub_bus(1, 1);
+}
+
+//*****************************************************************************
+//
+// ADC14, a trigger converts ADC_MEMstart to ADC_MEMend one after the other
+//
+//*****************************************************************************
+
+bool ADC14_enableModule(void)
+{
+    Stub_bus(1, 1);
+    return true;
+}
+
+bool ADC14_initModule(uint32_t clockSource, uint32_t clockPredivider,
+                      uint32_t clockDivider, uint32_t internalChannelMask)
+{
+    Stub_bus(2, 2);
+    adcClockDivide = predividers[(clockPredivider >> 30) & 3]
+            * (((clockDivider >> 22) & 7) + 1);
+    rescheduled();
+    return true;
+}
+
+bool ADC14_configureMultiSequenceMode(uint32_t memoryStart,
+                                      uint32_t memoryEnd, bool repeatMode)
+{
+    Stub_bus(2, 2);
+    adcStart = memoryStart & 31;
+    adcEnd = memoryEnd & 31;
+    adcRepeat = repeatMode;
+    adcNext = adcStart;
+    return true;
+}
+
+bool ADC14_configureConversionMemory(uint32_t memorySelect,
+                                     uint32_t refSelect,
+                                     uint32_t channelSelect,
+                                     bool differntialMode)
+{
+    Stub_bus(1, 1);
+    stubAdc14.MCTL[memorySelect & 31] = channelSelect | refSelect;
+    return true;
+}
+
+bool ADC14_setSampleHoldTime(uint32_t firstPulseWidth,
+                             uint32_t secondPulseWidth)
+{
+    Stub_bus(1, 1);
+    adcPulse = pulseCycles[firstPulseWidth & 7];
+    rescheduled();
+    return true;
+}
+
+bool ADC14_enableSampleTimer(uint32_t multiSampleConvert)
+{
+    Stub_bus(1, 1);
+    adcAutomatic = (multiSampleConvert == ADC_AUTOMATIC_ITERATION);
+    return true;
+}
+
+bool ADC14_setSampleHoldTrigger(uint32_t source, bool invertSignal)
+{
+    // SHS 1, 3, 5 and 7 are the CCR1 outputs of TA0 to TA3
+    static const int8_t timers[] = { -1, 0, -1, 1, -1, 2, -1, 3 };
+
+    Stub_bus(1, 1);
+    adcTriggerTimer = timers[(source >> 27) & 7];
+    return true;
+}
+
+bool ADC14_enableConversion(void)
+{
+    Stub_bus(1, 1);
+    // Enabling restarts the sequence
+    adcEnabledConversion = true;
+    adcNext = adcStart;
+    return true;
+}
+
+void ADC14_disableConversion(void)
+{
+    Stub_bus(1, 1);
+    adcEnabledConversion = false;
+    rescheduled();
+}
+
+bool ADC14_toggleConversionTrigger(void)
+{
+    Stub_bus(1, 1);
+    if (adcTriggerTimer < 0)
+    {
+        startConversion();
+    }
+    return true;
+}
+
+void ADC14_enableInterrupt(uint_fast64_t mask)
+{
+    Stub_bus(1, 1);
+    adcInterrupts |= mask;
+}
+
+uint_fast64_t ADC14_getEnabledInterruptStatus(void)
+{
+    Stub_bus(2, 0);
+    return stubAdc14.IFGR0 & adcInterrupts;
+}
+
+void ADC14_clearInterruptFlag(uint_fast64_t mask)
+{
+    Stub_bus(0, 1);
+    stubAdc14.IFGR0 &= ~mask;
+}
+
+void Stub_adcResultRead(uint32_t memory)
+{
+    stubAdc14.IFGR0 &= ~(1UL << (memory & 31));
+}
+
+uint_fast16_t ADC14_getResult(uint32_t memorySelect)
+{
+    Stub_bus(1, 0);
+    // Reading the result clears its flag
+    Stub_adcResultRead(memorySelect);
+    return stubAdc14.MEM[memorySelect & 31];
+}
+
+//*****************************************************************************
+//
+// Timer32, counts MCLK cycles of virtual time
+//
+//*****************************************************************************
+
+void Timer32_initModule(uint32_t timer, uint32_t preScaler,
+                        uint32_t resolution, uint32_t mode)
+{
+    Stub_bus(1, 1);
+    timer32State[timer32Index(timer)].periodic =
+            (mode == TIMER32_PERIODIC_MODE);
+    rescheduled();
+}
+
+void Timer32_setCount(uint32_t timer, uint32_t count)
+{
+    int i = timer32Index(timer);
+
+    Stub_bus(0, 1);
+    // Writing LOAD restarts the count from the new value
+    timer32[i].LOAD = count;
+    timer32State[i].start = stubCounters.cycles;
+    timer32State[i].fired = 0;
+    rescheduled();
+}
+
+uint32_t Timer32_getValue(uint32_t timer)
+{
+    return Stub_timer32(timer32Index(timer))->VALUE;
+}
+
+void Timer32_startTimer(uint32_t timer, bool oneShot)
+{
+    int i = timer32Index(timer);
+
+    Stub_bus(1, 1);
+    timer32State[i].start = stubCounters.cycles;
+    timer32State[i].fired = 0;
+    timer32State[i].running = true;
+    rescheduled();
+}
+
+void Timer32_enableInterrupt(uint32_t timer)
+{
+    Stub_bus(1, 1);
+    timer32State[timer32Index(timer)].interrupt = true;
+    dispatch();
+}
+
+void Timer32_clearInterruptFlag(uint32_t timer)
+{
+    Stub_bus(0, 1);
+    timer32[timer32Index(timer)].RIS = 0;
+}
+
+//*****************************************************************************
+//
+// Timer_A, counts SMCLK periods of virtual time in up mode
+//
+//*****************************************************************************
+
+void Timer_A_configureUpMode(uint32_t timer,
+                             const Timer_A_UpModeConfig *config)
+{
+    int i = timerAIndex(timer);
+
+    Stub_bus(3, 4);
+    timerA[i].CCR[0] = config->timerPeriod;
+    timerA[i].CCTL[0] = config->captureCompareInterruptEnable_CCR0_CCIE;
+    rescheduled();
+}
+
+void Timer_A_initCompare(uint32_t timer,
+                         const Timer_A_CompareModeConfig *config)
+{
+    int i = timerAIndex(timer);
+    int ccr = (config->compareRegister - TIMER_A_CAPTURECOMPARE_REGISTER_0) / 2;
+
+    Stub_bus(1, 2);
+    timerA[i].CCTL[ccr] = config->compareInterruptEnable
+            | config->compareOutputMode;
+    timerA[i].CCR[ccr] = config->compareValue;
+}
+
+void Timer_A_startCounter(uint32_t timer, uint_fast16_t timerMode)
+{
+    int i = timerAIndex(timer);
+
+    Stub_bus(1, 1);
+    timerA[i].CTL = (timerA[i].CTL & ~MC_MASK) | timerMode;
+    timerAState[i].start = smclkTicks;
+    timerAState[i].fired = 0;
+    timerAState[i].edges = 0;
+    timerAState[i].period = timerA[i].CCR[0];
+    timerAState[i].running = true;
+    rescheduled();
+}
+
+void Timer_A_stopTimer(uint32_t timer)
+{
+    Stub_bus(1, 1);
+    timerA[timerAIndex(timer)].CTL &= ~MC_MASK;
+    timerAState[timerAIndex(timer)].running = false;
+    rescheduled();
+}
+
+void Timer_A_clearTimer(uint32_t timer)
+{
+    int i = timerAIndex(timer);
+
+    Stub_bus(1, 1);
+    timerAState[i].start = smclkTicks;
+    timerAState[i].fired = 0;
+    timerAState[i].edges = 0;
+    rescheduled();
+}
+
+void Timer_A_setCompareValue(uint32_t timer, uint_fast16_t compareRegister,
+                             uint_fast16_t compareValue)
+{
+    int i = timerAIndex(timer);
+    int ccr = (compareRegister - TIMER_A_CAPTURECOMPARE_REGISTER_0) / 2;
+
+    Stub_bus(0, 1);
+    timerA[i].CCR[ccr] = compareValue;
+    // Period changes count from here, the stub keeps no phase
+    if (ccr == 0)
+    {
+        timerAState[i].start = smclkTicks;
+        timerAState[i].fired = 0;
+        timerAState[i].edges = 0;
+        timerAState[i].period = compareValue;
+    }
+    rescheduled();
+}
+
+void Stub_timerAWritten(int instance)
+{
+    Timer_A_Type *timer = &timerA[instance & 3];
+    TimerA_State *state = &timerAState[instance & 3];
+    bool running = (timer->CTL & MC_MASK) != 0;
+
+    // TACLR reads back as zero
+    if ((timer->CTL & TACLR) || running != state->running
+            || timer->CCR[0] != state->period)
+    {
+        timer->CTL &= ~TACLR;
+        state->start = smclkTicks;
+        state->fired = 0;
+        state->edges = 0;
+        state->period = timer->CCR[0];
+    }
+    state->running = running;
+    rescheduled();
+}
+
+void Timer_A_clearCaptureCompareInterrupt(uint32_t timer,
+                                          uint_fast16_t captureCompareRegister)
+{
+    int ccr = (captureCompareRegister - TIMER_A_CAPTURECOMPARE_REGISTER_0) / 2;
+
+    Stub_bus(1, 1);
+    timerA[timerAIndex(timer)].CCTL[ccr] &= ~CCIFG;
+}
+
+//*****************************************************************************
+//
+// eUSCI_A UART, each byte holds the transmitter for ten bit times
+//
+//*****************************************************************************
+
+bool UART_initModule(uint32_t moduleInstance,
+                     const eUSCI_UART_ConfigV1 *config)
+{
+    Stub_bus(4, 6);
+    if (config->overSampling == EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION)
+    {
+        uartBitTicks = 16 * config->clockPrescalar + config->firstModReg;
+    }
+    else
+    {
+        uartBitTicks = config->clockPrescalar;
+    }
+    if (uartBitTicks == 0)
+    {
+        uartBitTicks = 1;
+    }
+    rescheduled();
+    return true;
+}
+
+void UART_enableModule(uint32_t moduleInstance)
+{
+    Stub_bus(1, 1);
+}
+
+uint_fast8_t UART_queryStatusFlags(uint32_t moduleInstance, uint_fast8_t mask)
+{
+    Stub_bus(1, 0);
+    return (uartBusy || !uartTxFlag) ? (mask & EUSCI_A_UART_BUSY) : 0;
+}
+
+void UART_enableInterrupt(uint32_t moduleInstance, uint_fast8_t mask)
+{
+    Stub_bus(2, 2);
+    if (mask & EUSCI_A_UART_TRANSMIT_INTERRUPT)
+    {
+        uartInterrupt = true;
+    }
+    dispatch();
+}
+
+void UART_disableInterrupt(uint32_t moduleInstance, uint_fast8_t mask)
+{
+    Stub_bus(1, 1);
+    if (mask & EUSCI_A_UART_TRANSMIT_INTERRUPT)
+    {
+        uartInterrupt = false;
+    }
+}
+
+void UART_transmitData(uint32_t moduleInstance, uint_fast8_t transmitData)
+{
+    Stub_bus(1, 1);
+    // The buffer empties into the shift register once the line is free
+    uartByte = transmitData;
+    uartBusy = true;
+    uartTxFlag = false;
+    uartDoneAt = stubCounters.cycles
+            + (uint64_t) 10 * uartBitTicks * smclkRatio();
+    rescheduled();
+}
+
+//*****************************************************************************
+//
+// eUSCI_B I2C master, the target answers through the i2c hooks
+//
+//*****************************************************************************
+
+void I2C_initMaster(uint32_t moduleInstance,
+                    const eUSCI_I2C_MasterConfig *config)
+{
+    Stub_bus(4, 6);
+    // DriverLib truncates the divider
+    i2cBitTicks = config->i2cClk / config->dataRate;
+    if (i2cBitTicks == 0)
+    {
+        i2cBitTicks = 1;
+    }
+    i2cPhase = I2C_IDLE;
+    i2cStartPending = false;
+    i2cStopPending = false;
+    i2cTxFull = false;
+    i2cRxFull = false;
+    i2cFlags = 0;
+    i2cInterrupts = 0;
+    rescheduled();
+}
+
+void I2C_enableModule(uint32_t moduleInstance)
+{
+    Stub_bus(1, 1);
+}
+
+void I2C_setSlaveAddress(uint32_t moduleInstance, uint_fast16_t slaveAddress)
+{
+    Stub_bus(0, 1);
+    i2cAddress = (uint8_t) slaveAddress;
+}
+
+void I2C_setMode(uint32_t moduleInstance, uint_fast8_t mode)
+{
+    Stub_bus(1, 1);
+    i2cTransmit = (mode & EUSCI_B_I2C_TRANSMIT_MODE) != 0;
+    i2cUpdate();
+    dispatch();
+}
+
+void I2C_masterSendStart(uint32_t moduleInstance)
+{
+    Stub_bus(1, 1);
+    i2cStartPending = true;
+    i2cUpdate();
+    dispatch();
+}
+
+uint_fast8_t I2C_masterIsStartSent(uint32_t moduleInstance)
+{
+    Stub_bus(1, 0);
+    return i2cStartPending ? EUSCI_B_I2C_SENDING_START :
+                             EUSCI_B_I2C_START_SEND_COMPLETE;
+}
+
+void I2C_masterSendMultiByteStop(uint32_t moduleInstance)
+{
+    Stub_bus(2, 1);
+    i2cStopPending = true;
+    i2cUpdate();
+}
+
+void I2C_masterReceiveMultiByteStop(uint32_t moduleInstance)
+{
+    Stub_bus(1, 1);
+    i2cStopPending = true;
+    i2cUpdate();
+}
+
+uint8_t I2C_masterReceiveMultiByteNext(uint32_t moduleInstance)
+{
+    uint8_t byte = i2cRxBuffer;
+
+    Stub_bus(1, 0);
+    i2cRxFull = false;
+    i2cFlags &= ~EUSCI_B_I2C_RECEIVE_INTERRUPT0;
+    i2cUpdate();
+    return byte;
+}
+
+uint32_t I2C_getReceiveBufferAddressForDMA(uint32_t moduleInstance)
+{
+    return I2C_RXBUF_ADDRESS;
+}
+
+uint32_t I2C_getTransmitBufferAddressForDMA(uint32_t moduleInstance)
+{
+    return I2C_TXBUF_ADDRESS;
+}
+
+void I2C_enableInterrupt(uint32_t moduleInstance, uint_fast16_t mask)
+{
+    Stub_bus(1, 1);
+    i2cInterrupts |= mask;
+    dispatch();
+}
+
+void I2C_disableInterrupt(uint32_t moduleInstance, uint_fast16_t mask)
+{
+    Stub_bus(1, 1);
+    i2cInterrupts &= ~mask;
+}
+
+void I2C_clearInterruptFlag(uint32_t moduleInstance, uint_fast16_t mask)
+{
+    Stub_bus(1, 1);
+    i2cFlags &= ~mask;
+}
+
+uint_fast16_t I2C_getEnabledInterruptStatus(uint32_t moduleInstance)
+{
+    Stub_bus(2, 0);
+    return (i2cFlags | (i2cTxFlag() ? EUSCI_B_I2C_TRANSMIT_INTERRUPT0 : 0))
+            & i2cInterrupts;
+}
+
+//*****************************************************************************
+//
+// DMA
+//
+//*****************************************************************************
+
+void DMA_enableModule(void)
+{
+    Stub_bus(0, 1);
+}
+
+void DMA_setControlBase(void *controlTable)
+{
+    Stub_bus(0, 1);
+}
+
+void DMA_assignChannel(uint32_t mapping)
+{
+    Stub_bus(1, 1);
+    dma[mapping & (DMA_CHANNELS - 1)].mapping = mapping;
+}
+
+void DMA_setChannelControl(uint32_t channelStructIndex, uint32_t control)
+{
+    Dma_Channel *channel = &dma[channelStructIndex & (DMA_CHANNELS - 1)];
+
+    Stub_bus(1, 1);
+    channel->sourceIncrement = (control & UDMA_SRC_INC_NONE)
+            != UDMA_SRC_INC_NONE;
+    channel->destinationIncrement = (control & UDMA_DST_INC_NONE)
+            != UDMA_DST_INC_NONE;
+}
+
+void DMA_setChannelTransfer(uint32_t channelStructIndex, uint32_t mode,
+                            void *srcAddr, void *dstAddr,
+                            uint32_t transferSize)
+{
+    Dma_Channel *channel = &dma[channelStructIndex & (DMA_CHANNELS - 1)];
+
+    Stub_bus(1, 3);
+    channel->source = srcAddr;
+    channel->destination = dstAddr;
+    channel->remaining = transferSize;
+}
+
+void DMA_enableChannel(uint32_t channelNum)
+{
+    Stub_bus(0, 1);
+    dma[channelNum].enabled = dma[channelNum].remaining != 0;
+    i2cUpdate();
+    dispatch();
+}
+
+void DMA_disableChannel(uint32_t channelNum)
+{
+    Stub_bus(0, 1);
+    dma[channelNum].enabled = false;
+}
+
+void DMA_assignInterrupt(uint32_t interruptNumber, uint32_t channel)
+{
+    Stub_bus(1, 1);
+    dmaInt1Channel = channel;
+}
+
+void DMA_enableInterrupt(uint32_t interruptNumber)
+{
+    Interrupt_enableInterrupt(interruptNumber);
+}
+
+void DMA_clearInterruptFlag(uint32_t intChannel)
+{
+    Stub_bus(0, 1);
+    dmaDone &= ~(1UL << intChannel);
+}
+
+//*****************************************************************************
+//
+// SysTick, a delay takes LOAD + 1 cycles of virtual time
+//
+//*****************************************************************************
+
+void SysTick_enableModule(void)
+{
+    Stub_bus(1, 1);
+    Stub_advance((uint64_t) stubSysTick.LOAD + 1);
+    stubSysTick.CTRL |= SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_COUNTFLAG_Msk;
+}
+
+void SysTick_disableModule(void)
+{
+    Stub_bus(1, 1);
+    stubSysTick.CTRL = 0;
+}
@@ -0,0 +1,56 @@
+/*!
+ * dsp_bench.c
+ *      Description: Host run of the DSP kernel benchmark. The host has no
+ *                   DSP extension, so this runs the portable kernels: it
+ *                   checks their output against the scalar versions bit for
+ *                   bit and reports host cycles. The target numbers come from
+ *                   a build with DSP_BENCH_ENABLE set to 1.
+ *
+ *                   Usage: dsp_bench
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../dspbench.h"
+
+/*!
+ * Returns a host timestamp, TSC cycles where available.
+ *
+ * \return Host cycles or nanoseconds, low 32 bits
+ */
+static uint32_t hostCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t) __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t) (now.tv_sec * 1000000000ULL + now.tv_nsec);
+#endif
+}
+
+/*!
+ * Prints one report line.
+ *
+ * \param line Text without newline
+ *
+ * \return None
+ */
+static void writeLine(const char *line)
+{
+    puts(line);
+}
+
+int main(void)
+{
+    return DspBench_run(hostCycles, writeLine) ? 0 : 1;
+}
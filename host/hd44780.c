@@ -0,0 +1,331 @@
+/*!
+ * hd44780.c
+ *      Description: Helper file for the behavioral HD44780 model. Timing is
+ *                   from the HD44780U data sheet at VCC = 2.7 to 4.5 V and
+ *                   fosc = 270 kHz. A transfer that arrives while the
+ *                   controller is busy is reported and then executed anyway,
+ *                   so one violation does not garble everything after it.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <string.h>
+
+#include "hd44780.h"
+
+#define NS                  1000ULL
+#define US                  (1000 * NS)
+#define MS                  (1000 * US)
+
+/* Bus timing */
+#define T_CYCLE_E           (1000 * NS)
+#define PW_EH               (450 * NS)
+#define T_AS                (60 * NS)
+#define T_DSW               (195 * NS)
+
+/* Execution times */
+#define T_POWER_ON          (40 * MS)
+#define T_RESET_FIRST       (4100 * US)
+#define T_RESET_SECOND      (100 * US)
+#define T_CLEAR_HOME        (1520 * US)
+#define T_INSTRUCTION       (37 * US)
+#define T_DATA              (41 * US)
+
+#define LINE2_ADDRESS       0x40
+
+static const char * const violationNames[HD44780_NUM_VIOLATIONS] = {
+    "busy", "pulse width", "cycle time", "data setup", "rs setup" };
+
+/*!
+ * Counts a violation and keeps the first HD44780_MAX_REPORTS of them.
+ *
+ * \param lcd Model
+ * \param type Violation type
+ * \param picos Time of the offending edge
+ * \param value Value being transferred
+ *
+ * \return None
+ */
+static void violation(Hd44780 *lcd, Hd44780_ViolationType type,
+                      uint64_t picos, uint8_t value)
+{
+    lcd->violationCounts[type]++;
+    if (lcd->numReports < HD44780_MAX_REPORTS)
+    {
+        Hd44780_Violation *report = &lcd->reports[lcd->numReports++];
+        report->type = type;
+        report->picos = picos;
+        report->value = value;
+        report->rs = lcd->rs;
+    }
+}
+
+/*!
+ * Moves the address counter one position, wrapping between the lines the
+ * way the controller does in 2-line mode.
+ *
+ * \param lcd Model
+ * \param increment Direction
+ *
+ * \return None
+ */
+static void moveAddress(Hd44780 *lcd, bool increment)
+{
+    uint8_t address = lcd->address;
+
+    if (increment)
+    {
+        address++;
+        if (address == HD44780_LINE_LENGTH)
+        {
+            address = LINE2_ADDRESS;
+        }
+        else if (address == LINE2_ADDRESS + HD44780_LINE_LENGTH)
+        {
+            address = 0;
+        }
+    }
+    else
+    {
+        if (address == 0)
+        {
+            address = LINE2_ADDRESS + HD44780_LINE_LENGTH - 1;
+        }
+        else if (address == LINE2_ADDRESS)
+        {
+            address = HD44780_LINE_LENGTH - 1;
+        }
+        else
+        {
+            address--;
+        }
+    }
+    lcd->address = address;
+}
+
+/*!
+ * Shifts the display window one position.
+ *
+ * \param lcd Model
+ * \param right Whether the text moves right
+ *
+ * \return None
+ */
+static void shiftDisplay(Hd44780 *lcd, bool right)
+{
+    lcd->shift = (lcd->shift + (right ? HD44780_LINE_LENGTH - 1 : 1))
+            % HD44780_LINE_LENGTH;
+}
+
+/*!
+ * Executes a complete instruction or data write.
+ *
+ * \param lcd Model
+ * \param rs Register select, true for data
+ * \param value Instruction or data
+ * \param picos Time the transfer completed
+ *
+ * \return None
+ */
+static void execute(Hd44780 *lcd, bool rs, uint8_t value, uint64_t picos)
+{
+    uint64_t duration = T_INSTRUCTION;
+
+    if (rs)
+    {
+        if (!lcd->cgram)
+        {
+            int line = lcd->address >= LINE2_ADDRESS;
+            int column = (lcd->address & (LINE2_ADDRESS - 1))
+                    % HD44780_LINE_LENGTH;
+            lcd->ddram[line][column] = value;
+            if (lcd->shiftOnWrite)
+            {
+                shiftDisplay(lcd, !lcd->increment);
+            }
+        }
+        moveAddress(lcd, lcd->increment);
+        lcd->dataWrites++;
+        duration = T_DATA;
+    }
+    else if (value & 0x80)
+    {
+        lcd->cgram = false;
+        lcd->address = value & 0x7F;
+    }
+    else if (value & 0x40)
+    {
+        lcd->cgram = true;
+    }
+    else if (value & 0x20)
+    {
+        bool eightBit = (value & 0x10) != 0;
+        // Only the first three 8-bit function sets have reset timing
+        if (!lcd->fourBit && lcd->resetFunctionSets < 3)
+        {
+            lcd->resetFunctionSets++;
+            if (lcd->resetFunctionSets == 1)
+            {
+                duration = T_RESET_FIRST;
+            }
+            else if (lcd->resetFunctionSets == 2)
+            {
+                duration = T_RESET_SECOND;
+            }
+        }
+        lcd->fourBit = !eightBit;
+        lcd->lowNibble = false;
+        lcd->twoLines = (value & 0x08) != 0;
+    }
+    else if (value & 0x10)
+    {
+        bool right = (value & 0x04) != 0;
+        if (value & 0x08)
+        {
+            shiftDisplay(lcd, right);
+        }
+        else
+        {
+            moveAddress(lcd, right);
+        }
+    }
+    else if (value & 0x08)
+    {
+        lcd->displayOn = (value & 0x04) != 0;
+    }
+    else if (value & 0x04)
+    {
+        lcd->increment = (value & 0x02) != 0;
+        lcd->shiftOnWrite = (value & 0x01) != 0;
+    }
+    else if (value & 0x02)
+    {
+        lcd->address = 0;
+        lcd->cgram = false;
+        lcd->shift = 0;
+        duration = T_CLEAR_HOME;
+    }
+    else if (value & 0x01)
+    {
+        memset(lcd->ddram, ' ', sizeof(lcd->ddram));
+        lcd->address = 0;
+        lcd->cgram = false;
+        lcd->shift = 0;
+        lcd->increment = true;
+        duration = T_CLEAR_HOME;
+    }
+
+    if (!rs)
+    {
+        lcd->instructions++;
+    }
+    lcd->busyUntil = picos + duration;
+    if (lcd->onTransfer)
+    {
+        lcd->onTransfer(rs, value, picos);
+    }
+}
+
+void Hd44780_init(Hd44780 *lcd, uint64_t picos)
+{
+    void (*onTransfer)(bool rs, uint8_t value, uint64_t picos) =
+            lcd->onTransfer;
+
+    memset(lcd, 0, sizeof(*lcd));
+    memset(lcd->ddram, ' ', sizeof(lcd->ddram));
+    lcd->onTransfer = onTransfer;
+    lcd->increment = true;
+    lcd->busyUntil = picos + T_POWER_ON;
+}
+
+void Hd44780_pins(Hd44780 *lcd, bool rs, bool e, uint8_t data,
+                  uint64_t picos)
+{
+    data &= 0xF0;
+    if (rs != lcd->rs)
+    {
+        lcd->rs = rs;
+        lcd->rsChanged = picos;
+        if (lcd->e)
+        {
+            violation(lcd, HD44780_RS_SETUP, picos, data);
+        }
+    }
+    if (data != lcd->data)
+    {
+        lcd->data = data;
+        lcd->dataChanged = picos;
+    }
+    if (e == lcd->e)
+    {
+        return;
+    }
+    lcd->e = e;
+
+    if (e)
+    {
+        if (lcd->lastRise != 0 && picos - lcd->lastRise < T_CYCLE_E)
+        {
+            violation(lcd, HD44780_CYCLE_TIME, picos, data);
+        }
+        if (picos - lcd->rsChanged < T_AS)
+        {
+            violation(lcd, HD44780_RS_SETUP, picos, data);
+        }
+        lcd->eRose = picos;
+        lcd->lastRise = picos;
+        return;
+    }
+
+    // Falling edge latches the bus
+    if (picos - lcd->eRose < PW_EH)
+    {
+        violation(lcd, HD44780_PULSE_WIDTH, picos, data);
+    }
+    if (picos - lcd->dataChanged < T_DSW)
+    {
+        violation(lcd, HD44780_DATA_SETUP, picos, data);
+    }
+    if (!lcd->lowNibble && picos < lcd->busyUntil)
+    {
+        violation(lcd, HD44780_BUSY, picos, data);
+    }
+
+    if (!lcd->fourBit)
+    {
+        // DB0-3 are not connected and read low
+        execute(lcd, rs, data, picos);
+    }
+    else if (!lcd->lowNibble)
+    {
+        lcd->highNibble = data;
+        lcd->lowNibble = true;
+    }
+    else
+    {
+        lcd->lowNibble = false;
+        execute(lcd, rs, lcd->highNibble | (data >> 4), picos);
+    }
+}
+
+void Hd44780_getLine(const Hd44780 *lcd, int line, char *text)
+{
+    int column;
+
+    for (column = 0; column < HD44780_COLUMNS; column++)
+    {
+        uint8_t c = lcd->ddram[line][(column + lcd->shift)
+                % HD44780_LINE_LENGTH];
+        if (!lcd->displayOn)
+        {
+            c = ' ';
+        }
+        text[column] = (c >= 0x20 && c < 0x7F) ? (char) c : '?';
+    }
+    text[HD44780_COLUMNS] = 0;
+}
+
+const char *Hd44780_violationName(Hd44780_ViolationType type)
+{
+    return type < HD44780_NUM_VIOLATIONS ? violationNames[type] : "?";
+}
@@ -0,0 +1,145 @@
+/*!
+ * hd44780.h
+ *      Description: Header file for the behavioral HD44780 model used by the
+ *                   host simulator. The model watches the RS, E and DB4-7
+ *                   pins, decodes 8-bit and 4-bit transfers on each falling
+ *                   edge of E, keeps DDRAM, the address counter and the
+ *                   display shift, and checks the bus against the data sheet
+ *                   timing at 2.7 V, the worst case the driver is written for.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef HD44780_H_
+#define HD44780_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HD44780_COLUMNS         16
+#define HD44780_LINES           2
+#define HD44780_LINE_LENGTH     40
+#define HD44780_MAX_REPORTS     16
+
+typedef enum
+{
+    HD44780_BUSY,           /* transfer before the last instruction finished */
+    HD44780_PULSE_WIDTH,    /* E high shorter than PW_EH */
+    HD44780_CYCLE_TIME,     /* E rising edges closer than t_cycE */
+    HD44780_DATA_SETUP,     /* DB changed less than t_DSW before E fell */
+    HD44780_RS_SETUP,       /* RS changed less than t_AS before E rose */
+    HD44780_NUM_VIOLATIONS
+} Hd44780_ViolationType;
+
+typedef struct
+{
+    Hd44780_ViolationType type;
+    uint64_t picos;         /* time of the offending edge */
+    uint8_t value;          /* instruction or data being transferred */
+    bool rs;
+} Hd44780_Violation;
+
+typedef struct
+{
+    /* Pins as last seen */
+    bool rs;
+    bool e;
+    uint8_t data;           /* DB4-7 in the upper nibble */
+    uint64_t rsChanged;
+    uint64_t dataChanged;
+    uint64_t eRose;
+    uint64_t lastRise;
+
+    /* Interface */
+    bool fourBit;
+    bool lowNibble;         /* next 4-bit transfer is the low nibble */
+    uint8_t highNibble;
+    int resetFunctionSets;  /* function sets seen since power-on */
+    uint64_t busyUntil;
+
+    /* Controller state */
+    uint8_t ddram[HD44780_LINES][HD44780_LINE_LENGTH];
+    uint8_t address;        /* DDRAM address counter */
+    bool cgram;             /* data goes to CGRAM */
+    bool increment;
+    bool shiftOnWrite;
+    bool displayOn;
+    bool twoLines;
+    int shift;              /* display shift, 0 to HD44780_LINE_LENGTH - 1 */
+
+    /* Statistics */
+    uint32_t instructions;
+    uint32_t dataWrites;
+    uint32_t violationCounts[HD44780_NUM_VIOLATIONS];
+    Hd44780_Violation reports[HD44780_MAX_REPORTS];
+    uint32_t numReports;
+
+    /* Called after each complete instruction or data write, may be 0 */
+    void (*onTransfer)(bool rs, uint8_t value, uint64_t picos);
+} Hd44780;
+
+/*!
+ * \brief This function puts the model in its power-on state
+ *
+ * \param lcd is the model
+ * \param picos is the power-on time
+ *
+ * \return None
+ */
+extern void Hd44780_init(Hd44780 *lcd, uint64_t picos);
+
+/*!
+ * \brief This function applies a change of the interface pins
+ *
+ * \param lcd is the model
+ * \param rs is the RS pin level
+ * \param e is the E pin level
+ * \param data is DB4-7 in the upper nibble
+ * \param picos is the time of the change
+ *
+ * \return None
+ */
+extern void Hd44780_pins(Hd44780 *lcd, bool rs, bool e, uint8_t data,
+                         uint64_t picos);
+
+/*!
+ * \brief This function returns the visible text of one line
+ *
+ * \param lcd is the model
+ * \param line is 0 or 1
+ * \param text receives HD44780_COLUMNS characters and a terminator
+ *
+ * \return None
+ */
+extern void Hd44780_getLine(const Hd44780 *lcd, int line, char *text);
+
+/*!
+ * \brief This function returns the name of a violation type
+ *
+ * \param type is the violation type
+ *
+ * \return Short name
+ */
+extern const char *Hd44780_violationName(Hd44780_ViolationType type);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HD44780_H_ */
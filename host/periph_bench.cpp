@@ -0,0 +1,125 @@
+/*!
+ * periph_bench.cpp
+ *      Description: Host comparison of DriverLib calls and the periph.hpp
+ *                   types for the accesses the firmware makes. Each case is
+ *                   a pair of functions doing the same thing both ways; for
+ *                   each it reports, per call, the register reads and
+ *                   writes charged by the stub, the modeled time on the
+ *                   target and the host cycles spent. "make periph" also
+ *                   lists the code size of every function from
+ *                   periph_size.cpp.
+ *
+ *                   The bus counts are exact for the target. Modeled time
+ *                   only covers bus cycles, so it leaves out the call,
+ *                   argument decoding and port table lookups DriverLib
+ *                   adds on top, which the host cycles and code sizes show.
+ *
+ *                   Usage: periph_bench [iterations]
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../periph.hpp"
+
+#define DEFAULT_ITERATIONS  1000
+#define NOINLINE            __attribute__((noinline))
+
+static volatile uint32_t sink;
+
+#include "periph_cases.h"
+
+typedef struct
+{
+    const char *name;
+    void (*driverlib)(void);
+    void (*periph)(void);
+} Case;
+
+static const Case cases[] = {
+    { "pin pulse", driverlib_pinPulse, periph_pinPulse },
+    { "LCD nibble", driverlib_nibble, periph_nibble },
+    { "pin read", driverlib_pinRead, periph_pinRead },
+    { "clear CCIFG", driverlib_clearFlag, periph_clearFlag },
+    { "ADC result", driverlib_adcResult, periph_adcResult },
+    { "timer start", driverlib_timerStart, periph_timerStart },
+};
+
+/*!
+ * Returns a host timestamp, TSC cycles where available.
+ *
+ * \return Host cycles or nanoseconds
+ */
+static uint64_t hostCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/*!
+ * Runs one variant and prints its cost per call.
+ *
+ * \param label Variant name
+ * \param fn Function to run
+ * \param iterations Number of calls
+ *
+ * \return None
+ */
+static void run(const char *label, void (*fn)(void), long iterations)
+{
+    Stub_Counters before;
+    uint64_t start;
+    uint64_t host;
+    long i;
+
+    before = stubCounters;
+    start = hostCycles();
+    for (i = 0; i < iterations; i++)
+    {
+        fn();
+    }
+    host = hostCycles() - start;
+
+    printf("  %-10s %6.1f %6.1f %9.1f %10.1f\n", label,
+           (double) (stubCounters.busReads - before.busReads) / iterations,
+           (double) (stubCounters.busWrites - before.busWrites) / iterations,
+           (double) (stubCounters.picos - before.picos) / 1000.0 / iterations,
+           (double) host / iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    size_t i;
+
+    if (iterations <= 0)
+    {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    Stub_reset();
+    printf("%-12s %6s %6s %9s %10s\n", "case", "reads", "writes",
+           "model ns", "host cyc");
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        printf("%s\n", cases[i].name);
+        run("DriverLib", cases[i].driverlib, iterations);
+        run("periph", cases[i].periph, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*!
+ * periph_cases.h
+ *      Description: The DriverLib and periph.hpp variants compared by
+ *                   periph_bench.cpp. Also compiled by periph_size.cpp
+ *                   against fixed register addresses to measure code size.
+ *                   The includer defines NOINLINE and sink.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef PERIPH_CASES_H_
+#define PERIPH_CASES_H_
+
+/* The pins and peripherals the firmware uses */
+using LcdEnable = periph::Pin<3, 2>;
+using LcdData = periph::PinGroup<4, 0xF0>;
+using S1 = periph::Pin<1, 1>;
+using DebounceTimer = periph::TimerA<2>;
+using Photo = periph::AdcMemory<14, periph::AdcInput<14>>;
+
+static_assert(periph::Disjoint<LcdEnable, LcdData, S1>::value,
+              "LCD and switch pins overlap");
+
+extern "C"
+{
+
+NOINLINE void driverlib_pinPulse(void)
+{
+    GPIO_setOutputHighOnPin(GPIO_PORT_P3, GPIO_PIN2);
+    GPIO_setOutputLowOnPin(GPIO_PORT_P3, GPIO_PIN2);
+}
+
+NOINLINE void periph_pinPulse(void)
+{
+    LcdEnable::high();
+    LcdEnable::low();
+}
+
+NOINLINE void driverlib_nibble(void)
+{
+    GPIO_setOutputLowOnPin(GPIO_PORT_P4, 0xF0);
+    GPIO_setOutputHighOnPin(GPIO_PORT_P4, 0x50);
+}
+
+NOINLINE void periph_nibble(void)
+{
+    LcdData::write(0x50);
+}
+
+NOINLINE void driverlib_pinRead(void)
+{
+    sink = GPIO_getInputPinValue(GPIO_PORT_P1, GPIO_PIN1);
+}
+
+NOINLINE void periph_pinRead(void)
+{
+    sink = S1::read();
+}
+
+NOINLINE void driverlib_clearFlag(void)
+{
+    Timer_A_clearCaptureCompareInterrupt(TIMER_A2_BASE,
+                                         TIMER_A_CAPTURECOMPARE_REGISTER_0);
+}
+
+NOINLINE void periph_clearFlag(void)
+{
+    DebounceTimer::clearCcr0Flag();
+}
+
+NOINLINE void driverlib_adcResult(void)
+{
+    sink = ADC14_getResult(ADC_MEM14);
+}
+
+NOINLINE void periph_adcResult(void)
+{
+    sink = Photo::result();
+}
+
+NOINLINE void driverlib_timerStart(void)
+{
+    const Timer_A_UpModeConfig upConfig = { TIMER_A_CLOCKSOURCE_SMCLK,
+                                            TIMER_A_CLOCKSOURCE_DIVIDER_1,
+                                            15000,
+                                            TIMER_A_TAIE_INTERRUPT_DISABLE,
+                                            TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE,
+                                            TIMER_A_DO_CLEAR };
+    Timer_A_configureUpMode(TIMER_A2_BASE, &upConfig);
+    Timer_A_startCounter(TIMER_A2_BASE, TIMER_A_UP_MODE);
+}
+
+NOINLINE void periph_timerStart(void)
+{
+    DebounceTimer::startUp<periph::ClockSource::Smclk, 1>(15000, true);
+}
+
+}
+
+#endif /* PERIPH_CASES_H_ */
@@ -0,0 +1,35 @@
+/*!
+ * periph_size.cpp
+ *      Description: Compile only build of periph_cases.h for code size. The
+ *                   register blocks are placed at their MSP432P401R
+ *                   addresses and the stub accounting is left out, so the
+ *                   periph.hpp variants compile to the register accesses the
+ *                   target makes, with the bit-band stores. The DriverLib
+ *                   variants are the same calls as on the target. Sizes are
+ *                   for the host ISA, so compare the variants with each
+ *                   other, not with the linker map.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#undef STUB_DRIVERLIB
+#undef P1
+#undef P3
+#undef P4
+#undef TIMER_A2
+#undef ADC14
+#define P1                  ((DIO_PORT_Type *) 0x40004C00)
+#define P3                  ((DIO_PORT_Type *) 0x40004C20)
+#define P4                  ((DIO_PORT_Type *) 0x40004C21)
+#define TIMER_A2            ((Timer_A_Type *) 0x40000800)
+#define ADC14               ((ADC14_Type *) 0x40012000)
+
+#include "../periph.hpp"
+
+#define NOINLINE            __attribute__((noinline))
+
+static volatile uint32_t sink;
+
+#include "periph_cases.h"
@@ -0,0 +1,190 @@
+/*!
+ * pool_bench.c
+ *      Description: Host check of the fixed-block pool allocator. Drains
+ *                   every pool, checks the fallback to larger classes, the
+ *                   counters and that foreign pointers, pointers into a
+ *                   block and blocks freed twice are refused without
+ *                   corrupting the free lists, then reports the host cycles
+ *                   of an allocation and a free. Exits non-zero on any
+ *                   failed check.
+ *
+ *                   Usage: pool_bench
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../pool.h"
+
+#define TOTAL_BLOCKS        (POOL_SMALL_COUNT + POOL_MEDIUM_COUNT \
+                             + POOL_LARGE_COUNT)
+#define ROUNDS              100000
+
+static bool ok = true;
+
+/*!
+ * Returns a host timestamp, TSC cycles where available.
+ *
+ * \return Host cycles or nanoseconds
+ */
+static uint64_t hostCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/*!
+ * Records a failed check.
+ *
+ * \param passed Result of the check
+ * \param what Description printed on failure
+ *
+ * \return None
+ */
+static void check(bool passed, const char *what)
+{
+    if (!passed)
+    {
+        printf("FAILED: %s\n", what);
+        ok = false;
+    }
+}
+
+/*!
+ * Returns the blocks in use over all pools.
+ *
+ * \return Blocks in use
+ */
+static uint32_t blocksInUse(void)
+{
+    Pool_Stats stats;
+    uint32_t used = 0;
+    int p;
+
+    for (p = 0; p < POOL_NUM_CLASSES; p++)
+    {
+        Pool_getStats(p, &stats);
+        used += stats.used;
+    }
+    return used;
+}
+
+/*!
+ * Takes every block with the smallest requests and checks that each one is
+ * distinct, then returns them all.
+ *
+ * \return None
+ */
+static void drainAll(void)
+{
+    uint8_t *blocks[TOTAL_BLOCKS + 1];
+    Pool_Stats stats;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0; i < TOTAL_BLOCKS; i++)
+    {
+        blocks[i] = Pool_alloc(1);
+        check(blocks[i] != NULL, "allocation while blocks are free");
+        check(((uintptr_t) blocks[i] & 3) == 0, "block alignment");
+        for (j = 0; j < i; j++)
+        {
+            check(blocks[i] != blocks[j], "block handed out twice");
+        }
+    }
+    check(Pool_alloc(1) == NULL, "allocation from empty pools");
+    Pool_getStats(0, &stats);
+    check(stats.used == POOL_SMALL_COUNT
+                  && stats.highWater == POOL_SMALL_COUNT,
+          "small pool counters when full");
+    check(stats.failures == POOL_MEDIUM_COUNT + POOL_LARGE_COUNT + 1,
+          "small pool failures counted on fallback");
+    Pool_getStats(POOL_NUM_CLASSES - 1, &stats);
+    check(stats.failures == 1, "large pool failure");
+    for (i = 0; i < TOTAL_BLOCKS; i++)
+    {
+        Pool_free(blocks[i]);
+    }
+    check(blocksInUse() == 0, "every block returned");
+}
+
+/*!
+ * Frees pointers that must be refused and checks the free lists still hand
+ * out each block once.
+ *
+ * \return None
+ */
+static void refuseInvalid(void)
+{
+    static uint32_t foreign[4];
+    uint8_t *block = Pool_alloc(POOL_MEDIUM_SIZE);
+    uint8_t *first;
+    uint8_t *second;
+
+    check(Pool_alloc(POOL_MAX_SIZE + 1) == NULL, "oversized request");
+    Pool_free(foreign);
+    Pool_free(block + 4);
+    Pool_free(block);
+    Pool_free(block);
+    check(Pool_getInvalidFrees() == 3, "foreign, interior and double frees");
+    check(blocksInUse() == 0, "used after a double free");
+
+    first = Pool_alloc(POOL_MEDIUM_SIZE);
+    second = Pool_alloc(POOL_MEDIUM_SIZE);
+    check(first != second, "double free corrupts the free list");
+    Pool_free(first);
+    Pool_free(second);
+}
+
+int main(void)
+{
+    void *blocks[POOL_SMALL_COUNT];
+    uint64_t allocCycles = 0;
+    uint64_t freeCycles = 0;
+    uint64_t start;
+    uint32_t i;
+    uint32_t n;
+
+    Pool_init();
+    drainAll();
+    Pool_init();
+    refuseInvalid();
+
+    // Cost of draining and refilling the small pool
+    Pool_init();
+    for (n = 0; n < ROUNDS; n++)
+    {
+        start = hostCycles();
+        for (i = 0; i < POOL_SMALL_COUNT; i++)
+        {
+            blocks[i] = Pool_alloc(POOL_SMALL_SIZE);
+        }
+        allocCycles += hostCycles() - start;
+        start = hostCycles();
+        for (i = 0; i < POOL_SMALL_COUNT; i++)
+        {
+            Pool_free(blocks[i]);
+        }
+        freeCycles += hostCycles() - start;
+    }
+    printf("alloc %.1f cycles, free %.1f cycles\n",
+           (double) allocCycles / (ROUNDS * POOL_SMALL_COUNT),
+           (double) freeCycles / (ROUNDS * POOL_SMALL_COUNT));
+
+    printf("%s\n", ok ? "all pool checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
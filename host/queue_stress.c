@@ -0,0 +1,159 @@
+/*!
+ * queue_stress.c
+ *      Description: Host stress test of the SPSC event queue. A producer
+ *                   thread pushes sequence numbered events through
+ *                   Queue_push, retrying each one the queue refuses, while
+ *                   the consumer drains it with Queue_popBatch in batches of
+ *                   varying size. The consumer checks that every event
+ *                   arrives once and in order, and at the end the overflow
+ *                   counter must equal the refused pushes. Exits non-zero
+ *                   on any failed check.
+ *
+ *                   Usage: queue_stress [events]
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../queue.h"
+
+/* Small, so the producer often finds the queue full */
+#define QUEUE_SIZE          64
+#define MAX_BATCH           24
+#define DEFAULT_EVENTS      4000000
+
+static Event storage[QUEUE_SIZE];
+static EventQueue queue;
+static uint32_t totalEvents = DEFAULT_EVENTS;
+
+/* Written by the producer, read by the consumer after the join */
+static uint32_t pushes;
+
+/*!
+ * Fills the event with sequence number seq in every field.
+ *
+ * \param event Event to fill
+ * \param seq Sequence number
+ *
+ * \return None
+ */
+static void makeEvent(Event *event, uint32_t seq)
+{
+    event->timestamp = seq;
+    event->value = (uint16_t) (seq * 7);
+    event->type = (uint8_t) (seq % 7);
+    event->channel = (uint8_t) (seq >> 24);
+}
+
+/*!
+ * Pushes every event in order, retrying each until the queue takes it.
+ *
+ * \param arg Unused
+ *
+ * \return NULL
+ */
+static void *producer(void *arg)
+{
+    Event event;
+    uint32_t seq;
+
+    for (seq = 0; seq < totalEvents; seq++)
+    {
+        makeEvent(&event, seq);
+        pushes++;
+        while (!Queue_push(&queue, &event))
+        {
+            // Let the consumer run when both share one CPU
+            sched_yield();
+            pushes++;
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    Event batch[MAX_BATCH];
+    Event expected;
+    pthread_t thread;
+    uint32_t seed = 12345;
+    uint32_t pops = 0;
+    uint32_t errors = 0;
+    uint32_t batches = 0;
+    uint32_t i;
+
+    if (argc > 1)
+    {
+        totalEvents = (uint32_t) strtoul(argv[1], NULL, 0);
+    }
+    if (!Queue_init(&queue, storage, QUEUE_SIZE)
+            || pthread_create(&thread, NULL, producer, NULL) != 0)
+    {
+        printf("FAILED: setup\n");
+        return 1;
+    }
+
+    while (pops < totalEvents)
+    {
+        uint32_t n;
+
+        seed = seed * 1103515245 + 12345;
+        n = Queue_popBatch(&queue, batch, 1 + (seed >> 16) % MAX_BATCH);
+
+        for (i = 0; i < n; i++)
+        {
+            makeEvent(&expected, pops + i);
+            if (batch[i].timestamp != expected.timestamp
+                    || batch[i].value != expected.value
+                    || batch[i].type != expected.type
+                    || batch[i].channel != expected.channel)
+            {
+                // Report the first few, a gap shifts every later event
+                if (errors++ < 5)
+                {
+                    printf("FAILED: event %lu arrived as %lu\n",
+                           (unsigned long) (pops + i),
+                           (unsigned long) batch[i].timestamp);
+                }
+            }
+        }
+        pops += n;
+        batches += n != 0;
+        if (n == 0)
+        {
+            sched_yield();
+        }
+        if (errors > 0)
+        {
+            // The producer may be waiting on a full queue, leave it
+            printf("FAILED\n");
+            return 1;
+        }
+    }
+    pthread_join(thread, NULL);
+
+    printf("%lu events in %lu batches, %lu pushes, %lu overflows\n",
+           (unsigned long) pops, (unsigned long) batches,
+           (unsigned long) pushes,
+           (unsigned long) Queue_getOverflows(&queue));
+    if (Queue_count(&queue) != 0)
+    {
+        printf("FAILED: %lu events left over\n",
+               (unsigned long) Queue_count(&queue));
+        errors++;
+    }
+    if (Queue_getOverflows(&queue) != pushes - pops)
+    {
+        printf("FAILED: overflows are not pushes - pops\n");
+        errors++;
+    }
+    printf("%s\n", errors == 0 ? "queue stress passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
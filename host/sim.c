@@ -0,0 +1,1270 @@
+/*!
+ * sim.c
+ *      Description: Host simulator that runs the real firmware main() in
+ *                   virtual time. The stub DriverLib provides the timers,
+ *                   interrupts and low-power sleep; this file adds the board:
+ *                   an HD44780 on the LCD pins, scripted waveforms on A14 and
+ *                   A15, a bouncing S1, and a TMP102 and an OPT3001 on the
+ *                   I2C bus. At the end it prints the LCD, the
+ *                   refresh timing, every LCD timing violation and every
+ *                   frame that differs from the expected frames, and exits
+ *                   non-zero if there were any.
+ *
+ *                   Usage: sim [-f] [-q] [-u file] scenario
+ *                       -f  print every LCD frame as it completes and the
+ *                           view after every display shift
+ *                       -q  do not echo the UART console
+ *                       -u  write every UART byte to file, binary
+ *                           telemetry frames included
+ *
+ *                   Scenario lines are "<time ms> <command> [arguments]":
+ *                       adc <A14|A15> const <value>
+ *                       adc <A14|A15> sine <offset> <amplitude> <Hz>
+ *                       adc <A14|A15> square <low> <high> <Hz>
+ *                       adc <A14|A15> ramp <from> <to> <period ms>
+ *                       adc <A14|A15> noise <center> <amplitude>
+ *                       press S1 [bounces] [bounce ms]
+ *                       release S1 [bounces] [bounce ms]
+ *                       sensor temp <degrees C>|off
+ *                       sensor light <lux>|off
+ *                       replay <file>
+ *                       frames <file> <until ms>
+ *                       end
+ *                   Values are ADC counts, '#' starts a comment. The sensors
+ *                   start at 22 C and 300 lux; "off" disconnects one, so it
+ *                   NACKs its address until it is given a value again. replay
+ *                   feeds the first capture dump (CAPTURE BEGIN ... END) in
+ *                   a console log through the ADC and S1 inputs, starting
+ *                   at the command's time. Paths are relative to the
+ *                   scenario file. frames reads the LCD frames of a log of
+ *                   "sim -f" and expects the frames completed from the
+ *                   command's time until the given time to repeat them, the
+ *                   text exactly and the time to within a millisecond. The
+ *                   echo leaves out the zero-delimited telemetry frames, the
+ *                   report counts them.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hd44780.h"
+#include "../capture.h"
+#include "../codec.h"
+
+#define NS_PER_MS           1000000ULL
+#define PS_PER_US           1000000ULL
+#define MAX_EVENTS          65536
+#define LINE_LENGTH         160
+#define ADC_MAX             16383
+#define DEFAULT_BOUNCE_MS   0.5
+#define PATH_LENGTH         256
+/* Replayed S1 levels lead the sample that saw them by half a debounce tick */
+#define REPLAY_INPUT_LEAD   (2500 * 1000ULL)
+#define PI                  3.14159265358979323846
+/* Data writes further apart belong to different updates in place */
+#define FRAME_GAP           (50000 * PS_PER_US)
+/* Expected frames of the frames command */
+#define MAX_FRAMES          1024
+#define FRAME_TOLERANCE     (1000 * PS_PER_US)
+#define MAX_MISMATCH_REPORTS 5
+
+/* Board wiring, see the diagram in main.c */
+#define LCD_CTRL_PORT       GPIO_PORT_P3
+#define LCD_RS_PIN          GPIO_PIN3
+#define LCD_E_PIN           GPIO_PIN2
+#define LCD_DATA_PORT       GPIO_PORT_P4
+#define S1_PORT             GPIO_PORT_P1
+#define S1_PIN              GPIO_PIN1
+#define TMP102_ADDRESS      0x48
+#define OPT3001_ADDRESS     0x44
+
+/* OPT3001 configuration at power-on, M = 00 is shutdown */
+#define OPT3001_RESET_CONFIG    0xC810
+#define OPT3001_MODE_MASK       0x0600
+
+/* Firmware entry points, main() is renamed for the host build */
+extern int firmwareMain(void);
+extern void ADC14_IRQHandler(void);
+extern void T32_INT1_IRQHandler(void);
+extern void TA2_0_IRQHandler(void);
+extern void EUSCIA0_IRQHandler(void);
+extern void EUSCIB0_IRQHandler(void);
+extern void DMA_INT1_IRQHandler(void);
+extern void PendSV_Handler(void);
+
+typedef enum
+{
+    WAVE_CONST, WAVE_SINE, WAVE_SQUARE, WAVE_RAMP, WAVE_NOISE
+} WaveShape;
+
+typedef struct
+{
+    WaveShape shape;
+    double a;
+    double b;
+    double c;
+    uint64_t start;
+} Wave;
+
+typedef enum
+{
+    EVENT_WAVE, EVENT_PIN, EVENT_SENSOR, EVENT_END
+} EventKind;
+
+typedef struct
+{
+    uint64_t nanos;
+    int order;              /* file order, keeps the sort stable */
+    EventKind kind;
+    int channel;            /* 0 = A14, 1 = A15, or the I2C target */
+    Wave wave;
+    bool level;             /* S1 pressed, or the target connected */
+} InputEvent;
+
+/* I2C target with a register pointer and four 16-bit registers, MSB
+ * first like the TMP102 and OPT3001 */
+typedef struct
+{
+    uint8_t address;
+    bool connected;
+    uint8_t pointer;
+    uint16_t registers[4];
+    uint16_t result;        /* conversion result, the value of register 0 */
+    uint32_t written;       /* bytes since the start */
+    uint32_t read;
+} I2cTarget;
+
+typedef struct
+{
+    uint32_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t total;
+} Stat;
+
+typedef struct
+{
+    uint64_t picos;         /* last data write */
+    char text[HD44780_LINES][HD44780_COLUMNS + 1];
+} Frame;
+
+static char scenarioDir[PATH_LENGTH];
+static InputEvent events[MAX_EVENTS];
+static int numEvents;
+static int nextEvent;
+static Wave waves[2];
+static uint32_t noiseState = 12345;
+
+/* 0 = TMP102, 1 = OPT3001 */
+static I2cTarget targets[2];
+static I2cTarget *i2cTarget;
+
+static Hd44780 lcd;
+static jmp_buf simEnd;
+static bool printFrames;
+static bool quiet;
+
+/* Refresh timing, a frame runs from a clear, or from a data write after a
+ * display shift or a pause of FRAME_GAP, to its last data write */
+static bool frameOpen;
+static uint32_t frameWrites;
+static uint64_t frameStart;
+static uint64_t frameLast;
+static uint64_t frameSample;
+static char frameText[HD44780_LINES][HD44780_COLUMNS + 1];
+static uint64_t lastSample;
+static Stat frameTime;
+static Stat sampleLatency;
+
+/* Frames command, the expected frames from checkFrom to checkUntil */
+static Frame expectedFrames[MAX_FRAMES];
+static int numExpected;
+static int nextExpected;
+static bool checkFrames;
+static uint64_t checkFrom;
+static uint64_t checkUntil;
+static uint32_t frameMismatches;
+
+static char uartLine[LINE_LENGTH];
+static int uartLength;
+static FILE *uartFile;
+static bool uartInFrame;
+static uint32_t uartFrames;
+
+/*!
+ * Adds a value to a statistic.
+ *
+ * \param stat Statistic
+ * \param value Value to add
+ *
+ * \return None
+ */
+static void statAdd(Stat *stat, uint64_t value)
+{
+    if (stat->count == 0 || value < stat->min)
+    {
+        stat->min = value;
+    }
+    if (value > stat->max)
+    {
+        stat->max = value;
+    }
+    stat->total += value;
+    stat->count++;
+}
+
+/*!
+ * Prints a statistic of picosecond values in microseconds.
+ *
+ * \param name Label
+ * \param stat Statistic
+ *
+ * \return None
+ */
+static void statPrint(const char *name, const Stat *stat)
+{
+    if (stat->count == 0)
+    {
+        printf("%-22s none\n", name);
+        return;
+    }
+    printf("%-22s n=%u min=%.1f avg=%.1f max=%.1f us\n", name, stat->count,
+           (double) stat->min / PS_PER_US,
+           (double) stat->total / stat->count / PS_PER_US,
+           (double) stat->max / PS_PER_US);
+}
+
+/*!
+ * Prints a frame mismatch, only the first few of them.
+ *
+ * \param picos Time of the frame, 0 if missing
+ * \param text Frame text, NULL if missing
+ * \param expected Expected frame, NULL if none was
+ *
+ * \return None
+ */
+static void reportMismatch(uint64_t picos,
+                           char text[HD44780_LINES][HD44780_COLUMNS + 1],
+                           const Frame *expected)
+{
+    if (frameMismatches++ >= MAX_MISMATCH_REPORTS)
+    {
+        return;
+    }
+    if (text != 0)
+    {
+        printf("frame    %10.3f ms  |%s|%s|\n", (double) picos / 1e9,
+               text[0], text[1]);
+    }
+    if (expected != 0)
+    {
+        printf("expected %10.3f ms  |%s|%s|\n", (double) expected->picos / 1e9,
+               expected->text[0], expected->text[1]);
+    }
+}
+
+/*!
+ * Compares a completed frame with the next expected one.
+ *
+ * \param picos Time of its last data write
+ * \param text Frame text
+ *
+ * \return None
+ */
+static void checkFrame(uint64_t picos,
+                       char text[HD44780_LINES][HD44780_COLUMNS + 1])
+{
+    const Frame *expected;
+    uint64_t skew;
+
+    if (!checkFrames || picos < checkFrom || picos >= checkUntil)
+    {
+        return;
+    }
+    if (nextExpected == numExpected)
+    {
+        reportMismatch(picos, text, 0);
+        return;
+    }
+    expected = &expectedFrames[nextExpected++];
+    skew = picos > expected->picos ? picos - expected->picos
+            : expected->picos - picos;
+    if (skew > FRAME_TOLERANCE || strcmp(text[0], expected->text[0]) != 0
+            || strcmp(text[1], expected->text[1]) != 0)
+    {
+        reportMismatch(picos, text, expected);
+    }
+}
+
+/*!
+ * Ends the open frame and records its timing.
+ *
+ * \return None
+ */
+static void closeFrame(void)
+{
+    // A clear without data is the init sequence, not a refresh
+    if (!frameOpen || frameWrites == 0)
+    {
+        frameOpen = false;
+        return;
+    }
+    frameOpen = false;
+    statAdd(&frameTime, frameLast - frameStart);
+    if (frameSample != 0)
+    {
+        statAdd(&sampleLatency, frameLast - frameSample);
+    }
+    if (printFrames)
+    {
+        printf("%10.3f ms  |%s|%s|\n", (double) frameLast / 1e9,
+               frameText[0], frameText[1]);
+    }
+    checkFrame(frameLast, frameText);
+}
+
+/*!
+ * Starts a frame.
+ *
+ * \param picos Time of its first transfer
+ *
+ * \return None
+ */
+static void openFrame(uint64_t picos)
+{
+    closeFrame();
+    frameOpen = true;
+    frameWrites = 0;
+    frameStart = picos;
+    frameLast = picos;
+    frameSample = lastSample;
+}
+
+static void lcdTransfer(bool rs, uint8_t value, uint64_t picos)
+{
+    if (!rs && value == 0x01)
+    {
+        openFrame(picos);
+    }
+    else if (!rs && (value & 0xF8) == 0x18)
+    {
+        // Display shift, the next data write starts an update in place
+        closeFrame();
+        if (printFrames)
+        {
+            char text[HD44780_LINES][HD44780_COLUMNS + 1];
+
+            Hd44780_getLine(&lcd, 0, text[0]);
+            Hd44780_getLine(&lcd, 1, text[1]);
+            printf("%10.3f ms  |%s|%s|  shift %d\n", (double) picos / 1e9,
+                   text[0], text[1], lcd.shift);
+        }
+    }
+    else if (rs)
+    {
+        if (!frameOpen || picos - frameLast > FRAME_GAP)
+        {
+            openFrame(picos);
+        }
+        // The next clear wipes DDRAM before this callback sees it
+        frameWrites++;
+        frameLast = picos;
+        Hd44780_getLine(&lcd, 0, frameText[0]);
+        Hd44780_getLine(&lcd, 1, frameText[1]);
+    }
+}
+
+static void portWrite(uint_fast8_t port, uint8_t out, uint64_t picos)
+{
+    if (port == LCD_CTRL_PORT || port == LCD_DATA_PORT)
+    {
+        Hd44780_pins(&lcd, (stubPorts[LCD_CTRL_PORT].OUT & LCD_RS_PIN) != 0,
+                     (stubPorts[LCD_CTRL_PORT].OUT & LCD_E_PIN) != 0,
+                     stubPorts[LCD_DATA_PORT].OUT, picos);
+    }
+}
+
+static void uartByte(uint8_t byte)
+{
+    if (uartFile != 0)
+    {
+        fputc(byte, uartFile);
+    }
+    // Telemetry frames start and end with the only zero bytes
+    if (byte == 0)
+    {
+        uartFrames += uartInFrame;
+        uartInFrame = !uartInFrame;
+        return;
+    }
+    if (byte == '\r' || uartInFrame)
+    {
+        return;
+    }
+    if (byte == '\n' || uartLength == LINE_LENGTH - 1)
+    {
+        uartLine[uartLength] = 0;
+        if (!quiet)
+        {
+            printf("uart: %s\n", uartLine);
+        }
+        uartLength = 0;
+        if (byte == '\n')
+        {
+            return;
+        }
+    }
+    uartLine[uartLength++] = (char) byte;
+}
+
+/*!
+ * Puts a sensor in its power-on state.
+ *
+ * \param target 0 = TMP102, 1 = OPT3001
+ *
+ * \return None
+ */
+static void resetSensor(int target)
+{
+    memset(targets[target].registers, 0, sizeof(targets[target].registers));
+    targets[target].pointer = 0;
+    if (target == 1)
+    {
+        targets[1].registers[1] = OPT3001_RESET_CONFIG;
+    }
+}
+
+/*!
+ * Sets the result register of a sensor from a physical value.
+ *
+ * \param target 0 = TMP102 in degrees C, 1 = OPT3001 in lux
+ * \param value Temperature or illuminance
+ *
+ * \return None
+ */
+static void setSensor(int target, double value)
+{
+    if (target == 0)
+    {
+        // 12 bits of 0.0625 C, left aligned
+        double lsb = floor(value * 16 + 0.5);
+        lsb = lsb < -2048 ? -2048 : lsb > 2047 ? 2047 : lsb;
+        targets[0].result = (uint16_t) ((int32_t) lsb * 16);
+    }
+    else
+    {
+        // 0.01 lux * 2^E * R with the smallest exponent that fits
+        double centilux = value < 0 ? 0 : value * 100;
+        uint32_t exponent = 0;
+
+        while (centilux >= 4095.5 && exponent < 11)
+        {
+            centilux /= 2;
+            exponent++;
+        }
+        centilux = centilux > 4095 ? 4095 : centilux;
+        targets[1].result = (uint16_t) (exponent << 12
+                | (uint32_t) (centilux + 0.5));
+    }
+}
+
+static bool i2cStart(uint8_t address, bool read)
+{
+    int i;
+
+    i2cTarget = 0;
+    for (i = 0; i < 2; i++)
+    {
+        if (targets[i].connected && targets[i].address == address)
+        {
+            i2cTarget = &targets[i];
+            i2cTarget->written = 0;
+            i2cTarget->read = 0;
+        }
+    }
+    return i2cTarget != 0;
+}
+
+static bool i2cWrite(uint8_t byte)
+{
+    I2cTarget *target = i2cTarget;
+
+    if (target == 0)
+    {
+        return false;
+    }
+    // Pointer byte, then the register MSB first
+    if (target->written == 0)
+    {
+        target->pointer = byte & 3;
+    }
+    else if (target->written == 1)
+    {
+        target->registers[target->pointer] = (uint16_t) (byte << 8);
+    }
+    else if (target->written == 2)
+    {
+        target->registers[target->pointer] |= byte;
+    }
+    target->written++;
+    return true;
+}
+
+static uint8_t i2cRead(void)
+{
+    I2cTarget *target = i2cTarget;
+    uint16_t value;
+
+    if (target == 0)
+    {
+        return 0xFF;
+    }
+    value = target->registers[target->pointer];
+    if (target->pointer == 0)
+    {
+        // The OPT3001 does not convert until it is configured
+        value = target == &targets[1]
+                && (target->registers[1] & OPT3001_MODE_MASK) == 0 ?
+                0 : target->result;
+    }
+    return (uint8_t) (target->read++ & 1 ? value : value >> 8);
+}
+
+static void i2cStop(void)
+{
+    i2cTarget = 0;
+}
+
+/*!
+ * Evaluates a waveform.
+ *
+ * \param wave Waveform
+ * \param nanos Time
+ *
+ * \return ADC counts
+ */
+static uint16_t waveValue(const Wave *wave, uint64_t nanos)
+{
+    double t = (double) (nanos - wave->start) / 1e9;
+    double value = wave->a;
+
+    switch (wave->shape)
+    {
+    case WAVE_SINE:
+        value = wave->a + wave->b * sin(2 * PI * wave->c * t);
+        break;
+    case WAVE_SQUARE:
+        value = fmod(t * wave->c, 1.0) < 0.5 ? wave->a : wave->b;
+        break;
+    case WAVE_RAMP:
+        value = wave->a + (wave->b - wave->a)
+                * fmod(t * 1000 / wave->c, 1.0);
+        break;
+    case WAVE_NOISE:
+        noiseState = noiseState * 1103515245 + 12345;
+        value = wave->a + wave->b
+                * (((noiseState >> 16) & 0x7FFF) / 16383.5 - 1.0);
+        break;
+    case WAVE_CONST:
+        break;
+    }
+    if (value < 0)
+    {
+        value = 0;
+    }
+    return value > ADC_MAX ? ADC_MAX : (uint16_t) value;
+}
+
+static uint16_t adcInput(uint32_t channel, uint64_t nanos)
+{
+    if (channel == 14 || channel == 15)
+    {
+        return waveValue(&waves[channel - 14], nanos);
+    }
+    return 0;
+}
+
+static void adcDone(uint32_t memory, uint16_t result, uint64_t nanos)
+{
+    lastSample = nanos * 1000;
+}
+
+static uint64_t update(uint64_t nanos)
+{
+    while (nextEvent < numEvents && events[nextEvent].nanos <= nanos)
+    {
+        const InputEvent *event = &events[nextEvent++];
+        switch (event->kind)
+        {
+        case EVENT_WAVE:
+            waves[event->channel] = event->wave;
+            waves[event->channel].start = event->nanos;
+            break;
+        case EVENT_PIN:
+            // S1 pulls the pin low when pressed
+            if (event->level)
+            {
+                stubPorts[S1_PORT].IN &= ~S1_PIN;
+            }
+            else
+            {
+                stubPorts[S1_PORT].IN |= S1_PIN;
+            }
+            break;
+        case EVENT_SENSOR:
+            if (event->level && !targets[event->channel].connected)
+            {
+                resetSensor(event->channel);
+            }
+            targets[event->channel].connected = event->level;
+            if (event->level)
+            {
+                setSensor(event->channel, event->wave.a);
+            }
+            break;
+        case EVENT_END:
+            longjmp(simEnd, 1);
+        }
+    }
+    return nextEvent < numEvents ? events[nextEvent].nanos - nanos : 0;
+}
+
+/*!
+ * Adds an input event.
+ *
+ * \param event Event to copy
+ *
+ * \return None
+ */
+static void addEvent(const InputEvent *event)
+{
+    if (numEvents == MAX_EVENTS)
+    {
+        fprintf(stderr, "too many events, the limit is %d\n", MAX_EVENTS);
+        exit(2);
+    }
+    events[numEvents] = *event;
+    events[numEvents].order = numEvents;
+    numEvents++;
+}
+
+static int compareEvents(const void *a, const void *b)
+{
+    const InputEvent *x = a;
+    const InputEvent *y = b;
+    if (x->nanos != y->nanos)
+    {
+        return x->nanos < y->nanos ? -1 : 1;
+    }
+    return x->order - y->order;
+}
+
+/*!
+ * Reads one varint from a capture.
+ *
+ * \param data Capture bytes
+ * \param length Number of bytes
+ * \param next Read position, advanced past the varint
+ * \param value Receives the value
+ *
+ * \return false if the capture ends inside the varint
+ */
+static bool getVarint(const uint8_t *data, uint32_t length, uint32_t *next,
+                      uint32_t *value)
+{
+    int shift = 0;
+
+    *value = 0;
+    while (*next < length && shift < 35)
+    {
+        uint8_t byte = data[(*next)++];
+        *value |= (uint32_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+/*!
+ * Loads the first capture dump of a console log as input events.
+ *
+ * Each sample of an ADC block becomes a constant input from half a sample
+ * period before its time, counted back from the last sample at the rate of
+ * the block, so the replayed conversion near the recorded time reads the
+ * recorded value even if it drifts a little.
+ *
+ * \param name Log file, relative to the scenario
+ * \param start Time the capture starts in ns
+ *
+ * \return false if the file has no complete capture dump
+ */
+static bool loadCapture(const char *name, uint64_t start)
+{
+    static uint8_t data[CAPTURE_BUFFER_SIZE];
+    char path[2 * PATH_LENGTH];
+    char text[256];
+    uint32_t length = 0;
+    uint32_t expected = 0;
+    bool inDump = false;
+    bool complete = false;
+    FILE *file;
+
+    snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : scenarioDir,
+             name);
+    file = fopen(path, "r");
+    if (file == 0)
+    {
+        perror(path);
+        return false;
+    }
+    while (!complete && fgets(text, sizeof(text), file) != 0)
+    {
+        // Console logs may prefix the firmware output
+        char *begin = strstr(text, "CAPTURE BEGIN");
+        char *hex = text;
+        unsigned int byte;
+
+        if (!inDump)
+        {
+            inDump = begin != 0
+                    && sscanf(begin, "CAPTURE BEGIN %u", &expected) == 1;
+            continue;
+        }
+        if (strstr(text, "CAPTURE END") != 0)
+        {
+            complete = true;
+            break;
+        }
+        if (strncmp(hex, "uart: ", 6) == 0)
+        {
+            hex += 6;
+        }
+        // Other console output can interleave with the dump, even trace
+        // records, which are hex words separated by spaces
+        if (strspn(hex + strspn(hex, "0123456789abcdef"), "\r\n") == 0)
+        {
+            continue;
+        }
+        while (length < CAPTURE_BUFFER_SIZE && sscanf(hex, "%2x", &byte) == 1)
+        {
+            data[length++] = (uint8_t) byte;
+            hex += 2;
+        }
+    }
+    fclose(file);
+    if (!complete || length != expected)
+    {
+        fprintf(stderr, "%s: no complete capture dump\n", path);
+        return false;
+    }
+
+    uint64_t nanos = start;
+    uint32_t khz = 0;
+    uint32_t next = 0;
+
+    while (next < length)
+    {
+        uint8_t tag = data[next++];
+        uint16_t samples[CODEC_MAX_SAMPLES];
+        uint32_t delta;
+        uint32_t payload;
+        uint32_t bytes;
+        uint8_t channel;
+        int32_t count;
+        int32_t i;
+        InputEvent event;
+
+        if (!getVarint(data, length, &next, &delta)
+                || !getVarint(data, length, &next, &payload))
+        {
+            fprintf(stderr, "%s: truncated record\n", path);
+            return false;
+        }
+        // Deltas are zigzag, blocks may be recorded after later inputs
+        if (khz != 0)
+        {
+            nanos += (int64_t) ((int32_t) (delta >> 1) ^ -(int32_t) (delta & 1))
+                    * 1000000 / (int64_t) khz;
+        }
+
+        memset(&event, 0, sizeof(event));
+        switch (tag >> 4)
+        {
+        case CAPTURE_CLOCK:
+            khz = payload;
+            break;
+        case CAPTURE_ADC:
+            // The payload so far is the rate, the block follows
+            count = -1;
+            if (getVarint(data, length, &next, &bytes) && payload != 0
+                    && bytes <= length - next)
+            {
+                count = Codec_decode(&data[next], bytes, &channel, samples,
+                                     CODEC_MAX_SAMPLES);
+                next += bytes;
+            }
+            if (count <= 0)
+            {
+                fprintf(stderr, "%s: bad ADC block\n", path);
+                return false;
+            }
+            // Channels 0 and 1 are the photoresistor (A14) and pot (A15)
+            event.channel = tag & 0x0F;
+            if (event.channel > 1)
+            {
+                break;
+            }
+            uint64_t period = 1000000000ULL / payload;
+            event.kind = EVENT_WAVE;
+            event.wave.shape = WAVE_CONST;
+            for (i = 0; i < count; i++)
+            {
+                uint64_t back = (count - i) * period - period / 2;
+
+                event.wave.a = samples[i];
+                event.nanos = nanos > start + back ? nanos - back : start;
+                addEvent(&event);
+            }
+            break;
+        case CAPTURE_INPUT:
+            // Button 0 is S1
+            event.kind = EVENT_PIN;
+            event.level = (payload & 1) != 0;
+            event.nanos = nanos > start + REPLAY_INPUT_LEAD ?
+                    nanos - REPLAY_INPUT_LEAD : start;
+            addEvent(&event);
+            break;
+        default:
+            fprintf(stderr, "%s: unknown record 0x%02x\n", path, tag);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * Loads the frames a "sim -f" log shows from checkFrom until checkUntil.
+ * Views after display shifts are not frames and are left out.
+ *
+ * \param name Log file, relative to the scenario
+ *
+ * \return false if the file cannot be read
+ */
+static bool loadFrames(const char *name)
+{
+    char path[2 * PATH_LENGTH];
+    char text[256];
+    FILE *file;
+
+    snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : scenarioDir,
+             name);
+    file = fopen(path, "r");
+    if (file == 0)
+    {
+        perror(path);
+        return false;
+    }
+    numExpected = 0;
+    while (fgets(text, sizeof(text), file) != 0)
+    {
+        Frame *frame = &expectedFrames[numExpected];
+        char *bar = strchr(text, '|');
+        double ms;
+        int line;
+
+        if (bar == 0 || strstr(bar, "shift") != 0
+                || sscanf(text, "%lf ms", &ms) != 1)
+        {
+            continue;
+        }
+        frame->picos = (uint64_t) (ms * NS_PER_MS + 0.5) * 1000;
+        for (line = 0; line < HD44780_LINES; line++)
+        {
+            memcpy(frame->text[line], bar + 1, HD44780_COLUMNS);
+            frame->text[line][HD44780_COLUMNS] = 0;
+            bar += HD44780_COLUMNS + 1;
+        }
+        if (frame->picos >= checkFrom && frame->picos < checkUntil
+                && numExpected < MAX_FRAMES)
+        {
+            numExpected++;
+        }
+    }
+    fclose(file);
+    checkFrames = true;
+    return true;
+}
+
+/*!
+ * Parses one scenario line into events.
+ *
+ * \param text Line without comment
+ * \param lineNumber For error messages
+ *
+ * \return true if the line was valid
+ */
+static bool parseLine(char *text, int lineNumber)
+{
+    InputEvent event;
+    double ms;
+    char command[16];
+    char target[8];
+    char shape[16];
+    double args[3] = { 0, 0, 0 };
+    int fields;
+
+    memset(&event, 0, sizeof(event));
+    fields = sscanf(text, "%lf %15s", &ms, command);
+    if (fields <= 0)
+    {
+        return true;
+    }
+    if (fields != 2 || ms < 0)
+    {
+        return false;
+    }
+    event.nanos = (uint64_t) (ms * NS_PER_MS);
+
+    if (strcmp(command, "end") == 0)
+    {
+        event.kind = EVENT_END;
+        addEvent(&event);
+        return true;
+    }
+    if (strcmp(command, "adc") == 0)
+    {
+        fields = sscanf(text, "%*f %*s %7s %15s %lf %lf %lf", target, shape,
+                        &args[0], &args[1], &args[2]);
+        if (fields < 3)
+        {
+            return false;
+        }
+        if (strcmp(target, "A14") == 0)
+        {
+            event.channel = 0;
+        }
+        else if (strcmp(target, "A15") == 0)
+        {
+            event.channel = 1;
+        }
+        else
+        {
+            return false;
+        }
+        if (strcmp(shape, "const") == 0)
+        {
+            event.wave.shape = WAVE_CONST;
+        }
+        else if (strcmp(shape, "sine") == 0 && fields == 5)
+        {
+            event.wave.shape = WAVE_SINE;
+        }
+        else if (strcmp(shape, "square") == 0 && fields == 5)
+        {
+            event.wave.shape = WAVE_SQUARE;
+        }
+        else if (strcmp(shape, "ramp") == 0 && fields == 5 && args[2] > 0)
+        {
+            event.wave.shape = WAVE_RAMP;
+        }
+        else if (strcmp(shape, "noise") == 0 && fields >= 4)
+        {
+            event.wave.shape = WAVE_NOISE;
+        }
+        else
+        {
+            return false;
+        }
+        event.kind = EVENT_WAVE;
+        event.wave.a = args[0];
+        event.wave.b = args[1];
+        event.wave.c = args[2];
+        addEvent(&event);
+        return true;
+    }
+    if (strcmp(command, "press") == 0 || strcmp(command, "release") == 0)
+    {
+        bool pressed = command[0] == 'p';
+        double bounceMs = DEFAULT_BOUNCE_MS;
+        int bounces = 0;
+        int i;
+
+        fields = sscanf(text, "%*f %*s %7s %d %lf", target, &bounces,
+                        &bounceMs);
+        if (fields < 1 || strcmp(target, "S1") != 0 || bounces < 0)
+        {
+            return false;
+        }
+        // Each bounce briefly returns to the old level before settling
+        event.kind = EVENT_PIN;
+        event.level = pressed;
+        addEvent(&event);
+        for (i = 1; i <= bounces; i++)
+        {
+            uint64_t at = event.nanos + (uint64_t) (i * bounceMs * NS_PER_MS);
+            InputEvent bounce = event;
+            bounce.nanos = at - (uint64_t) (bounceMs * NS_PER_MS / 2);
+            bounce.level = !pressed;
+            addEvent(&bounce);
+            bounce.nanos = at;
+            bounce.level = pressed;
+            addEvent(&bounce);
+        }
+        return true;
+    }
+    if (strcmp(command, "sensor") == 0)
+    {
+        char value[16];
+
+        if (sscanf(text, "%*f %*s %7s %15s", target, value) != 2)
+        {
+            return false;
+        }
+        if (strcmp(target, "temp") == 0)
+        {
+            event.channel = 0;
+        }
+        else if (strcmp(target, "light") == 0)
+        {
+            event.channel = 1;
+        }
+        else
+        {
+            return false;
+        }
+        event.kind = EVENT_SENSOR;
+        event.level = strcmp(value, "off") != 0;
+        if (event.level && sscanf(value, "%lf", &event.wave.a) != 1)
+        {
+            return false;
+        }
+        addEvent(&event);
+        return true;
+    }
+    if (strcmp(command, "replay") == 0)
+    {
+        char name[PATH_LENGTH];
+        return sscanf(text, "%*f %*s %255s", name) == 1
+                && loadCapture(name, event.nanos);
+    }
+    if (strcmp(command, "frames") == 0)
+    {
+        char name[PATH_LENGTH];
+        double untilMs;
+
+        if (sscanf(text, "%*f %*s %255s %lf", name, &untilMs) != 2
+                || untilMs * NS_PER_MS < event.nanos)
+        {
+            return false;
+        }
+        checkFrom = event.nanos * 1000;
+        checkUntil = (uint64_t) (untilMs * NS_PER_MS) * 1000;
+        return loadFrames(name);
+    }
+    fprintf(stderr, "line %d: unknown command %s\n", lineNumber, command);
+    return false;
+}
+
+/*!
+ * Loads a scenario file.
+ *
+ * \param path File name
+ *
+ * \return None, exits on errors
+ */
+static void loadScenario(const char *path)
+{
+    char text[256];
+    int lineNumber = 0;
+    bool hasEnd = false;
+    FILE *file = fopen(path, "r");
+    const char *slash = strrchr(path, '/');
+    int i;
+
+    if (slash != 0 && slash - path < PATH_LENGTH - 1)
+    {
+        memcpy(scenarioDir, path, slash - path + 1);
+    }
+    if (file == 0)
+    {
+        perror(path);
+        exit(2);
+    }
+    while (fgets(text, sizeof(text), file) != 0)
+    {
+        char *comment = strchr(text, '#');
+        lineNumber++;
+        if (comment != 0)
+        {
+            *comment = 0;
+        }
+        if (!parseLine(text, lineNumber))
+        {
+            fprintf(stderr, "%s:%d: invalid line\n", path, lineNumber);
+            exit(2);
+        }
+    }
+    fclose(file);
+
+    qsort(events, numEvents, sizeof(events[0]), compareEvents);
+    for (i = 0; i < numEvents; i++)
+    {
+        hasEnd |= events[i].kind == EVENT_END;
+    }
+    if (!hasEnd)
+    {
+        fprintf(stderr, "%s: no end command\n", path);
+        exit(2);
+    }
+}
+
+/*!
+ * Prints the final LCD contents, the timing summary, the violations and the
+ * result of the frame check.
+ *
+ * \return Number of LCD timing violations and frame mismatches
+ */
+static uint32_t report(clock_t hostTime)
+{
+    char line[HD44780_COLUMNS + 1];
+    uint32_t total = 0;
+    uint32_t i;
+
+    closeFrame();
+    printf("simulated %.3f ms, MCLK %lu Hz\n",
+           (double) Stub_getNanos() / NS_PER_MS,
+           (unsigned long) CS_getMCLK());
+    if (hostTime > 0)
+    {
+        double hostMs = (double) hostTime * 1000 / CLOCKS_PER_SEC;
+        printf("host %.1f ms, %.0fx real time\n", hostMs,
+               (double) Stub_getNanos() / NS_PER_MS / hostMs);
+    }
+    printf("bus reads %llu, writes %llu\n",
+           (unsigned long long) stubCounters.busReads,
+           (unsigned long long) stubCounters.busWrites);
+    if (uartFrames != 0)
+    {
+        printf("uart telemetry frames %u\n", uartFrames);
+    }
+    Hd44780_getLine(&lcd, 0, line);
+    printf("lcd  +----------------+\n     |%s|\n", line);
+    Hd44780_getLine(&lcd, 1, line);
+    printf("     |%s|\n     +----------------+\n", line);
+    printf("lcd instructions %u, data writes %u\n", lcd.instructions,
+           lcd.dataWrites);
+    statPrint("refresh duration", &frameTime);
+    statPrint("sample to display", &sampleLatency);
+
+    for (i = 0; i < HD44780_NUM_VIOLATIONS; i++)
+    {
+        total += lcd.violationCounts[i];
+    }
+    printf("lcd timing violations %u\n", total);
+    for (i = 0; i < lcd.numReports; i++)
+    {
+        const Hd44780_Violation *v = &lcd.reports[i];
+        printf("  %12.3f us  %-12s %s 0x%02x\n", (double) v->picos / PS_PER_US,
+               Hd44780_violationName(v->type), v->rs ? "data" : "ctrl",
+               v->value);
+    }
+    if (total > lcd.numReports)
+    {
+        printf("  ... %u more\n", total - lcd.numReports);
+    }
+    if (checkFrames)
+    {
+        // Expected frames that never came
+        while (nextExpected < numExpected)
+        {
+            reportMismatch(0, 0, &expectedFrames[nextExpected++]);
+        }
+        printf("frame mismatches %u of %d\n", frameMismatches, numExpected);
+    }
+    return total + frameMismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *scenario = 0;
+    clock_t hostStart;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-f") == 0)
+        {
+            printFrames = true;
+        }
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            quiet = true;
+        }
+        else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc)
+        {
+            uartFile = fopen(argv[++i], "wb");
+            if (uartFile == 0)
+            {
+                perror(argv[i]);
+                return 2;
+            }
+        }
+        else
+        {
+            scenario = argv[i];
+        }
+    }
+    if (scenario == 0)
+    {
+        fprintf(stderr, "usage: %s [-f] [-q] [-u file] scenario\n",
+                argv[0]);
+        return 2;
+    }
+    loadScenario(scenario);
+
+    Stub_reset();
+    lcd.onTransfer = lcdTransfer;
+    Hd44780_init(&lcd, 0);
+    stubHooks.update = update;
+    stubHooks.adcInput = adcInput;
+    stubHooks.adcDone = adcDone;
+    stubHooks.portWrite = portWrite;
+    stubHooks.uartByte = uartByte;
+    stubHooks.i2cStart = i2cStart;
+    stubHooks.i2cWrite = i2cWrite;
+    stubHooks.i2cRead = i2cRead;
+    stubHooks.i2cStop = i2cStop;
+    for (i = 0; i < 2; i++)
+    {
+        targets[i].address = i == 0 ? TMP102_ADDRESS : OPT3001_ADDRESS;
+        targets[i].connected = true;
+        resetSensor(i);
+    }
+    setSensor(0, 22.0);
+    setSensor(1, 300.0);
+    stubVectors[INT_ADC14] = ADC14_IRQHandler;
+    stubVectors[INT_T32_INT1] = T32_INT1_IRQHandler;
+    stubVectors[INT_TA2_0] = TA2_0_IRQHandler;
+    stubVectors[INT_EUSCIA0] = EUSCIA0_IRQHandler;
+    stubVectors[INT_EUSCIB0] = EUSCIB0_IRQHandler;
+    stubVectors[INT_DMA_INT1] = DMA_INT1_IRQHandler;
+    stubVectors[FAULT_PENDSV] = PendSV_Handler;
+
+    hostStart = clock();
+    if (setjmp(simEnd) == 0)
+    {
+        firmwareMain();
+    }
+    return report(clock() - hostStart) != 0;
+}
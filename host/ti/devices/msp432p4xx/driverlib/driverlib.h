@@ -0,0 +1,735 @@
+/*!
+ * driverlib.h
+ *      Description: Host stand-in for the MSP432 DriverLib and the CMSIS
+ *                   pieces the firmware uses, so the firmware sources build
+ *                   unmodified on Linux. Peripheral registers are plain
+ *                   structs; every DriverLib call counts the register reads
+ *                   and writes the real library performs and advances a
+ *                   virtual clock by the bus cycles they take. SysTick delays
+ *                   advance virtual time by their full length, so modeled
+ *                   time matches the target for delay-bound code.
+ *
+ *                   Timer32, Timer_A, ADC14, UART, the I2C master and the
+ *                   DMA raise their flags as virtual time passes. Once a simulator fills stubVectors,
+ *                   enabled interrupts are taken whenever PRIMASK allows and
+ *                   PCM_gotoLPM0 sleeps until the next one. Without vectors
+ *                   nothing is dispatched, which is what the benchmarks want.
+ *
+ *                   Only what the firmware calls is provided. Add functions
+ *                   here and in driverlib_stub.c as the firmware grows.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef DRIVERLIB_H_
+#define DRIVERLIB_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Lets code that touches registers directly call the access hooks below */
+#define STUB_DRIVERLIB      1
+
+//*****************************************************************************
+//
+// Stub accounting
+//
+//*****************************************************************************
+
+/* MCLK cycles per peripheral register access (AHB/APB bridge, no wait) */
+#define STUB_BUS_CYCLES     2
+/* Exception entry and exit, Cortex-M4F without FPU context */
+#define STUB_ISR_ENTRY_CYCLES   12
+#define STUB_ISR_EXIT_CYCLES    10
+/* DriverLib interrupt numbers, system exceptions included */
+#define STUB_NUM_INTERRUPTS     64
+/* Words in the stand-in for the linker's .stack section */
+#define STUB_STACK_WORDS        256
+
+typedef struct
+{
+    uint64_t busReads;      /* peripheral register reads */
+    uint64_t busWrites;     /* peripheral register writes */
+    uint64_t cycles;        /* virtual MCLK cycles */
+    uint64_t picos;         /* virtual time in picoseconds */
+} Stub_Counters;
+
+extern Stub_Counters stubCounters;
+
+/* Inputs the harness drives */
+extern uint16_t stubAdcResult[32];
+
+/* Simulator hooks, each may be 0 */
+typedef struct
+{
+    /* Applies inputs due at time now and returns ns until the next, 0 if none */
+    uint64_t (*update)(uint64_t nanos);
+    /* Returns the input of an ADC channel, default is stubAdcResult */
+    uint16_t (*adcInput)(uint32_t channel, uint64_t nanos);
+    /* Called when an ADC conversion completes */
+    void (*adcDone)(uint32_t memory, uint16_t result, uint64_t nanos);
+    /* Called after each GPIO output change */
+    void (*portWrite)(uint_fast8_t port, uint8_t out, uint64_t picos);
+    /* Called with each byte once the UART has sent it */
+    void (*uartByte)(uint8_t byte);
+    /* I2C target: a (repeated) start with its address, returns the ACK */
+    bool (*i2cStart)(uint8_t address, bool read);
+    /* I2C target: a byte written by the master, returns the ACK */
+    bool (*i2cWrite)(uint8_t byte);
+    /* I2C target: returns the next byte the master reads */
+    uint8_t (*i2cRead)(void);
+    /* I2C target: a stop */
+    void (*i2cStop)(void);
+} Stub_Hooks;
+
+extern Stub_Hooks stubHooks;
+
+/* Handlers by DriverLib interrupt number, filled by a simulator */
+extern void (*stubVectors[STUB_NUM_INTERRUPTS])(void);
+
+/* Handler stack memory, code runs on the host stack */
+extern uint32_t stubStack[STUB_STACK_WORDS];
+
+/*!
+ * \brief This function returns the stub to its power-on state
+ *
+ * This function clears the counters, virtual time and peripheral state.
+ * Hooks and vectors are kept.
+ *
+ * \return None
+ */
+extern void Stub_reset(void);
+
+/*!
+ * \brief This function advances virtual time
+ *
+ * This function moves time in steps that end on each peripheral or hook
+ * event and takes pending interrupts between steps.
+ *
+ * \param cycles is the number of MCLK cycles to advance
+ *
+ * \return None
+ */
+extern void Stub_advance(uint64_t cycles);
+
+/*!
+ * \brief This function counts register accesses and their bus time
+ *
+ * \param reads is the number of register reads
+ * \param writes is the number of register writes
+ *
+ * \return None
+ */
+extern void Stub_bus(uint32_t reads, uint32_t writes);
+
+/*!
+ * \brief This function reports a direct write of a port output register
+ *
+ * \param port is the port number, 1 - 10
+ *
+ * \return None
+ */
+extern void Stub_portWritten(uint_fast8_t port);
+
+/*!
+ * \brief This function reports direct writes of Timer_A registers
+ *
+ * This function starts or stops the modeled counter from the MC bits of CTL,
+ * and restarts its phase on TACLR or a new CCR0.
+ *
+ * \param instance is the Timer_A instance, 0 - 3
+ *
+ * \return None
+ */
+extern void Stub_timerAWritten(int instance);
+
+/*!
+ * \brief This function reports a direct read of an ADC14 result register
+ *
+ * Reading a result clears its interrupt flag, as on the hardware.
+ *
+ * \param memory is the conversion memory, 0 - 31
+ *
+ * \return None
+ */
+extern void Stub_adcResultRead(uint32_t memory);
+
+/*!
+ * \brief This function returns virtual time
+ *
+ * \return Virtual time in nanoseconds
+ */
+extern uint64_t Stub_getNanos(void);
+
+//*****************************************************************************
+//
+// CMSIS core
+//
+//*****************************************************************************
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+    volatile uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+    volatile uint32_t CFSR;
+    volatile uint32_t MMFAR;
+} SCB_Type;
+
+extern SysTick_Type stubSysTick;
+extern CoreDebug_Type stubCoreDebug;
+extern SCB_Type stubScb;
+extern DWT_Type *Stub_dwt(void);
+
+#define SysTick             (&stubSysTick)
+#define DWT                 (Stub_dwt())
+#define CoreDebug           (&stubCoreDebug)
+#define SCB                 (&stubScb)
+
+#define SysTick_CTRL_COUNTFLAG_Msk  (1UL << 16)
+#define SysTick_CTRL_ENABLE_Msk     (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+#define CONTROL_SPSEL_Msk           (1UL << 1)
+
+#define __DMB()             __sync_synchronize()
+#define __ISB()             __sync_synchronize()
+#define __CLZ(x)            ((uint32_t) ((x) ? __builtin_clz(x) : 32))
+
+extern uint32_t __get_PRIMASK(void);
+extern void __set_PRIMASK(uint32_t primask);
+extern void __disable_irq(void);
+extern void __enable_irq(void);
+extern uint32_t __get_BASEPRI(void);
+extern void __set_BASEPRI(uint32_t basePri);
+extern uint32_t __get_MSP(void);
+extern void __set_PSP(uint32_t topOfProcStack);
+extern uint32_t __get_CONTROL(void);
+extern void __set_CONTROL(uint32_t control);
+
+//*****************************************************************************
+//
+// Device registers
+//
+//*****************************************************************************
+
+typedef struct
+{
+    volatile uint8_t IN;
+    volatile uint8_t OUT;
+    volatile uint8_t DIR;
+    volatile uint8_t REN;
+    volatile uint8_t SEL0;
+    volatile uint8_t SEL1;
+} DIO_PORT_Type;
+
+typedef struct
+{
+    volatile uint16_t CTL;
+    volatile uint16_t CCTL[7];
+    volatile uint16_t R;
+    volatile uint16_t CCR[7];
+} Timer_A_Type;
+
+typedef struct
+{
+    volatile uint32_t LOAD;
+    volatile uint32_t VALUE;
+    volatile uint32_t CONTROL;
+    volatile uint32_t INTCLR;
+    volatile uint32_t RIS;
+    volatile uint32_t MIS;
+    volatile uint32_t BGLOAD;
+} Timer32_Type;
+
+typedef struct
+{
+    volatile uint32_t CTL0;
+    volatile uint32_t CTL1;
+    volatile uint32_t MCTL[32];
+    volatile uint32_t MEM[32];
+    volatile uint32_t IER0;
+    volatile uint32_t IFGR0;
+} ADC14_Type;
+
+/* Index 1 to 10 are P1 to P10 */
+extern DIO_PORT_Type stubPorts[11];
+extern Timer_A_Type *Stub_timerA(int instance);
+/* Same registers without charging a read, for code that counts its own */
+extern Timer_A_Type *Stub_timerARegs(int instance);
+extern Timer32_Type *Stub_timer32(int instance);
+extern ADC14_Type stubAdc14;
+
+#define P1                  (&stubPorts[1])
+#define P2                  (&stubPorts[2])
+#define P3                  (&stubPorts[3])
+#define P4                  (&stubPorts[4])
+#define P5                  (&stubPorts[5])
+#define P6                  (&stubPorts[6])
+#define P7                  (&stubPorts[7])
+#define P8                  (&stubPorts[8])
+#define P9                  (&stubPorts[9])
+#define P10                 (&stubPorts[10])
+#define TIMER_A0            (Stub_timerA(0))
+#define TIMER_A1            (Stub_timerA(1))
+#define TIMER_A2            (Stub_timerA(2))
+#define TIMER_A3            (Stub_timerA(3))
+#define TIMER32_1           (Stub_timer32(0))
+#define TIMER32_2           (Stub_timer32(1))
+#define ADC14               (&stubAdc14)
+
+/* Interrupt numbers */
+#define FAULT_PENDSV        14
+#define INT_TA0_0           24
+#define INT_TA1_0           26
+#define INT_TA2_0           28
+#define INT_TA3_0           30
+#define INT_EUSCIA0         32
+#define INT_EUSCIB0         36
+#define INT_ADC14           40
+#define INT_T32_INT1        41
+#define INT_T32_INT2        42
+#define INT_DMA_INT1        49
+#define INT_PORT1           51
+
+//*****************************************************************************
+//
+// GPIO
+//
+//*****************************************************************************
+
+#define GPIO_PORT_P1        1
+#define GPIO_PORT_P2        2
+#define GPIO_PORT_P3        3
+#define GPIO_PORT_P4        4
+#define GPIO_PORT_P5        5
+#define GPIO_PORT_P6        6
+#define GPIO_PORT_P7        7
+#define GPIO_PORT_P8        8
+#define GPIO_PORT_P9        9
+#define GPIO_PORT_P10       10
+
+#define GPIO_PIN0           0x0001
+#define GPIO_PIN1           0x0002
+#define GPIO_PIN2           0x0004
+#define GPIO_PIN3           0x0008
+#define GPIO_PIN4           0x0010
+#define GPIO_PIN5           0x0020
+#define GPIO_PIN6           0x0040
+#define GPIO_PIN7           0x0080
+#define PIN_ALL8            0x00FF
+
+#define GPIO_PRIMARY_MODULE_FUNCTION    0x01
+#define GPIO_SECONDARY_MODULE_FUNCTION  0x02
+#define GPIO_TERTIARY_MODULE_FUNCTION   0x03
+
+#define GPIO_INPUT_PIN_LOW  0
+#define GPIO_INPUT_PIN_HIGH 1
+
+extern void GPIO_setAsOutputPin(uint_fast8_t port, uint_fast16_t pins);
+extern void GPIO_setAsInputPinWithPullUpResistor(uint_fast8_t port,
+                                                 uint_fast16_t pins);
+extern void GPIO_setAsPeripheralModuleFunctionInputPin(uint_fast8_t port,
+                                                       uint_fast16_t pins,
+                                                       uint_fast8_t mode);
+extern void GPIO_setOutputHighOnPin(uint_fast8_t port, uint_fast16_t pins);
+extern void GPIO_setOutputLowOnPin(uint_fast8_t port, uint_fast16_t pins);
+extern uint8_t GPIO_getInputPinValue(uint_fast8_t port, uint_fast16_t pins);
+extern void GPIO_enableInterrupt(uint_fast8_t port, uint_fast16_t pins);
+extern void GPIO_clearInterruptFlag(uint_fast8_t port, uint_fast16_t pins);
+extern uint_fast16_t GPIO_getEnabledInterruptStatus(uint_fast8_t port);
+
+//*****************************************************************************
+//
+// Clock system, power control, flash controller, watchdog, FPU
+//
+//*****************************************************************************
+
+#define CS_DCO_FREQUENCY_1_5    0
+#define CS_DCO_FREQUENCY_3      1
+#define CS_DCO_FREQUENCY_6      2
+#define CS_DCO_FREQUENCY_12     3
+#define CS_DCO_FREQUENCY_24     4
+#define CS_DCO_FREQUENCY_48     5
+
+#define CS_MCLK                 0x01
+#define CS_HSMCLK               0x02
+#define CS_SMCLK                0x04
+#define CS_DCOCLK_SELECT        0x03
+
+#define CS_CLOCK_DIVIDER_1      0
+#define CS_CLOCK_DIVIDER_2      1
+#define CS_CLOCK_DIVIDER_4      2
+#define CS_CLOCK_DIVIDER_8      3
+#define CS_CLOCK_DIVIDER_16     4
+#define CS_CLOCK_DIVIDER_32     5
+#define CS_CLOCK_DIVIDER_64     6
+#define CS_CLOCK_DIVIDER_128    7
+
+#define PCM_VCORE0              0
+#define PCM_VCORE1              1
+
+#define FLASH_BANK0             0x00
+#define FLASH_BANK1             0x01
+#define FLASH_DATA_READ         0x01
+#define FLASH_INSTRUCTION_FETCH 0x02
+
+extern void CS_setDCOCenteredFrequency(uint32_t dcoFreq);
+extern void CS_initClockSignal(uint32_t selectedClockSignal,
+                               uint32_t clockSource,
+                               uint32_t clockSourceDivider);
+extern uint32_t CS_getMCLK(void);
+extern uint32_t CS_getSMCLK(void);
+extern bool PCM_setCoreVoltageLevel(uint_fast8_t voltageLevel);
+extern bool PCM_gotoLPM0(void);
+extern bool FlashCtl_setWaitState(uint32_t bank, uint32_t waitState);
+extern void FlashCtl_enableReadBuffering(uint_fast8_t memoryBank,
+                                         uint_fast8_t accessMethod);
+extern void FlashCtl_disableReadBuffering(uint_fast8_t memoryBank,
+                                          uint_fast8_t accessMethod);
+extern void WDT_A_holdTimer(void);
+extern void FPU_enableModule(void);
+extern void FPU_enableLazyStacking(void);
+
+//*****************************************************************************
+//
+// Interrupt controller
+//
+//*****************************************************************************
+
+extern void Interrupt_enableInterrupt(uint32_t interruptNumber);
+extern void Interrupt_disableInterrupt(uint32_t interruptNumber);
+extern bool Interrupt_enableMaster(void);
+extern bool Interrupt_disableMaster(void);
+extern void Interrupt_setPriority(uint32_t interruptNumber,
+                                  uint8_t priority);
+extern void Interrupt_pendInterrupt(uint32_t interruptNumber);
+
+//*****************************************************************************
+//
+// MPU, regions are recorded but never checked
+//
+//*****************************************************************************
+
+#define MPU_CONFIG_PRIV_DEFAULT     0x00000004
+#define MPU_RGN_SIZE_32B            (4 << 1)
+#define MPU_RGN_PERM_NOEXEC         0x10000000
+#define MPU_RGN_PERM_PRV_NO_USR_NO  0x00000000
+#define MPU_RGN_ENABLE              1
+
+extern void MPU_enableModule(uint32_t mpuConfig);
+extern void MPU_setRegion(uint32_t region, uint32_t addr, uint32_t flags);
+extern void MPU_enableInterrupt(void);
+
+//*****************************************************************************
+//
+// ADC14
+//
+//*****************************************************************************
+
+#define ADC_CLOCKSOURCE_MCLK            0x0A000000
+#define ADC_PREDIVIDER_1                0x00000000
+#define ADC_PREDIVIDER_4                0x40000000
+#define ADC_DIVIDER_1                   0x00000000
+#define ADC_DIVIDER_2                   0x00400000
+#define ADC_DIVIDER_3                   0x00800000
+#define ADC_DIVIDER_4                   0x00C00000
+#define ADC_DIVIDER_5                   0x01000000
+#define ADC_DIVIDER_6                   0x01400000
+#define ADC_DIVIDER_7                   0x01800000
+#define ADC_DIVIDER_8                   0x01C00000
+
+#define ADC_MEM14                       14
+#define ADC_MEM15                       15
+#define ADC_INPUT_A14                   14
+#define ADC_INPUT_A15                   15
+#define ADC_VREFPOS_AVCC_VREFNEG_VSS    0
+#define ADC_MANUAL_ITERATION            0
+#define ADC_AUTOMATIC_ITERATION         1
+#define ADC_TRIGGER_ADCSC               0x00000000
+#define ADC_TRIGGER_SOURCE1             0x08000000
+#define ADC_TRIGGER_SOURCE3             0x18000000
+#define ADC_TRIGGER_SOURCE5             0x28000000
+#define ADC_TRIGGER_SOURCE7             0x38000000
+
+#define ADC_INT14                       (1ULL << 14)
+#define ADC_INT15                       (1ULL << 15)
+
+#define ADC_PULSE_WIDTH_4               0
+#define ADC_PULSE_WIDTH_8               1
+#define ADC_PULSE_WIDTH_16              2
+#define ADC_PULSE_WIDTH_32              3
+#define ADC_PULSE_WIDTH_64              4
+#define ADC_PULSE_WIDTH_96              5
+#define ADC_PULSE_WIDTH_128             6
+#define ADC_PULSE_WIDTH_192             7
+
+extern bool ADC14_enableModule(void);
+extern bool ADC14_initModule(uint32_t clockSource, uint32_t clockPredivider,
+                             uint32_t clockDivider, uint32_t internalChannelMask);
+extern bool ADC14_configureMultiSequenceMode(uint32_t memoryStart,
+                                             uint32_t memoryEnd,
+                                             bool repeatMode);
+extern bool ADC14_configureConversionMemory(uint32_t memorySelect,
+                                            uint32_t refSelect,
+                                            uint32_t channelSelect,
+                                            bool differntialMode);
+extern bool ADC14_setSampleHoldTime(uint32_t firstPulseWidth,
+                                    uint32_t secondPulseWidth);
+extern bool ADC14_enableSampleTimer(uint32_t multiSampleConvert);
+extern bool ADC14_setSampleHoldTrigger(uint32_t source, bool invertSignal);
+extern bool ADC14_enableConversion(void);
+extern void ADC14_disableConversion(void);
+extern bool ADC14_toggleConversionTrigger(void);
+extern void ADC14_enableInterrupt(uint_fast64_t mask);
+extern uint_fast64_t ADC14_getEnabledInterruptStatus(void);
+extern void ADC14_clearInterruptFlag(uint_fast64_t mask);
+extern uint_fast16_t ADC14_getResult(uint32_t memorySelect);
+
+#define MAP_ADC14_getEnabledInterruptStatus ADC14_getEnabledInterruptStatus
+#define MAP_ADC14_clearInterruptFlag        ADC14_clearInterruptFlag
+#define MAP_ADC14_getResult                 ADC14_getResult
+
+//*****************************************************************************
+//
+// Timer32
+//
+//*****************************************************************************
+
+#define TIMER32_0_BASE          0x4000C000
+#define TIMER32_1_BASE          0x4000C020
+#define TIMER32_PRESCALER_1     0x00
+#define TIMER32_16BIT           0x00
+#define TIMER32_32BIT           0x01
+#define TIMER32_FREE_RUN_MODE   0x00
+#define TIMER32_PERIODIC_MODE   0x40
+
+extern void Timer32_initModule(uint32_t timer, uint32_t preScaler,
+                               uint32_t resolution, uint32_t mode);
+extern void Timer32_setCount(uint32_t timer, uint32_t count);
+extern uint32_t Timer32_getValue(uint32_t timer);
+extern void Timer32_startTimer(uint32_t timer, bool oneShot);
+extern void Timer32_enableInterrupt(uint32_t timer);
+extern void Timer32_clearInterruptFlag(uint32_t timer);
+
+//*****************************************************************************
+//
+// Timer_A
+//
+//*****************************************************************************
+
+#define TIMER_A0_BASE                       0x40000000
+#define TIMER_A1_BASE                       0x40000400
+#define TIMER_A2_BASE                       0x40000800
+#define TIMER_A3_BASE                       0x40000C00
+#define TIMER_A_CLOCKSOURCE_SMCLK           0x0200
+#define TIMER_A_CLOCKSOURCE_DIVIDER_1       0x01
+#define TIMER_A_TAIE_INTERRUPT_DISABLE      0x00
+#define TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE  0x10
+#define TIMER_A_CCIE_CCR0_INTERRUPT_DISABLE 0x00
+#define TIMER_A_DO_CLEAR                    0x04
+#define TIMER_A_UP_MODE                     0x10
+#define TIMER_A_CAPTURECOMPARE_REGISTER_0   0x02
+#define TIMER_A_CAPTURECOMPARE_REGISTER_1   0x04
+#define TIMER_A_CAPTURECOMPARE_INTERRUPT_DISABLE 0x00
+#define TIMER_A_OUTPUTMODE_SET_RESET        0x60
+
+typedef struct
+{
+    uint_fast16_t clockSource;
+    uint_fast16_t clockSourceDivider;
+    uint_fast16_t timerPeriod;
+    uint_fast16_t timerInterruptEnable_TAIE;
+    uint_fast16_t captureCompareInterruptEnable_CCR0_CCIE;
+    uint_fast16_t timerClear;
+} Timer_A_UpModeConfig;
+
+typedef struct
+{
+    uint_fast16_t compareRegister;
+    uint_fast16_t compareInterruptEnable;
+    uint_fast16_t compareOutputMode;
+    uint_fast16_t compareValue;
+} Timer_A_CompareModeConfig;
+
+extern void Timer_A_configureUpMode(uint32_t timer,
+                                    const Timer_A_UpModeConfig *config);
+extern void Timer_A_initCompare(uint32_t timer,
+                                const Timer_A_CompareModeConfig *config);
+extern void Timer_A_startCounter(uint32_t timer, uint_fast16_t timerMode);
+extern void Timer_A_stopTimer(uint32_t timer);
+extern void Timer_A_clearTimer(uint32_t timer);
+extern void Timer_A_setCompareValue(uint32_t timer,
+                                    uint_fast16_t compareRegister,
+                                    uint_fast16_t compareValue);
+extern void Timer_A_clearCaptureCompareInterrupt(uint32_t timer,
+                                                 uint_fast16_t captureCompareRegister);
+
+//*****************************************************************************
+//
+// eUSCI_A UART
+//
+//*****************************************************************************
+
+#define EUSCI_A0_BASE                                   0x40001000
+#define EUSCI_A_UART_CLOCKSOURCE_SMCLK                  0x80
+#define EUSCI_A_UART_NO_PARITY                          0x00
+#define EUSCI_A_UART_LSB_FIRST                          0x00
+#define EUSCI_A_UART_ONE_STOP_BIT                       0x00
+#define EUSCI_A_UART_MODE                               0x00
+#define EUSCI_A_UART_8_BIT_LEN                          0x00
+#define EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION   0x01
+#define EUSCI_A_UART_LOW_FREQUENCY_BAUDRATE_GENERATION  0x00
+#define EUSCI_A_UART_BUSY                               0x01
+#define EUSCI_A_UART_TRANSMIT_INTERRUPT                 0x02
+
+typedef struct
+{
+    uint_fast8_t selectClockSource;
+    uint_fast16_t clockPrescalar;
+    uint_fast8_t firstModReg;
+    uint_fast8_t secondModReg;
+    uint_fast8_t parity;
+    uint_fast16_t msborLsbFirst;
+    uint_fast16_t numberofStopBits;
+    uint_fast16_t uartMode;
+    uint_fast8_t overSampling;
+    uint_fast16_t dataLength;
+} eUSCI_UART_ConfigV1;
+
+extern bool UART_initModule(uint32_t moduleInstance,
+                            const eUSCI_UART_ConfigV1 *config);
+extern void UART_enableModule(uint32_t moduleInstance);
+extern uint_fast8_t UART_queryStatusFlags(uint32_t moduleInstance,
+                                          uint_fast8_t mask);
+extern void UART_enableInterrupt(uint32_t moduleInstance, uint_fast8_t mask);
+extern void UART_disableInterrupt(uint32_t moduleInstance, uint_fast8_t mask);
+extern void UART_transmitData(uint32_t moduleInstance,
+                              uint_fast8_t transmitData);
+
+//*****************************************************************************
+//
+// eUSCI_B I2C master
+//
+//*****************************************************************************
+
+#define EUSCI_B0_BASE                       0x40002000
+#define EUSCI_B_I2C_CLOCKSOURCE_SMCLK       0x80
+#define EUSCI_B_I2C_NO_AUTO_STOP            0x00
+#define EUSCI_B_I2C_TRANSMIT_MODE           0x10
+#define EUSCI_B_I2C_RECEIVE_MODE            0x00
+#define EUSCI_B_I2C_SENDING_START           0x02
+#define EUSCI_B_I2C_START_SEND_COMPLETE     0x00
+
+#define EUSCI_B_I2C_RECEIVE_INTERRUPT0      0x0001
+#define EUSCI_B_I2C_TRANSMIT_INTERRUPT0     0x0002
+#define EUSCI_B_I2C_STOP_INTERRUPT          0x0008
+#define EUSCI_B_I2C_NAK_INTERRUPT           0x0020
+
+typedef struct
+{
+    uint_fast8_t selectClockSource;
+    uint32_t i2cClk;
+    uint32_t dataRate;
+    uint_fast8_t byteCounterThreshold;
+    uint_fast8_t autoSTOPGeneration;
+} eUSCI_I2C_MasterConfig;
+
+extern void I2C_initMaster(uint32_t moduleInstance,
+                           const eUSCI_I2C_MasterConfig *config);
+extern void I2C_enableModule(uint32_t moduleInstance);
+extern void I2C_setSlaveAddress(uint32_t moduleInstance,
+                                uint_fast16_t slaveAddress);
+extern void I2C_setMode(uint32_t moduleInstance, uint_fast8_t mode);
+extern void I2C_masterSendStart(uint32_t moduleInstance);
+extern uint_fast8_t I2C_masterIsStartSent(uint32_t moduleInstance);
+extern void I2C_masterSendMultiByteStop(uint32_t moduleInstance);
+extern void I2C_masterReceiveMultiByteStop(uint32_t moduleInstance);
+extern uint8_t I2C_masterReceiveMultiByteNext(uint32_t moduleInstance);
+extern uint32_t I2C_getReceiveBufferAddressForDMA(uint32_t moduleInstance);
+extern uint32_t I2C_getTransmitBufferAddressForDMA(uint32_t moduleInstance);
+extern void I2C_enableInterrupt(uint32_t moduleInstance, uint_fast16_t mask);
+extern void I2C_disableInterrupt(uint32_t moduleInstance, uint_fast16_t mask);
+extern void I2C_clearInterruptFlag(uint32_t moduleInstance,
+                                   uint_fast16_t mask);
+extern uint_fast16_t I2C_getEnabledInterruptStatus(uint32_t moduleInstance);
+
+//*****************************************************************************
+//
+// DMA, basic mode transfers triggered by eUSCI_B0
+//
+//*****************************************************************************
+
+#define DMA_CH0_EUSCIB0TX0      0x01000000
+#define DMA_CH1_EUSCIB0RX0      0x01000001
+#define DMA_INT1                INT_DMA_INT1
+
+#define UDMA_PRI_SELECT         0x00000000
+#define UDMA_MODE_BASIC         0x00000001
+#define UDMA_SIZE_8             0x00000000
+#define UDMA_SRC_INC_8          0x00000000
+#define UDMA_SRC_INC_NONE       0x0c000000
+#define UDMA_DST_INC_8          0x00000000
+#define UDMA_DST_INC_NONE       0xc0000000
+#define UDMA_ARB_1              0x00000000
+
+extern void DMA_enableModule(void);
+extern void DMA_setControlBase(void *controlTable);
+extern void DMA_assignChannel(uint32_t mapping);
+extern void DMA_setChannelControl(uint32_t channelStructIndex,
+                                  uint32_t control);
+extern void DMA_setChannelTransfer(uint32_t channelStructIndex,
+                                   uint32_t mode, void *srcAddr,
+                                   void *dstAddr, uint32_t transferSize);
+extern void DMA_enableChannel(uint32_t channelNum);
+extern void DMA_disableChannel(uint32_t channelNum);
+extern void DMA_assignInterrupt(uint32_t interruptNumber, uint32_t channel);
+extern void DMA_enableInterrupt(uint32_t interruptNumber);
+extern void DMA_clearInterruptFlag(uint32_t intChannel);
+
+//*****************************************************************************
+//
+// SysTick
+//
+//*****************************************************************************
+
+extern void SysTick_enableModule(void);
+extern void SysTick_disableModule(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DRIVERLIB_H_ */
@@ -0,0 +1,410 @@
+/*!
+ * i2cbus.c
+ *      Description: Helper file for the asynchronous I2C master. Each
+ *                   transaction is a short chain of interrupts:
+ *
+ *                   write   DMA channel 0 feeds TXBUF from writeData on
+ *                           TXIFG. DMA_INT1 then enables TXIFG for the CPU,
+ *                           which is next set once the last byte is in the
+ *                           shift register; it issues a repeated start for
+ *                           the read, or STOP.
+ *                   read    DMA channel 1 empties RXBUF into readData for
+ *                           all but the last two bytes. The CPU takes those
+ *                           two on RXIFG and sets STOP before reading the
+ *                           second to last, so the last one is NACKed. The
+ *                           eUSCI holds SCL while RXBUF is full, so a late
+ *                           interrupt only slows the bus down.
+ *                   end     STOP or a NACK (followed by STOP) finishes the
+ *                           transaction in the STOP interrupt, which starts
+ *                           the next one and requests the callbacks.
+ *
+ *                   The bit rate divider is set for CLOCK_SMCLK_MAX, so the
+ *                   bus never runs faster than I2CBUS_RATE_HZ. In the
+ *                   profiles with a slower SMCLK it runs slower instead and
+ *                   no clock listener is needed.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+
+#include "i2cbus.h"
+#include "clock.h"
+#include "defer.h"
+#include "priorities.h"
+#include "instrument.h"
+
+#define DMA_TX_CHANNEL      0
+#define DMA_RX_CHANNEL      1
+
+/* Primary and alternate control structures of the 8 DMA channels, the
+ * controller needs the table aligned to its size */
+#define DMA_TABLE_SIZE      256
+
+static uint8_t dmaControlTable[DMA_TABLE_SIZE]
+        __attribute__((aligned(DMA_TABLE_SIZE)));
+
+/* Submitted transactions, the head is on the bus. Changed by the STOP
+ * interrupt and by I2cBus_submit with interrupts masked. */
+static I2cBus_Transaction *queueHead;
+static I2cBus_Transaction *queueTail;
+/* Finished transactions waiting for their callbacks */
+static I2cBus_Transaction *doneHead;
+static I2cBus_Transaction *doneTail;
+
+/* State of the transaction on the bus, owned by the bus interrupts */
+static uint8_t rxIndex;
+static uint8_t dmaChannel;
+static bool nacked;
+
+static int doneWork = DEFER_INVALID_WORK;
+
+/* Bus statistics, written by the STOP interrupt */
+static volatile uint32_t transactions;
+static volatile uint32_t nacks;
+static volatile uint32_t bytes;
+
+/*!
+ * Starts the DMA channel of a phase, its completion is DMA_INT1.
+ *
+ * \param channel DMA_TX_CHANNEL or DMA_RX_CHANNEL
+ * \param mapping Channel and trigger source, DMA_CHn_x
+ * \param source Source address
+ * \param destination Destination address
+ * \param count Number of bytes
+ *
+ * \return None
+ */
+static void startDma(uint8_t channel, uint32_t mapping, void *source,
+                     void *destination, uint32_t count)
+{
+    dmaChannel = channel;
+    DMA_setChannelTransfer(UDMA_PRI_SELECT | mapping, UDMA_MODE_BASIC, source,
+                           destination, count);
+    DMA_assignInterrupt(DMA_INT1, channel);
+    DMA_enableChannel(channel);
+}
+
+/*!
+ * Sends a start in receive mode, a repeated start if the write came first.
+ *
+ * \param transaction Transaction on the bus, readLength is not 0
+ *
+ * \return None
+ */
+static void startRead(I2cBus_Transaction *transaction)
+{
+    rxIndex = 0;
+    I2C_setMode(EUSCI_B0_BASE, EUSCI_B_I2C_RECEIVE_MODE);
+    if (transaction->readLength > 2)
+    {
+        rxIndex = transaction->readLength - 2;
+        startDma(DMA_RX_CHANNEL, DMA_CH1_EUSCIB0RX0,
+                 (void *) (uintptr_t) I2C_getReceiveBufferAddressForDMA(
+                         EUSCI_B0_BASE),
+                 transaction->readData, rxIndex);
+    }
+    else
+    {
+        I2C_enableInterrupt(EUSCI_B0_BASE, EUSCI_B_I2C_RECEIVE_INTERRUPT0);
+    }
+    I2C_masterSendStart(EUSCI_B0_BASE);
+
+    // STOP after a single byte must be set while the address is on the bus
+    if (transaction->readLength == 1)
+    {
+        while (I2C_masterIsStartSent(EUSCI_B0_BASE) == EUSCI_B_I2C_SENDING_START)
+        {
+        }
+        I2C_masterReceiveMultiByteStop(EUSCI_B0_BASE);
+    }
+}
+
+/*!
+ * Puts a transaction on the idle bus.
+ *
+ * \param transaction Head of the queue
+ *
+ * \return None
+ */
+static void startTransaction(I2cBus_Transaction *transaction)
+{
+    nacked = false;
+    I2C_setSlaveAddress(EUSCI_B0_BASE, transaction->address);
+    if (transaction->writeLength == 0)
+    {
+        startRead(transaction);
+        return;
+    }
+    startDma(DMA_TX_CHANNEL, DMA_CH0_EUSCIB0TX0,
+             (void *) transaction->writeData,
+             (void *) (uintptr_t) I2C_getTransmitBufferAddressForDMA(
+                     EUSCI_B0_BASE),
+             transaction->writeLength);
+    I2C_setMode(EUSCI_B0_BASE, EUSCI_B_I2C_TRANSMIT_MODE);
+    I2C_masterSendStart(EUSCI_B0_BASE);
+}
+
+/*!
+ * Moves the transaction on the bus to the done list and starts the next one.
+ * Runs in the STOP interrupt.
+ *
+ * \return None
+ */
+static void finishTransaction(void)
+{
+    I2cBus_Transaction *transaction = queueHead;
+
+    if (transaction == 0)
+    {
+        return;
+    }
+    transaction->result = nacked ? I2CBUS_NACK : I2CBUS_DONE;
+    transactions++;
+    if (nacked)
+    {
+        nacks++;
+    }
+    else
+    {
+        bytes += transaction->writeLength + transaction->readLength;
+    }
+
+    queueHead = transaction->next;
+    if (queueHead == 0)
+    {
+        queueTail = 0;
+    }
+    transaction->next = 0;
+    if (doneTail != 0)
+    {
+        doneTail->next = transaction;
+    }
+    else
+    {
+        doneHead = transaction;
+    }
+    doneTail = transaction;
+
+    if (queueHead != 0)
+    {
+        startTransaction(queueHead);
+    }
+    Defer_request(doneWork);
+}
+
+/*!
+ * Runs the callbacks of finished transactions, as the "i2c" deferred work.
+ *
+ * \return None
+ */
+static void runCallbacks(void)
+{
+    I2cBus_Transaction *transaction;
+    uint32_t primask;
+
+    while (1)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        transaction = doneHead;
+        if (transaction != 0)
+        {
+            doneHead = transaction->next;
+            if (doneHead == 0)
+            {
+                doneTail = 0;
+            }
+        }
+        __set_PRIMASK(primask);
+        if (transaction == 0)
+        {
+            return;
+        }
+
+        // From here the callback may submit it again
+        transaction->status = transaction->result;
+        if (transaction->done != 0)
+        {
+            transaction->done(transaction);
+        }
+    }
+}
+
+void I2cBus_init(void)
+{
+    const eUSCI_I2C_MasterConfig config = { EUSCI_B_I2C_CLOCKSOURCE_SMCLK,
+                                            CLOCK_SMCLK_MAX, I2CBUS_RATE_HZ,
+                                            0, EUSCI_B_I2C_NO_AUTO_STOP };
+
+    queueHead = 0;
+    queueTail = 0;
+    doneHead = 0;
+    doneTail = 0;
+    doneWork = Defer_add("i2c", runCallbacks);
+
+    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P1,
+                                               GPIO_PIN6 | GPIO_PIN7,
+                                               GPIO_PRIMARY_MODULE_FUNCTION);
+    I2C_initMaster(EUSCI_B0_BASE, &config);
+    I2C_enableModule(EUSCI_B0_BASE);
+    I2C_clearInterruptFlag(EUSCI_B0_BASE,
+                           EUSCI_B_I2C_NAK_INTERRUPT
+                                   | EUSCI_B_I2C_STOP_INTERRUPT);
+    I2C_enableInterrupt(EUSCI_B0_BASE,
+                        EUSCI_B_I2C_NAK_INTERRUPT | EUSCI_B_I2C_STOP_INTERRUPT);
+    Interrupt_setPriority(INT_EUSCIB0, PRIORITY_EUSCIB0);
+    Interrupt_enableInterrupt(INT_EUSCIB0);
+
+    DMA_enableModule();
+    DMA_setControlBase(dmaControlTable);
+    DMA_assignChannel(DMA_CH0_EUSCIB0TX0);
+    DMA_assignChannel(DMA_CH1_EUSCIB0RX0);
+    DMA_setChannelControl(UDMA_PRI_SELECT | DMA_CH0_EUSCIB0TX0,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE
+                                  | UDMA_ARB_1);
+    DMA_setChannelControl(UDMA_PRI_SELECT | DMA_CH1_EUSCIB0RX0,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8
+                                  | UDMA_ARB_1);
+    Interrupt_setPriority(DMA_INT1, PRIORITY_DMA_INT1);
+    DMA_enableInterrupt(DMA_INT1);
+}
+
+bool I2cBus_submit(I2cBus_Transaction *transaction)
+{
+    uint32_t primask;
+    bool idle;
+
+    if (transaction->status == I2CBUS_PENDING
+            || (transaction->writeLength == 0 && transaction->readLength == 0))
+    {
+        return false;
+    }
+    transaction->status = I2CBUS_PENDING;
+    transaction->next = 0;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    idle = queueHead == 0;
+    if (idle)
+    {
+        queueHead = transaction;
+    }
+    else
+    {
+        queueTail->next = transaction;
+    }
+    queueTail = transaction;
+    __set_PRIMASK(primask);
+
+    // Nothing else starts a transaction on the idle bus
+    if (idle)
+    {
+        startTransaction(transaction);
+    }
+    return true;
+}
+
+bool I2cBus_isBusy(const I2cBus_Transaction *transaction)
+{
+    return transaction->status == I2CBUS_PENDING;
+}
+
+void I2cBus_report(void (*write)(const char *line))
+{
+    char line[80];
+
+    sprintf(line, "i2c %lu transactions, %lu NACKed, %lu bytes",
+            (unsigned long) transactions, (unsigned long) nacks,
+            (unsigned long) bytes);
+    write(line);
+}
+
+/* !
+ * \brief This function ends a DMA phase
+ *
+ * This function hands the end of the write to the TXIFG interrupt, and the
+ * last two bytes of the read to the RXIFG interrupt.
+ *
+ * \return None
+ */
+void DMA_INT1_IRQHandler(void)
+{
+    INSTR_ISR_ENTER(INSTR_ISR_DMA_INT1);
+    DMA_clearInterruptFlag(dmaChannel);
+    if (dmaChannel == DMA_TX_CHANNEL)
+    {
+        I2C_enableInterrupt(EUSCI_B0_BASE, EUSCI_B_I2C_TRANSMIT_INTERRUPT0);
+    }
+    else
+    {
+        I2C_enableInterrupt(EUSCI_B0_BASE, EUSCI_B_I2C_RECEIVE_INTERRUPT0);
+    }
+    INSTR_ISR_EXIT(INSTR_ISR_DMA_INT1);
+}
+
+/* !
+ * \brief This function runs the I2C transaction steps
+ *
+ * This function ends the write with a repeated start or STOP, reads the
+ * last bytes, stops after a NACK, and finishes the transaction on STOP.
+ *
+ * \return None
+ */
+void EUSCIB0_IRQHandler(void)
+{
+    INSTR_ISR_ENTER(INSTR_ISR_EUSCIB0);
+    uint_fast16_t status = I2C_getEnabledInterruptStatus(EUSCI_B0_BASE);
+    I2cBus_Transaction *transaction = queueHead;
+
+    if (status & EUSCI_B_I2C_NAK_INTERRUPT)
+    {
+        // TXBUF is discarded, the DMA must not refill it
+        I2C_clearInterruptFlag(EUSCI_B0_BASE, EUSCI_B_I2C_NAK_INTERRUPT);
+        DMA_disableChannel(DMA_TX_CHANNEL);
+        DMA_disableChannel(DMA_RX_CHANNEL);
+        I2C_disableInterrupt(EUSCI_B0_BASE,
+                             EUSCI_B_I2C_TRANSMIT_INTERRUPT0
+                                     | EUSCI_B_I2C_RECEIVE_INTERRUPT0);
+        I2C_masterReceiveMultiByteStop(EUSCI_B0_BASE);
+        nacked = true;
+    }
+    else if (status & EUSCI_B_I2C_TRANSMIT_INTERRUPT0)
+    {
+        // The last byte is in the shift register
+        I2C_disableInterrupt(EUSCI_B0_BASE, EUSCI_B_I2C_TRANSMIT_INTERRUPT0);
+        if (transaction->readLength != 0)
+        {
+            startRead(transaction);
+        }
+        else
+        {
+            I2C_masterSendMultiByteStop(EUSCI_B0_BASE);
+        }
+    }
+    else if (status & EUSCI_B_I2C_RECEIVE_INTERRUPT0)
+    {
+        // Reading the second to last byte lets the bus go on to the last
+        if (rxIndex + 2 == transaction->readLength)
+        {
+            I2C_masterReceiveMultiByteStop(EUSCI_B0_BASE);
+        }
+        transaction->readData[rxIndex++] = I2C_masterReceiveMultiByteNext(
+                EUSCI_B0_BASE);
+        if (rxIndex == transaction->readLength)
+        {
+            I2C_disableInterrupt(EUSCI_B0_BASE,
+                                 EUSCI_B_I2C_RECEIVE_INTERRUPT0);
+        }
+    }
+
+    if (status & EUSCI_B_I2C_STOP_INTERRUPT)
+    {
+        I2C_clearInterruptFlag(EUSCI_B0_BASE, EUSCI_B_I2C_STOP_INTERRUPT);
+        finishTransaction();
+    }
+    INSTR_ISR_EXIT(INSTR_ISR_EUSCIB0);
+}
@@ -0,0 +1,121 @@
+/*!
+ * i2cbus.h
+ *      Description: Header file for the asynchronous I2C master on eUSCI_B0
+ *                   (P1.6 SDA, P1.7 SCL). Callers submit transactions, a
+ *                   register write followed by an optional read after a
+ *                   repeated start, to a FIFO queue and return at once. The
+ *                   bus runs them one after the other from its interrupts,
+ *                   with the DMA moving the data bytes, and calls the
+ *                   completion callback of each as deferred work in PendSV.
+ *
+ *                   A transaction belongs to the bus from I2cBus_submit until
+ *                   its callback runs; the caller must not touch it or its
+ *                   buffers meanwhile. I2cBus_isBusy tells whether it may be
+ *                   submitted again.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef I2CBUS_H_
+#define I2CBUS_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Bus clock. 400 kHz does not divide the 3 MHz SMCLK, DriverLib would round
+ * the divider down and run faster. */
+#define I2CBUS_RATE_HZ      375000
+
+/* Transaction status */
+typedef enum
+{
+    I2CBUS_IDLE,        /* never submitted */
+    I2CBUS_PENDING,     /* queued or on the bus */
+    I2CBUS_DONE,        /* every byte acknowledged */
+    I2CBUS_NACK         /* address or a written byte not acknowledged */
+} I2cBus_Status;
+
+typedef struct I2cBus_Transaction I2cBus_Transaction;
+
+/* Called in PendSV once a transaction has finished */
+typedef void (*I2cBus_DoneFn)(I2cBus_Transaction *transaction);
+
+struct I2cBus_Transaction
+{
+    uint8_t address;            /* 7-bit target address */
+    const uint8_t *writeData;   /* bytes sent first, usually a register */
+    uint8_t writeLength;
+    uint8_t *readData;          /* bytes read, after a repeated start if
+                                 * anything was written */
+    uint8_t readLength;
+    I2cBus_DoneFn done;         /* may be 0 */
+    void *context;              /* for the callback */
+    volatile I2cBus_Status status;
+    I2cBus_Status result;       /* status for the callback, owned by the bus */
+    I2cBus_Transaction *next;   /* queue link, owned by the bus */
+};
+
+/*!
+ * \brief This function initializes the I2C master and its DMA channels
+ *
+ * This function configures eUSCI_B0 as a master at I2CBUS_RATE_HZ and the
+ * DMA channels 0 (transmit) and 1 (receive), and registers the "i2c"
+ * deferred work that runs the callbacks. Defer_init must have been called.
+ *
+ * \return None
+ */
+extern void I2cBus_init(void);
+
+/*!
+ * \brief This function queues a transaction
+ *
+ * Safe to call from the main context and from deferred work, including a
+ * completion callback. The transaction starts right away if the bus is idle.
+ * A read of a single byte without a write waits for the address in the
+ * caller, about 27 us.
+ *
+ * \param transaction is the transaction, filled in up to status
+ *
+ * \return false if it is still pending or transfers nothing
+ */
+extern bool I2cBus_submit(I2cBus_Transaction *transaction);
+
+/*!
+ * \brief This function tells whether a transaction belongs to the bus
+ *
+ * \param transaction is the transaction
+ *
+ * \return true from I2cBus_submit until just before its callback runs
+ */
+extern bool I2cBus_isBusy(const I2cBus_Transaction *transaction);
+
+/*!
+ * \brief This function sends the bus statistics over the UART
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void I2cBus_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* I2CBUS_H_ */
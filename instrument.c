@@ -0,0 +1,206 @@
+/*!
+ * instrument.c
+ *      Description: Helper file for the DWT based timing instrumentation.
+ *                   Recording a value costs a compare, a count-leading-zeros
+ *                   and a few adds. Interrupt statistics are only written by
+ *                   their own handler, so readers copy them with interrupts
+ *                   masked to get a consistent view.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "instrument.h"
+
+static Instr_Histogram isrDuration[INSTR_NUM_ISRS];
+static Instr_Histogram isrLatency[INSTR_NUM_ISRS];
+static Instr_Histogram scopeDuration[INSTR_NUM_SCOPES];
+static Instr_Histogram cpuLoad;
+
+static const char * const isrNames[INSTR_NUM_ISRS] = { "ADC14", "T32_INT1",
+                                                       "TA2_0", "EUSCIA0",
+                                                       "EUSCIB0", "DMA_INT1",
+                                                       "PendSV" };
+/* Handlers that can time their request, see INSTR_ISR_LATENCY */
+static const bool isrHasLatency[INSTR_NUM_ISRS] = { true, true, true, false,
+                                                    false, false, false };
+static const char * const scopeNames[INSTR_NUM_SCOPES] = { "lcdWrite",
+                                                           "display",
+                                                           "events" };
+
+/*!
+ * Adds a value to a histogram.
+ *
+ * \param histogram Histogram to update
+ * \param value Value to add
+ *
+ * \return None
+ */
+static void record(Instr_Histogram *histogram, uint32_t value)
+{
+    uint32_t bucket = 31 - __CLZ(value | 1);
+    if (bucket >= INSTR_NUM_BUCKETS)
+    {
+        bucket = INSTR_NUM_BUCKETS - 1;
+    }
+    histogram->buckets[bucket]++;
+    histogram->total += value;
+    if (histogram->count == 0 || value < histogram->min)
+    {
+        histogram->min = value;
+    }
+    if (value > histogram->max)
+    {
+        histogram->max = value;
+    }
+    histogram->count++;
+}
+
+/*!
+ * Copies a histogram with interrupts masked.
+ *
+ * \param dest Copy destination, ignored if 0
+ * \param src Histogram to copy
+ *
+ * \return None
+ */
+static void copy(Instr_Histogram *dest, const Instr_Histogram *src)
+{
+    if (dest == 0)
+    {
+        return;
+    }
+    bool wasMasked = Interrupt_disableMaster();
+    *dest = *src;
+    if (!wasMasked)
+    {
+        Interrupt_enableMaster();
+    }
+}
+
+void Instr_init(void)
+{
+    memset(isrDuration, 0, sizeof(isrDuration));
+    memset(isrLatency, 0, sizeof(isrLatency));
+    memset(scopeDuration, 0, sizeof(scopeDuration));
+    memset(&cpuLoad, 0, sizeof(cpuLoad));
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void Instr_recordIsr(Instr_IsrId id, uint32_t cycles)
+{
+    record(&isrDuration[id], cycles);
+}
+
+void Instr_recordLatency(Instr_IsrId id, uint32_t cycles)
+{
+    record(&isrLatency[id], cycles);
+}
+
+void Instr_recordScope(Instr_ScopeId id, uint32_t cycles)
+{
+    record(&scopeDuration[id], cycles);
+}
+
+void Instr_recordLoad(uint8_t percent)
+{
+    record(&cpuLoad, percent);
+}
+
+void Instr_getIsr(Instr_IsrId id, Instr_Histogram *duration,
+                  Instr_Histogram *latency)
+{
+    copy(duration, &isrDuration[id]);
+    copy(latency, &isrLatency[id]);
+}
+
+void Instr_getScope(Instr_ScopeId id, Instr_Histogram *duration)
+{
+    copy(duration, &scopeDuration[id]);
+}
+
+void Instr_getLoad(Instr_Histogram *load)
+{
+    copy(load, &cpuLoad);
+}
+
+/*!
+ * Writes the summary and histogram of one quantity.
+ *
+ * \param write Line writer
+ * \param name Name of the quantity
+ * \param histogram Histogram to write
+ *
+ * \return None
+ */
+static void writeHistogram(void (*write)(const char *line), const char *name,
+                           const Instr_Histogram *histogram)
+{
+    char line[96];
+    int length;
+    int i;
+
+    // Empty histograms keep their lines so the report length is fixed
+    if (histogram->count == 0)
+    {
+        sprintf(line, "%-16s n=0", name);
+    }
+    else
+    {
+        sprintf(line, "%-16s n=%lu min=%lu avg=%lu max=%lu", name,
+                (unsigned long) histogram->count,
+                (unsigned long) histogram->min,
+                (unsigned long) (histogram->total / histogram->count),
+                (unsigned long) histogram->max);
+    }
+    write(line);
+
+    // Buckets as counts of [1, 2, 4, ...) cycles
+    length = sprintf(line, "  log2:");
+    for (i = 0; i < INSTR_NUM_BUCKETS; i++)
+    {
+        length += sprintf(line + length, " %lu",
+                          (unsigned long) histogram->buckets[i]);
+        if (length > (int) sizeof(line) - 12)
+        {
+            break;
+        }
+    }
+    write(line);
+}
+
+void Instr_report(void (*write)(const char *line))
+{
+    Instr_Histogram histogram;
+    char name[24];
+    int i;
+
+    write("timing (cycles):");
+    for (i = 0; i < INSTR_NUM_ISRS; i++)
+    {
+        copy(&histogram, &isrDuration[i]);
+        sprintf(name, "%s run", isrNames[i]);
+        writeHistogram(write, name, &histogram);
+        if (isrHasLatency[i])
+        {
+            copy(&histogram, &isrLatency[i]);
+            sprintf(name, "%s latency", isrNames[i]);
+            writeHistogram(write, name, &histogram);
+        }
+    }
+    for (i = 0; i < INSTR_NUM_SCOPES; i++)
+    {
+        copy(&histogram, &scopeDuration[i]);
+        writeHistogram(write, scopeNames[i], &histogram);
+    }
+    copy(&histogram, &cpuLoad);
+    writeHistogram(write, "cpu load %", &histogram);
+}
@@ -0,0 +1,191 @@
+/*!
+ * instrument.h
+ *      Description: Header file for always-on timing instrumentation based on
+ *                   the Cortex-M4 DWT cycle counter. Records interrupt entry
+ *                   latency and duration, function scope durations and CPU
+ *                   load as min/avg/max plus a log2 histogram each.
+ *
+ *                   The DWT counter stops while the core sleeps, so it only
+ *                   measures active code; wall-clock idle time comes from
+ *                   power.c.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef INSTRUMENT_H_
+#define INSTRUMENT_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdint.h>
+
+/* Bucket n counts values in [2^n, 2^(n+1)), the last bucket is open ended */
+#define INSTR_NUM_BUCKETS   16
+
+/* Instrumented interrupts */
+typedef enum
+{
+    INSTR_ISR_ADC14,
+    INSTR_ISR_T32_INT1,
+    INSTR_ISR_TA2_0,
+    INSTR_ISR_EUSCIA0,
+    INSTR_ISR_EUSCIB0,
+    INSTR_ISR_DMA_INT1,
+    INSTR_ISR_PENDSV,
+    INSTR_NUM_ISRS
+} Instr_IsrId;
+
+/* Instrumented function scopes */
+typedef enum
+{
+    INSTR_SCOPE_LCD_WRITE,
+    INSTR_SCOPE_DISPLAY,
+    INSTR_SCOPE_EVENTS,
+    INSTR_NUM_SCOPES
+} Instr_ScopeId;
+
+/* Distribution of one measured quantity, values in CPU cycles */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t buckets[INSTR_NUM_BUCKETS];
+} Instr_Histogram;
+
+/*!
+ * \brief This function returns the DWT cycle counter
+ *
+ * \return CPU cycles since Instr_init, wrapping at 2^32
+ */
+static inline uint32_t Instr_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/* Marks the start of an interrupt handler, use once per handler */
+#define INSTR_ISR_ENTER(id)         uint32_t instrIsrStart = Instr_cycles()
+/* Records the handler duration, use before every return of the handler */
+#define INSTR_ISR_EXIT(id)          Instr_recordIsr((id), \
+                                        Instr_cycles() - instrIsrStart)
+/* Records the time from the interrupt request to handler entry. Only
+ * ADC14, T32_INT1 and TA2_0 have a counter to time their request from, the
+ * report leaves out the latency of the others */
+#define INSTR_ISR_LATENCY(id, c)    Instr_recordLatency((id), (c))
+/* Marks the start of a scope, use once per scope id per function */
+#define INSTR_SCOPE_BEGIN(id)       uint32_t instrScope##id = Instr_cycles()
+/* Records the scope duration */
+#define INSTR_SCOPE_END(id)         Instr_recordScope((id), \
+                                        Instr_cycles() - instrScope##id)
+
+/*!
+ * \brief This function starts the DWT cycle counter
+ *
+ * This function enables trace, resets CYCCNT and clears all statistics.
+ *
+ * \return None
+ */
+extern void Instr_init(void);
+
+/*!
+ * \brief This function records an interrupt handler duration
+ *
+ * \param id is the interrupt
+ * \param cycles is the handler duration in CPU cycles
+ *
+ * \return None
+ */
+extern void Instr_recordIsr(Instr_IsrId id, uint32_t cycles);
+
+/*!
+ * \brief This function records an interrupt entry latency
+ *
+ * \param id is the interrupt
+ * \param cycles is the time from the request to handler entry in CPU cycles
+ *
+ * \return None
+ */
+extern void Instr_recordLatency(Instr_IsrId id, uint32_t cycles);
+
+/*!
+ * \brief This function records a scope duration
+ *
+ * \param id is the scope
+ * \param cycles is the scope duration in CPU cycles
+ *
+ * \return None
+ */
+extern void Instr_recordScope(Instr_ScopeId id, uint32_t cycles);
+
+/*!
+ * \brief This function records a CPU load sample
+ *
+ * \param percent is the CPU load over the last measurement window
+ *
+ * \return None
+ */
+extern void Instr_recordLoad(uint8_t percent);
+
+/*!
+ * \brief This function reads interrupt statistics
+ *
+ * \param id is the interrupt
+ * \param duration is filled with the handler durations, may be 0
+ * \param latency is filled with the entry latencies, may be 0
+ *
+ * \return None
+ */
+extern void Instr_getIsr(Instr_IsrId id, Instr_Histogram *duration,
+                         Instr_Histogram *latency);
+
+/*!
+ * \brief This function reads scope statistics
+ *
+ * \param id is the scope
+ * \param duration is filled with the scope durations
+ *
+ * \return None
+ */
+extern void Instr_getScope(Instr_ScopeId id, Instr_Histogram *duration);
+
+/*!
+ * \brief This function reads the CPU load statistics
+ *
+ * \param load is filled with the load samples, in percent
+ *
+ * \return None
+ */
+extern void Instr_getLoad(Instr_Histogram *load);
+
+/*!
+ * \brief This function writes all statistics as text
+ *
+ * \param write is called once per line of the report
+ *
+ * \return None
+ */
+extern void Instr_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INSTRUMENT_H_ */
@@ -2,7 +2,9 @@
  * lcd.c
  *
  *      Description: Helper file for LCD library. For Hitachi HD44780 parallel
- *      LCD in 4-bit mode.
+ *      LCD in 4-bit mode. A copy of DDRAM, the address counter and the
+ *      display shift follows every instruction, so fields can be rewritten
+ *      off-screen without resending unchanged text.
  *
  *      Author: ece230
  *      Edited by: Cooper Brotherton
@@ -12,8 +14,13 @@
 /* DriverLib Includes */
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 
+#include <string.h>
+
 #include "lcd.h"
 #include "delays.h"
+#include "instrument.h"
+#include "trace.h"
+#include "ramfunc.h"
 
 #define NONHOME_MASK        0xFC
 
@@ -23,6 +30,16 @@
 uint_fast8_t RS_Port, EN_Port, DB_Port;
 uint_fast16_t RS_Pin, EN_Pin;
 
+/* Copy of DDRAM and of the LCD's address counter and display shift, kept by
+ * commandInstruction and dataInstruction. Valid from the first clear on. */
+static char ddram[2][LCD_DDRAM_COLUMNS];
+static uint8_t cursorLine;
+static uint8_t cursorColumn;
+static uint8_t displayShift;
+static bool cursorInCgram;
+static bool cursorIncrement = true;
+static bool ddramKnown = false;
+
 void configLCD(uint_fast8_t rsPort, uint_fast16_t rsPin, uint_fast8_t enPort,
                uint_fast16_t enPin, uint_fast8_t dbPort)
 {
@@ -61,7 +78,7 @@ void instructionDelay(uint8_t mode, uint8_t instruction)
 }
 
 /*!
- * Function to write instruction/data to LCD.
+ * Function to write instruction/data to LCD. Runs from SRAM.
  *
  * \param mode          Write mode: 0 - control, 1 - data
  * \param instruction   Instruction/data to write to LCD
@@ -70,8 +87,10 @@ void instructionDelay(uint8_t mode, uint8_t instruction)
  *
  * \return None
  */
-void writeInstruction(uint8_t mode, uint8_t instruction, bool init)
+RAMFUNC void writeInstruction(uint8_t mode, uint8_t instruction, bool init)
 {
+    INSTR_SCOPE_BEGIN(INSTR_SCOPE_LCD_WRITE);
+    TRACE(TRACE_LCD_WRITE, (mode << 8) | instruction);
     GPIO_setOutputLowOnPin(DB_Port, PIN_ALL8);
     if (mode == DATA_MODE)
     {
@@ -96,11 +115,115 @@ void writeInstruction(uint8_t mode, uint8_t instruction, bool init)
     }
 
     instructionDelay(mode, instruction);
+    INSTR_SCOPE_END(INSTR_SCOPE_LCD_WRITE);
+}
+
+/*!
+ * Moves the copy of the address counter one column on, from the end of a
+ * line to the start of the other as the HD44780 does in 2-line mode.
+ *
+ * \param forward Whether the counter increments
+ *
+ * \return None
+ */
+static void stepCursor(bool forward)
+{
+    if (forward)
+    {
+        if (++cursorColumn == LCD_DDRAM_COLUMNS)
+        {
+            cursorColumn = 0;
+            cursorLine ^= 1;
+        }
+    }
+    else
+    {
+        if (cursorColumn-- == 0)
+        {
+            cursorColumn = LCD_DDRAM_COLUMNS - 1;
+            cursorLine ^= 1;
+        }
+    }
+}
+
+/*!
+ * Follows an instruction in the copy of the LCD state. The highest set bit
+ * selects the instruction.
+ *
+ * \param command Instruction written
+ *
+ * \return None
+ */
+static void trackCommand(uint8_t command)
+{
+    if (command & SET_CURSOR_MASK)
+    {
+        cursorLine = (command & LINE2_OFFSET) != 0;
+        cursorColumn = (command & 0x3F) % LCD_DDRAM_COLUMNS;
+        cursorInCgram = false;
+    }
+    else if (command & SET_CGRAM_MASK)
+    {
+        cursorInCgram = true;
+    }
+    else if (command & FUNCTION_SET_MASK)
+    {
+        return;
+    }
+    else if (command & CURSOR_SHIFT_MASK)
+    {
+        bool right = (command & RL_FLAG_MASK) != 0;
+
+        if (command & SC_FLAG_MASK)
+        {
+            displayShift = (displayShift
+                    + (right ? LCD_DDRAM_COLUMNS - 1 : 1)) % LCD_DDRAM_COLUMNS;
+        }
+        else
+        {
+            stepCursor(right);
+        }
+    }
+    else if (command & DISPLAY_CTRL_MASK)
+    {
+        return;
+    }
+    else if (command & ENTRY_MODE_MASK)
+    {
+        cursorIncrement = (command & ID_FLAG_MASK) != 0;
+        // Shifting on every write is not followed
+        if (command & S_FLAG_MASK)
+        {
+            ddramKnown = false;
+        }
+    }
+    else if (command & RETURN_HOME_MASK)
+    {
+        cursorLine = 0;
+        cursorColumn = 0;
+        cursorInCgram = false;
+        displayShift = 0;
+    }
+    else if (command & CLEAR_DISPLAY_MASK)
+    {
+        memset(ddram, ' ', sizeof(ddram));
+        cursorLine = 0;
+        cursorColumn = 0;
+        cursorInCgram = false;
+        cursorIncrement = true;
+        displayShift = 0;
+        ddramKnown = true;
+    }
 }
 
 void commandInstruction(uint8_t command, bool init)
 {
     writeInstruction(CTRL_MODE, command, init);
+    // The 8-bit wake-up writes of the initialization change nothing tracked
+    if (!init)
+    {
+        trackCommand(command);
+    }
 }
 
 /*!
@@ -113,33 +236,86 @@ void commandInstruction(uint8_t command, bool init)
 void dataInstruction(uint8_t data)
 {
     writeInstruction(DATA_MODE, data, false);
+    if (!cursorInCgram)
+    {
+        ddram[cursorLine][cursorColumn] = data;
+        stepCursor(cursorIncrement);
+    }
 }
 
-void initLCD(void)
+/* One step of the initialization sequence and the wait that follows it */
+typedef struct
 {
-    // Primary initialization for 4-bit mode
-    // See Figure 24 in Hitachi HD44780 data sheet
-    delayMilliSec(40);
-    commandInstruction(0x30, true);
-    delayMilliSec(5);
-    commandInstruction(0x30, true);
-    delayMicroSec(150);
-    commandInstruction(0x30, true);
-    delayMicroSec(SHORT_INSTR_DELAY);
-    commandInstruction(0x20, true);
-    delayMicroSec(SHORT_INSTR_DELAY);
+    uint8_t command;
+    bool init;
+    uint16_t waitMicros;
+} InitStep;
+
+/* Power-on wait before the first instruction */
+#define POWER_ON_DELAY      40000
 
+/*
+ * Primary initialization for 4-bit mode
+ * See Figure 24 in Hitachi HD44780 data sheet
+ */
+static const InitStep initSequence[] = {
+    { 0x30, true, 5000 },
+    { 0x30, true, 150 },
+    { 0x30, true, SHORT_INSTR_DELAY },
+    { 0x20, true, SHORT_INSTR_DELAY },
     // 4-bit, 2-line, 5x8 font
-    commandInstruction(FUNCTION_SET_MASK | N_FLAG_MASK, false);
+    { FUNCTION_SET_MASK | N_FLAG_MASK, false, 0 },
     // Display off
-    commandInstruction(DISPLAY_CTRL_MASK, false);
+    { DISPLAY_CTRL_MASK, false, 0 },
     // Display clear
-    commandInstruction(CLEAR_DISPLAY_MASK, false);
+    { CLEAR_DISPLAY_MASK, false, 0 },
     // Cursor increment and no shift
-    commandInstruction(ENTRY_MODE_MASK | ID_FLAG_MASK, false);
+    { ENTRY_MODE_MASK | ID_FLAG_MASK, false, 0 },
     // Initialization complete, turn ON display
-    commandInstruction(DISPLAY_CTRL_MASK | D_FLAG_MASK, false);
-    delayMilliSec(5);
+    { DISPLAY_CTRL_MASK | D_FLAG_MASK, false, 5000 },
+};
+
+#define NUM_INIT_STEPS      (sizeof(initSequence) / sizeof(initSequence[0]))
+
+/* Next initSequence entry, -1 before the power-on wait */
+static int initIndex = -1;
+
+bool initLCDStep(uint32_t *waitMicros)
+{
+    if (initIndex < 0)
+    {
+        initIndex = 0;
+        *waitMicros = POWER_ON_DELAY;
+        return false;
+    }
+    if (initIndex < (int) NUM_INIT_STEPS)
+    {
+        const InitStep *step = &initSequence[initIndex++];
+        commandInstruction(step->command, step->init);
+        *waitMicros = step->waitMicros;
+        return false;
+    }
+    *waitMicros = 0;
+    return true;
+}
+
+bool isLCDReady(void)
+{
+    return initIndex >= (int) NUM_INIT_STEPS;
+}
+
+void initLCD(void)
+{
+    uint32_t waitMicros;
+
+    initIndex = -1;
+    while (!initLCDStep(&waitMicros))
+    {
+        if (waitMicros != 0)
+        {
+            delayMicroSec(waitMicros);
+        }
+    }
 }
 
 void printChar(char character)
@@ -158,3 +334,56 @@ void printString(char *chars, int length)
         }
     }
 }
+
+int writeLCDField(uint8_t line, uint8_t column, const char *text, int length)
+{
+    int sent = 0;
+    int i;
+
+    line &= 1;
+    column %= LCD_DDRAM_COLUMNS;
+    for (i = 0; i < length; i++)
+    {
+        if (!ddramKnown || ddram[line][column] != text[i])
+        {
+            if (cursorInCgram || !cursorIncrement || cursorLine != line
+                    || cursorColumn != column)
+            {
+                uint8_t address = (line ? LINE2_OFFSET : LINE1_OFFSET)
+                        + column;
+
+                commandInstruction(SET_CURSOR_MASK | address, false);
+                sent++;
+            }
+            dataInstruction(text[i]);
+            sent++;
+        }
+        if (++column == LCD_DDRAM_COLUMNS)
+        {
+            column = 0;
+        }
+    }
+    return sent;
+}
+
+void scrollLCD(int columns)
+{
+    uint8_t direction = columns < 0 ? RL_FLAG_MASK : 0;
+
+    if (columns < 0)
+    {
+        columns = -columns;
+    }
+    // A full turn leaves the view where it was
+    columns %= LCD_DDRAM_COLUMNS;
+    while (columns-- > 0)
+    {
+        commandInstruction(CURSOR_SHIFT_MASK | SC_FLAG_MASK | direction,
+                           false);
+    }
+}
+
+uint8_t getLCDShift(void)
+{
+    return displayShift;
+}
@@ -26,6 +26,12 @@ extern "C"
 #define LINE1_OFFSET    0x0
 #define LINE2_OFFSET    0x40
 
+/* Characters shown per line, and DDRAM characters per line in 2-line mode.
+ * The display shows LCD_COLUMNS of the LCD_DDRAM_COLUMNS starting at the
+ * display shift, wrapping around the end of the line. */
+#define LCD_COLUMNS         16
+#define LCD_DDRAM_COLUMNS   40
+
 /* Instruction masks */
 #define CLEAR_DISPLAY_MASK  0x01
 #define RETURN_HOME_MASK    0x02
@@ -111,12 +117,35 @@ extern void configLCD(uint_fast8_t rsPort, uint_fast16_t rsPin,
  *  \brief This function initializes LCD
  *
  *  This function generates initialization sequence for LCD for 8-bit mode.
- *      Delays set by worst-case 2.7 V
+ *      Delays set by worst-case 2.7 V. Blocks for about 50 ms, see
+ *      initLCDStep.
  *
  *  \return None
  */
 extern void initLCD(void);
 
+/*!
+ *  \brief This function runs the next step of the LCD initialization
+ *
+ *  This function is the non-blocking form of initLCD. Each call sends at
+ *      most one instruction of the initialization sequence and returns how
+ *      long the LCD needs before the next call; the caller may do other work
+ *      in the meantime. The first call only asks for the power-on wait.
+ *
+ *  \param waitMicros receives the minimum wait in microseconds before the
+ *                    next call
+ *
+ *  \return true once the sequence is complete, false while steps remain
+ */
+extern bool initLCDStep(uint32_t *waitMicros);
+
+/*!
+ *  \brief This function checks whether the LCD accepts text
+ *
+ *  \return true once initLCD or the initLCDStep sequence has completed
+ */
+extern bool isLCDReady(void);
+
 /*!
  *  \brief This function prints a character to current cursor position
  *
@@ -141,6 +170,49 @@ extern void printChar(char character);
  */
 extern void printString(char* chars, int length);
 
+/*!
+ *  \brief This function writes text to DDRAM, shown or not
+ *
+ *  This function writes a field of a 40-column DDRAM line, such as one value
+ *      of a ticker, wherever the display shift currently is. Only characters
+ *      that differ from what the LCD already holds are sent, and the cursor
+ *      is only set when it skips unchanged ones, so rewriting a whole line
+ *      with one changed value costs a few instructions. The LCD contents are
+ *      known from every instruction sent since the last CLEAR_DISPLAY_MASK;
+ *      before one, everything is sent.
+ *
+ *  \param line is 0 for the first line, 1 for the second
+ *  \param column is the DDRAM column of the first character, 0 to 39
+ *  \param text is the characters to write
+ *  \param length is the number of characters, wrapping past column 39
+ *
+ *  \return Number of instructions sent
+ */
+extern int writeLCDField(uint8_t line, uint8_t column, const char *text,
+                         int length);
+
+/*!
+ *  \brief This function scrolls the display through DDRAM
+ *
+ *  This function shifts both lines with one display shift instruction per
+ *      column, leaving DDRAM and the cursor alone. Text scrolls left for a
+ *      positive count, so the view moves on through the line, and wraps
+ *      around every LCD_DDRAM_COLUMNS columns. CLEAR_DISPLAY_MASK and
+ *      RETURN_HOME_MASK undo the shift.
+ *
+ *  \param columns is the number of columns to scroll, negative to the right
+ *
+ *  \return None
+ */
+extern void scrollLCD(int columns);
+
+/*!
+ *  \brief This function returns the display shift
+ *
+ *  \return DDRAM column shown at the left edge, 0 to 39
+ */
+extern uint8_t getLCDShift(void);
+
 /*!
  * Function to write command instruction to LCD.
  *
@@ -7,8 +7,10 @@
  * MSP432 Project 5 ECE230 Winter 2020-2021
  *
  * Description: Potentiometer circuit connected to PX.Y, photoresistor circuit
- *              connected to PX.Y. S1 toggles which analog output is shown on
- *              the LCD.
+ *              connected to PX.Y, TMP102 and OPT3001 on the I2C bus. S1
+ *              cycles the LCD between the two analog outputs, the flicker
+ *              spectrum of the photoresistor, the digital sensors, the
+ *              last detected signal event and a ticker of every reading.
  *
  *                MSP432P401
  *             ------------------
@@ -20,6 +22,8 @@
  *            |            P3.2  |---> E
  *      Pot-->|P6.1              |
  *    Photo-->|P6.0              |
+ *      SDA<->|P1.6              |
+ *      SCL<--|P1.7              |
  *******************************************************************************/
 /* DriverLib Includes */
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
@@ -27,220 +31,1055 @@
 /* Standard Includes */
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "Switch.h"
 #include "lcd.h"
 #include "delays.h"
+#include "power.h"
+#include "scheduler.h"
+#include "defer.h"
+#include "priorities.h"
+#include "queue.h"
+#include "debounce.h"
+#include "clock.h"
+#include "acquisition.h"
+#include "governor.h"
+#include "uart.h"
+#include "instrument.h"
+#include "trace.h"
+#include "capture.h"
+#include "boot.h"
+#include "filters.h"
+#include "dspbench.h"
+#include "flicker.h"
+#include "stack.h"
+#include "i2cbus.h"
+#include "sensors.h"
+#include "snapshot.h"
+#include "detector.h"
+#include "telemetry.h"
+#include "pool.h"
 
-static volatile uint16_t digitalValue;
-static volatile uint32_t analogValue;
-bool usePotentiometerCircuit;
-bool debounced;
+/* Clock profile at boot and the range the governor may use */
+#define BOOT_CLOCK_PROFILE  CLOCK_3MHZ
+#define MIN_CLOCK_PROFILE   CLOCK_1_5MHZ
+#define MAX_CLOCK_PROFILE   CLOCK_48MHZ
+
+#define ADC_QUEUE_SIZE      16
+#define INPUT_QUEUE_SIZE    8
+#define SENSOR_QUEUE_SIZE   4
+#define DETECT_QUEUE_SIZE   8
+#define EVENT_BATCH         8
+
+/* LCD waits of at least one tick yield to the scheduler, shorter ones spin */
+#define LCD_YIELD_MICROS    (SCHED_TICK_MS * 1000)
+
+/* Buffer size for each formatReading string */
+#define READING_LENGTH      6
+
+/* Buffer size for each formatSensor string, "83865 lux" at most */
+#define SENSOR_TEXT_LENGTH  10
+
+/* Light counts as dropped below PHOTO_DARK_LEVEL, the pot as moved past
+ * POT_MIDPOINT either way, and the pot sweeps are counted by their peaks and
+ * dips. ADC counts. */
+#define PHOTO_DARK_LEVEL    4096
+#define PHOTO_HYSTERESIS    256
+#define POT_MIDPOINT        (ADC_FULL_SCALE / 2)
+#define POT_HYSTERESIS      128
+#define POT_PROMINENCE      2048
+
+/* The ticker screen scrolls one column per TICKER_STEP_TICKS */
+#define TICKER_STEP_TICKS   (SCHED_TICK_HZ / 4)
+
+/* Readings by channel, the ADC channels first, then the sensors */
+#define NUM_READINGS        (NUM_CHANNELS + SENSOR_NUM)
+#define SENSOR_CHANNEL(s)   (NUM_CHANNELS + (s))
+
+/* Screens selected with S1, in order */
+typedef enum
+{
+    DISPLAY_POT,
+    DISPLAY_PHOTO,
+    DISPLAY_FLICKER,
+    DISPLAY_SENSORS,
+    DISPLAY_DETECTIONS,
+    DISPLAY_TICKER,
+    NUM_DISPLAYS
+} DisplayMode;
+
+/* Latest filtered sample or sensor result of each channel, with the
+ * timestamp of its block or reading and the number of updates so far, and
+ * the last detection with the scheduler tick it was handled at */
+typedef struct
+{
+    uint16_t value[NUM_READINGS];
+    uint32_t timestamp[NUM_READINGS];
+    uint32_t updates[NUM_READINGS];
+    Event detection;
+    uint32_t detectionTicks;
+    uint32_t detections;
+} Readings;
+
+/* Readings are written by the events work and copied whole by the display
+ * and report tasks through the snapshot, so both lines of a screen come from
+ * the same update. The screen is written by the events work too. */
+static Readings readings;
+static Snapshot readingsSnapshot;
+static volatile DisplayMode displayMode;
+/* The ticker is on the LCD, written by the display task */
+static bool tickerShown;
+
+/* ADC14_IRQHandler -> events work */
+static Event adcEvents[ADC_QUEUE_SIZE];
+static EventQueue adcQueue;
+/* TA2_0_IRQHandler (debounce) -> events work */
+static Event inputEvents[INPUT_QUEUE_SIZE];
+static EventQueue inputQueue;
+/* I2C callbacks (sensors) -> events work */
+static Event sensorEvents[SENSOR_QUEUE_SIZE];
+static EventQueue sensorQueue;
+/* ADC14_IRQHandler (detectors) -> events work */
+static Event detectEvents[DETECT_QUEUE_SIZE];
+static EventQueue detectQueue;
+/* Events work -> trace task, the UART is only written by tasks */
+static volatile bool traceDumpRequested;
+static volatile bool captureDumpRequested;
+/* Report task only: lines of the report sent so far, the line being
+ * generated, and whether the UART ran out of room in this run. The trace
+ * task resumes the report while reportPending is set. */
+static uint32_t reportSent;
+static uint32_t reportLine;
+static bool reportFull;
+static bool reportPending;
+/* Percent of the last refresh period spent in LPM0, for diagnostics */
+volatile uint8_t idlePercent;
+
+/* Timer32 tick reload and MCLK/SMCLK ratio, for interrupt latency */
+static uint32_t tickReload;
+static uint32_t smclkRatio;
+
+/* Deferred work id */
+static int eventWork;
+
+/* Scheduler task ids */
+static int displayTask;
+static int governorTask;
+static int reportTask;
+static int lcdInitTask;
+static int flickerTask;
+/* Name of the registration setup ran out of slots for, for the debugger */
+static const char *setupFailure;
+
+void handleEvents(void);
+void storeReading(uint8_t channel, uint16_t value, uint32_t timestamp);
+void refreshDisplay(void);
+void showFlicker(void);
+void showSensors(const Readings *latest);
+void showDetection(const Readings *latest);
+void showTicker(const Readings *latest);
+void scrollTicker(void);
+void formatSensor(const Readings *latest, uint8_t sensor, char *text);
+void writeReport(void (*write)(const char *line));
+void writeReportLine(const char *line);
+void printReport(void);
+void dumpTrace(void);
+void startLCD(void);
+int addTask(const char *name, Sched_TaskFn fn, uint8_t priority,
+            uint32_t period, uint32_t deadline);
+void addListener(const char *name, Clock_Listener listener);
+void setupFailed(const char *name);
+void formatReading(uint16_t digitalValue, char *digits, char *volts);
+void retimeTick(uint32_t mclk);
+void retimeDebounce(uint32_t mclk);
 
 /*!
  * \brief This function intializes the peripherials for the project
  *
- * This function initializes S1 with interrupts, turns on ADC for P6.0 and P6.1,
- * starts Timer32 for ADC refresh rate, and TimerA0 for debouncing S1.
+ * This function initializes S1, starts sampling P6.0 and P6.1 in blocks,
+ * starts Timer32 as the scheduler tick, and TimerA2 as the 5 ms debounce
+ * sampling tick. Each interrupt gets its level from priorities.h. Sample
+ * blocks, sensor readings and button events are processed as deferred work
+ * in PendSV; the application tasks, the sensor poll among them, are
+ * registered with the scheduler.
+ *
+ * The LCD initialization is not run here: its power-on and reset waits take
+ * about 50 ms, so it runs as the "lcd init" task while the first block is
+ * already being sampled. Boot milestones are timed from Power_init.
  *
  * \return None
  */
 void setup(void)
 {
-    usePotentiometerCircuit = true;
-    debounced = true;
-
-    Switch_init();
+    displayMode = DISPLAY_POT;
+    Queue_init(&adcQueue, adcEvents, ADC_QUEUE_SIZE);
+    Queue_init(&inputQueue, inputEvents, INPUT_QUEUE_SIZE);
+    Queue_init(&sensorQueue, sensorEvents, SENSOR_QUEUE_SIZE);
+    Queue_init(&detectQueue, detectEvents, DETECT_QUEUE_SIZE);
+    Snapshot_init(&readingsSnapshot, &readings, sizeof(readings));
 
     // Stop Watchdog
     WDT_A_holdTimer();
 
-    // ADC initialization
+    Instr_init();
+    Clock_init(BOOT_CLOCK_PROFILE);
+    Uart_init();
+    Power_init();
+    Defer_init();
+    Boot_init(Clock_getMCLK());
+    Trace_init();
+    Capture_init();
+    Pool_init();
+    Telemetry_init();
+
+    Switch_init();
+    Debounce_init(&inputQueue);
+    Debounce_addButton(SWITCH_PORT, SWITCH_PIN);
+
     // Enabling the FPU for floating point operation
     FPU_enableModule();
     FPU_enableLazyStacking();
 
-    // Initializing ADC
-    ADC14_enableModule();
-    ADC14_initModule(ADC_CLOCKSOURCE_MCLK, ADC_PREDIVIDER_1, ADC_DIVIDER_1, 0);
-
-    // Configuring GPIOs (6.0, 6.1; A15, A14)
-    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P6,
-                                               GPIO_PIN0 | GPIO_PIN1,
-                                               GPIO_TERTIARY_MODULE_FUNCTION);
-
-    // Configuring ADC
-    ADC14_configureMultiSequenceMode(ADC_MEM14, ADC_MEM15, false);
-    ADC14_configureConversionMemory(ADC_MEM14,
-                                    ADC_VREFPOS_AVCC_VREFNEG_VSS,
-                                    ADC_INPUT_A14, false);
-    ADC14_configureConversionMemory(ADC_MEM15,
-                                    ADC_VREFPOS_AVCC_VREFNEG_VSS,
-                                    ADC_INPUT_A15, false);
-    ADC14_enableSampleTimer(ADC_MANUAL_ITERATION);
-    ADC14_enableConversion();
-    ADC14_toggleConversionTrigger();
-    ADC14_enableInterrupt(ADC_INT14);
-    ADC14_enableInterrupt(ADC_INT15);
-    Interrupt_enableInterrupt(INT_ADC14);
-
-    // 1s Timer32 in One-shot mode
+    // ISR events and sample blocks are deferred work, tasks start with the
+    // flicker analysis, then display (1 second)
+    eventWork = Defer_add("events", handleEvents);
+    Sched_init();
+    flickerTask = addTask("flicker", Flicker_analyze, 1, 0,
+                          SCHED_TICK_HZ / 2);
+    Filters_init();
+    Flicker_init();
+    Detector_init(&detectQueue);
+    const Detector_Config darkConfig = { PHOTO_DARK_LEVEL, PHOTO_HYSTERESIS,
+                                         DETECT_FALLING, 0 };
+    const Detector_Config potConfig = { POT_MIDPOINT, POT_HYSTERESIS,
+                                        DETECT_RISING | DETECT_FALLING,
+                                        POT_PROMINENCE };
+    Detector_configure(CHANNEL_PHOTO, &darkConfig);
+    Detector_configure(CHANNEL_POT, &potConfig);
+    Acq_init(&adcQueue, eventWork);
+    displayTask = addTask("display", refreshDisplay, 2, SCHED_TICK_HZ,
+                          SCHED_TICK_HZ / 2);
+    addTask("sensors", Sensors_poll, 2, SENSOR_POLL_TICKS, SENSOR_POLL_TICKS);
+    addTask("ticker", scrollTicker, 2, TICKER_STEP_TICKS, TICKER_STEP_TICKS);
+    governorTask = addTask("governor", Governor_task, 3, GOVERNOR_PERIOD,
+                           GOVERNOR_PERIOD);
+    reportTask = addTask("report", printReport, 4, 0, SCHED_TICK_HZ);
+    addTask("trace", dumpTrace, 5, SCHED_TICK_HZ / 10, SCHED_TICK_HZ / 10);
+    lcdInitTask = addTask("lcd init", startLCD, 6, 0, SCHED_TICK_HZ);
+    Governor_init(&adcQueue, MIN_CLOCK_PROFILE, MAX_CLOCK_PROFILE);
+    I2cBus_init();
+    Sensors_init(&sensorQueue, eventWork);
+
+    // Timer32 in periodic mode as the scheduler tick, wakes CPU from LPM0
     Timer32_initModule(TIMER32_0_BASE, TIMER32_PRESCALER_1, TIMER32_32BIT,
     TIMER32_PERIODIC_MODE);
-    Timer32_setCount(TIMER32_0_BASE, CS_getMCLK());
-    Timer32_startTimer(TIMER32_0_BASE, true);
+    tickReload = Clock_getMCLK() / SCHED_TICK_HZ;
+    Timer32_setCount(TIMER32_0_BASE, tickReload);
+    Timer32_enableInterrupt(TIMER32_0_BASE);
+    Interrupt_setPriority(INT_T32_INT1, PRIORITY_T32_INT1);
+    Interrupt_enableInterrupt(INT_T32_INT1);
+    Timer32_startTimer(TIMER32_0_BASE, false);
 
-    // 5ms TimerA for debounce
+    // 5ms TimerA2 samples the buttons
+    smclkRatio = Clock_getMCLK() / Clock_getSMCLK();
     const Timer_A_UpModeConfig upConfig = { TIMER_A_CLOCKSOURCE_SMCLK,
                                             TIMER_A_CLOCKSOURCE_DIVIDER_1,
-                                            15000,
+                                            Clock_getSMCLK()
+                                                    / (1000 / DEBOUNCE_TICK_MS),
                                             TIMER_A_TAIE_INTERRUPT_DISABLE,
                                             TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE,
                                             TIMER_A_DO_CLEAR };
     Timer_A_configureUpMode(TIMER_A2_BASE, &upConfig);
-    Timer_A_enableInterrupt(INT_TA2_0);
+    Interrupt_setPriority(INT_TA2_0, PRIORITY_TA2_0);
+    Interrupt_enableInterrupt(INT_TA2_0);
+    Timer_A_startCounter(TIMER_A2_BASE, TIMER_A_UP_MODE);
 
-    // LCD initialization
+    // LCD pins only, the initialization sequence runs in startLCD
     configLCD(GPIO_PORT_P3, GPIO_PIN3, GPIO_PORT_P3, GPIO_PIN2, GPIO_PORT_P4);
-    initDelayTimer(CS_getMCLK());
-    initLCD();
+    initDelayTimer(Clock_getMCLK());
+
+    // Everything timed from MCLK or SMCLK follows profile changes
+    addListener("delays", initDelayTimer);
+    addListener("tick", retimeTick);
+    addListener("debounce", retimeDebounce);
+    addListener("acquisition", Acq_retime);
+    addListener("uart", Uart_retime);
+    addListener("trace", Trace_clock);
+    addListener("capture", Capture_clock);
+    addListener("boot", Boot_clock);
+
+    // Sampling is running, the LCD catches up in the background
+    Sched_trigger(lcdInitTask);
+    Boot_mark(BOOT_SETUP_DONE);
 
     Interrupt_enableMaster();
 }
 
 /*!
- * \brief This function updates the LCD based on the analog inputs
+ * \brief This function registers a scheduler task or stops setup
  *
- * This function waits until Timer32 has counted down (1 second), then updates
- * the LCD with the digital value from the analog circuit and the corresponding
- * converting analog value on the next line.
+ * \param name is the task name
+ * \param fn is the task function
+ * \param priority is the dispatch priority, 0 is highest
+ * \param period is the release period in scheduler ticks, 0 for event driven
+ * \param deadline is the relative deadline in scheduler ticks
  *
- * \return None
+ * \return Task id, never SCHED_INVALID_TASK
  */
-void loop(void)
+int addTask(const char *name, Sched_TaskFn fn, uint8_t priority,
+            uint32_t period, uint32_t deadline)
 {
-    while (TIMER32_1->VALUE != 0)
+    int id = Sched_addTask(name, fn, priority, period, deadline);
+    if (id == SCHED_INVALID_TASK)
     {
+        setupFailed(name);
     }
-    ADC14_toggleConversionTrigger();
-    commandInstruction(CLEAR_DISPLAY_MASK, false);
-    commandInstruction(RETURN_HOME_MASK, false);
+    return id;
+}
 
-    if (usePotentiometerCircuit)
+/*!
+ * \brief This function registers a clock change listener or stops setup
+ *
+ * \param name names the listener for setupFailed
+ * \param listener is called after every profile change
+ *
+ * \return None
+ */
+void addListener(const char *name, Clock_Listener listener)
+{
+    if (!Clock_addListener(listener))
     {
-        printString("Pot: ", 5);
+        setupFailed(name);
     }
-    else
+}
+
+/*!
+ * \brief This function stops on a registration that found its table full
+ *
+ * This function keeps the name for the debugger and stops with interrupts
+ * masked: a missing task or listener is a build configuration error, raise
+ * the table size.
+ *
+ * \param name is the task or listener that did not fit
+ *
+ * \return None
+ */
+void setupFailed(const char *name)
+{
+    setupFailure = name;
+    __disable_irq();
+    while (1)
     {
-        printString("Photo: ", 7);
     }
-    // Display digital value
-    char dnum[5];
-    sprintf(dnum, "%d", digitalValue);
-    printString(dnum, 7);
-    commandInstruction(SET_CURSOR_MASK | LINE2_OFFSET, false);
-
-    // Convert and print analog value
-    printString("Analog: ", 8);
-    analogValue = ((digitalValue * 3.3) / 16384) * 1000;
-    char num[10] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
-    printChar(num[analogValue / 1000]);
-    printChar('.');
-    char anum[3];
-    sprintf(anum, "%d", analogValue % 1000);
-    printString(anum, 3);
-    printString(" V", 2);
-    // Restart timer (1 second)
-    Timer32_setCount(TIMER32_0_BASE, CS_getMCLK());
 }
 
-int main(void)
+/*!
+ * \brief This function runs the LCD initialization sequence
+ *
+ * This function sends LCD initialization steps until one needs a wait of a
+ * scheduler tick or more, then re-arms itself with Sched_triggerAfter so the
+ * other tasks run and the CPU sleeps during the wait. Shorter waits are spun
+ * as in initLCD. Once the LCD is ready the display is refreshed right away.
+ *
+ * \return None
+ */
+void startLCD(void)
 {
-    setup();
+    uint32_t waitMicros;
 
-    while (1)
+    while (!initLCDStep(&waitMicros))
     {
-        loop();
+        if (waitMicros >= LCD_YIELD_MICROS)
+        {
+            Sched_triggerAfter(lcdInitTask,
+                               (waitMicros + LCD_YIELD_MICROS - 1)
+                                       / LCD_YIELD_MICROS);
+            return;
+        }
+        if (waitMicros != 0)
+        {
+            delayMicroSec(waitMicros);
+        }
     }
+    Boot_mark(BOOT_LCD_READY);
+    Sched_trigger(displayTask);
 }
 
-/* !
- * \brief This function handles ADC conversions
- *
- * This function updates the digital value of the appropriate circuit. ADC_MEM14
- * is connected to a photoresistor and ADC_MEM15 is connected to a potentiometer.
+/*!
+ * \brief This function drains the interrupt event queues
  *
- * If the incorrect conversion is ready, it will trigger again to update to the
- * correct value faster.
+ * This function copies sample block, detection, sensor and button events
+ * out of their queues in batches. Runs as deferred work in PendSV,
+ * requested by the ADC and debounce interrupts and the sensor callbacks.
+ * Each block is filtered and updates the latest value of its channel, and
+ * is encoded into the telemetry stream, before it is handed back to the ADC
+ * interrupt, which also adapts the channel's sample rate. Sensor results
+ * are averaged by the sensors themselves and are stored as they are. The
+ * last detection is kept for its screen. On the flicker screen the
+ * photoresistor is held at the full rate and its raw blocks also go to the
+ * flicker analysis, which is released once a frame is full. A debounced S1
+ * press selects the next screen.
+ * Holding S1 sends the diagnostic report and the input capture over the UART
+ * and a double click dumps the trace buffer. The dumps are started by the
+ * trace task, which owns the UART with the other tasks.
  *
  * \return None
  */
-void ADC14_IRQHandler(void)
+void handleEvents(void)
 {
-    uint64_t status = MAP_ADC14_getEnabledInterruptStatus();
-    MAP_ADC14_clearInterruptFlag(status);
-    // Photoresistor
-    if (ADC_INT14 & status)
+    INSTR_SCOPE_BEGIN(INSTR_SCOPE_EVENTS);
+    Event batch[EVENT_BATCH];
+    uint32_t count;
+    uint32_t i;
+
+    while ((count = Queue_popBatch(&adcQueue, batch, EVENT_BATCH)) != 0)
     {
-        if (!usePotentiometerCircuit)
+        // The first full block, a block period after the first conversion
+        Boot_mark(BOOT_FIRST_BLOCK);
+        for (i = 0; i < count; i++)
         {
-            digitalValue = MAP_ADC14_getResult(ADC_MEM14);
+            uint8_t block = batch[i].value;
+            uint8_t channel = batch[i].channel;
+            const uint16_t *samples = Acq_getBlock(block, channel);
+
+            storeReading(channel, Filters_processBlock(channel, samples, 0),
+                         batch[i].timestamp);
+            // The analysis needs full rate blocks, the screen pins the rate
+            if (channel == CHANNEL_PHOTO && displayMode == DISPLAY_FLICKER
+                    && Acq_getBlockRate(block, channel) == ACQ_SAMPLE_HZ
+                    && Flicker_addBlock(samples))
+            {
+                Sched_trigger(flickerTask);
+            }
+            Telemetry_addBlock(channel, samples, ACQ_BLOCK_SIZE,
+                               Acq_getBlockRate(block, channel));
+            Acq_captureBlock(block, channel, batch[i].timestamp);
+            Acq_releaseBlock(block, channel);
         }
-        else
+    }
+
+    while ((count = Queue_popBatch(&detectQueue, batch, EVENT_BATCH)) != 0)
+    {
+        Snapshot_writeBegin(&readingsSnapshot);
+        readings.detection = batch[count - 1];
+        readings.detectionTicks = Sched_getTicks();
+        readings.detections += count;
+        Snapshot_writeEnd(&readingsSnapshot);
+    }
+
+    while ((count = Queue_popBatch(&sensorQueue, batch, EVENT_BATCH)) != 0)
+    {
+        for (i = 0; i < count; i++)
         {
-            ADC14_toggleConversionTrigger();
+            storeReading(SENSOR_CHANNEL(batch[i].channel), batch[i].value,
+                         batch[i].timestamp);
         }
     }
-    // Potentiometer
-    if (ADC_INT15 & status)
+
+    while ((count = Queue_popBatch(&inputQueue, batch, EVENT_BATCH)) != 0)
     {
-        if (usePotentiometerCircuit)
+        for (i = 0; i < count; i++)
         {
-            digitalValue = MAP_ADC14_getResult(ADC_MEM15);
+            if (batch[i].type != EVENT_BUTTON)
+            {
+                continue;
+            }
+            if (batch[i].value == BUTTON_PRESS)
+            {
+                displayMode = (DisplayMode) ((displayMode + 1) % NUM_DISPLAYS);
+                // Frames start over each time the flicker screen is entered
+                Flicker_restart();
+                Acq_setRateLimits(CHANNEL_PHOTO,
+                                  displayMode == DISPLAY_FLICKER ?
+                                          ACQ_SAMPLE_HZ : ACQ_MIN_SAMPLE_HZ,
+                                  ACQ_SAMPLE_HZ);
+            }
+            else if (batch[i].value == BUTTON_LONG_PRESS)
+            {
+                Sched_trigger(reportTask);
+                captureDumpRequested = true;
+            }
+            else if (batch[i].value == BUTTON_DOUBLE_CLICK)
+            {
+                traceDumpRequested = true;
+            }
+        }
+    }
+    INSTR_SCOPE_END(INSTR_SCOPE_EVENTS);
+}
+
+/*!
+ * \brief This function publishes the latest value of a channel
+ *
+ * Only called from the events work, the single writer of the readings.
+ *
+ * \param channel is an ADC channel or SENSOR_CHANNEL of a sensor
+ * \param value is the filtered sample or the sensor result
+ * \param timestamp is the Power_timestamp of the block or reading
+ *
+ * \return None
+ */
+void storeReading(uint8_t channel, uint16_t value, uint32_t timestamp)
+{
+    Snapshot_writeBegin(&readingsSnapshot);
+    readings.value[channel] = value;
+    readings.timestamp[channel] = timestamp;
+    readings.updates[channel]++;
+    Snapshot_writeEnd(&readingsSnapshot);
+}
+
+/*!
+ * \brief This function generates the diagnostic report
+ *
+ * This function writes the timing statistics of every task and deferred
+ * work item, the time spent at each clock profile, the time each channel
+ * spent at each sample rate, the detection counts, the latest readings, the
+ * sensor, I2C, telemetry and pool counts and the stack high-water marks.
+ * The age of a reading is converted at the current MCLK. Every section
+ * writes a fixed number of lines, so printReport can resume by line count.
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+void writeReport(void (*write)(const char *line))
+{
+    static const char *const readingNames[NUM_READINGS] = { "photo", "pot",
+                                                            "temp", "light" };
+    char line[64];
+    Sched_Stats stats;
+    Readings latest;
+    uint32_t now;
+    int i;
+
+    write("task       runs   worst     avg  misses");
+    for (i = 0; i < Sched_getTaskCount(); i++)
+    {
+        Sched_getStats(i, &stats);
+        sprintf(line, "%-8s %6lu %7lu %7lu %7lu", Sched_getName(i),
+                (unsigned long) stats.runs,
+                (unsigned long) stats.worstCycles,
+                (unsigned long) (stats.runs ?
+                        stats.totalCycles / stats.runs : 0),
+                (unsigned long) stats.deadlineMisses);
+        write(line);
+    }
+    Defer_report(write);
+    sprintf(line, "load %u%%, idle %u%%, dropped blocks %lu",
+            Governor_getLoad(), idlePercent,
+            (unsigned long) Acq_getOverruns());
+    write(line);
+    Governor_report(write);
+    Acq_report(write);
+    Detector_report(write);
+
+    Snapshot_read(&readingsSnapshot, &latest);
+    now = Power_timestamp();
+    write("reading    value  updates  age ms");
+    for (i = 0; i < NUM_READINGS; i++)
+    {
+        sprintf(line, "%-8s %7u %8lu %7lu", readingNames[i], latest.value[i],
+                (unsigned long) latest.updates[i],
+                (unsigned long) ((now - latest.timestamp[i])
+                        / (Clock_getMCLK() / 1000)));
+        write(line);
+    }
+    sprintf(line, "snapshot retries %lu",
+            (unsigned long) Snapshot_getRetries(&readingsSnapshot));
+    write(line);
+    Boot_report(write);
+    Sensors_report(write);
+    Telemetry_report(write);
+    Pool_report(write);
+    Stack_report(write);
+    Instr_report(write);
+}
+
+/*!
+ * \brief This function writes one report line if it is due and fits
+ *
+ * Lines sent by an earlier run are skipped. Once a line does not fit, the
+ * rest of this run is skipped too, so no line is ever cut off.
+ *
+ * \param line is the next line of the report
+ *
+ * \return None
+ */
+void writeReportLine(const char *line)
+{
+    if (reportLine++ < reportSent || reportFull)
+    {
+        return;
+    }
+    if (Uart_getFree() < strlen(line) + 2)
+    {
+        reportFull = true;
+        return;
+    }
+    Uart_writeLine(line);
+    reportSent++;
+}
+
+/*!
+ * \brief This function sends the diagnostic report over the UART
+ *
+ * The report is longer than the UART buffer, so this function writes the
+ * lines that fit and the trace task triggers it again for the rest. Each
+ * run generates the report from the start and skips the lines already
+ * sent; lines sent by a later run show the counts of that run.
+ *
+ * \return None
+ */
+void printReport(void)
+{
+    reportLine = 0;
+    reportFull = false;
+    writeReport(writeReportLine);
+    reportPending = reportFull;
+    if (!reportPending)
+    {
+        reportSent = 0;
+    }
+}
+
+/*!
+ * \brief This function writes started trace and capture dumps over the UART
+ *
+ * This function runs every 100 ms, about the time the UART needs to drain a
+ * full buffer, and writes only as many lines as fit so a dump never blocks
+ * the other tasks. Dumps requested with S1 start here. A capture dump waits
+ * for a running trace dump so their lines do not interleave, and the
+ * telemetry stream waits for both. A report that did not fit goes first:
+ * this task releases the report task for its next lines instead.
+ *
+ * \return None
+ */
+void dumpTrace(void)
+{
+    if (reportPending)
+    {
+        Sched_trigger(reportTask);
+        return;
+    }
+    if (traceDumpRequested)
+    {
+        traceDumpRequested = false;
+        Trace_dumpBegin(Uart_writeLine);
+    }
+    if (captureDumpRequested)
+    {
+        captureDumpRequested = false;
+        Capture_dumpBegin(Uart_writeLine);
+    }
+    // "tttttttt iiii pppp\r\n" is 20 bytes per record
+    if (Trace_dumpStep(Uart_getFree() / 20)
+            && Capture_dumpStep(Uart_getFree() / (2 * CAPTURE_LINE_BYTES + 2)))
+    {
+        Telemetry_step(Uart_write, Uart_getFree());
+    }
+}
+
+/*!
+ * \brief This function keeps the scheduler tick at SCHED_TICK_HZ
+ *
+ * \param mclk is the new MCLK frequency in Hz
+ *
+ * \return None
+ */
+void retimeTick(uint32_t mclk)
+{
+    tickReload = mclk / SCHED_TICK_HZ;
+    Timer32_setCount(TIMER32_0_BASE, tickReload);
+}
+
+/*!
+ * \brief This function keeps the debounce tick at DEBOUNCE_TICK_MS
+ *
+ * \param mclk is the new MCLK frequency in Hz, TimerA2 runs from SMCLK
+ *
+ * \return None
+ */
+void retimeDebounce(uint32_t mclk)
+{
+    smclkRatio = mclk / Clock_getSMCLK();
+    Timer_A_setCompareValue(TIMER_A2_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0,
+                            Clock_getSMCLK() / (1000 / DEBOUNCE_TICK_MS));
+}
+
+/*!
+ * \brief This function converts an ADC reading to display text
+ *
+ * This function writes the raw reading and the corresponding voltage as
+ * "d.ddd" with millivolt resolution.
+ *
+ * \param digitalValue is the 14-bit ADC reading
+ * \param digits receives the reading, READING_LENGTH characters
+ * \param volts receives the voltage, READING_LENGTH characters
+ *
+ * \return None
+ */
+void formatReading(uint16_t digitalValue, char *digits, char *volts)
+{
+    // Millivolts for a 3.3 V reference, integer math only
+    uint32_t analogValue = ((uint32_t) digitalValue * 3300) / ADC_FULL_SCALE;
+
+    // A 14-bit reading is below 3.3 V, the clamp keeps the text in its buffer
+    if (analogValue > 9999)
+    {
+        analogValue = 9999;
+    }
+    snprintf(digits, READING_LENGTH, "%u", digitalValue);
+    snprintf(volts, READING_LENGTH, "%lu.%03lu",
+             (unsigned long) (analogValue / 1000),
+             (unsigned long) (analogValue % 1000));
+}
+
+/*!
+ * \brief This function updates the LCD based on the analog inputs
+ *
+ * This function updates the LCD with the digital value from the analog
+ * circuit and the corresponding converting analog value on the next line,
+ * with the flicker analysis on the flicker screen, with the digital
+ * sensors or the last detection on theirs, or with every reading on the
+ * ticker. The readings are copied once at the start, so the screen shows a
+ * single update of them. The other screens are cleared and redrawn, the
+ * ticker only rewrites what changed and keeps scrolling. Released by the
+ * scheduler once a second, and once by startLCD. The boot times are sent
+ * over the UART after the first refresh.
+ *
+ * \return None
+ */
+void refreshDisplay(void)
+{
+    Readings latest;
+
+    if (!isLCDReady())
+    {
+        return;
+    }
+    INSTR_SCOPE_BEGIN(INSTR_SCOPE_DISPLAY);
+    Snapshot_read(&readingsSnapshot, &latest);
+    idlePercent = Power_getIdlePercent();
+    Instr_recordLoad(100 - idlePercent);
+    if (displayMode != DISPLAY_TICKER)
+    {
+        commandInstruction(CLEAR_DISPLAY_MASK, false);
+        commandInstruction(RETURN_HOME_MASK, false);
+    }
+    tickerShown = displayMode == DISPLAY_TICKER;
+
+    if (displayMode == DISPLAY_FLICKER)
+    {
+        showFlicker();
+    }
+    else if (displayMode == DISPLAY_SENSORS)
+    {
+        showSensors(&latest);
+    }
+    else if (displayMode == DISPLAY_DETECTIONS)
+    {
+        showDetection(&latest);
+    }
+    else if (displayMode == DISPLAY_TICKER)
+    {
+        showTicker(&latest);
+    }
+    else
+    {
+        uint16_t digitalValue = latest.value[displayMode == DISPLAY_POT ?
+                                             CHANNEL_POT : CHANNEL_PHOTO];
+        char digits[READING_LENGTH];
+        char volts[READING_LENGTH];
+
+        formatReading(digitalValue, digits, volts);
+        if (displayMode == DISPLAY_POT)
+        {
+            printString("Pot: ", 5);
         }
         else
         {
-            ADC14_toggleConversionTrigger();
+            printString("Photo: ", 7);
         }
+        // Display digital value
+        printString(digits, strlen(digits));
+        commandInstruction(SET_CURSOR_MASK | LINE2_OFFSET, false);
 
+        // Print analog value
+        printString("Analog: ", 8);
+        printString(volts, strlen(volts));
+        printString(" V", 2);
+    }
+    INSTR_SCOPE_END(INSTR_SCOPE_DISPLAY);
+
+    if (Boot_mark(BOOT_FIRST_DISPLAY))
+    {
+        Boot_report(Uart_writeLine);
     }
 }
 
 /*!
- * \brief This function toggles which analog circuit is used for input
+ * \brief This function writes the flicker analysis to the LCD
  *
- * This function toggles whether the analog input is the potentiometer or the
- * photoresistor when S1 is pressed.
+ * This function shows the dominant flicker frequency on the first line and
+ * the percent flicker at 100 Hz and 120 Hz on the second. Each frame takes
+ * FLICKER_SIZE samples, so the first result appears about half a second
+ * after the screen is selected. The cursor is at home.
  *
  * \return None
  */
-void PORT1_IRQHandler(void)
+void showFlicker(void)
 {
-    uint32_t status = GPIO_getEnabledInterruptStatus(GPIO_PORT_P1);
-    GPIO_clearInterruptFlag(GPIO_PORT_P1, status);
+    Flicker_Result flicker;
+    char line[LCD_COLUMNS + 1];
+    unsigned low;
+    unsigned high;
 
-    if (debounced)
+    Flicker_getResult(&flicker);
+    if (!flicker.valid)
     {
-        if (status & SWITCH_PIN)
-        {
-            usePotentiometerCircuit = !usePotentiometerCircuit;
-        }
-//        debounced = false;
-        Timer_A_startCounter(TIMER_A2_BASE, TIMER_A_UP_MODE);
+        printString("Flicker ...", 11);
+        return;
     }
+    if (flicker.peakTenthsHz == 0)
+    {
+        printString("Flicker none", 12);
+    }
+    else
+    {
+        snprintf(line, sizeof(line), "Flicker %3u.%uHz",
+                 flicker.peakTenthsHz / 10, flicker.peakTenthsHz % 10);
+        printString(line, strlen(line));
+    }
+    commandInstruction(SET_CURSOR_MASK | LINE2_OFFSET, false);
+
+    // Whole percent, two digits fit, so a depth of 100 % shows as 99
+    low = (flicker.lowPermille + 5) / 10;
+    high = (flicker.highPermille + 5) / 10;
+    snprintf(line, sizeof(line), "%u:%2u%% %u:%2u%%", FLICKER_LOW_HZ,
+             low > 99 ? 99 : low, FLICKER_HIGH_HZ, high > 99 ? 99 : high);
+    printString(line, strlen(line));
 }
 
 /*!
- * \brief This function acts as a debounce function for S1
+ * \brief This function converts a sensor reading to display text
  *
- * This function turns debounced to true so S1 can take another press
+ * \param latest is a snapshot of the readings
+ * \param sensor is SENSOR_TEMP or SENSOR_LIGHT
+ * \param text receives the value with its unit, or "--" for a sensor that
+ *        has not answered yet, SENSOR_TEXT_LENGTH characters
+ *
+ * \return None
+ */
+void formatSensor(const Readings *latest, uint8_t sensor, char *text)
+{
+    if (latest->updates[SENSOR_CHANNEL(sensor)] != 0)
+    {
+        Sensors_format(sensor, latest->value[SENSOR_CHANNEL(sensor)], text,
+                       SENSOR_TEXT_LENGTH);
+    }
+    else
+    {
+        strcpy(text, "--");
+    }
+}
+
+/*!
+ * \brief This function writes the digital sensor readings to the LCD
+ *
+ * This function shows the temperature on the first line and the ambient
+ * light on the second. The cursor is at home.
+ *
+ * \param latest is a snapshot of the readings
+ *
+ * \return None
+ */
+void showSensors(const Readings *latest)
+{
+    char value[SENSOR_TEXT_LENGTH];
+
+    formatSensor(latest, SENSOR_TEMP, value);
+    printString("Temp: ", 6);
+    printString(value, strlen(value));
+    commandInstruction(SET_CURSOR_MASK | LINE2_OFFSET, false);
+
+    formatSensor(latest, SENSOR_LIGHT, value);
+    printString("Light: ", 7);
+    printString(value, strlen(value));
+}
+
+/*!
+ * \brief This function writes the last detection to the LCD
+ *
+ * This function shows the channel and kind of the last detection on the
+ * first line, and its sample and the time since boot it was handled at on
+ * the second. The cursor is at home.
+ *
+ * \param latest is a snapshot of the readings
+ *
+ * \return None
+ */
+void showDetection(const Readings *latest)
+{
+    static const char *const kindNames[] = { "rising", "falling", "peak",
+                                             "dip" };
+    const Event *detection = &latest->detection;
+    char line[LCD_COLUMNS + 1];
+    char when[24];
+
+    if (latest->detections == 0)
+    {
+        printString("No events", 9);
+        return;
+    }
+    snprintf(line, sizeof(line), "%s %s",
+             detection->channel == CHANNEL_POT ? "Pot" : "Photo",
+             kindNames[detection->type - EVENT_RISING]);
+    printString(line, strlen(line));
+    commandInstruction(SET_CURSOR_MASK | LINE2_OFFSET, false);
+
+    snprintf(when, sizeof(when), "%u @%lu.%02lus", detection->value,
+             (unsigned long) (latest->detectionTicks / SCHED_TICK_HZ),
+             (unsigned long) (latest->detectionTicks % SCHED_TICK_HZ * 100
+                     / SCHED_TICK_HZ));
+    // Past a day of uptime the end of the time is cut off
+    when[LCD_COLUMNS] = '\0';
+    printString(when, strlen(when));
+}
+
+/*!
+ * \brief This function writes every reading to the ticker lines
+ *
+ * This function lays the analog readings and the detection count out on
+ * the first 40-column DDRAM line and the sensors on the second, padded with
+ * spaces so the text is apart where the scroll wraps around. Only the
+ * characters that changed are sent, wherever the view has scrolled to.
+ *
+ * \param latest is a snapshot of the readings
+ *
+ * \return None
+ */
+void showTicker(const Readings *latest)
+{
+    char line[48];
+    char digits[READING_LENGTH];
+    char pot[READING_LENGTH];
+    char photo[READING_LENGTH];
+    char temp[SENSOR_TEXT_LENGTH];
+    char light[SENSOR_TEXT_LENGTH];
+    size_t length;
+
+    formatReading(latest->value[CHANNEL_POT], digits, pot);
+    formatReading(latest->value[CHANNEL_PHOTO], digits, photo);
+    snprintf(line, sizeof(line), "Pot %s V  Photo %s V  Det %lu", pot, photo,
+             (unsigned long) latest->detections);
+    length = strlen(line);
+    if (length < LCD_DDRAM_COLUMNS)
+    {
+        memset(line + length, ' ', LCD_DDRAM_COLUMNS - length);
+    }
+    writeLCDField(0, 0, line, LCD_DDRAM_COLUMNS);
+
+    formatSensor(latest, SENSOR_TEMP, temp);
+    formatSensor(latest, SENSOR_LIGHT, light);
+    snprintf(line, sizeof(line), "Temp %s  Light %s", temp, light);
+    length = strlen(line);
+    memset(line + length, ' ', LCD_DDRAM_COLUMNS - length);
+    writeLCDField(1, 0, line, LCD_DDRAM_COLUMNS);
+}
+
+/*!
+ * \brief This function scrolls the ticker one column
+ *
+ * This function shifts the display while the ticker is shown, one
+ * instruction instead of redrawing both lines. Runs every
+ * TICKER_STEP_TICKS, so the lines go around every 10 seconds.
+ *
+ * \return None
+ */
+void scrollTicker(void)
+{
+    if (tickerShown && displayMode == DISPLAY_TICKER)
+    {
+        scrollLCD(1);
+    }
+}
+
+#if DSP_BENCH_ENABLE
+/*!
+ * \brief This function returns MCLK cycles for the DSP benchmark
+ *
+ * \return Power_timestamp
+ */
+static uint32_t dspCycles(void)
+{
+    return Power_timestamp();
+}
+#endif
+
+/*!
+ * \brief This function runs the main context on its own stack
+ *
+ * \return None
+ */
+static void appMain(void)
+{
+    setup();
+
+#if DSP_BENCH_ENABLE
+    DspBench_run(dspCycles, Uart_writeLine);
+#endif
+    Sched_run();
+}
+
+int main(void)
+{
+    Stack_init();
+    Stack_runOnMainStack(appMain);
+}
+
+/*!
+ * \brief This function provides the scheduler tick
+ *
+ * This function advances scheduler time each time Timer32 reloads, releasing
+ * periodic tasks and waking the CPU from LPM0.
+ *
+ * \return None
+ */
+void T32_INT1_IRQHandler(void)
+{
+    INSTR_ISR_ENTER(INSTR_ISR_T32_INT1);
+    TRACE(TRACE_ISR_T32_INT1_BEGIN, 0);
+    // Counter runs from MCLK, so cycles since the reload are the latency
+    INSTR_ISR_LATENCY(INSTR_ISR_T32_INT1,
+                      tickReload - Timer32_getValue(TIMER32_0_BASE));
+    Timer32_clearInterruptFlag(TIMER32_0_BASE);
+    Sched_tick();
+    TRACE(TRACE_ISR_T32_INT1_END, 0);
+    INSTR_ISR_EXIT(INSTR_ISR_T32_INT1);
+}
+
+/*!
+ * \brief This function samples the buttons
+ *
+ * This function runs the debounce engine every 5 ms and requests the events
+ * work when a button event was posted.
  *
  * \return None
  */
 void TA2_0_IRQHandler(void)
 {
-    debounced = true;
-    Timer_A_stopTimer(TIMER_A0_BASE);
+    INSTR_ISR_ENTER(INSTR_ISR_TA2_0);
+    TRACE(TRACE_ISR_TA2_0_BEGIN, 0);
+    // TA2R counts SMCLK periods since the CCR0 match
+    INSTR_ISR_LATENCY(INSTR_ISR_TA2_0, TIMER_A2->R * smclkRatio);
     Timer_A_clearCaptureCompareInterrupt(TIMER_A2_BASE,
     TIMER_A_CAPTURECOMPARE_REGISTER_0);
+    if (Debounce_tick())
+    {
+        Defer_request(eventWork);
+    }
+    TRACE(TRACE_ISR_TA2_0_END, 0);
+    INSTR_ISR_EXIT(INSTR_ISR_TA2_0);
 }
@@ -0,0 +1,470 @@
+/*!
+ * periph.hpp
+ *      Description: Header only C++ layer over the GPIO, Timer_A and ADC14
+ *                   registers. Pins, timers and conversion memories are
+ *                   types, so the port, pin, instance and channel are known
+ *                   at compile time: a wrong one is a static_assert instead
+ *                   of a silently ignored DriverLib argument, and each access
+ *                   compiles to the register operation itself. Single bit
+ *                   writes go through the peripheral bit-band alias, one
+ *                   store with no read-modify-write.
+ *
+ *                   Nothing here replaces the C modules. A .cpp module can
+ *                   use these types and keep its extern "C" header, so
+ *                   modules migrate one at a time (see Switch.cpp). The
+ *                   types only touch registers, so mixing them with DriverLib
+ *                   calls on the same peripheral is fine.
+ *
+ *                   On the host build (STUB_DRIVERLIB) every access is also
+ *                   reported to the stub, so the benchmarks and the
+ *                   simulator see it like a DriverLib call.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef PERIPH_HPP_
+#define PERIPH_HPP_
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdint.h>
+
+namespace periph
+{
+
+namespace detail
+{
+
+/* Register accessors by port number, P1 - P10 */
+template<unsigned N> struct PortRegs;
+
+#define PERIPH_PORT_REGS(n) \
+    template<> struct PortRegs<n> \
+    { \
+        static decltype(P##n) get() { return P##n; } \
+    };
+PERIPH_PORT_REGS(1)
+PERIPH_PORT_REGS(2)
+PERIPH_PORT_REGS(3)
+PERIPH_PORT_REGS(4)
+PERIPH_PORT_REGS(5)
+PERIPH_PORT_REGS(6)
+PERIPH_PORT_REGS(7)
+PERIPH_PORT_REGS(8)
+PERIPH_PORT_REGS(9)
+PERIPH_PORT_REGS(10)
+#undef PERIPH_PORT_REGS
+
+/* Register accessors by Timer_A instance, TIMER_A0 - TIMER_A3 */
+template<unsigned N> struct TimerRegs;
+
+#ifdef STUB_DRIVERLIB
+#define PERIPH_TIMER_REGS(n) \
+    template<> struct TimerRegs<n> \
+    { \
+        static Timer_A_Type *get() { return Stub_timerARegs(n); } \
+    };
+#else
+#define PERIPH_TIMER_REGS(n) \
+    template<> struct TimerRegs<n> \
+    { \
+        static decltype(TIMER_A##n) get() { return TIMER_A##n; } \
+    };
+#endif
+PERIPH_TIMER_REGS(0)
+PERIPH_TIMER_REGS(1)
+PERIPH_TIMER_REGS(2)
+PERIPH_TIMER_REGS(3)
+#undef PERIPH_TIMER_REGS
+
+/*!
+ * Accounts register accesses on the host, nothing on the target.
+ *
+ * \param reads Register reads
+ * \param writes Register writes
+ *
+ * \return None
+ */
+inline void bus(uint32_t reads, uint32_t writes)
+{
+#ifdef STUB_DRIVERLIB
+    Stub_bus(reads, writes);
+#else
+    (void) reads;
+    (void) writes;
+#endif
+}
+
+/*!
+ * Writes one bit of a peripheral register with a single store through the
+ * bit-band alias. The host has no alias and uses read-modify-write, charged
+ * as the one write the target makes.
+ *
+ * \param reg Register
+ * \param bit Bit number
+ * \param value New bit value
+ *
+ * \return None
+ */
+template<typename Reg>
+inline void writeBit(volatile Reg &reg, unsigned bit, bool value)
+{
+#ifdef STUB_DRIVERLIB
+    reg = value ? (Reg) (reg | (1u << bit)) : (Reg) (reg & ~(1u << bit));
+    bus(0, 1);
+#else
+    *reinterpret_cast<volatile uint32_t *>(0x42000000u
+            + ((reinterpret_cast<uintptr_t>(&reg) - 0x40000000u) << 5)
+            + (bit << 2)) = value;
+#endif
+}
+
+/* ADC14 input channel to pin, from the MSP432P401R data sheet */
+constexpr unsigned adcPort(unsigned channel)
+{
+    return channel < 6 ? 5 : channel < 14 ? 4 : channel < 16 ? 6 :
+           channel < 18 ? 9 : 8;
+}
+
+constexpr unsigned adcPin(unsigned channel)
+{
+    return channel < 6 ? 5 - channel : channel < 14 ? 13 - channel :
+           channel < 16 ? 15 - channel : channel < 18 ? 17 - channel :
+           25 - channel;
+}
+
+} // namespace detail
+
+/* Peripheral module functions, the PxSEL1:PxSEL0 setting */
+enum class Function : uint8_t
+{
+    Primary = 1,
+    Secondary = 2,
+    Tertiary = 3
+};
+
+/*!
+ * \brief A group of pins on one port
+ *
+ * \tparam PortN is the port number, 1 - 10
+ * \tparam Mask is the set of pins, bit n for pin n
+ */
+template<unsigned PortN, uint8_t Mask>
+struct PinGroup
+{
+    static_assert(PortN >= 1 && PortN <= 10,
+                  "the MSP432P401R has ports P1 to P10");
+    static_assert(Mask != 0, "a pin group needs at least one pin");
+
+    static constexpr uint8_t port = PortN;
+    static constexpr uint8_t mask = Mask;
+
+    static decltype(detail::PortRegs<PortN>::get()) regs()
+    {
+        return detail::PortRegs<PortN>::get();
+    }
+
+    /*! \brief Makes the pins outputs with GPIO function */
+    static void asOutput()
+    {
+        auto r = regs();
+        r->SEL0 &= ~Mask;
+        r->SEL1 &= ~Mask;
+        r->DIR |= Mask;
+        detail::bus(3, 3);
+    }
+
+    /*! \brief Makes the pins inputs with pull-up resistors */
+    static void asInputPullUp()
+    {
+        auto r = regs();
+        r->SEL0 &= ~Mask;
+        r->SEL1 &= ~Mask;
+        r->DIR &= ~Mask;
+        r->OUT |= Mask;
+        r->REN |= Mask;
+        detail::bus(5, 5);
+#ifdef STUB_DRIVERLIB
+        // Nothing drives the pins yet, the pull-ups read high
+        r->IN |= Mask;
+#endif
+    }
+
+    /*! \brief Hands the pins to a peripheral module */
+    template<Function F>
+    static void asPeripheral()
+    {
+        auto r = regs();
+        if (static_cast<uint8_t>(F) & 1)
+        {
+            r->SEL0 |= Mask;
+        }
+        else
+        {
+            r->SEL0 &= ~Mask;
+        }
+        if (static_cast<uint8_t>(F) & 2)
+        {
+            r->SEL1 |= Mask;
+        }
+        else
+        {
+            r->SEL1 &= ~Mask;
+        }
+        detail::bus(2, 2);
+    }
+
+    /*!
+     * \brief Writes the group with one read-modify-write, other pins of the
+     *        port keep their level
+     *
+     * \param value is the new level of each pin in the group, bits outside
+     *              the group are ignored
+     */
+    static void write(uint8_t value)
+    {
+        auto r = regs();
+        r->OUT = (r->OUT & ~Mask) | (value & Mask);
+        detail::bus(1, 1);
+#ifdef STUB_DRIVERLIB
+        Stub_portWritten(PortN);
+#endif
+    }
+
+    /*! \brief Returns the input level of the group, other bits are 0 */
+    static uint8_t read()
+    {
+        detail::bus(1, 0);
+        return regs()->IN & Mask;
+    }
+};
+
+/*!
+ * \brief One pin
+ *
+ * \tparam PortN is the port number, 1 - 10
+ * \tparam PinN is the pin number, 0 - 7
+ */
+template<unsigned PortN, unsigned PinN>
+struct Pin : PinGroup<PortN, (uint8_t) (1u << (PinN & 7))>
+{
+    static_assert(PinN < 8, "pins are numbered 0 to 7");
+
+    static constexpr unsigned pin = PinN;
+
+    using Group = PinGroup<PortN, (uint8_t) (1u << (PinN & 7))>;
+
+    /*! \brief Drives the pin high */
+    static void high()
+    {
+        detail::writeBit(Group::regs()->OUT, PinN, true);
+#ifdef STUB_DRIVERLIB
+        Stub_portWritten(PortN);
+#endif
+    }
+
+    /*! \brief Drives the pin low */
+    static void low()
+    {
+        detail::writeBit(Group::regs()->OUT, PinN, false);
+#ifdef STUB_DRIVERLIB
+        Stub_portWritten(PortN);
+#endif
+    }
+
+    /*! \brief Drives the pin to a level */
+    static void write(bool level)
+    {
+        detail::writeBit(Group::regs()->OUT, PinN, level);
+#ifdef STUB_DRIVERLIB
+        Stub_portWritten(PortN);
+#endif
+    }
+
+    /*! \brief Returns true if the pin reads high */
+    static bool read()
+    {
+        return Group::read() != 0;
+    }
+};
+
+/*!
+ * \brief Checks at compile time that pins or pin groups do not overlap
+ *
+ * static_assert(periph::Disjoint<Rs, En, Data>::value, "...");
+ */
+template<typename... Groups>
+struct Disjoint
+{
+    static constexpr bool value = true;
+};
+
+template<typename First, typename Second, typename... Rest>
+struct Disjoint<First, Second, Rest...>
+{
+    static constexpr bool value = !(First::port == Second::port
+            && (First::mask & Second::mask) != 0)
+            && Disjoint<First, Rest...>::value
+            && Disjoint<Second, Rest...>::value;
+};
+
+/* Timer_A clock sources, the TASSEL setting */
+enum class ClockSource : uint16_t
+{
+    Taclk = 0x0000,
+    Aclk = 0x0100,
+    Smclk = 0x0200,
+    Inclk = 0x0300
+};
+
+/*!
+ * \brief One Timer_A instance
+ *
+ * \tparam N is the instance, 0 - 3
+ */
+template<unsigned N>
+struct TimerA
+{
+    static_assert(N < 4, "the MSP432P401R has Timer_A0 to Timer_A3");
+
+    /* TAxCTL and TAxCCTLn bits */
+    static constexpr uint16_t TACLR = 0x0004;
+    static constexpr uint16_t MC_UP = 0x0010;
+    static constexpr uint16_t MC_MASK = 0x0030;
+    static constexpr uint16_t CCIE = 0x0010;
+    static constexpr unsigned CCIFG_BIT = 0;
+
+    static decltype(detail::TimerRegs<N>::get()) regs()
+    {
+        return detail::TimerRegs<N>::get();
+    }
+
+    /*!
+     * \brief Starts the timer in up mode from zero
+     *
+     * \tparam Source is the clock source
+     * \tparam Divider is the input divider, 1, 2, 4 or 8
+     * \param period is the CCR0 value, the timer counts period + 1 clocks
+     * \param interrupt enables the CCR0 interrupt
+     */
+    template<ClockSource Source, unsigned Divider>
+    static void startUp(uint16_t period, bool interrupt)
+    {
+        static_assert(Divider == 1 || Divider == 2 || Divider == 4
+                              || Divider == 8,
+                      "the ID divider is 1, 2, 4 or 8");
+        constexpr uint16_t id = Divider == 1 ? 0x0000 : Divider == 2 ? 0x0040 :
+                                Divider == 4 ? 0x0080 : 0x00C0;
+        auto r = regs();
+        r->CTL = 0;
+        r->CCR[0] = period;
+        r->CCTL[0] = interrupt ? CCIE : 0;
+        r->CTL = static_cast<uint16_t>(Source) | id | MC_UP | TACLR;
+        detail::bus(0, 4);
+#ifdef STUB_DRIVERLIB
+        Stub_timerAWritten(N);
+#endif
+    }
+
+    /*! \brief Stops the counter, it keeps its count */
+    static void stop()
+    {
+        auto r = regs();
+        r->CTL &= ~MC_MASK;
+        detail::bus(1, 1);
+#ifdef STUB_DRIVERLIB
+        Stub_timerAWritten(N);
+#endif
+    }
+
+    /*! \brief Changes the up mode period, CCR0 */
+    static void setPeriod(uint16_t period)
+    {
+        regs()->CCR[0] = period;
+        detail::bus(0, 1);
+#ifdef STUB_DRIVERLIB
+        Stub_timerAWritten(N);
+#endif
+    }
+
+    /*! \brief Clears the CCR0 interrupt flag */
+    static void clearCcr0Flag()
+    {
+        detail::writeBit(regs()->CCTL[0], CCIFG_BIT, false);
+    }
+
+    /*! \brief Returns the counter, TAxR */
+    static uint16_t count()
+    {
+        detail::bus(1, 0);
+        return regs()->R;
+    }
+};
+
+/*!
+ * \brief An ADC14 input channel and the pin it is on
+ *
+ * \tparam Channel is the input, 0 - 23 (A0 - A23)
+ */
+template<unsigned Channel>
+struct AdcInput
+{
+    static_assert(Channel < 24, "the MSP432P401R has inputs A0 to A23");
+
+    static constexpr unsigned channel = Channel;
+
+    using InputPin = Pin<detail::adcPort(Channel), detail::adcPin(Channel)>;
+
+    /*! \brief Hands the pin to the ADC (tertiary function) */
+    static void selectPin()
+    {
+        InputPin::template asPeripheral<Function::Tertiary>();
+    }
+};
+
+/*!
+ * \brief An ADC14 conversion memory bound to an input
+ *
+ * \tparam Memory is the conversion memory, 0 - 31
+ * \tparam Input is an AdcInput
+ */
+template<unsigned Memory, typename Input>
+struct AdcMemory
+{
+    static_assert(Memory < 32, "ADC14 has conversion memories 0 to 31");
+
+    static constexpr uint32_t flag = 1UL << Memory;
+
+    /*!
+     * \brief Selects the input with AVCC and VSS references. Conversions
+     *        must be disabled (ENC = 0).
+     */
+    static void configure()
+    {
+        ADC14->MCTL[Memory] = Input::channel;
+        detail::bus(0, 1);
+    }
+
+    /*! \brief Returns true when a result is ready */
+    static bool ready()
+    {
+        detail::bus(1, 0);
+        return (ADC14->IFGR0 & flag) != 0;
+    }
+
+    /*! \brief Returns the result, reading it clears the ready flag */
+    static uint16_t result()
+    {
+        uint16_t value = ADC14->MEM[Memory];
+        detail::bus(1, 0);
+#ifdef STUB_DRIVERLIB
+        Stub_adcResultRead(Memory);
+#endif
+        return value;
+    }
+};
+
+} // namespace periph
+
+#endif /* PERIPH_HPP_ */
@@ -0,0 +1,235 @@
+/*!
+ * pool.c
+ *      Description: Helper file for the fixed-block pool allocator. Each
+ *                   free block holds the link to the next, so a pool is a
+ *                   singly linked free list over its static array and a
+ *                   block is taken or returned at the head in a short
+ *                   critical section. The pool of a freed block is found
+ *                   from its address, and a bitmap of the blocks in use
+ *                   catches a block freed twice before it corrupts the
+ *                   list.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+
+#include "pool.h"
+
+/* Words of an in-use bitmap for count blocks */
+#define BITMAP_WORDS(count) (((count) + 31) / 32)
+
+typedef struct PoolBlock
+{
+    struct PoolBlock *next;
+} PoolBlock;
+
+typedef struct
+{
+    uint8_t *storage;
+    uint16_t size;
+    uint16_t count;
+    PoolBlock *freeList;
+    uint32_t *inUse;
+    uint16_t used;
+    uint16_t highWater;
+    uint32_t failures;
+} Pool;
+
+#if POOL_ENABLE
+/* uint32_t arrays keep every block word aligned */
+static uint32_t smallStorage[POOL_SMALL_COUNT * POOL_SMALL_SIZE / 4];
+static uint32_t mediumStorage[POOL_MEDIUM_COUNT * POOL_MEDIUM_SIZE / 4];
+static uint32_t largeStorage[POOL_LARGE_COUNT * POOL_LARGE_SIZE / 4];
+
+static uint32_t smallInUse[BITMAP_WORDS(POOL_SMALL_COUNT)];
+static uint32_t mediumInUse[BITMAP_WORDS(POOL_MEDIUM_COUNT)];
+static uint32_t largeInUse[BITMAP_WORDS(POOL_LARGE_COUNT)];
+
+/* Linked and counted by Pool_init */
+static Pool pools[POOL_NUM_CLASSES] = {
+        { (uint8_t *) smallStorage, POOL_SMALL_SIZE, POOL_SMALL_COUNT,
+          NULL, smallInUse, 0, 0, 0 },
+        { (uint8_t *) mediumStorage, POOL_MEDIUM_SIZE, POOL_MEDIUM_COUNT,
+          NULL, mediumInUse, 0, 0, 0 },
+        { (uint8_t *) largeStorage, POOL_LARGE_SIZE, POOL_LARGE_COUNT,
+          NULL, largeInUse, 0, 0, 0 } };
+#endif
+
+/* Pointers passed to Pool_free that are not pool blocks in use */
+static volatile uint32_t invalidFrees;
+
+void Pool_init(void)
+{
+#if POOL_ENABLE
+    uint32_t primask = __get_PRIMASK();
+    int p;
+    int i;
+
+    __disable_irq();
+    for (p = 0; p < POOL_NUM_CLASSES; p++)
+    {
+        Pool *pool = &pools[p];
+
+        pool->freeList = NULL;
+        // Link from the end so blocks are handed out in address order
+        for (i = pool->count - 1; i >= 0; i--)
+        {
+            PoolBlock *block = (PoolBlock *) (pool->storage + i * pool->size);
+
+            block->next = pool->freeList;
+            pool->freeList = block;
+        }
+        for (i = 0; i < BITMAP_WORDS(pool->count); i++)
+        {
+            pool->inUse[i] = 0;
+        }
+        pool->used = 0;
+        pool->highWater = 0;
+        pool->failures = 0;
+    }
+    __set_PRIMASK(primask);
+#endif
+    invalidFrees = 0;
+}
+
+void *Pool_alloc(uint32_t size)
+{
+#if POOL_ENABLE
+    uint32_t primask;
+    PoolBlock *block = NULL;
+    uint32_t index;
+    int p;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for (p = 0; p < POOL_NUM_CLASSES && block == NULL; p++)
+    {
+        Pool *pool = &pools[p];
+
+        if (size > pool->size)
+        {
+            continue;
+        }
+        block = pool->freeList;
+        if (block == NULL)
+        {
+            pool->failures++;
+            continue;
+        }
+        pool->freeList = block->next;
+        index = ((uint8_t *) block - pool->storage) / pool->size;
+        pool->inUse[index / 32] |= 1UL << (index % 32);
+        if (++pool->used > pool->highWater)
+        {
+            pool->highWater = pool->used;
+        }
+    }
+    __set_PRIMASK(primask);
+    return block;
+#else
+    return NULL;
+#endif
+}
+
+void Pool_free(void *block)
+{
+#if POOL_ENABLE
+    uint8_t *address = block;
+    Pool *pool = NULL;
+    uint32_t primask;
+    uint32_t offset = 0;
+    uint32_t mask = 0;
+    uint32_t *word = NULL;
+    int p;
+
+    if (block == NULL)
+    {
+        return;
+    }
+    for (p = 0; p < POOL_NUM_CLASSES && pool == NULL; p++)
+    {
+        if (address >= pools[p].storage && address < pools[p].storage
+                + pools[p].count * pools[p].size)
+        {
+            pool = &pools[p];
+            offset = (uint32_t) (address - pool->storage);
+            word = &pool->inUse[offset / pool->size / 32];
+            mask = 1UL << (offset / pool->size % 32);
+        }
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    // Foreign pointers, pointers into a block and blocks already free
+    if (pool == NULL || offset % pool->size != 0 || (*word & mask) == 0)
+    {
+        invalidFrees++;
+    }
+    else
+    {
+        *word &= ~mask;
+        ((PoolBlock *) block)->next = pool->freeList;
+        pool->freeList = block;
+        pool->used--;
+    }
+    __set_PRIMASK(primask);
+#else
+    // Nothing can have come from Pool_alloc
+    if (block != NULL)
+    {
+        invalidFrees++;
+    }
+#endif
+}
+
+bool Pool_getStats(int pool, Pool_Stats *stats)
+{
+#if POOL_ENABLE
+    uint32_t primask;
+
+    if (pool < 0 || pool >= POOL_NUM_CLASSES)
+    {
+        return false;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    stats->size = pools[pool].size;
+    stats->count = pools[pool].count;
+    stats->used = pools[pool].used;
+    stats->highWater = pools[pool].highWater;
+    stats->failures = pools[pool].failures;
+    __set_PRIMASK(primask);
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t Pool_getInvalidFrees(void)
+{
+    return invalidFrees;
+}
+
+void Pool_report(void (*write)(const char *line))
+{
+#if POOL_ENABLE
+    char line[64];
+    Pool_Stats stats;
+    int p;
+
+    write("pool  bytes  blocks  used  peak  failed");
+    for (p = 0; p < POOL_NUM_CLASSES; p++)
+    {
+        Pool_getStats(p, &stats);
+        sprintf(line, "%4d %6u %7u %5u %5u %7lu", p, stats.size, stats.count,
+                stats.used, stats.highWater, (unsigned long) stats.failures);
+        write(line);
+    }
+    sprintf(line, "invalid frees %lu", (unsigned long) invalidFrees);
+    write(line);
+#endif
+}
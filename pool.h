@@ -0,0 +1,147 @@
+/*!
+ * pool.h
+ *      Description: Header file for the fixed-block pool allocator. The
+ *                   firmware has no heap, so records with a lifetime of
+ *                   their own, such as telemetry blocks waiting for the
+ *                   UART, come from a few pools of equal blocks carved out
+ *                   of static arrays. A request takes a block of the
+ *                   smallest size class that fits and falls back to the
+ *                   larger classes when that pool is empty. Allocating and
+ *                   freeing are constant time and safe from any context.
+ *
+ *                   Each pool counts its blocks in use, the most ever in
+ *                   use and the requests it could not serve.
+ *
+ *                   The pools only take SRAM when a user is built in, by
+ *                   default with the telemetry stream. Build with
+ *                   POOL_ENABLE defined to 1 or 0 to override; without the
+ *                   pools every allocation fails.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "telemetry.h"
+
+/* On with any of the users of the pools */
+#ifndef POOL_ENABLE
+#define POOL_ENABLE         TELEMETRY_ENABLE
+#endif
+
+/* Size classes, block sizes in bytes are multiples of 4 and ascending */
+#define POOL_SMALL_SIZE     32
+#define POOL_SMALL_COUNT    16
+#define POOL_MEDIUM_SIZE    64
+#define POOL_MEDIUM_COUNT   8
+/* Fits the largest telemetry record, 5 + CODEC_MAX_BYTES(ACQ_BLOCK_SIZE) */
+#define POOL_LARGE_SIZE     144
+#define POOL_LARGE_COUNT    4
+
+/* Largest request that can be served */
+#define POOL_MAX_SIZE       POOL_LARGE_SIZE
+
+#define POOL_NUM_CLASSES    3
+
+/* Counters of one pool */
+typedef struct
+{
+    uint16_t size;
+    uint16_t count;
+    uint16_t used;
+    uint16_t highWater;
+    uint32_t failures;
+} Pool_Stats;
+
+/*!
+ * \brief This function initializes the pools
+ *
+ * This function links every block into the free list of its pool and clears
+ * the counters. Call before any allocation.
+ *
+ * \return None
+ */
+extern void Pool_init(void);
+
+/*!
+ * \brief This function allocates a block
+ *
+ * This function takes a block from the smallest size class that fits size
+ * and has one free. Blocks are 4-byte aligned and not cleared.
+ *
+ * \param size is the number of bytes needed, at most POOL_MAX_SIZE
+ *
+ * \return The block, or NULL if size is too large or every fitting pool is
+ *         empty
+ */
+extern void *Pool_alloc(uint32_t size);
+
+/*!
+ * \brief This function returns a block to its pool
+ *
+ * Pointers that are not the start of a pool block in use, including blocks
+ * freed twice, are counted in the report and ignored.
+ *
+ * \param block is a block from Pool_alloc, or NULL
+ *
+ * \return None
+ */
+extern void Pool_free(void *block);
+
+/*!
+ * \brief This function returns the counters of one pool
+ *
+ * A request that a pool could not serve is counted in its failures even if
+ * a larger pool served it.
+ *
+ * \param pool is the size class, 0 for the smallest
+ * \param stats receives the counters, all taken at the same moment
+ *
+ * \return false if pool is out of range
+ */
+extern bool Pool_getStats(int pool, Pool_Stats *stats);
+
+/*!
+ * \brief This function returns the number of frees that were refused
+ *
+ * \return Frees of pointers that were not a pool block in use
+ */
+extern uint32_t Pool_getInvalidFrees(void);
+
+/*!
+ * \brief This function sends the pool statistics over the UART
+ *
+ * This function writes the block size, blocks in use, high-water mark and
+ * failed requests of each pool, and the refused frees.
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void Pool_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POOL_H_ */
@@ -0,0 +1,61 @@
+/*!
+ * power.c
+ *      Description: Helper file for low-power idle. Timer32 instance 1 runs
+ *                   free from MCLK so sleep time can be measured; the SysTick
+ *                   is owned by delays.c and cannot be used here.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "power.h"
+
+/* Cycles spent asleep since Power_init */
+static volatile uint32_t idleTotal = 0;
+/* Timestamp and idle total at the start of the Power_getIdlePercent window */
+static uint32_t windowStart = 0;
+static uint32_t windowIdleStart = 0;
+
+void Power_init(void)
+{
+    Timer32_initModule(TIMER32_1_BASE, TIMER32_PRESCALER_1, TIMER32_32BIT,
+    TIMER32_FREE_RUN_MODE);
+    Timer32_startTimer(TIMER32_1_BASE, false);
+    idleTotal = 0;
+    windowIdleStart = 0;
+    windowStart = Power_timestamp();
+}
+
+void Power_sleep(void)
+{
+    uint32_t start = Power_timestamp();
+    PCM_gotoLPM0();
+    idleTotal += Power_timestamp() - start;
+}
+
+uint32_t Power_getIdleTotal(void)
+{
+    return idleTotal;
+}
+
+uint8_t Power_getIdlePercent(void)
+{
+    uint32_t now = Power_timestamp();
+    uint32_t elapsed = now - windowStart;
+    uint32_t total = idleTotal;
+    uint32_t idle = total - windowIdleStart;
+    windowIdleStart = total;
+    windowStart = now;
+
+    if (elapsed == 0)
+    {
+        return 0;
+    }
+    if (idle > elapsed)
+    {
+        idle = elapsed;
+    }
+    return (uint8_t) (((uint64_t) idle * 100) / elapsed);
+}
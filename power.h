@@ -0,0 +1,99 @@
+/*!
+ * power.h
+ *      Description: Header file for low-power idle helpers. Keeps a free
+ *                   running Timer32 as a timestamp source and measures how
+ *                   much of the time the CPU spends asleep in LPM0.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdint.h>
+
+/*!
+ * \brief This function initializes the idle accounting module
+ *
+ * This function starts Timer32 instance 1 in free-running mode from MCLK.
+ * Timer32 instance 0 is left free for the application tick.
+ *
+ * \return None
+ */
+extern void Power_init(void);
+
+/*!
+ * \brief This function returns a free-running timestamp
+ *
+ * This function returns the number of MCLK cycles elapsed since Power_init,
+ * wrapping at 2^32. Differences of two timestamps are valid across the wrap.
+ *
+ * Inline register read so it is cheap enough for trace points. DriverLib's
+ * TIMER32_1_BASE is the CMSIS TIMER32_2 instance.
+ *
+ * \return Timestamp in MCLK cycles
+ */
+static inline uint32_t Power_timestamp(void)
+{
+    // Timer32 counts down, invert so timestamps increase
+    return ~TIMER32_2->VALUE;
+}
+
+/*!
+ * \brief This function puts the CPU into LPM0 until the next interrupt
+ *
+ * This function must be called with interrupts masked (after
+ * Interrupt_disableMaster) once the caller has checked that no work is
+ * pending. A pending interrupt still wakes the CPU while masked; it is
+ * serviced once the caller calls Interrupt_enableMaster. The time spent
+ * asleep is added to the idle total.
+ *
+ * \return None
+ */
+extern void Power_sleep(void);
+
+/*!
+ * \brief This function returns the total time spent asleep
+ *
+ * This function returns the running total of cycles spent in Power_sleep,
+ * wrapping at 2^32. Compare two readings against two Power_timestamp
+ * readings to measure idle time over any window.
+ *
+ * \return Idle time in MCLK cycles
+ */
+extern uint32_t Power_getIdleTotal(void);
+
+/*!
+ * \brief This function returns the measured idle percentage
+ *
+ * This function returns the percentage of time spent in Power_sleep since the
+ * previous call, then starts a new measurement window.
+ *
+ * \return Idle time in percent (0 - 100)
+ */
+extern uint8_t Power_getIdlePercent(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_H_ */
@@ -0,0 +1,56 @@
+/*!
+ * priorities.h
+ *      Description: Header file for the NVIC priority map. The MSP432
+ *                   implements 3 priority bits, so there are 8 levels and 0
+ *                   is the most urgent. DriverLib takes the level in the top
+ *                   bits of a byte, which PRIORITY() builds. A handler is
+ *                   only preempted by a strictly more urgent one; equal
+ *                   levels wait for each other.
+ *
+ *                   Level  Handler     Deadline and work
+ *                     0    ADC14       next conversion pair, 1 ms at the
+ *                                      full rate: stores two samples
+ *                     1    T32_INT1    scheduler tick, 10 ms: releases tasks
+ *                     2    TA2_0       debounce tick, 5 ms: samples S1
+ *                     3    EUSCIA0     one UART byte, about 87 us at
+ *                                      115200 baud, but the TX ring absorbs
+ *                                      late refills
+ *                     4    PORT1       reserved, S1 is sampled by TA2_0
+ *                     5    EUSCIB0     next I2C step, see i2cbus.c; the bus
+ *                          DMA_INT1    holds SCL while it waits, so a late
+ *                                      step only slows the transaction
+ *                     7    PendSV      deferred work, see defer.h
+ *
+ *                   The handlers at levels 0 to 5 only capture data and
+ *                   request deferred work, so each one is delayed at most by
+ *                   the short handlers above it. Everything that may grow,
+ *                   filtering, rate control and the display state, runs in
+ *                   PendSV below all of them, and the main context runs
+ *                   below PendSV. The Instr run times of a handler include
+ *                   the time it was preempted.
+ *
+ *                   Each module sets the level of its interrupt where it
+ *                   enables it.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef PRIORITIES_H_
+#define PRIORITIES_H_
+
+/* Implemented priority bits on the MSP432 */
+#define PRIORITY_BITS       3
+
+/* Priority byte for Interrupt_setPriority, level 0 to 7 */
+#define PRIORITY(level)     ((uint8_t) ((level) << (8 - PRIORITY_BITS)))
+
+#define PRIORITY_ADC14      PRIORITY(0)
+#define PRIORITY_T32_INT1   PRIORITY(1)
+#define PRIORITY_TA2_0      PRIORITY(2)
+#define PRIORITY_EUSCIA0    PRIORITY(3)
+#define PRIORITY_PORT1      PRIORITY(4)
+#define PRIORITY_EUSCIB0    PRIORITY(5)
+#define PRIORITY_DMA_INT1   PRIORITY(5)
+#define PRIORITY_PENDSV     PRIORITY(7)
+
+#endif /* PRIORITIES_H_ */
@@ -0,0 +1,80 @@
+/*!
+ * queue.c
+ *      Description: Helper file for lock-free SPSC event queues. Head and tail
+ *                   are free-running counters, so a full queue is
+ *                   head - tail == size and no slot is wasted. The data
+ *                   memory barrier orders the record copy against the index
+ *                   update that publishes it.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "queue.h"
+
+bool Queue_init(EventQueue *queue, Event *storage, uint32_t size)
+{
+    if (size == 0 || (size & (size - 1)) != 0)
+    {
+        return false;
+    }
+    queue->buffer = storage;
+    queue->mask = size - 1;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->overflows = 0;
+    return true;
+}
+
+bool Queue_push(EventQueue *queue, const Event *event)
+{
+    uint32_t head = queue->head;
+    if (head - queue->tail > queue->mask)
+    {
+        queue->overflows++;
+        return false;
+    }
+    queue->buffer[head & queue->mask] = *event;
+    // Record must be visible before the consumer sees the new head
+    __DMB();
+    queue->head = head + 1;
+    return true;
+}
+
+bool Queue_pop(EventQueue *queue, Event *event)
+{
+    return Queue_popBatch(queue, event, 1) == 1;
+}
+
+uint32_t Queue_popBatch(EventQueue *queue, Event *events, uint32_t max)
+{
+    uint32_t tail = queue->tail;
+    uint32_t available = queue->head - tail;
+    if (available > max)
+    {
+        available = max;
+    }
+    // Read records only after the head that published them
+    __DMB();
+    uint32_t i;
+    for (i = 0; i < available; i++)
+    {
+        events[i] = queue->buffer[(tail + i) & queue->mask];
+    }
+    // Records must be copied out before the producer may reuse the slots
+    __DMB();
+    queue->tail = tail + available;
+    return available;
+}
+
+uint32_t Queue_count(const EventQueue *queue)
+{
+    return queue->head - queue->tail;
+}
+
+uint32_t Queue_getOverflows(const EventQueue *queue)
+{
+    return queue->overflows;
+}
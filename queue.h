@@ -0,0 +1,139 @@
+/*!
+ * queue.h
+ *      Description: Header file for lock-free single-producer/single-consumer
+ *                   event queues. Used to pass typed event records from one
+ *                   interrupt to the main context without disabling
+ *                   interrupts. Each queue must have exactly one producer
+ *                   context and one consumer context.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef QUEUE_H_
+#define QUEUE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Event types */
+#define EVENT_ADC_BLOCK     0
+#define EVENT_BUTTON        1
+#define EVENT_SENSOR        2
+#define EVENT_RISING        3
+#define EVENT_FALLING       4
+#define EVENT_PEAK          5
+#define EVENT_DIP           6
+
+/* Event record, 8 bytes */
+typedef struct
+{
+    uint32_t timestamp;
+    uint16_t value;
+    uint8_t type;
+    uint8_t channel;
+} Event;
+
+/* Queue state, head is only written by the producer, tail by the consumer */
+typedef struct
+{
+    Event *buffer;
+    uint32_t mask;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t overflows;
+} EventQueue;
+
+/*!
+ * \brief This function initializes an event queue
+ *
+ * This function attaches statically allocated storage to a queue. The size
+ * must be a power of two.
+ *
+ * \param queue is the queue to initialize
+ * \param storage is an array of size events
+ * \param size is the number of events, a power of two
+ *
+ * \return true on success, false if size is not a power of two
+ */
+extern bool Queue_init(EventQueue *queue, Event *storage, uint32_t size);
+
+/*!
+ * \brief This function adds an event to a queue
+ *
+ * This function copies an event into the queue. Only call from the producer
+ * context. If the queue is full the event is dropped and the overflow counter
+ * is incremented.
+ *
+ * \param queue is the queue to add to
+ * \param event is the event to copy
+ *
+ * \return true if queued, false if the queue was full
+ */
+extern bool Queue_push(EventQueue *queue, const Event *event);
+
+/*!
+ * \brief This function removes an event from a queue
+ *
+ * This function copies the oldest event out of the queue. Only call from the
+ * consumer context.
+ *
+ * \param queue is the queue to remove from
+ * \param event is filled with the oldest event
+ *
+ * \return true if an event was removed, false if the queue was empty
+ */
+extern bool Queue_pop(EventQueue *queue, Event *event);
+
+/*!
+ * \brief This function removes several events from a queue
+ *
+ * This function copies up to max of the oldest events out of the queue and
+ * releases their slots together. Only call from the consumer context.
+ *
+ * \param queue is the queue to remove from
+ * \param events is an array of at least max events to fill
+ * \param max is the maximum number of events to remove
+ *
+ * \return Number of events removed
+ */
+extern uint32_t Queue_popBatch(EventQueue *queue, Event *events, uint32_t max);
+
+/*!
+ * \brief This function returns the number of queued events
+ *
+ * \param queue is the queue to check
+ *
+ * \return Number of events waiting
+ */
+extern uint32_t Queue_count(const EventQueue *queue);
+
+/*!
+ * \brief This function returns the number of dropped events
+ *
+ * \param queue is the queue to check
+ *
+ * \return Number of events dropped because the queue was full
+ */
+extern uint32_t Queue_getOverflows(const EventQueue *queue);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QUEUE_H_ */
@@ -0,0 +1,37 @@
+/*!
+ * ramfunc.h
+ *      Description: Header file for placing hot functions in SRAM. A function
+ *                   tagged RAMFUNC goes to the .TI.ramfunc section, which
+ *                   msp432p401r.cmd loads into flash and runs from SRAM_CODE.
+ *                   The boot code copies it through the BINIT table before
+ *                   main(), so tagged functions need no setup and are not
+ *                   slowed by flash wait states above 24 MHz.
+ *
+ *                   Only tag short functions that run often: SRAM_CODE
+ *                   shares its 64 KB with .data, .bss and the stack. DriverLib
+ *                   calls made from a RAM function still run from flash.
+ *                   tools/ramfunc_report.py lists what landed where from the
+ *                   linker map.
+ *
+ *                   Build with RAMFUNC_ENABLE defined to 0 to run everything
+ *                   from flash, e.g. to compare timings.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef RAMFUNC_H_
+#define RAMFUNC_H_
+
+#ifndef RAMFUNC_ENABLE
+#define RAMFUNC_ENABLE      1
+#endif
+
+/* The .TI.ramfunc copy table needs the SRAM alias, see msp432p401r.cmd */
+#if RAMFUNC_ENABLE && defined(__TI_COMPILER_VERSION__) \
+        && __TI_COMPILER_VERSION__ >= 15009000
+#define RAMFUNC             __attribute__((ramfunc))
+#else
+#define RAMFUNC
+#endif
+
+#endif /* RAMFUNC_H_ */
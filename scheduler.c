@@ -0,0 +1,249 @@
+/*!
+ * scheduler.c
+ *      Description: Helper file for the cooperative task scheduler. All task
+ *                   state is statically allocated. Tasks run to completion in
+ *                   the main context; interrupts only set ready flags.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include "scheduler.h"
+#include "power.h"
+#include "trace.h"
+
+typedef struct
+{
+    const char *name;
+    Sched_TaskFn fn;
+    uint8_t priority;
+    uint32_t period;
+    uint32_t deadline;
+    uint32_t nextRelease;
+    uint32_t releaseTick;
+    /* Volatile so the store stays ahead of the triggerArmed store */
+    volatile uint32_t triggerTick;
+    volatile bool triggerArmed;
+    volatile bool ready;
+    /* Main context only, the tick counts its misses in releaseMisses */
+    Sched_Stats stats;
+    volatile uint32_t releaseMisses;
+} Sched_Task;
+
+static Sched_Task tasks[SCHED_MAX_TASKS];
+/* Task ids sorted by priority, highest priority first */
+static uint8_t dispatchOrder[SCHED_MAX_TASKS];
+static int taskCount = 0;
+static volatile uint32_t ticks = 0;
+
+void Sched_init(void)
+{
+    taskCount = 0;
+    ticks = 0;
+}
+
+int Sched_addTask(const char *name, Sched_TaskFn fn, uint8_t priority,
+                  uint32_t period, uint32_t deadline)
+{
+    if (taskCount >= SCHED_MAX_TASKS || fn == 0)
+    {
+        return SCHED_INVALID_TASK;
+    }
+
+    int id = taskCount;
+    Sched_Task *task = &tasks[id];
+    task->name = name;
+    task->fn = fn;
+    task->priority = priority;
+    task->period = period;
+    task->deadline = deadline;
+    task->nextRelease = ticks + period;
+    task->releaseTick = ticks;
+    task->triggerArmed = false;
+    task->ready = false;
+    task->stats.runs = 0;
+    task->stats.worstCycles = 0;
+    task->stats.totalCycles = 0;
+    task->stats.deadlineMisses = 0;
+    task->releaseMisses = 0;
+
+    // Insertion keeps equal priorities in registration order
+    int i = taskCount;
+    while (i > 0 && tasks[dispatchOrder[i - 1]].priority > priority)
+    {
+        dispatchOrder[i] = dispatchOrder[i - 1];
+        i--;
+    }
+    dispatchOrder[i] = id;
+    taskCount++;
+    return id;
+}
+
+/*!
+ * Marks a task ready and records its release time. A periodic release while
+ * the task is still waiting to run means the previous release missed its
+ * deadline; repeated triggers of an event driven task are merged. Only the
+ * tick releases periodically, so releaseMisses has a single writer.
+ *
+ * \param task Task to release
+ * \param periodic Whether the release comes from the task period
+ *
+ * \return None
+ */
+static void releaseTask(Sched_Task *task, bool periodic)
+{
+    if (task->ready)
+    {
+        if (periodic)
+        {
+            task->releaseMisses++;
+        }
+        return;
+    }
+    task->releaseTick = ticks;
+    task->ready = true;
+}
+
+void Sched_trigger(int id)
+{
+    if (id < 0 || id >= taskCount)
+    {
+        return;
+    }
+    releaseTask(&tasks[id], false);
+}
+
+void Sched_triggerAfter(int id, uint32_t delay)
+{
+    if (id < 0 || id >= taskCount)
+    {
+        return;
+    }
+    // The current tick period is already partly over, so count one more
+    tasks[id].triggerTick = ticks + delay + 1;
+    tasks[id].triggerArmed = true;
+}
+
+void Sched_tick(void)
+{
+    ticks++;
+    int i;
+    for (i = 0; i < taskCount; i++)
+    {
+        Sched_Task *task = &tasks[i];
+        if (task->period != 0 && (int32_t) (ticks - task->nextRelease) >= 0)
+        {
+            task->nextRelease += task->period;
+            releaseTask(task, true);
+        }
+        if (task->triggerArmed && (int32_t) (ticks - task->triggerTick) >= 0)
+        {
+            task->triggerArmed = false;
+            releaseTask(task, false);
+        }
+    }
+}
+
+uint32_t Sched_getTicks(void)
+{
+    return ticks;
+}
+
+bool Sched_runOnce(void)
+{
+    int i;
+    for (i = 0; i < taskCount; i++)
+    {
+        Sched_Task *task = &tasks[dispatchOrder[i]];
+        if (!task->ready)
+        {
+            continue;
+        }
+
+        // Clear first so a release during the run is not lost
+        task->ready = false;
+        uint32_t release = task->releaseTick;
+        uint32_t start = Power_timestamp();
+        TRACE(TRACE_TASK_BEGIN, dispatchOrder[i]);
+        task->fn();
+        TRACE(TRACE_TASK_END, dispatchOrder[i]);
+        uint32_t cycles = Power_timestamp() - start;
+
+        task->stats.runs++;
+        task->stats.totalCycles += cycles;
+        if (cycles > task->stats.worstCycles)
+        {
+            task->stats.worstCycles = cycles;
+        }
+        if (ticks - release > task->deadline)
+        {
+            task->stats.deadlineMisses++;
+        }
+        return true;
+    }
+    return false;
+}
+
+/*!
+ * Checks whether any task is waiting to run.
+ *
+ * \return true if a task is ready
+ */
+static bool anyReady(void)
+{
+    int i;
+    for (i = 0; i < taskCount; i++)
+    {
+        if (tasks[i].ready)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Sched_run(void)
+{
+    while (1)
+    {
+        // Always restart from the highest priority after each task
+        while (Sched_runOnce())
+        {
+        }
+
+        // Check with interrupts masked so a release cannot be missed
+        Interrupt_disableMaster();
+        if (!anyReady())
+        {
+            Power_sleep();
+        }
+        Interrupt_enableMaster();
+    }
+}
+
+bool Sched_getStats(int id, Sched_Stats *stats)
+{
+    if (id < 0 || id >= taskCount || stats == 0)
+    {
+        return false;
+    }
+    *stats = tasks[id].stats;
+    stats->deadlineMisses += tasks[id].releaseMisses;
+    return true;
+}
+
+const char *Sched_getName(int id)
+{
+    if (id < 0 || id >= taskCount)
+    {
+        return 0;
+    }
+    return tasks[id].name;
+}
+
+int Sched_getTaskCount(void)
+{
+    return taskCount;
+}
@@ -0,0 +1,170 @@
+/*!
+ * scheduler.h
+ *      Description: Header file for a static cooperative run-to-completion
+ *                   task scheduler. Tasks are released periodically from the
+ *                   scheduler tick or on demand with Sched_trigger, and are
+ *                   dispatched highest priority first. The CPU sleeps in LPM0
+ *                   whenever no task is ready.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHED_MAX_TASKS     12
+#define SCHED_TICK_HZ       100
+#define SCHED_TICK_MS       (1000 / SCHED_TICK_HZ)
+#define SCHED_INVALID_TASK  (-1)
+
+typedef void (*Sched_TaskFn)(void);
+
+/* Timing statistics for one task, execution times in MCLK cycles */
+typedef struct
+{
+    uint32_t runs;
+    uint32_t worstCycles;
+    uint64_t totalCycles;
+    uint32_t deadlineMisses;
+} Sched_Stats;
+
+/*!
+ * \brief This function initializes the scheduler
+ *
+ * This function clears the task table. Power_init must have been called so
+ * task execution times can be measured.
+ *
+ * \return None
+ */
+extern void Sched_init(void);
+
+/*!
+ * \brief This function registers a task
+ *
+ * This function adds a task to the static task table. Tasks with a lower
+ * priority value run first. A period of 0 makes the task event driven; it
+ * only runs after Sched_trigger. The deadline is counted from the release and
+ * a task that completes later, or is released again before it ran, counts a
+ * deadline miss.
+ *
+ * \param name is a short name used in reports
+ * \param fn is the function run to completion on each release
+ * \param priority is the dispatch priority, 0 is highest
+ * \param period is the release period in scheduler ticks, 0 for event driven
+ * \param deadline is the relative deadline in scheduler ticks
+ *
+ * \return Task id, or SCHED_INVALID_TASK if the table is full
+ */
+extern int Sched_addTask(const char *name, Sched_TaskFn fn, uint8_t priority,
+                         uint32_t period, uint32_t deadline);
+
+/*!
+ * \brief This function releases a task
+ *
+ * This function marks a task ready to run. Safe to call from interrupts.
+ *
+ * \param id is the task id returned by Sched_addTask
+ *
+ * \return None
+ */
+extern void Sched_trigger(int id);
+
+/*!
+ * \brief This function releases a task after a delay
+ *
+ * This function arms a one-shot release of a task from the scheduler tick.
+ * The task is released once at least delay full tick periods have passed,
+ * at most one period later. Arming it again replaces the pending release.
+ * Used to wait for slow hardware without blocking the other tasks.
+ *
+ * \param id is the task id returned by Sched_addTask
+ * \param delay is the minimum delay in scheduler ticks
+ *
+ * \return None
+ */
+extern void Sched_triggerAfter(int id, uint32_t delay);
+
+/*!
+ * \brief This function advances scheduler time
+ *
+ * This function must be called from the periodic tick interrupt at
+ * SCHED_TICK_HZ. It releases periodic tasks that are due.
+ *
+ * \return None
+ */
+extern void Sched_tick(void);
+
+/*!
+ * \brief This function returns the current scheduler time
+ *
+ * \return Ticks elapsed since Sched_init
+ */
+extern uint32_t Sched_getTicks(void);
+
+/*!
+ * \brief This function runs the scheduler
+ *
+ * This function dispatches ready tasks in priority order and sleeps in LPM0
+ * when none are ready. It never returns.
+ *
+ * \return None
+ */
+extern void Sched_run(void);
+
+/*!
+ * \brief This function dispatches at most one ready task
+ *
+ * \return true if a task ran, false if no task was ready
+ */
+extern bool Sched_runOnce(void);
+
+/*!
+ * \brief This function reads the timing statistics of a task
+ *
+ * \param id is the task id returned by Sched_addTask
+ * \param stats is filled with a copy of the statistics
+ *
+ * \return true on success, false if the id is invalid
+ */
+extern bool Sched_getStats(int id, Sched_Stats *stats);
+
+/*!
+ * \brief This function returns the name of a task
+ *
+ * \param id is the task id returned by Sched_addTask
+ *
+ * \return Task name, or 0 if the id is invalid
+ */
+extern const char *Sched_getName(int id);
+
+/*!
+ * \brief This function returns the number of registered tasks
+ *
+ * \return Number of tasks
+ */
+extern int Sched_getTaskCount(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHEDULER_H_ */
@@ -0,0 +1,220 @@
+/*!
+ * sensors.c
+ *      Description: Helper file for the digital sensors. Each sensor has one
+ *                   transaction that is either its configuration write or
+ *                   its result read, so it never has more than one on the
+ *                   bus. The completion callbacks run as the "i2c" deferred
+ *                   work and post the results.
+ *
+ *                   TMP102: 12-bit result left aligned in register 0x00,
+ *                   0.0625 C per LSB, 4 conversions per second by default.
+ *                   OPT3001: result register 0x00 holds a 4-bit exponent E
+ *                   and a 12-bit mantissa R, lux = 0.01 * 2^E * R. The
+ *                   configuration register 0x01 is written with automatic
+ *                   range and continuous 100 ms conversions.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <stdio.h>
+
+#include "sensors.h"
+#include "i2cbus.h"
+#include "defer.h"
+#include "power.h"
+
+/* Result register of both sensors */
+#define RESULT_REGISTER     0x00
+
+/* OPT3001 configuration: RN = 1100 (automatic range), CT = 0 (100 ms),
+ * M = 10 (continuous) */
+#define OPT3001_CONFIG_REGISTER 0x01
+#define OPT3001_CONFIG          0xC410
+
+typedef struct
+{
+    const char *name;
+    uint8_t address;
+    uint8_t periodTicks;        /* in SENSOR_POLL_TICKS */
+    const uint8_t *setup;       /* register and value, 0 if none */
+    uint8_t setupLength;
+} Sensor_Device;
+
+typedef struct
+{
+    I2cBus_Transaction transfer;
+    uint8_t result[2];
+    uint8_t countdown;
+    bool configured;
+    uint32_t reads;
+    uint32_t errors;
+} Sensor_State;
+
+static const uint8_t resultRegister = RESULT_REGISTER;
+static const uint8_t opt3001Setup[] = { OPT3001_CONFIG_REGISTER,
+                                        OPT3001_CONFIG >> 8,
+                                        OPT3001_CONFIG & 0xFF };
+
+/* Polled at about twice the conversion rate of each */
+static const Sensor_Device devices[SENSOR_NUM] = {
+    { "temp", SENSOR_TMP102_ADDRESS, 2, 0, 0 },
+    { "light", SENSOR_OPT3001_ADDRESS, 1, opt3001Setup, sizeof(opt3001Setup) }
+};
+
+static Sensor_State sensors[SENSOR_NUM];
+static EventQueue *readingQueue;
+static int readingWork = DEFER_INVALID_WORK;
+
+/*!
+ * Posts a finished read, or counts the error. Runs as deferred work.
+ *
+ * \param transaction Read of a sensor
+ *
+ * \return None
+ */
+static void readDone(I2cBus_Transaction *transaction)
+{
+    Sensor_State *sensor = transaction->context;
+    Event event;
+
+    if (transaction->status != I2CBUS_DONE)
+    {
+        // Set it up again in case it was reset or reconnected
+        sensor->errors++;
+        sensor->configured = false;
+        return;
+    }
+    sensor->reads++;
+    event.timestamp = Power_timestamp();
+    event.value = ((uint16_t) sensor->result[0] << 8) | sensor->result[1];
+    event.type = EVENT_SENSOR;
+    event.channel = (uint8_t) (sensor - sensors);
+    Queue_push(readingQueue, &event);
+    Defer_request(readingWork);
+}
+
+/*!
+ * Marks a sensor configured once its setup write went through.
+ *
+ * \param transaction Setup of a sensor
+ *
+ * \return None
+ */
+static void setupDone(I2cBus_Transaction *transaction)
+{
+    Sensor_State *sensor = transaction->context;
+
+    sensor->configured = transaction->status == I2CBUS_DONE;
+    if (!sensor->configured)
+    {
+        sensor->errors++;
+    }
+}
+
+/*!
+ * Submits the setup write of a sensor, or its read once it is set up.
+ *
+ * \param index Sensor number
+ *
+ * \return None
+ */
+static void submit(int index)
+{
+    const Sensor_Device *device = &devices[index];
+    I2cBus_Transaction *transfer = &sensors[index].transfer;
+
+    transfer->address = device->address;
+    transfer->context = &sensors[index];
+    if (device->setup != 0 && !sensors[index].configured)
+    {
+        transfer->writeData = device->setup;
+        transfer->writeLength = device->setupLength;
+        transfer->readData = 0;
+        transfer->readLength = 0;
+        transfer->done = setupDone;
+    }
+    else
+    {
+        transfer->writeData = &resultRegister;
+        transfer->writeLength = 1;
+        transfer->readData = sensors[index].result;
+        transfer->readLength = sizeof(sensors[index].result);
+        transfer->done = readDone;
+    }
+    I2cBus_submit(transfer);
+}
+
+void Sensors_init(EventQueue *queue, int notifyWork)
+{
+    int i;
+
+    readingQueue = queue;
+    readingWork = notifyWork;
+    for (i = 0; i < SENSOR_NUM; i++)
+    {
+        sensors[i].transfer.status = I2CBUS_IDLE;
+        sensors[i].countdown = devices[i].periodTicks;
+        sensors[i].configured = false;
+        sensors[i].reads = 0;
+        sensors[i].errors = 0;
+        if (devices[i].setup != 0)
+        {
+            submit(i);
+        }
+    }
+}
+
+void Sensors_poll(void)
+{
+    int i;
+
+    for (i = 0; i < SENSOR_NUM; i++)
+    {
+        if (--sensors[i].countdown != 0)
+        {
+            continue;
+        }
+        sensors[i].countdown = devices[i].periodTicks;
+        if (!I2cBus_isBusy(&sensors[i].transfer))
+        {
+            submit(i);
+        }
+    }
+}
+
+void Sensors_format(uint8_t sensor, uint16_t raw, char *text, uint32_t size)
+{
+    if (sensor == SENSOR_TEMP)
+    {
+        // Sixteenths of a degree to hundredths, sign kept for -0.xx
+        int32_t hundredths = ((int32_t) (int16_t) raw >> 4) * 625 / 100;
+        uint32_t magnitude = hundredths < 0 ? -hundredths : hundredths;
+
+        snprintf(text, size, "%s%lu.%02lu C", hundredths < 0 ? "-" : "",
+                 (unsigned long) (magnitude / 100),
+                 (unsigned long) (magnitude % 100));
+    }
+    else
+    {
+        uint32_t centilux = (uint32_t) (raw & 0x0FFF) << (raw >> 12);
+
+        snprintf(text, size, "%lu lux",
+                 (unsigned long) ((centilux + 50) / 100));
+    }
+}
+
+void Sensors_report(void (*write)(const char *line))
+{
+    char line[64];
+    int i;
+
+    write("sensor     reads  errors");
+    for (i = 0; i < SENSOR_NUM; i++)
+    {
+        sprintf(line, "%-8s %7lu %7lu", devices[i].name,
+                (unsigned long) sensors[i].reads,
+                (unsigned long) sensors[i].errors);
+        write(line);
+    }
+    I2cBus_report(write);
+}
@@ -0,0 +1,102 @@
+/*!
+ * sensors.h
+ *      Description: Header file for the digital sensors on the I2C bus, a
+ *                   TMP102 temperature sensor and an OPT3001 ambient light
+ *                   sensor. A scheduler task polls each one at its own
+ *                   period through i2cbus.h, and every reading is posted to
+ *                   an event queue as EVENT_SENSOR with the raw result
+ *                   register, like a sample block of an ADC channel.
+ *
+ *                   A sensor that needs configuring is set up again after
+ *                   every failed transaction, so one that was missing at
+ *                   boot starts reporting once it answers.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef SENSORS_H_
+#define SENSORS_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#include "queue.h"
+#include "scheduler.h"
+
+/* Sensor numbers used in Event.channel of EVENT_SENSOR */
+#define SENSOR_TEMP         0
+#define SENSOR_LIGHT        1
+#define SENSOR_NUM          2
+
+/* Period of the poll task in scheduler ticks (50 ms) */
+#define SENSOR_POLL_TICKS   (SCHED_TICK_HZ / 20)
+
+/* 7-bit addresses, ADD0 of the TMP102 and ADDR of the OPT3001 to ground */
+#define SENSOR_TMP102_ADDRESS   0x48
+#define SENSOR_OPT3001_ADDRESS  0x44
+
+/*!
+ * \brief This function initializes the sensors
+ *
+ * This function queues the configuration of the sensors that need one. The
+ * bus must have been initialized with I2cBus_init.
+ *
+ * \param queue is the queue EVENT_SENSOR events are posted to
+ * \param notifyWork is the deferred work requested after each reading
+ *
+ * \return None
+ */
+extern void Sensors_init(EventQueue *queue, int notifyWork);
+
+/*!
+ * \brief This function submits the reads that are due
+ *
+ * This function must run as a scheduler task every SENSOR_POLL_TICKS ticks.
+ * A sensor whose last read is still on the bus is skipped.
+ *
+ * \return None
+ */
+extern void Sensors_poll(void);
+
+/*!
+ * \brief This function converts a reading to display text
+ *
+ * \param sensor is SENSOR_TEMP or SENSOR_LIGHT
+ * \param raw is the result register from the EVENT_SENSOR event
+ * \param text receives the value with its unit, e.g. "23.50 C"
+ * \param size is the size of text
+ *
+ * \return None
+ */
+extern void Sensors_format(uint8_t sensor, uint16_t raw, char *text,
+                           uint32_t size);
+
+/*!
+ * \brief This function sends the read and error counts over the UART
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void Sensors_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSORS_H_ */
@@ -0,0 +1,64 @@
+/*!
+ * snapshot.c
+ *      Description: Helper file for seqlock snapshots. The writer makes the
+ *                   sequence odd, updates the data and makes it even again;
+ *                   a copy is kept only if it started and ended on the same
+ *                   even sequence. The data memory barriers order the data
+ *                   accesses against the sequence on both sides.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <string.h>
+
+#include "snapshot.h"
+
+void Snapshot_init(Snapshot *snapshot, void *data, uint32_t size)
+{
+    snapshot->data = data;
+    snapshot->size = size;
+    snapshot->sequence = 0;
+    snapshot->retries = 0;
+}
+
+void Snapshot_writeBegin(Snapshot *snapshot)
+{
+    snapshot->sequence++;
+    // Odd sequence must be visible before any of the data changes
+    __DMB();
+}
+
+void Snapshot_writeEnd(Snapshot *snapshot)
+{
+    // Data must be complete before the even sequence publishes it
+    __DMB();
+    snapshot->sequence++;
+}
+
+void Snapshot_read(Snapshot *snapshot, void *copy)
+{
+    uint32_t sequence;
+
+    for (;;)
+    {
+        sequence = snapshot->sequence;
+        // Copy only after the sequence it is checked against
+        __DMB();
+        memcpy(copy, snapshot->data, snapshot->size);
+        // Copy must be done before the sequence is checked again
+        __DMB();
+        if ((sequence & 1) == 0 && snapshot->sequence == sequence)
+        {
+            return;
+        }
+        snapshot->retries++;
+    }
+}
+
+uint32_t Snapshot_getRetries(const Snapshot *snapshot)
+{
+    return snapshot->retries;
+}
@@ -0,0 +1,108 @@
+/*!
+ * snapshot.h
+ *      Description: Header file for sequence counter (seqlock) snapshots.
+ *                   One context updates a shared structure in place between
+ *                   Snapshot_writeBegin and Snapshot_writeEnd; readers copy
+ *                   the whole structure with Snapshot_read, which copies it
+ *                   again if an update ran in between. Neither side
+ *                   disables interrupts, so a reader never delays the
+ *                   writer however often it updates.
+ *
+ *                   Readers must run at a lower priority than the writer.
+ *                   The writer then always finishes before a reader
+ *                   resumes, and a reader retries at most once per update
+ *                   that preempted its copy.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/* Snapshot state, sequence is odd while an update is in progress */
+typedef struct
+{
+    void *data;
+    uint32_t size;
+    volatile uint32_t sequence;
+    volatile uint32_t retries;
+} Snapshot;
+
+/*!
+ * \brief This function initializes a snapshot
+ *
+ * \param snapshot is the snapshot to initialize
+ * \param data is the shared structure, written only by the writer context
+ * \param size is the size of data in bytes
+ *
+ * \return None
+ */
+extern void Snapshot_init(Snapshot *snapshot, void *data, uint32_t size);
+
+/*!
+ * \brief This function starts an update
+ *
+ * This function marks the data as changing. Only call from the writer
+ * context, and keep the update short: every reader it preempts copies
+ * again.
+ *
+ * \param snapshot is the snapshot to update
+ *
+ * \return None
+ */
+extern void Snapshot_writeBegin(Snapshot *snapshot);
+
+/*!
+ * \brief This function publishes an update
+ *
+ * \param snapshot is the snapshot that was updated
+ *
+ * \return None
+ */
+extern void Snapshot_writeEnd(Snapshot *snapshot);
+
+/*!
+ * \brief This function copies a consistent view of the data
+ *
+ * This function copies the data until no update ran during the copy. Only
+ * call from contexts the writer can preempt.
+ *
+ * \param snapshot is the snapshot to read
+ * \param copy receives the data, size bytes
+ *
+ * \return None
+ */
+extern void Snapshot_read(Snapshot *snapshot, void *copy);
+
+/*!
+ * \brief This function returns the number of repeated copies
+ *
+ * \param snapshot is the snapshot to check
+ *
+ * \return Number of copies that were redone because of an update
+ */
+extern uint32_t Snapshot_getRetries(const Snapshot *snapshot);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SNAPSHOT_H_ */
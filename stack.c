@@ -0,0 +1,200 @@
+/*!
+ * stack.c
+ *      Description: Helper file for stack sizing. The main stack is a .bss
+ *                   array aligned for the MPU; the handler stack comes from
+ *                   the linker symbols __stack and __STACK_END. With the
+ *                   guard enabled the lowest STACK_GUARD_SIZE bytes of each
+ *                   are MPU regions that allow no access, and the rest of
+ *                   the memory map keeps its default attributes.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+
+#include "stack.h"
+
+#if defined(__TI_COMPILER_VERSION__)
+/* .stack from the linker, sized with --stack_size */
+extern uint32_t __stack;
+extern uint32_t __STACK_END;
+#define HANDLER_STACK_BASE  (&__stack)
+#define HANDLER_STACK_END   (&__STACK_END)
+/* Words below the frame of Stack_init are unused, leave a few to spare */
+#define HANDLER_PAINT_END   ((uint32_t *) __get_MSP() - 8)
+#else
+/* Host builds run on the host stack, the stub stands in for .stack */
+#define HANDLER_STACK_BASE  (stubStack)
+#define HANDLER_STACK_END   (stubStack + STUB_STACK_WORDS)
+#define HANDLER_PAINT_END   HANDLER_STACK_END
+#endif
+
+#define GUARD_WORDS         (STACK_GUARD_SIZE / sizeof(uint32_t))
+
+/* MPU regions of the guards */
+#define MAIN_GUARD_REGION       0
+#define HANDLER_GUARD_REGION    1
+
+static uint32_t mainStack[STACK_MAIN_SIZE / sizeof(uint32_t)]
+        __attribute__((aligned(STACK_GUARD_SIZE)));
+
+/* Fault status captured by MemManage_Handler, for the debugger */
+static volatile uint32_t faultStatus;
+static volatile uint32_t faultAddress;
+
+/*!
+ * Returns the lowest usable word of a stack, above its guard.
+ *
+ * \param context STACK_MAIN or STACK_HANDLER
+ *
+ * \return First word the stack may use
+ */
+static uint32_t *stackBase(Stack_Context context)
+{
+    uint32_t *base;
+
+    if (context == STACK_MAIN)
+    {
+        base = mainStack;
+    }
+    else
+    {
+        // The linker only aligns .stack to 8 bytes
+        base = (uint32_t *) (((uintptr_t) HANDLER_STACK_BASE
+                + STACK_GUARD_SIZE - 1) & ~(uintptr_t) (STACK_GUARD_SIZE - 1));
+    }
+#if STACK_GUARD_ENABLE
+    base += GUARD_WORDS;
+#endif
+    return base;
+}
+
+/*!
+ * Returns the word above a stack.
+ *
+ * \param context STACK_MAIN or STACK_HANDLER
+ *
+ * \return Initial stack pointer
+ */
+static uint32_t *stackEnd(Stack_Context context)
+{
+    if (context == STACK_MAIN)
+    {
+        return mainStack + STACK_MAIN_SIZE / sizeof(uint32_t);
+    }
+    return HANDLER_STACK_END;
+}
+
+#if STACK_GUARD_ENABLE
+/*!
+ * Makes the guard below a stack base inaccessible.
+ *
+ * \param region MPU region number
+ * \param base First usable word of the stack
+ *
+ * \return None
+ */
+static void setGuard(uint32_t region, const uint32_t *base)
+{
+    MPU_setRegion(region, (uint32_t) (uintptr_t) (base - GUARD_WORDS),
+                  MPU_RGN_SIZE_32B | MPU_RGN_PERM_NOEXEC
+                          | MPU_RGN_PERM_PRV_NO_USR_NO | MPU_RGN_ENABLE);
+}
+#endif
+
+void Stack_init(void)
+{
+    uint32_t *word;
+    uint32_t *limit;
+
+    for (word = stackBase(STACK_MAIN); word < stackEnd(STACK_MAIN); word++)
+    {
+        *word = STACK_PAINT;
+    }
+    limit = HANDLER_PAINT_END;
+    for (word = stackBase(STACK_HANDLER); word < limit; word++)
+    {
+        *word = STACK_PAINT;
+    }
+
+#if STACK_GUARD_ENABLE
+    setGuard(MAIN_GUARD_REGION, stackBase(STACK_MAIN));
+    setGuard(HANDLER_GUARD_REGION, stackBase(STACK_HANDLER));
+    MPU_enableModule(MPU_CONFIG_PRIV_DEFAULT);
+    MPU_enableInterrupt();
+#endif
+}
+
+uint32_t Stack_getMainTop(void)
+{
+    return (uint32_t) (uintptr_t) stackEnd(STACK_MAIN);
+}
+
+#if !defined(__TI_COMPILER_VERSION__)
+void Stack_runOnMainStack(void (*entry)(void))
+{
+    // Same register writes as stackswitch.asm, the host stack stays in use
+    __set_PSP(Stack_getMainTop());
+    __set_CONTROL(__get_CONTROL() | CONTROL_SPSEL_Msk);
+    __ISB();
+    entry();
+    while (1)
+    {
+    }
+}
+#endif
+
+void Stack_getUsage(Stack_Context context, Stack_Usage *usage)
+{
+    const uint32_t *base = stackBase(context);
+    const uint32_t *end = stackEnd(context);
+    const uint32_t *word = base;
+
+    while (word < end && *word == STACK_PAINT)
+    {
+        word++;
+    }
+    usage->size = (end - base) * sizeof(uint32_t);
+    usage->peak = (end - word) * sizeof(uint32_t);
+}
+
+void Stack_report(void (*write)(const char *line))
+{
+    static const char * const names[STACK_NUM_CONTEXTS] = { "main",
+                                                            "handler" };
+    char line[64];
+    Stack_Usage usage;
+    int i;
+
+    for (i = 0; i < STACK_NUM_CONTEXTS; i++)
+    {
+        Stack_getUsage((Stack_Context) i, &usage);
+        sprintf(line, "stack %-8s %5lu of %5lu bytes (%lu%%)", names[i],
+                (unsigned long) usage.peak, (unsigned long) usage.size,
+                (unsigned long) (usage.size ?
+                        100 * usage.peak / usage.size : 0));
+        write(line);
+    }
+}
+
+/* !
+ * \brief This function stops at a guard access
+ *
+ * This function keeps the fault status and address for the debugger and
+ * stops with interrupts masked. Only reached with STACK_GUARD_ENABLE, or on
+ * other MPU faults.
+ *
+ * \return None
+ */
+void MemManage_Handler(void)
+{
+    faultStatus = SCB->CFSR;
+    faultAddress = SCB->MMFAR;
+    __disable_irq();
+    while (1)
+    {
+    }
+}
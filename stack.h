@@ -0,0 +1,141 @@
+/*!
+ * stack.h
+ *      Description: Header file for stack sizing. The main context runs on
+ *                   its own process stack of STACK_MAIN_SIZE bytes and the
+ *                   interrupt handlers on the linker's .stack section, set
+ *                   with --stack_size in the project options. Both are
+ *                   painted before they are used; the deepest overwritten
+ *                   word gives the high-water mark of each.
+ *
+ *                   An interrupt taken in the main context stacks its
+ *                   exception frame, up to 104 bytes with FPU state, on the
+ *                   process stack before the handler switches to .stack.
+ *                   Nested handlers stack all their frames on .stack.
+ *
+ *                   Build with STACK_GUARD_ENABLE defined to 1 to have the
+ *                   MPU fault on any access to the lowest STACK_GUARD_SIZE
+ *                   bytes of either stack. An overflow of the main stack
+ *                   then stops in MemManage_Handler; one of the handler
+ *                   stack locks the core up, as the fault cannot be
+ *                   stacked. Either way it stops at the overflow instead
+ *                   of corrupting .bss.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef STACK_H_
+#define STACK_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdint.h>
+
+/* Process stack of the main context in bytes, a multiple of
+ * STACK_GUARD_SIZE */
+#ifndef STACK_MAIN_SIZE
+#define STACK_MAIN_SIZE     2048
+#endif
+
+#ifndef STACK_GUARD_ENABLE
+#define STACK_GUARD_ENABLE  0
+#endif
+
+/* Smallest MPU region, also its alignment */
+#define STACK_GUARD_SIZE    32
+
+/* Fill pattern of unused stack words */
+#define STACK_PAINT         0xDEADBEEF
+
+/* Stacks whose use is measured */
+typedef enum
+{
+    STACK_MAIN,
+    STACK_HANDLER,
+    STACK_NUM_CONTEXTS
+} Stack_Context;
+
+/* Size and high-water mark of one stack in bytes, guard excluded */
+typedef struct
+{
+    uint32_t size;
+    uint32_t peak;
+} Stack_Usage;
+
+/*!
+ * \brief This function paints the stacks and sets up the guard regions
+ *
+ * Paints the whole main stack and the handler stack below the current
+ * frame. Must run in main before Stack_runOnMainStack, while the main
+ * context still runs on the handler stack.
+ *
+ * \return None
+ */
+extern void Stack_init(void);
+
+/*!
+ * \brief This function returns the initial stack pointer of the main stack
+ *
+ * \return Address just above the main stack
+ */
+extern uint32_t Stack_getMainTop(void);
+
+/*!
+ * \brief This function continues the main context on its own stack
+ *
+ * This function points the process stack pointer at the top of the main
+ * stack, selects it for thread mode and jumps to entry. It is written in
+ * assembly in stackswitch.asm so no compiled code runs between the switch
+ * and entry; the frame of the caller stays behind on the handler stack and
+ * is never used again. Host builds call entry on the host stack.
+ *
+ * \param entry is the rest of the main context, it must never return
+ *
+ * \return None
+ */
+extern void Stack_runOnMainStack(void (*entry)(void))
+        __attribute__((noreturn));
+
+/*!
+ * \brief This function returns the size and high-water mark of a stack
+ *
+ * Scans the painted words from the bottom, so the cost grows with the
+ * unused part of the stack.
+ *
+ * \param context is STACK_MAIN or STACK_HANDLER
+ * \param usage receives the size and high-water mark
+ *
+ * \return None
+ */
+extern void Stack_getUsage(Stack_Context context, Stack_Usage *usage);
+
+/*!
+ * \brief This function sends the stack high-water marks over the UART
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void Stack_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STACK_H_ */
@@ -0,0 +1,33 @@
+;*****************************************************************************
+; stackswitch.asm
+;      Description: Moves the main context from the handler stack it starts
+;                   on to its own stack, see Stack_runOnMainStack in stack.h.
+;                   Written in assembly so the switch does not depend on
+;                   what the compiler keeps in the frame of main.
+;
+;      Author: Cooper Brotherton
+;*****************************************************************************
+
+        .thumb
+        .text
+
+        .global Stack_runOnMainStack
+        .global Stack_getMainTop
+
+;*****************************************************************************
+; void Stack_runOnMainStack(void (*entry)(void))
+;
+; Never returns, so r4 and lr of the caller need not be kept.
+;*****************************************************************************
+Stack_runOnMainStack: .asmfunc
+        MOV     r4, r0                  ; entry survives the call
+        BL      Stack_getMainTop        ; r0 = top of the main stack
+        MSR     PSP, r0
+        MRS     r1, CONTROL
+        ORR     r1, r1, #2              ; SPSEL, thread mode uses PSP
+        MSR     CONTROL, r1
+        ISB                             ; later instructions use the new SP
+        BX      r4
+        .endasmfunc
+
+        .end
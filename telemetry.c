@@ -0,0 +1,224 @@
+/*!
+ * telemetry.c
+ *      Description: Helper file for the sample telemetry stream. Each
+ *                   record is the length of the frame payload and the
+ *                   payload itself, CRC included, in a block from pool.h
+ *                   just large enough for it. The records wait in a
+ *                   single-producer/single-consumer ring of pointers like
+ *                   the event queues, and the data memory barrier orders
+ *                   the record against the head that publishes it. The
+ *                   writing task only adds the COBS framing.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdio.h>
+
+#include "telemetry.h"
+#include "pool.h"
+#include "power.h"
+
+/* Length byte and rate ahead of each encoded block, CRC after it */
+#define RECORD_HEADER       3
+#define RECORD_CRC          2
+
+/* Frame delimiter, the only zero byte on the console */
+#define FRAME_DELIMITER     0
+
+#if TELEMETRY_ENABLE
+static uint8_t *records[TELEMETRY_QUEUE_SIZE];
+static volatile uint32_t head;
+static volatile uint32_t tail;
+
+/* Written by the deferred work, read by the report */
+static uint32_t blocks;
+static uint32_t dropped;
+static uint32_t rawBytes;
+static uint32_t encodedBytes;
+static uint32_t worstSampleCycles;
+
+/* Written by the task, read by the report */
+static uint32_t sentBytes;
+
+/*!
+ * Returns the CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of a
+ * buffer, bit by bit as it runs once per block.
+ *
+ * \param data Bytes
+ * \param length Number of bytes
+ *
+ * \return CRC
+ */
+static uint16_t crc16(const uint8_t *data, uint32_t length)
+{
+    uint16_t crc = 0xFFFF;
+    uint32_t i;
+    int bit;
+
+    for (i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t) data[i] << 8;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021)
+                    : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*!
+ * Encodes a frame payload with consistent overhead byte stuffing. Each code
+ * byte gives the distance to the next zero of the payload, so the output
+ * has none.
+ *
+ * \param in Payload
+ * \param length Number of payload bytes
+ * \param out Receives length + 1 + length / 254 bytes
+ *
+ * \return Number of bytes written
+ */
+static uint32_t cobsEncode(const uint8_t *in, uint32_t length, uint8_t *out)
+{
+    uint32_t code = 0;
+    uint32_t next = 1;
+    uint32_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[code] = (uint8_t) (next - code);
+            code = next++;
+            continue;
+        }
+        out[next++] = in[i];
+        if (next - code == 0xFF)
+        {
+            out[code] = 0xFF;
+            code = next++;
+        }
+    }
+    out[code] = (uint8_t) (next - code);
+    return next;
+}
+#endif
+
+void Telemetry_init(void)
+{
+#if TELEMETRY_ENABLE
+    head = 0;
+    tail = 0;
+    blocks = 0;
+    dropped = 0;
+    rawBytes = 0;
+    encodedBytes = 0;
+    worstSampleCycles = 0;
+    sentBytes = 0;
+#endif
+}
+
+void Telemetry_addBlock(uint8_t channel, const uint16_t *samples,
+                        uint32_t count, uint16_t rate)
+{
+#if TELEMETRY_ENABLE
+    uint8_t block[CODEC_MAX_BYTES(ACQ_BLOCK_SIZE)];
+    uint32_t start = Power_timestamp();
+    uint32_t length = Codec_encode(channel, samples, count, block);
+    uint32_t cycles = Power_timestamp() - start;
+    uint8_t *record;
+    uint16_t crc;
+    uint32_t i;
+
+    if (length == 0 || count > ACQ_BLOCK_SIZE)
+    {
+        return;
+    }
+    if (cycles / count > worstSampleCycles)
+    {
+        worstSampleCycles = cycles / count;
+    }
+    record = Pool_alloc(RECORD_HEADER + length + RECORD_CRC);
+    if (record == NULL || head - tail >= TELEMETRY_QUEUE_SIZE)
+    {
+        Pool_free(record);
+        dropped++;
+        return;
+    }
+    record[0] = (uint8_t) (length + RECORD_HEADER - 1 + RECORD_CRC);
+    record[1] = (uint8_t) (rate >> 8);
+    record[2] = (uint8_t) rate;
+    for (i = 0; i < length; i++)
+    {
+        record[RECORD_HEADER + i] = block[i];
+    }
+    crc = crc16(&record[1], RECORD_HEADER - 1 + length);
+    record[RECORD_HEADER + length] = (uint8_t) (crc >> 8);
+    record[RECORD_HEADER + length + 1] = (uint8_t) crc;
+    records[head & (TELEMETRY_QUEUE_SIZE - 1)] = record;
+    // Record must be visible before the reader sees the new head
+    __DMB();
+    head++;
+
+    blocks++;
+    rawBytes += count * sizeof(uint16_t);
+    encodedBytes += length;
+#endif
+}
+
+void Telemetry_step(uint32_t (*write)(const char *data, uint32_t length),
+                    uint32_t maxBytes)
+{
+#if TELEMETRY_ENABLE
+    uint8_t frame[TELEMETRY_FRAME_BYTES];
+    uint8_t *record;
+    uint32_t size;
+
+    while (tail != head)
+    {
+        // Read the record only after the head that published it
+        __DMB();
+        record = records[tail & (TELEMETRY_QUEUE_SIZE - 1)];
+        frame[0] = FRAME_DELIMITER;
+        size = 1 + cobsEncode(&record[1], record[0], &frame[1]);
+        frame[size++] = FRAME_DELIMITER;
+        // A partial frame would be lost anyway, keep it for the next run
+        if (size > maxBytes)
+        {
+            break;
+        }
+        Pool_free(record);
+        // Slot must be read before the writer may reuse it
+        __DMB();
+        tail++;
+        write((const char *) frame, size);
+        maxBytes -= size;
+        sentBytes += size;
+    }
+#endif
+}
+
+void Telemetry_report(void (*write)(const char *line))
+{
+#if TELEMETRY_ENABLE
+    char line[96];
+
+    sprintf(line, "telemetry blocks %lu, dropped %lu",
+            (unsigned long) blocks, (unsigned long) dropped);
+    write(line);
+    sprintf(line, "  raw %lu bytes, encoded %lu (%lu%%), sent %lu (%lu%%)",
+            (unsigned long) rawBytes, (unsigned long) encodedBytes,
+            (unsigned long) (rawBytes ?
+                    (uint64_t) encodedBytes * 100 / rawBytes : 0),
+            (unsigned long) sentBytes,
+            (unsigned long) (rawBytes ?
+                    (uint64_t) sentBytes * 100 / rawBytes : 0));
+    write(line);
+    sprintf(line, "  worst %lu cycles/sample",
+            (unsigned long) worstSampleCycles);
+    write(line);
+#endif
+}
@@ -0,0 +1,122 @@
+/*!
+ * telemetry.h
+ *      Description: Header file for the sample telemetry stream. Every
+ *                   sample block of the acquisition path is compressed with
+ *                   codec.h and sent over the UART as one binary frame
+ *
+ *                       0x00, COBS(payload), 0x00
+ *                       payload: rate Hz (big endian), encoded block,
+ *                                CRC-16/CCITT of both (big endian)
+ *
+ *                   where the rate is 0 for a block sampled at more than one
+ *                   rate. COBS removes every zero byte from the payload at
+ *                   the cost of one byte, and console text never contains
+ *                   one, so the frames share the UART with the reports and
+ *                   a reader finds them between the zeros. A frame costs 7
+ *                   bytes on top of the encoded block.
+ *
+ *                   The blocks wait in pool blocks between the deferred work
+ *                   that encodes them and the task that writes them, so a
+ *                   full UART drops whole blocks, counted in the report.
+ *                   tools/telemetry_decode.py turns a raw capture of the
+ *                   console back into samples.
+ *
+ *                   The stream is sent while no trace or capture dump is
+ *                   running. Build with TELEMETRY_ENABLE defined to 1 to
+ *                   compile it in.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#include "codec.h"
+#include "acquisition.h"
+
+#ifndef TELEMETRY_ENABLE
+#define TELEMETRY_ENABLE    0
+#endif
+
+/* Encoded blocks waiting for the UART, a power of two. The blocks
+ * themselves come from pool.h, which may run out first. */
+#define TELEMETRY_QUEUE_SIZE    32
+
+/* Largest frame: rate, block and CRC, one COBS code byte per 254 bytes and
+ * the two delimiters. The payload is below 254 bytes, so one code byte. */
+#define TELEMETRY_PAYLOAD_BYTES (2 + CODEC_MAX_BYTES(ACQ_BLOCK_SIZE) + 2)
+#define TELEMETRY_FRAME_BYTES   (TELEMETRY_PAYLOAD_BYTES + 1 + 2)
+
+/*!
+ * \brief This function initializes the telemetry stream
+ *
+ * \return None
+ */
+extern void Telemetry_init(void);
+
+/*!
+ * \brief This function encodes a sample block into the stream
+ *
+ * Only called from the deferred work that processes the blocks.
+ *
+ * \param channel is CHANNEL_PHOTO or CHANNEL_POT
+ * \param samples is the block
+ * \param count is the number of samples, at most ACQ_BLOCK_SIZE
+ * \param rate is the sample rate of the block in Hz, 0 if mixed
+ *
+ * \return None
+ */
+extern void Telemetry_addBlock(uint8_t channel, const uint16_t *samples,
+                               uint32_t count, uint16_t rate);
+
+/*!
+ * \brief This function writes waiting blocks over the UART
+ *
+ * This function writes whole frames only, as many as fit in maxBytes. Only
+ * called from one task.
+ *
+ * \param write is called once per frame with its bytes
+ * \param maxBytes is the number of bytes that may be written
+ *
+ * \return None
+ */
+extern void Telemetry_step(uint32_t (*write)(const char *data,
+                                             uint32_t length),
+                           uint32_t maxBytes);
+
+/*!
+ * \brief This function sends the stream statistics over the UART
+ *
+ * This function writes the blocks sent and dropped, the encoded size and
+ * the bytes sent against 16 bits per sample, and the worst encoding time
+ * per sample.
+ *
+ * \param write is called with each line of the report
+ *
+ * \return None
+ */
+extern void Telemetry_report(void (*write)(const char *line));
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_H_ */
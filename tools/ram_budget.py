@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Report the static SRAM budget from the TI linker map.
+
+After a CCS build run
+
+    tools/ram_budget.py [Debug/ece230project5BrothertonC.map]
+
+to print how the 64 KB of SRAM is split between output sections (.data,
+.bss, the handler .stack, the heap and the code copied to SRAM_CODE, which
+aliases the same memory), the RAM each module takes, and the largest
+buffers. The main context stack is the mainStack buffer of stack.obj, see
+stack.h. Pass --reserve to exit with status 1 when less than that many bytes
+are left free, e.g. before growing a buffer.
+"""
+
+import argparse
+import sys
+from collections import defaultdict
+
+from ramfunc_report import find_map, read_copies, read_regions, read_sections
+
+SRAM_DATA = "SRAM_DATA"
+SRAM_CODE = "SRAM_CODE"
+RAMFUNC_SECTION = ".TI.ramfunc"
+STACK_SECTION = ".stack"
+
+
+def in_region(address, region):
+    """Returns whether an address lies in a (name, origin, length, used)."""
+    return region[1] <= address < region[1] + region[2]
+
+
+def module_name(module):
+    """Returns the object file of a map entry without its library path."""
+    module = module.split(" : ")[-1].lstrip(": ").strip()
+    # Tentative definitions are listed without their module
+    return module.split("\\")[-1].split("/")[-1] or "(common)"
+
+
+def buffer_name(section):
+    """Returns the symbol of a '.bss:name' or '.common:name' input section."""
+    return section.split(":", 1)[1] if ":" in section else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("map", nargs="?", help="linker map file")
+    parser.add_argument("-n", "--top", type=int, default=15,
+                        help="number of buffers to list")
+    parser.add_argument("--reserve", type=int, default=0,
+                        help="bytes that must stay free")
+    args = parser.parse_args()
+
+    path = args.map or find_map()
+    with open(path) as f:
+        lines = f.read().splitlines()
+    regions = {region[0]: region for region in read_regions(lines)}
+    sections = read_sections(lines)
+    copies = read_copies(lines)
+    sram = regions.get(SRAM_DATA)
+    if sram is None:
+        sys.exit("no %s region in %s" % (SRAM_DATA, path))
+
+    # Output sections that take SRAM, code run from SRAM_CODE included
+    used = []
+    for name, (origin, length, entries) in sections.items():
+        if not length:
+            continue
+        if name in copies:
+            run = copies[name][1]
+            if in_region(run, sram) or (SRAM_CODE in regions and in_region(
+                    run, regions[SRAM_CODE])):
+                used.append((name, run, copies[name][2], entries))
+        elif in_region(origin, sram):
+            used.append((name, origin, length, entries))
+
+    total = sum(length for _, _, length, _ in used)
+    print("%s\n" % path)
+    print("section          origin       bytes")
+    for name, origin, length, _ in sorted(used, key=lambda u: u[1]):
+        print("%-14s %08x  %10d" % (name, origin, length))
+    print("%-14s %8s  %10d of %d, %d free" % ("total", "", total, sram[2],
+                                              sram[2] - total))
+
+    modules = defaultdict(lambda: defaultdict(int))
+    buffers = []
+    for name, _, length, entries in used:
+        if name == STACK_SECTION:
+            # Mostly a hole reserved by --stack_size
+            modules["(handler stack)"][name] += length
+            buffers.append((length, "(handler stack)", "", name))
+            continue
+        for _, size, module, section in entries:
+            modules[module_name(module)][name] += size
+            symbol = buffer_name(section)
+            if symbol is not None and name != RAMFUNC_SECTION:
+                buffers.append((size, symbol, module_name(module), name))
+
+    columns = sorted({name for name, _, _, _ in used})
+    print("\nmodule" + " " * 22 + "".join("%10s" % c for c in columns)
+          + "     total")
+    for module, sizes in sorted(modules.items(),
+                                key=lambda item: -sum(item[1].values())):
+        print("%-28s" % module
+              + "".join("%10d" % sizes.get(c, 0) for c in columns)
+              + "%10d" % sum(sizes.values()))
+
+    print("\nlargest buffers")
+    for length, symbol, module, section in sorted(buffers,
+                                                  reverse=True)[:args.top]:
+        print("  %6d  %-24s %-20s %s" % (length, symbol, module, section))
+
+    free = sram[2] - total
+    if free < args.reserve:
+        print("\nonly %d bytes free, %d reserved" % (free, args.reserve))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""Report where code and data landed from the TI linker map.
+
+After a CCS build run
+
+    tools/ramfunc_report.py [Debug/ece230project5BrothertonC.map]
+
+to print the memory region usage, the functions copied to SRAM (the
+.TI.ramfunc section, see ramfunc.h) with their load and run addresses, the
+size of each output section and the largest functions left in flash.
+
+Functions tagged RAMFUNC in the sources are checked against the map; the
+script exits with status 1 if one of them did not land in .TI.ramfunc, for
+example because the compiler is older than the SRAM alias support.
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+
+RAMFUNC_SECTION = ".TI.ramfunc"
+
+
+def find_map():
+    """Returns the map file of the newest build configuration."""
+    maps = glob.glob(os.path.join(ROOT, "*", "*.map"))
+    if not maps:
+        sys.exit("no linker map found, pass one on the command line")
+    return max(maps, key=os.path.getmtime)
+
+
+def read_tagged():
+    """Returns the names of functions defined with RAMFUNC in the sources."""
+    names = set()
+    pattern = re.compile(r"^RAMFUNC\s+[\w\s\*]*?(\w+)\s*\(", re.M)
+    for path in glob.glob(os.path.join(ROOT, "*.c")):
+        with open(path) as f:
+            names.update(pattern.findall(f.read()))
+    return names
+
+
+def read_regions(lines):
+    """Returns [(name, origin, length, used)] from MEMORY CONFIGURATION."""
+    regions = []
+    active = False
+    for line in lines:
+        if line.startswith("MEMORY CONFIGURATION"):
+            active = True
+            continue
+        if not active:
+            continue
+        if line.startswith("SEGMENT ALLOCATION MAP"):
+            break
+        fields = line.split()
+        if len(fields) >= 5 and re.fullmatch(r"[0-9a-f]{8}", fields[1]):
+            regions.append((fields[0], int(fields[1], 16),
+                            int(fields[2], 16), int(fields[3], 16)))
+    return regions
+
+
+def read_sections(lines):
+    """Returns {output section: (origin, length, [(addr, size, object,
+    input section)])} from SECTION ALLOCATION MAP."""
+    sections = {}
+    current = None
+    pending = None
+    library = ""
+    active = False
+    for line in lines:
+        if line.startswith("SECTION ALLOCATION MAP"):
+            active = True
+            continue
+        if not active:
+            continue
+        if line.startswith("MODULE SUMMARY"):
+            break
+        if not line.strip() or line.startswith("-"):
+            continue
+        header = re.match(r"^(\S+)\s+(\d+)\s+([0-9a-f]{8})\s+([0-9a-f]{8})",
+                          line)
+        if header is None and line[0] not in " *":
+            # Long section names sit alone on their line
+            pending = line.strip()
+            continue
+        if header is None and pending is not None:
+            header = re.match(r"^(\*)\s+(\d+)\s+([0-9a-f]{8})\s+([0-9a-f]{8})",
+                              line)
+        if header is not None:
+            name = pending if header.group(1) == "*" else header.group(1)
+            pending = None
+            current = [int(header.group(3), 16), int(header.group(4), 16), []]
+            sections[name] = current
+            continue
+        entry = re.match(r"^\s+([0-9a-f]{8})\s+([0-9a-f]{8})\s+(.*)$", line)
+        if entry is None or current is None:
+            continue
+        rest = entry.group(3).strip()
+        if rest.startswith("--HOLE--"):
+            continue
+        # "module.obj (.section:name)" or "lib : member.o (.section:name)"
+        inner = re.search(r"\(([^()]*)\)\s*$", rest)
+        section = inner.group(1) if inner else ""
+        module = rest[:inner.start()].strip() if inner else rest
+        # Later members of a library leave out the library name
+        if module.startswith(":"):
+            module = library + " " + module
+        elif " : " in module:
+            library = module.split(" : ")[0]
+        current[2].append((int(entry.group(1), 16), int(entry.group(2), 16),
+                           module, section))
+    return {name: tuple(value) for name, value in sections.items()}
+
+
+def read_copies(lines):
+    """Returns {section: (load, run, size)} from the linker copy tables."""
+    copies = {}
+    for line in lines:
+        match = re.match(r"^\s+(\S+): load addr=([0-9a-f]+), "
+                         r"load size=([0-9a-f]+) bytes, run addr=([0-9a-f]+), "
+                         r"run size=([0-9a-f]+) bytes", line)
+        if match:
+            copies[match.group(1)] = (int(match.group(2), 16),
+                                      int(match.group(4), 16),
+                                      int(match.group(5), 16))
+    return copies
+
+
+def function_name(section):
+    """Returns the function of a '.text:name' style input section."""
+    return section.split(":")[-1] if ":" in section else section
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("map", nargs="?", help="linker map file")
+    parser.add_argument("-n", "--top", type=int, default=10,
+                        help="number of flash functions to list")
+    args = parser.parse_args()
+
+    path = args.map or find_map()
+    with open(path) as f:
+        lines = f.read().splitlines()
+    regions = read_regions(lines)
+    sections = read_sections(lines)
+    copies = read_copies(lines)
+
+    print("%s\n" % path)
+    print("region         origin      length       used")
+    for name, origin, length, used in regions:
+        print("%-12s %08x  %10d %10d  %3d%%" % (name, origin, length, used,
+                                               100 * used // max(length, 1)))
+
+    print("\nsection        origin      length")
+    for name, (origin, length, _) in sorted(sections.items(),
+                                            key=lambda item: item[1][0]):
+        if length:
+            print("%-12s %08x  %10d" % (name, origin, length))
+
+    tagged = read_tagged()
+    placed = set()
+    ramfunc = sections.get(RAMFUNC_SECTION)
+    print("\nRAM functions (%s)" % RAMFUNC_SECTION)
+    if ramfunc is None or not ramfunc[2]:
+        print("  none")
+    else:
+        load, run, size = copies.get(RAMFUNC_SECTION,
+                                     (ramfunc[0], None, ramfunc[1]))
+        print("  load %08x  run %s  %d bytes, copied by %s" % (
+            load, "%08x" % run if run is not None else "?", size,
+            "binit" if RAMFUNC_SECTION in copies else "?"))
+        print("  run addr    size  function              object")
+        for addr, length, module, section in ramfunc[2]:
+            name = function_name(section)
+            placed.add(name)
+            run_addr = addr - load + run if run is not None else addr
+            print("  %08x  %6d  %-20s  %s" % (run_addr, length, name,
+                                               module))
+
+    text = sections.get(".text", (0, 0, []))[2]
+    print("\nlargest functions in flash")
+    for addr, length, module, section in sorted(text, key=lambda e: -e[1])[
+            :args.top]:
+        print("  %08x  %6d  %-30s  %s" % (addr, length, function_name(section),
+                                          module))
+
+    missing = sorted(tagged - placed)
+    if missing:
+        print("\nRAMFUNC but not in %s: %s" % (RAMFUNC_SECTION,
+                                               ", ".join(missing)))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Decode the sample telemetry stream of a raw console capture to CSV.
+
+A firmware built with TELEMETRY_ENABLE sends each ADC sample block as a
+binary frame between the console text,
+
+    0x00, COBS(rate Hz, encoded block, CRC-16/CCITT), 0x00
+
+with the block in the format of codec.h (see telemetry.h). Capture the
+console bytes unchanged, e.g. from the board or with "sim -u capture.bin",
+and run
+
+    tools/telemetry_decode.py capture.bin -o samples.csv
+
+for one row per sample: the block number, the channel, the rate of the block
+and the sample. Text between the frames fails the CRC and is skipped, so the
+capture can hold reports and trace dumps as well. The totals, the
+compression ratio and the bytes the frames took on the link go to stderr;
+the exit status is 1 if no frame or a damaged frame was found.
+"""
+
+import argparse
+import csv
+import sys
+
+HEADER_BYTES = 4
+ESCAPE = 16
+RAW_BITS = 17
+
+# Rate ahead of the block, CRC after it
+RATE_BYTES = 2
+CRC_BYTES = 2
+
+CHANNELS = {0: "photo", 1: "pot"}
+
+
+class Bits:
+    """Reads bits most significant first."""
+
+    def __init__(self, data):
+        self.data = data
+        self.next = 0
+
+    def get(self, count):
+        value = 0
+        for _ in range(count):
+            byte = self.next // 8
+            if byte >= len(self.data):
+                raise ValueError("block truncated")
+            value = (value << 1) | (self.data[byte] >> (7 - self.next % 8)) & 1
+            self.next += 1
+        return value
+
+
+def decode(block):
+    """Returns (channel, samples) of an encoded block, see Codec_decode."""
+    if len(block) < HEADER_BYTES or block[0] == 0:
+        raise ValueError("bad header")
+    count = block[0]
+    channel = block[1] >> 4
+    k = block[1] & 0x0F
+    samples = [(block[2] << 8) | block[3]]
+    bits = Bits(block[HEADER_BYTES:])
+    for _ in range(count - 1):
+        quotient = 0
+        while quotient < ESCAPE and bits.get(1):
+            quotient += 1
+        if quotient == ESCAPE:
+            z = bits.get(RAW_BITS)
+        else:
+            z = (quotient << k) | bits.get(k)
+        delta = (z >> 1) ^ -(z & 1)
+        samples.append((samples[-1] + delta) & 0xFFFF)
+    return channel, samples
+
+
+def crc16(data):
+    """Returns the CRC-16/CCITT of data, as telemetry.c computes it."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    """Returns the payload of a COBS encoded chunk, None if malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def read_frames(capture, stats):
+    """Yields (rate, block) of each frame, counting chunks and frame bytes."""
+    for chunk in capture.split(b"\0"):
+        if not chunk:
+            continue
+        stats["chunks"] += 1
+        payload = cobs_decode(chunk)
+        if payload is None or len(payload) < RATE_BYTES + HEADER_BYTES \
+                + CRC_BYTES or crc16(payload[:-CRC_BYTES]) \
+                != int.from_bytes(payload[-CRC_BYTES:], "big"):
+            continue
+        # The chunk and its two delimiters
+        stats["wire"] += len(chunk) + 2
+        yield int.from_bytes(payload[:RATE_BYTES], "big"), \
+            payload[RATE_BYTES:-CRC_BYTES]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("capture", nargs="?", help="raw capture (stdin)")
+    parser.add_argument("-o", "--output", help="CSV output (stdout)")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, "rb") as f:
+            capture = f.read()
+    else:
+        capture = sys.stdin.buffer.read()
+    output = open(args.output, "w", newline="") if args.output \
+        else sys.stdout
+    blocks = bad = samples = encoded = 0
+    stats = {"chunks": 0, "wire": 0}
+    with output:
+        writer = csv.writer(output, lineterminator="\n")
+        writer.writerow(["block", "channel", "rate_hz", "sample"])
+        for rate, block in read_frames(capture, stats):
+            try:
+                channel, values = decode(block)
+            except ValueError as error:
+                print("frame %d: %s" % (blocks + bad, error),
+                      file=sys.stderr)
+                bad += 1
+                continue
+            name = CHANNELS.get(channel, str(channel))
+            for value in values:
+                writer.writerow([blocks, name, rate, value])
+            blocks += 1
+            samples += len(values)
+            encoded += len(block)
+
+    raw = 2 * samples
+    print("%d blocks, %d bad, %d samples, %d other chunks"
+          % (blocks, bad, samples, stats["chunks"] - blocks - bad),
+          file=sys.stderr)
+    print("raw %d bytes, encoded %d (%.1f%%), on the link %d (%.1f%%)"
+          % (raw, encoded, 100.0 * encoded / raw if raw else 0,
+             stats["wire"], 100.0 * stats["wire"] / raw if raw else 0),
+          file=sys.stderr)
+    if blocks == 0 or bad != 0:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
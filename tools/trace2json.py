@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""Convert a UART trace dump to Chrome trace / Perfetto JSON.
+
+The firmware writes the trace buffer on an S1 double click as
+
+    TRACE BEGIN <records> <mclk>
+    <timestamp> <id> <payload>      (hex, oldest first)
+    TRACE END
+
+Capture the console to a file and run
+
+    tools/trace2json.py capture.txt -o trace.json
+
+then open trace.json in chrome://tracing or ui.perfetto.dev. Event ids are
+read from the Trace_Id enum in trace.h and task names from the
+Sched_addTask calls in main.c, so the script follows the firmware sources.
+
+Timestamps are Timer32 counts at MCLK. TRACE_CLOCK records give the MCLK in
+100 kHz units; records before the first one use the MCLK from the header.
+TRACE_ACQ_RATE records become one sample rate counter per ADC channel.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+
+PID = 1
+TID_ISR = 1
+TID_MAIN = 2
+
+
+def read_ids(path):
+    """Returns the Trace_Id names indexed by value."""
+    with open(path) as f:
+        text = f.read()
+    body = re.search(r"typedef enum\s*\{(.*?)\}\s*Trace_Id;", text, re.S)
+    if body is None:
+        sys.exit("%s: Trace_Id enum not found" % path)
+    names = []
+    for entry in body.group(1).split(","):
+        entry = re.sub(r"/\*.*?\*/|//.*", "", entry, flags=re.S).strip()
+        if entry:
+            names.append(entry.split("=")[0].strip())
+    return names
+
+
+def read_tasks(path):
+    """Returns the task names in registration order (the task ids)."""
+    try:
+        with open(path) as f:
+            return re.findall(r'Sched_addTask\(\s*"([^"]*)"', f.read())
+    except OSError:
+        return []
+
+
+def read_dumps(lines):
+    """Yields (mclk, [(timestamp, id, payload), ...]) for each dump."""
+    records = None
+    mclk = 0
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRACE BEGIN"):
+            fields = line.split()
+            mclk = int(fields[3]) if len(fields) > 3 else 0
+            records = []
+        elif line == "TRACE END":
+            if records is not None:
+                yield mclk, records
+            records = None
+        elif records is not None:
+            fields = line.split()
+            if len(fields) == 3:
+                records.append(tuple(int(x, 16) for x in fields))
+
+
+def convert(mclk, records, ids, tasks, pid):
+    """Returns the trace events for one dump."""
+    events = []
+    elapsed = 0.0
+    last = records[0][0] if records else 0
+    clock = [mclk]
+
+    def name_of(i):
+        return ids[i] if i < len(ids) else "ID_%d" % i
+
+    def clock_of(payload):
+        return payload * 100000 if payload else clock[0]
+
+    if clock[0] == 0:
+        sys.exit("unknown MCLK, dump header has none")
+
+    for stamp, i, payload in records:
+        # Timer32 counts wrap at 32 bits
+        elapsed += ((stamp - last) & 0xFFFFFFFF) / clock[0] * 1e6
+        last = stamp
+        name = name_of(i)
+        if name.startswith("TRACE_"):
+            name = name[len("TRACE_"):]
+        tid = TID_ISR if name.startswith("ISR_") else TID_MAIN
+        event = {"pid": pid, "tid": tid, "ts": round(elapsed, 3)}
+
+        if name == "CLOCK":
+            clock[0] = clock_of(payload)
+            event.update(ph="C", name="MCLK",
+                         args={"MHz": clock[0] / 1e6})
+        elif name == "ACQ_RATE":
+            event.update(ph="C", name="A%d rate" % (14 + (payload >> 12)),
+                         args={"Hz": payload & 0xFFF})
+        elif name.endswith("_BEGIN") or name.endswith("_END"):
+            base = name.rsplit("_", 1)[0]
+            if base.startswith("ISR_"):
+                base = base[len("ISR_"):]
+            if base == "TASK":
+                base = tasks[payload] if payload < len(tasks) \
+                    else "task %d" % payload
+            event.update(ph="B" if name.endswith("_BEGIN") else "E",
+                         name=base, args={"payload": payload})
+        else:
+            event.update(ph="i", s="t", name=name,
+                         args={"payload": "0x%04x" % payload})
+        events.append(event)
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("dump", nargs="?", help="console capture (stdin)")
+    parser.add_argument("-o", "--output", help="JSON output (stdout)")
+    parser.add_argument("--header", default=os.path.join(ROOT, "trace.h"),
+                        help="trace.h with the Trace_Id enum")
+    parser.add_argument("--main", default=os.path.join(ROOT, "main.c"),
+                        help="source with the Sched_addTask calls")
+    args = parser.parse_args()
+
+    ids = read_ids(args.header)
+    tasks = read_tasks(args.main)
+    source = open(args.dump, errors="replace") if args.dump else sys.stdin
+    with source:
+        dumps = list(read_dumps(source))
+    if not dumps:
+        sys.exit("no complete TRACE BEGIN/END dump found")
+
+    events = []
+    for n, (mclk, records) in enumerate(dumps):
+        pid = PID + n
+        events.append({"ph": "M", "pid": pid, "name": "process_name",
+                       "args": {"name": "dump %d" % (n + 1)}})
+        events.append({"ph": "M", "pid": pid, "tid": TID_ISR,
+                       "name": "thread_name", "args": {"name": "interrupts"}})
+        events.append({"ph": "M", "pid": pid, "tid": TID_MAIN,
+                       "name": "thread_name", "args": {"name": "main"}})
+        events.extend(convert(mclk, records, ids, tasks, pid))
+
+    output = open(args.output, "w") if args.output else sys.stdout
+    with output:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, output,
+                  indent=1)
+        output.write("\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+/*!
+ * trace.c
+ *      Description: Helper file for the binary event trace. The dump format
+ *                   is line based so it survives a terminal capture:
+ *
+ *                       TRACE BEGIN <records> <mclk>
+ *                       <timestamp> <id> <payload>      (hex, oldest first)
+ *                       TRACE END
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#include <stdio.h>
+
+#include "trace.h"
+#include "clock.h"
+
+#if TRACE_ENABLE
+Trace_Record traceBuffer[TRACE_BUFFER_SIZE];
+volatile uint32_t traceHead = 0;
+volatile bool traceRunning = false;
+
+static void (*dumpWrite)(const char *line) = 0;
+static uint32_t dumpNext;
+static uint32_t dumpEnd;
+#endif
+
+void Trace_init(void)
+{
+#if TRACE_ENABLE
+    traceHead = 0;
+    traceRunning = true;
+    Trace_clock(Clock_getMCLK());
+#endif
+}
+
+void Trace_clock(uint32_t mclk)
+{
+    TRACE(TRACE_CLOCK, mclk / 100000);
+}
+
+void Trace_dumpBegin(void (*write)(const char *line))
+{
+#if TRACE_ENABLE
+    char line[40];
+    traceRunning = false;
+
+    // Only the newest TRACE_BUFFER_SIZE records survive a wrap
+    dumpEnd = traceHead;
+    dumpNext = dumpEnd > TRACE_BUFFER_SIZE ? dumpEnd - TRACE_BUFFER_SIZE : 0;
+    dumpWrite = write;
+
+    // MCLK at the oldest record is unknown after a wrap, report the current
+    sprintf(line, "TRACE BEGIN %lu %lu", (unsigned long) (dumpEnd - dumpNext),
+            (unsigned long) Clock_getMCLK());
+    write(line);
+#else
+    write("TRACE BEGIN 0 0");
+    write("TRACE END");
+#endif
+}
+
+bool Trace_dumpStep(uint32_t maxRecords)
+{
+#if TRACE_ENABLE
+    char line[32];
+
+    if (dumpWrite == 0)
+    {
+        return true;
+    }
+    while (dumpNext != dumpEnd && maxRecords-- > 0)
+    {
+        const Trace_Record *record = &traceBuffer[dumpNext
+                & (TRACE_BUFFER_SIZE - 1)];
+        sprintf(line, "%08lx %04x %04x", (unsigned long) record->timestamp,
+                record->id, record->payload);
+        dumpWrite(line);
+        dumpNext++;
+    }
+    if (dumpNext != dumpEnd)
+    {
+        return false;
+    }
+
+    dumpWrite("TRACE END");
+    dumpWrite = 0;
+    Trace_init();
+#endif
+    return true;
+}
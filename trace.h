@@ -0,0 +1,174 @@
+/*!
+ * trace.h
+ *      Description: Header file for the binary event trace. Trace points
+ *                   store 8-byte records (timestamp, event id, payload) in a
+ *                   RAM ring buffer for post-mortem timing analysis. The
+ *                   buffer is dumped as hex over the UART and converted to
+ *                   Chrome trace / Perfetto JSON with tools/trace2json.py.
+ *
+ *                   Build with TRACE_ENABLE defined to 0 to compile every
+ *                   trace point out.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "power.h"
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE        1
+#endif
+
+/* Number of records, a power of two */
+#define TRACE_BUFFER_SIZE   1024
+
+/*
+ * Event ids. tools/trace2json.py reads this list: ids ending in _BEGIN and
+ * _END become duration slices, TRACE_ISR_* events go on the interrupt track,
+ * everything else is an instant event. TRACE_CLOCK carries MCLK in 100 kHz
+ * units so timestamps can be converted to time. TRACE_ACQ_RATE carries the
+ * channel in the top 4 bits and its new sample rate in Hz below; both become
+ * counter tracks.
+ */
+typedef enum
+{
+    TRACE_CLOCK,
+    TRACE_ISR_ADC14_BEGIN,
+    TRACE_ISR_ADC14_END,
+    TRACE_ISR_T32_INT1_BEGIN,
+    TRACE_ISR_T32_INT1_END,
+    TRACE_ISR_TA2_0_BEGIN,
+    TRACE_ISR_TA2_0_END,
+    TRACE_ISR_PENDSV_BEGIN,
+    TRACE_ISR_PENDSV_END,
+    TRACE_TASK_BEGIN,
+    TRACE_TASK_END,
+    TRACE_LCD_WRITE,
+    TRACE_DELAY_BEGIN,
+    TRACE_DELAY_END,
+    TRACE_BUTTON,
+    TRACE_ACQ_RATE,
+    TRACE_NUM_IDS
+} Trace_Id;
+
+/* Trace record, 8 bytes */
+typedef struct
+{
+    uint32_t timestamp;
+    uint16_t id;
+    uint16_t payload;
+} Trace_Record;
+
+#if TRACE_ENABLE
+
+extern Trace_Record traceBuffer[TRACE_BUFFER_SIZE];
+extern volatile uint32_t traceHead;
+extern volatile bool traceRunning;
+
+/*!
+ * \brief This function stores one trace record
+ *
+ * This function reserves a slot and fills it with interrupts masked, so
+ * records from interrupts never interleave with a half written record.
+ *
+ * \param id is the event id
+ * \param payload is event specific data
+ *
+ * \return None
+ */
+static inline void Trace_record(uint16_t id, uint16_t payload)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (traceRunning)
+    {
+        Trace_Record *record = &traceBuffer[traceHead
+                & (TRACE_BUFFER_SIZE - 1)];
+        record->timestamp = Power_timestamp();
+        record->id = id;
+        record->payload = payload;
+        traceHead++;
+    }
+    __set_PRIMASK(primask);
+}
+
+#define TRACE(id, payload)  Trace_record((id), (uint16_t) (payload))
+
+#else
+
+#define TRACE(id, payload)
+
+#endif
+
+/*!
+ * \brief This function clears the trace buffer and starts tracing
+ *
+ * \return None
+ */
+extern void Trace_init(void);
+
+/*!
+ * \brief This function records the MCLK frequency
+ *
+ * This function adds a TRACE_CLOCK record. Registered as a clock listener so
+ * the converter can follow profile changes.
+ *
+ * \param mclk is the MCLK frequency in Hz
+ *
+ * \return None
+ */
+extern void Trace_clock(uint32_t mclk);
+
+/*!
+ * \brief This function starts a dump of the trace buffer
+ *
+ * This function stops tracing so the buffer is frozen while it is written.
+ * Call Trace_dumpStep until it returns true.
+ *
+ * \param write is called once per line of the dump
+ *
+ * \return None
+ */
+extern void Trace_dumpBegin(void (*write)(const char *line));
+
+/*!
+ * \brief This function writes part of the trace dump
+ *
+ * This function writes up to maxRecords records, oldest first. Tracing
+ * restarts with an empty buffer once the dump is complete.
+ *
+ * \param maxRecords is the maximum number of records to write
+ *
+ * \return true when the dump is complete or none is in progress
+ */
+extern bool Trace_dumpStep(uint32_t maxRecords);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H_ */
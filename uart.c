@@ -0,0 +1,169 @@
+/*!
+ * uart.c
+ *      Description: Helper file for the backchannel UART console. The main
+ *                   context fills a single-producer/single-consumer byte ring
+ *                   and EUSCIA0_IRQHandler drains it. Baud rate settings are
+ *                   computed with the algorithm from the eUSCI chapter of the
+ *                   MSP432P4xx technical reference manual so any SMCLK works.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+/* DriverLib Includes */
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#include <string.h>
+
+#include "uart.h"
+#include "clock.h"
+#include "instrument.h"
+#include "priorities.h"
+
+#define TX_MASK             (UART_TX_BUFFER_SIZE - 1)
+
+static char txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint32_t txHead = 0;
+static volatile uint32_t txTail = 0;
+static uint32_t dropped = 0;
+
+/* Fractional part of the divider (x10000) -> UCBRSx, TRM table 24-4 */
+static const uint16_t fractions[] = { 0, 529, 715, 835, 1001, 1252, 1430, 1670,
+                                      2147, 2224, 2503, 3000, 3335, 3575, 3753,
+                                      4003, 4286, 4378, 5002, 5715, 6003, 6254,
+                                      6432, 6667, 7001, 7147, 7503, 7861, 8004,
+                                      8333, 8464, 8572, 8751, 9004, 9170,
+                                      9288 };
+static const uint8_t modulations[] = { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20,
+                                       0x11, 0x21, 0x22, 0x44, 0x25, 0x49,
+                                       0x4A, 0x52, 0x92, 0x53, 0x55, 0xAA,
+                                       0x6B, 0xAD, 0xB5, 0xB6, 0xD6, 0xB7,
+                                       0xBB, 0xDD, 0xED, 0xEE, 0xBF, 0xDF,
+                                       0xEF, 0xF7, 0xFB, 0xFD, 0xFE };
+#define NUM_FRACTIONS       (sizeof(fractions) / sizeof(fractions[0]))
+
+/*!
+ * Programs eUSCI_A0 for UART_BAUD_RATE from the given clock and enables it.
+ *
+ * \param clock BRCLK (SMCLK) frequency in Hz
+ *
+ * \return None
+ */
+static void configureBaud(uint32_t clock)
+{
+    eUSCI_UART_ConfigV1 config;
+    uint32_t n = clock / UART_BAUD_RATE;
+    uint32_t fraction = (uint32_t) ((((uint64_t) clock * 10000)
+            / UART_BAUD_RATE) - (uint64_t) n * 10000);
+
+    uint32_t i = NUM_FRACTIONS - 1;
+    while (i > 0 && fractions[i] > fraction)
+    {
+        i--;
+    }
+
+    config.selectClockSource = EUSCI_A_UART_CLOCKSOURCE_SMCLK;
+    config.secondModReg = modulations[i];
+    config.parity = EUSCI_A_UART_NO_PARITY;
+    config.msborLsbFirst = EUSCI_A_UART_LSB_FIRST;
+    config.numberofStopBits = EUSCI_A_UART_ONE_STOP_BIT;
+    config.uartMode = EUSCI_A_UART_MODE;
+    config.dataLength = EUSCI_A_UART_8_BIT_LEN;
+    if (n >= 16)
+    {
+        config.overSampling = EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION;
+        config.clockPrescalar = n / 16;
+        config.firstModReg = n % 16;
+    }
+    else
+    {
+        config.overSampling = EUSCI_A_UART_LOW_FREQUENCY_BAUDRATE_GENERATION;
+        config.clockPrescalar = n;
+        config.firstModReg = 0;
+    }
+
+    UART_initModule(EUSCI_A0_BASE, &config);
+    UART_enableModule(EUSCI_A0_BASE);
+}
+
+void Uart_init(void)
+{
+    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P1,
+                                               GPIO_PIN2 | GPIO_PIN3,
+                                               GPIO_PRIMARY_MODULE_FUNCTION);
+    configureBaud(Clock_getSMCLK());
+    Interrupt_setPriority(INT_EUSCIA0, PRIORITY_EUSCIA0);
+    Interrupt_enableInterrupt(INT_EUSCIA0);
+}
+
+void Uart_retime(uint32_t mclk)
+{
+    // Let the byte in the shift register finish at the old rate
+    while (UART_queryStatusFlags(EUSCI_A0_BASE, EUSCI_A_UART_BUSY))
+    {
+    }
+    UART_disableInterrupt(EUSCI_A0_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
+    configureBaud(Clock_getSMCLK());
+    if (txHead != txTail)
+    {
+        UART_enableInterrupt(EUSCI_A0_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
+    }
+}
+
+uint32_t Uart_write(const char *data, uint32_t length)
+{
+    uint32_t head = txHead;
+    uint32_t space = UART_TX_BUFFER_SIZE - (head - txTail);
+    uint32_t count = length < space ? length : space;
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        txBuffer[(head + i) & TX_MASK] = data[i];
+    }
+    __DMB();
+    txHead = head + count;
+    dropped += length - count;
+
+    // TXIFG is set while idle, so enabling the interrupt starts the transfer
+    UART_enableInterrupt(EUSCI_A0_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
+    return count;
+}
+
+void Uart_writeLine(const char *line)
+{
+    Uart_write(line, strlen(line));
+    Uart_write("\r\n", 2);
+}
+
+uint32_t Uart_getFree(void)
+{
+    return UART_TX_BUFFER_SIZE - (txHead - txTail);
+}
+
+uint32_t Uart_getDropped(void)
+{
+    return dropped;
+}
+
+/*!
+ * \brief This function sends the next buffered byte
+ *
+ * This function moves one byte to the transmit buffer each time it empties
+ * and disables itself once the ring is drained.
+ *
+ * \return None
+ */
+void EUSCIA0_IRQHandler(void)
+{
+    INSTR_ISR_ENTER(INSTR_ISR_EUSCIA0);
+    uint32_t tail = txTail;
+    if (tail == txHead)
+    {
+        UART_disableInterrupt(EUSCI_A0_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
+        INSTR_ISR_EXIT(INSTR_ISR_EUSCIA0);
+        return;
+    }
+    UART_transmitData(EUSCI_A0_BASE, txBuffer[tail & TX_MASK]);
+    txTail = tail + 1;
+    INSTR_ISR_EXIT(INSTR_ISR_EUSCIA0);
+}
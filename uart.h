@@ -0,0 +1,99 @@
+/*!
+ * uart.h
+ *      Description: Header file for the backchannel UART console on eUSCI_A0
+ *                   (P1.2 RX, P1.3 TX), used for diagnostic reports. Output is
+ *                   buffered and sent from the transmit interrupt so callers
+ *                   never wait on the line.
+ *
+ *      Author: Cooper Brotherton
+ */
+
+#ifndef UART_H_
+#define UART_H_
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+#define UART_BAUD_RATE      115200
+#define UART_TX_BUFFER_SIZE 2048
+
+/*!
+ * \brief This function initializes the console UART
+ *
+ * This function configures eUSCI_A0 at UART_BAUD_RATE 8N1 from SMCLK. The
+ * transmit interrupt gets PRIORITY_EUSCIA0.
+ *
+ * \return None
+ */
+extern void Uart_init(void);
+
+/*!
+ * \brief This function recomputes the baud rate divider
+ *
+ * This function waits for the transmitter to go idle, then reprograms the
+ * baud rate for the current SMCLK. Registered as a clock listener.
+ *
+ * \param mclk is the new MCLK frequency in Hz (unused, UART runs from SMCLK)
+ *
+ * \return None
+ */
+extern void Uart_retime(uint32_t mclk);
+
+/*!
+ * \brief This function queues bytes for transmission
+ *
+ * This function copies as many bytes as fit into the transmit buffer.
+ *
+ * \param data is the bytes to send
+ * \param length is the number of bytes
+ *
+ * \return Number of bytes queued
+ */
+extern uint32_t Uart_write(const char *data, uint32_t length);
+
+/*!
+ * \brief This function queues a line of text
+ *
+ * This function sends a null terminated string followed by CR LF. Usable as
+ * the writer of the report functions.
+ *
+ * \param line is the text to send
+ *
+ * \return None
+ */
+extern void Uart_writeLine(const char *line);
+
+/*!
+ * \brief This function returns the free space in the transmit buffer
+ *
+ * \return Number of bytes that can be queued without dropping
+ */
+extern uint32_t Uart_getFree(void);
+
+/*!
+ * \brief This function returns the number of bytes dropped
+ *
+ * \return Bytes dropped because the transmit buffer was full
+ */
+extern uint32_t Uart_getDropped(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_H_ */